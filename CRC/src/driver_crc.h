@@ -0,0 +1,150 @@
+#ifndef __DRIVER_CRC_H
+#define __DRIVER_CRC_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief CRC计算的实现方式
+ * @note  速度依次提高，占用的Flash (查找表) 也依次增加：
+ * - BITWISE: 逐位计算，不需要查找表。
+ * - TABLE:   每字节查一次256项表。CRC-16表512字节，CRC-32表1KB。
+ * - SLICE4:  每次处理4字节，需要4张表。CRC-16共2KB，CRC-32共4KB。
+ * - SLICE8:  每次处理8字节，需要8张表。CRC-16共4KB，CRC-32共8KB。
+ * 所有实现的结果完全相同，可以互换。查找表都是const，存放在Flash中。
+ */
+#define CRC_VARIANT_BITWISE 0
+#define CRC_VARIANT_TABLE   1
+#define CRC_VARIANT_SLICE4  2
+#define CRC_VARIANT_SLICE8  3
+
+/**
+ * @brief 选择crc16_ccitt_update/crc32_update默认使用的实现方式
+ * @note  可以在编译选项中覆盖，例如 -DCRC_VARIANT=CRC_VARIANT_BITWISE。
+ * 每张查找表都是独立的数组，配合 -fdata-sections 和 --gc-sections 链接选项
+ * (STM32CubeIDE工程默认开启)，未被引用的表不会占用Flash。
+ */
+#ifndef CRC_VARIANT
+#define CRC_VARIANT CRC_VARIANT_TABLE
+#endif
+
+/* CRC-16/CCITT-FALSE -------------------------------------------------------*/
+// 多项式0x1021，初值0xFFFF，不反转，结果不异或。"123456789"的校验值为0x29B1。
+
+/**
+ * @brief  获取CRC-16/CCITT的初始值
+ * @return uint16_t - 初始值，作为第一次crc16_ccitt_update的输入
+ */
+uint16_t crc16_ccitt_init(void);
+
+/**
+ * @brief  增量计算CRC-16/CCITT
+ * @note   数据可以任意切分后多次调用，结果与一次性计算相同，
+ * 因此可以直接对环形缓冲区的两段数据、或逐块到达的数据流依次计算。
+ * @param[in] crc  - 上一次的计算结果 (第一次为crc16_ccitt_init的返回值)
+ * @param[in] data - 数据
+ * @param[in] len  - 数据长度
+ * @return uint16_t - 新的中间结果
+ */
+uint16_t crc16_ccitt_update(uint16_t crc, const void* data, uint32_t len);
+
+/**
+ * @brief  由中间结果得到最终的CRC-16/CCITT值
+ * @param[in] crc - 最后一次crc16_ccitt_update的返回值
+ * @return uint16_t - 校验值
+ */
+uint16_t crc16_ccitt_final(uint16_t crc);
+
+/**
+ * @brief  一次性计算一段数据的CRC-16/CCITT
+ */
+uint16_t crc16_ccitt(const void* data, uint32_t len);
+
+// 指定实现方式的版本，用于测试和基准测试，一般使用crc16_ccitt_update即可
+uint16_t crc16_ccitt_update_bitwise(uint16_t crc, const void* data, uint32_t len);
+uint16_t crc16_ccitt_update_table(uint16_t crc, const void* data, uint32_t len);
+uint16_t crc16_ccitt_update_slice4(uint16_t crc, const void* data, uint32_t len);
+uint16_t crc16_ccitt_update_slice8(uint16_t crc, const void* data, uint32_t len);
+
+/* CRC-16/MODBUS ------------------------------------------------------------*/
+// 多项式0x8005 (反转形式0xA001)，初值0xFFFF，输入输出反转，结果不异或。
+// "123456789"的校验值为0x4B37。Modbus RTU帧末尾先发低字节、后发高字节。
+// 帧最长只有256字节，因此只提供逐位和查表两种实现 (SLICE4/SLICE8时使用查表)。
+
+/**
+ * @brief  获取CRC-16/MODBUS的初始值
+ * @return uint16_t - 初始值，作为第一次crc16_modbus_update的输入
+ */
+uint16_t crc16_modbus_init(void);
+
+/**
+ * @brief  增量计算CRC-16/MODBUS
+ * @param[in] crc  - 上一次的计算结果 (第一次为crc16_modbus_init的返回值)
+ * @param[in] data - 数据
+ * @param[in] len  - 数据长度
+ * @return uint16_t - 新的中间结果
+ */
+uint16_t crc16_modbus_update(uint16_t crc, const void* data, uint32_t len);
+
+/**
+ * @brief  由中间结果得到最终的CRC-16/MODBUS值
+ * @param[in] crc - 最后一次crc16_modbus_update的返回值
+ * @return uint16_t - 校验值
+ */
+uint16_t crc16_modbus_final(uint16_t crc);
+
+/**
+ * @brief  一次性计算一段数据的CRC-16/MODBUS
+ */
+uint16_t crc16_modbus(const void* data, uint32_t len);
+
+// 指定实现方式的版本，用于测试和基准测试，一般使用crc16_modbus_update即可
+uint16_t crc16_modbus_update_bitwise(uint16_t crc, const void* data, uint32_t len);
+uint16_t crc16_modbus_update_table(uint16_t crc, const void* data, uint32_t len);
+
+/* CRC-32 (IEEE 802.3) ------------------------------------------------------*/
+// 多项式0x04C11DB7 (反转形式0xEDB88320)，初值0xFFFFFFFF，输入输出反转，
+// 结果异或0xFFFFFFFF。与zlib/以太网一致，"123456789"的校验值为0xCBF43926。
+
+/**
+ * @brief  获取CRC-32的初始值
+ * @return uint32_t - 初始值，作为第一次crc32_update的输入
+ */
+uint32_t crc32_init(void);
+
+/**
+ * @brief  增量计算CRC-32
+ * @note   数据可以任意切分后多次调用，结果与一次性计算相同。
+ * @param[in] crc  - 上一次的计算结果 (第一次为crc32_init的返回值)
+ * @param[in] data - 数据
+ * @param[in] len  - 数据长度
+ * @return uint32_t - 新的中间结果
+ */
+uint32_t crc32_update(uint32_t crc, const void* data, uint32_t len);
+
+/**
+ * @brief  由中间结果得到最终的CRC-32值
+ * @param[in] crc - 最后一次crc32_update的返回值
+ * @return uint32_t - 校验值
+ */
+uint32_t crc32_final(uint32_t crc);
+
+/**
+ * @brief  一次性计算一段数据的CRC-32
+ */
+uint32_t crc32(const void* data, uint32_t len);
+
+// 指定实现方式的版本，用于测试和基准测试，一般使用crc32_update即可
+uint32_t crc32_update_bitwise(uint32_t crc, const void* data, uint32_t len);
+uint32_t crc32_update_table(uint32_t crc, const void* data, uint32_t len);
+uint32_t crc32_update_slice4(uint32_t crc, const void* data, uint32_t len);
+uint32_t crc32_update_slice8(uint32_t crc, const void* data, uint32_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __DRIVER_CRC_H
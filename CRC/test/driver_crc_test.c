@@ -0,0 +1,148 @@
+#include "driver_crc_test.h"
+
+#include <string.h>
+#include "driver_bench.h"
+
+typedef uint16_t (*crc16_update_fn_t)(uint16_t crc, const void* data, uint32_t len);
+typedef uint32_t (*crc32_update_fn_t)(uint32_t crc, const void* data, uint32_t len);
+
+static const char* const s_variant_names[] = { "bitwise", "table", "slice4", "slice8" };
+
+static const crc16_update_fn_t s_crc16_variants[] = {
+    crc16_ccitt_update_bitwise,
+    crc16_ccitt_update_table,
+    crc16_ccitt_update_slice4,
+    crc16_ccitt_update_slice8,
+};
+
+static const crc32_update_fn_t s_crc32_variants[] = {
+    crc32_update_bitwise,
+    crc32_update_table,
+    crc32_update_slice4,
+    crc32_update_slice8,
+};
+
+#define CRC_VARIANT_COUNT (sizeof(s_variant_names) / sizeof(s_variant_names[0]))
+
+static uint32_t s_crc_rand_state = 0x12345678u;
+
+static uint32_t crc_rand(void) {
+    s_crc_rand_state = s_crc_rand_state * 1664525u + 1013904223u;
+    return s_crc_rand_state >> 8;
+}
+
+/* 正确性测试 ---------------------------------------------------------------*/
+
+#define CRC_TEST_BUF_SIZE 600
+
+led_status_t driver_crc_test(void) {
+    static uint8_t buffer[CRC_TEST_BUF_SIZE + 8];
+    static const uint8_t check[] = "123456789";
+
+    // 1. 标准检验值
+    if (crc16_ccitt(check, 9) != 0x29B1u || crc32(check, 9) != 0xCBF43926u) {
+        return LED_STATUS_ERROR;
+    }
+    for (uint8_t v = 0; v < CRC_VARIANT_COUNT; ++v) {
+        if (crc16_ccitt_final(s_crc16_variants[v](crc16_ccitt_init(), check, 9)) != 0x29B1u) {
+            return LED_STATUS_ERROR;
+        }
+        if (crc32_final(s_crc32_variants[v](crc32_init(), check, 9)) != 0xCBF43926u) {
+            return LED_STATUS_ERROR;
+        }
+    }
+
+    for (uint32_t i = 0; i < sizeof(buffer); ++i) {
+        buffer[i] = (uint8_t)crc_rand();
+    }
+
+    // CRC-16/MODBUS：检验值，以及查表与逐位实现、一次性与增量计算一致
+    if (crc16_modbus(check, 9) != 0x4B37u ||
+        crc16_modbus_final(crc16_modbus_update_bitwise(crc16_modbus_init(), check, 9)) != 0x4B37u) {
+        return LED_STATUS_ERROR;
+    }
+    for (uint32_t len = 0; len <= 256; ++len) {
+        uint16_t ref = crc16_modbus_update_bitwise(crc16_modbus_init(), buffer, len);
+        uint32_t split = crc_rand() % (len + 1);
+        uint16_t crc = crc16_modbus_update_table(crc16_modbus_init(), buffer, split);
+        crc = crc16_modbus_update_table(crc, &buffer[split], len - split);
+        if (crc16_modbus_update_table(crc16_modbus_init(), buffer, len) != ref || crc != ref) {
+            return LED_STATUS_ERROR;
+        }
+    }
+
+    // 2. 每种实现在各种起始对齐和长度下都与逐位实现一致
+    for (uint32_t offset = 0; offset < 8; ++offset) {
+        for (uint32_t len = 0; len <= 80; ++len) {
+            const uint8_t* p = &buffer[offset];
+            uint16_t ref16 = crc16_ccitt_update_bitwise(crc16_ccitt_init(), p, len);
+            uint32_t ref32 = crc32_update_bitwise(crc32_init(), p, len);
+            for (uint8_t v = 1; v < CRC_VARIANT_COUNT; ++v) {
+                if (s_crc16_variants[v](crc16_ccitt_init(), p, len) != ref16 ||
+                    s_crc32_variants[v](crc32_init(), p, len) != ref32) {
+                    return LED_STATUS_ERROR;
+                }
+            }
+        }
+    }
+
+    // 3. 增量计算：随机切分成若干块 (模拟环形缓冲区的两段、逐块到达的数据)，结果与一次性计算相同
+    uint16_t whole16 = crc16_ccitt(buffer, CRC_TEST_BUF_SIZE);
+    uint32_t whole32 = crc32(buffer, CRC_TEST_BUF_SIZE);
+    for (uint32_t round = 0; round < 200; ++round) {
+        uint8_t v = (uint8_t)(round % CRC_VARIANT_COUNT);
+        uint16_t crc16 = crc16_ccitt_init();
+        uint32_t crc32_value = crc32_init();
+        uint32_t pos = 0;
+        while (pos < CRC_TEST_BUF_SIZE) {
+            uint32_t chunk = crc_rand() % 70;
+            if (chunk > CRC_TEST_BUF_SIZE - pos) {
+                chunk = CRC_TEST_BUF_SIZE - pos;
+            }
+            crc16 = s_crc16_variants[v](crc16, &buffer[pos], chunk);
+            crc32_value = s_crc32_variants[v](crc32_value, &buffer[pos], chunk);
+            pos += chunk;
+        }
+        if (crc16_ccitt_final(crc16) != whole16 || crc32_final(crc32_value) != whole32) {
+            return LED_STATUS_ERROR;
+        }
+    }
+
+    return LED_STATUS_OK;
+}
+
+/* 吞吐量基准测试 -----------------------------------------------------------*/
+// 对4KB随机数据重复计算，统计每字节的平均耗时。
+
+#define CRC_BENCH_LEN    4096
+#define CRC_BENCH_ROUNDS 16
+
+void driver_crc_benchmark(void) {
+    static uint8_t buffer[CRC_BENCH_LEN];
+    volatile uint32_t sink = 0; // 防止计算结果被优化掉
+
+    for (uint32_t i = 0; i < CRC_BENCH_LEN; ++i) {
+        buffer[i] = (uint8_t)crc_rand();
+    }
+
+    bench_cycle_counter_init();
+    bench_report("crc benchmark (%s per byte x100, %u bytes)\r\n", BENCH_UNIT, (unsigned)CRC_BENCH_LEN);
+
+    for (uint8_t v = 0; v < CRC_VARIANT_COUNT; ++v) {
+        uint32_t t16 = 0;
+        uint32_t t32 = 0;
+        for (uint32_t round = 0; round < CRC_BENCH_ROUNDS; ++round) {
+            uint32_t t0 = bench_now();
+            sink += s_crc16_variants[v](crc16_ccitt_init(), buffer, CRC_BENCH_LEN);
+            uint32_t t1 = bench_now();
+            sink += s_crc32_variants[v](crc32_init(), buffer, CRC_BENCH_LEN);
+            uint32_t t2 = bench_now();
+            t16 += t1 - t0;
+            t32 += t2 - t1;
+        }
+        bench_report("%-8s crc16 %5lu, crc32 %5lu\r\n", s_variant_names[v],
+                     (unsigned long)((uint64_t)t16 * 100u / (CRC_BENCH_LEN * CRC_BENCH_ROUNDS)),
+                     (unsigned long)((uint64_t)t32 * 100u / (CRC_BENCH_LEN * CRC_BENCH_ROUNDS)));
+    }
+    (void)sink;
+}
@@ -0,0 +1,29 @@
+#ifndef __DRIVER_CRC_TEST_H
+#define __DRIVER_CRC_TEST_H
+
+#include "driver_led_interface.h" // 复用led_status_t等定义
+#include "driver_crc.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief CRC正确性测试：校验标准检验值，并验证各实现方式、任意对齐和任意切分的结果一致
+ * @return led_status_t - 全部通过返回LED_STATUS_OK
+ */
+led_status_t driver_crc_test(void);
+
+/**
+ * @brief CRC吞吐量基准测试：比较逐位、查表、slice-by-4和slice-by-8的速度
+ * @note  在目标板上使用DWT周期计数器 (单位为周期)，在PC上使用系统单调时钟 (单位为纳秒)。
+ * 结果通过g_uart1输出，需在g_uart1完成uart_init之后调用。
+ */
+void driver_crc_benchmark(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -1,33 +1,37 @@
 #include "driver_i2c_test.h"
 
-#include <stdio.h>          // 用于printf
 #include <string.h>         // 用于memcmp和strlen
 
 /* Private variables ---------------------------------------------------------*/
 // 定义I2C驱动对象
 i2c_t g_i2c1;
-extern UART_HandleTypeDef* huart1;
+
+// 日志输出：通过UART1异步发送，记录日志不会阻塞I2C传输
+static uart_t s_log_uart;
+static uint8_t s_log_uart_rx_buffer[16];
+static uint8_t s_log_uart_tx_buffer[512];
+static log_slot_t s_log_slots[16];
+static log_t s_log;
 
 
 // 定义EEPROM设备地址 (AT24C02/AT24C04... 的地址通常是0x50)
 #define EEPROM_DEVICE_ADDRESS 0x50
 
-// printf重定向到UART1的实现
-#ifdef __GNUC__
-#define PUTCHAR_PROTOTYPE int __io_putchar(int ch)
-#else
-#define PUTCHAR_PROTOTYPE int fputc(int ch, FILE *f)
-#endif
-PUTCHAR_PROTOTYPE
-{
-  HAL_UART_Transmit(&huart1, (uint8_t*) &ch, 1, 0xFFFF);
-  return ch;
+// 停机：不再继续测试，但仍然把已记录的日志输出完
+static void log_halt(void) {
+    while (1) {
+        log_process(&s_log);
+    }
 }
 
 
 void driver_i2c_test(void) {
 
-    printf("\r\n--- I2C EEPROM Test Program ---\r\n");
+    uart_init(&s_log_uart, bsp_uart_get_api(), (void*) &g_bsp_usart1, s_log_uart_rx_buffer,
+              sizeof(s_log_uart_rx_buffer), s_log_uart_tx_buffer, sizeof(s_log_uart_tx_buffer));
+    log_init(&s_log, &s_log_uart, LOG_OUTPUT_TEXT, s_log_slots, 16);
+
+    LOG_INFO(&s_log, "--- I2C EEPROM Test Program ---\r\n");
 
     /* 驱动初始化 -------------------------------------------------------------*/
     const i2c_api_t* i2c_api = bsp_i2c_get_api();
@@ -35,12 +39,12 @@ void driver_i2c_test(void) {
 
     /* 应用逻辑：EEPROM读写测试 ------------------------------------------------*/
     // 1. 检查设备是否就绪
-    printf("Checking for EEPROM at address 0x%02X... ", EEPROM_DEVICE_ADDRESS);
+    LOG_INFO(&s_log, "Checking for EEPROM at address 0x%02X...\r\n", EEPROM_DEVICE_ADDRESS);
     if (i2c_is_device_ready(&g_i2c1, EEPROM_DEVICE_ADDRESS, 100) == LED_STATUS_OK) {
-        printf("Device found!\r\n");
+        LOG_INFO(&s_log, "Device found!\r\n");
     } else {
-        printf("Device not found! Halting.\r\n");
-        while (1);
+        LOG_ERROR(&s_log, "Device not found! Halting.\r\n");
+        log_halt();
     }
 
     // 2. 准备要写入的数据
@@ -50,39 +54,41 @@ void driver_i2c_test(void) {
     uint16_t mem_address = 0x10; // 写入到EEPROM的地址0x10
 
     // 3. 写入数据到EEPROM
-    printf("Writing %d bytes to memory address 0x%04X...\r\n", data_len, mem_address);
+    LOG_INFO(&s_log, "Writing %d bytes to memory address 0x%04X...\r\n", data_len, mem_address);
     if (i2c_mem_write(&g_i2c1, EEPROM_DEVICE_ADDRESS, mem_address, I2C_MEM_ADDR_SIZE_8BIT, write_data, data_len) == LED_STATUS_OK) {
-        printf("Write successful.\r\n");
+        LOG_INFO(&s_log, "Write successful.\r\n");
     } else {
-        printf("Write failed! Halting.\r\n");
-        while (1);
+        LOG_ERROR(&s_log, "Write failed! Halting.\r\n");
+        log_halt();
     }
 
     // 4. 等待EEPROM内部写操作完成 (AT24C02典型值为5ms)
     HAL_Delay(10);
 
     // 5. 从EEPROM同一地址读出数据
-    printf("Reading %d bytes from memory address 0x%04X...\r\n", data_len, mem_address);
+    LOG_INFO(&s_log, "Reading %d bytes from memory address 0x%04X...\r\n", data_len, mem_address);
     if (i2c_mem_read(&g_i2c1, EEPROM_DEVICE_ADDRESS, mem_address, I2C_MEM_ADDR_SIZE_8BIT, read_data, data_len) == LED_STATUS_OK) {
-        printf("Read successful. Data: \"%s\"\r\n", (char*) read_data);
+        // read_data在本函数中一直有效 (函数不会返回)，可以作为%s参数延迟格式化
+        LOG_INFO(&s_log, "Read successful. Data: \"%s\"\r\n", (uint32_t)(uintptr_t) read_data);
     } else {
-        printf("Read failed! Halting.\r\n");
-        while (1);
+        LOG_ERROR(&s_log, "Read failed! Halting.\r\n");
+        log_halt();
     }
 
     // 6. 比较写入和读出的数据是否一致
-    printf("Verifying data... ");
+    LOG_INFO(&s_log, "Verifying data...\r\n");
     if (memcmp(write_data, read_data, data_len) == 0) {
-        printf("Verification successful!\r\n");
+        LOG_INFO(&s_log, "Verification successful!\r\n");
     } else {
-        printf("Verification failed!\r\n");
+        LOG_ERROR(&s_log, "Verification failed!\r\n");
     }
 
-    printf("--- Test Finished ---\r\n");
+    LOG_INFO(&s_log, "--- Test Finished ---\r\n");
 
     while (1)
     {
-        
+        // 主循环空闲时输出日志
+        log_process(&s_log);
     }
     
 
@@ -3,6 +3,8 @@
 
 #include "driver_i2c_bsp.h"
 #include "driver_i2c.h"
+#include "driver_uart_bsp.h"
+#include "driver_log.h"
 
 
 #ifdef __cplusplus
@@ -17,6 +17,8 @@ typedef enum {
     LED_STATUS_ERROR        = 1,    /**< 通用/未知错误 */
     LED_STATUS_INV_ARG      = 2,    /**< 无效参数 */
     LED_STATUS_NOT_SUPPORTED = 3,    /**< 功能不被支持 (例如，对普通LED调用调光) */
+    LED_STATUS_BUSY         = 4,    /**< 资源忙或队列已满，稍后重试 */
+    LED_STATUS_TIMEOUT      = 5,    /**< 操作在规定时间内未完成 */
 } led_status_t;
 
 /**
@@ -0,0 +1,218 @@
+#include "driver_log.h"
+
+#include <stdio.h>  // For snprintf
+#include <string.h> // For memcpy
+#include "driver_atomic.h"
+
+static const char* const s_level_names[] = { "E", "W", "I", "D" };
+
+led_status_t log_init(log_t* log, uart_t* uart, log_output_t output, log_slot_t* slots, uint32_t slot_count) {
+    if (log == NULL || uart == NULL || slots == NULL) {
+        return LED_STATUS_INV_ARG;
+    }
+    if (slot_count < 2 || (slot_count & (slot_count - 1)) != 0) {
+        return LED_STATUS_INV_ARG;
+    }
+    if (output != LOG_OUTPUT_TEXT && output != LOG_OUTPUT_BINARY) {
+        return LED_STATUS_INV_ARG;
+    }
+
+    log->uart = uart;
+    log->output = output;
+    if (uart_frame_init(&log->frame, uart, UART_FRAME_COBS, log->frame_unused, sizeof(log->frame_unused)) !=
+        LED_STATUS_OK) {
+        return LED_STATUS_INV_ARG;
+    }
+
+    // 每个槽位的序号初始化为自己的下标，表示“可以写入第i条”
+    log->slots = slots;
+    log->mask = slot_count - 1;
+    for (uint32_t i = 0; i < slot_count; ++i) {
+        slots[i].sequence = i;
+    }
+    log->enqueue_pos = 0;
+    log->dequeue_pos = 0;
+    log->dropped = 0;
+    log->dropped_reported = 0;
+    log->line_len = 0;
+    return LED_STATUS_OK;
+}
+
+led_status_t log_record(log_t* log, log_level_t level, const char* fmt, uint32_t nargs, const uint32_t* args) {
+    if (log == NULL || log->slots == NULL || fmt == NULL) {
+        return LED_STATUS_INV_ARG;
+    }
+
+    // 有界多生产者队列：槽位序号等于写入位置时槽位空闲，抢到写入位置的一方独占该槽位
+    log_slot_t* slot;
+    uint32_t pos = DRIVER_LOAD_RELAXED(&log->enqueue_pos);
+    for (;;) {
+        slot = &log->slots[pos & log->mask];
+        int32_t diff = (int32_t)(DRIVER_LOAD_ACQUIRE(&slot->sequence) - pos);
+        if (diff == 0) {
+            if (driver_atomic_cas(&log->enqueue_pos, pos, pos + 1)) {
+                break;
+            }
+            pos = DRIVER_LOAD_RELAXED(&log->enqueue_pos);
+        } else if (diff < 0) {
+            // 槽位还没有被log_process取走：队列已满
+            (void)driver_atomic_fetch_add(&log->dropped, 1);
+            return LED_STATUS_BUSY;
+        } else {
+            pos = DRIVER_LOAD_RELAXED(&log->enqueue_pos);
+        }
+    }
+
+    if (nargs > LOG_MAX_ARGS) {
+        nargs = LOG_MAX_ARGS;
+    }
+    slot->fmt = fmt;
+    slot->tick = log->uart->api->get_tick();
+    slot->level = (uint8_t)level;
+    slot->nargs = (uint8_t)nargs;
+    memcpy(slot->args, args, nargs * sizeof(uint32_t));
+
+    // 发布：序号变为pos+1，表示第pos条已经写好
+    DRIVER_STORE_RELEASE(&slot->sequence, pos + 1);
+    return LED_STATUS_OK;
+}
+
+/**
+ * @brief 内部函数：发出TEXT模式行缓冲区中的内容
+ * @return uint8_t - 发送队列已满、需要稍后重试时返回0
+ */
+static uint8_t log_flush_line(log_t* log) {
+    if (log->line_len == 0) {
+        return 1;
+    }
+    if (uart_write(log->uart, (const uint8_t*)log->line, log->line_len) == LED_STATUS_BUSY) {
+        return 0;
+    }
+    log->line_len = 0;
+    return 1;
+}
+
+/**
+ * @brief 内部函数：格式化一条日志到行缓冲区
+ * @note  参数全部按32位整数传给snprintf，格式字符串中多余的参数会被忽略。
+ */
+static void log_format(log_t* log, const log_slot_t* slot) {
+    uint32_t a[6] = { 0 };
+    memcpy(a, slot->args, slot->nargs * sizeof(uint32_t));
+
+    int n = snprintf(log->line, sizeof(log->line), "[%lu] %s: ", (unsigned long)slot->tick,
+                     s_level_names[slot->level & 3]);
+    if (n < 0) {
+        n = 0;
+    }
+    int m = snprintf(&log->line[n], sizeof(log->line) - (uint32_t)n, slot->fmt, a[0], a[1], a[2], a[3], a[4], a[5]);
+    if (m < 0) {
+        m = 0;
+    }
+    // 超长的行被截断
+    uint32_t len = (uint32_t)n + (uint32_t)m;
+    log->line_len = (len < sizeof(log->line)) ? len : sizeof(log->line) - 1;
+}
+
+/**
+ * @brief 内部函数：BINARY模式下把一条日志编码为一帧发出
+ */
+static led_status_t log_send_binary(log_t* log, uint32_t id, uint32_t tick, uint8_t level, uint8_t nargs,
+                                    const uint32_t* args) {
+    uint8_t record[10 + 4 * LOG_MAX_ARGS];
+    uint32_t len = 0;
+    uint32_t words[2] = { id, tick };
+
+    for (uint32_t w = 0; w < 2; ++w) {
+        for (uint32_t b = 0; b < 4; ++b) {
+            record[len++] = (uint8_t)(words[w] >> (8 * b));
+        }
+    }
+    record[len++] = level;
+    record[len++] = nargs;
+    for (uint32_t i = 0; i < nargs; ++i) {
+        for (uint32_t b = 0; b < 4; ++b) {
+            record[len++] = (uint8_t)(args[i] >> (8 * b));
+        }
+    }
+    return uart_frame_send(&log->frame, record, len);
+}
+
+/**
+ * @brief 内部函数：报告新增的丢弃条数
+ * @return uint8_t - 发送队列已满、需要稍后重试时返回0
+ */
+static uint8_t log_report_dropped(log_t* log) {
+    uint32_t dropped = DRIVER_LOAD_RELAXED(&log->dropped);
+    uint32_t count = dropped - log->dropped_reported;
+    if (count == 0) {
+        return 1;
+    }
+
+    if (log->output == LOG_OUTPUT_BINARY) {
+        if (log_send_binary(log, 0, log->uart->api->get_tick(), LOG_LEVEL_WARN, 1, &count) != LED_STATUS_OK) {
+            return 0;
+        }
+    } else {
+        int n = snprintf(log->line, sizeof(log->line), "[log] %lu messages dropped\r\n", (unsigned long)count);
+        log->line_len = (n > 0) ? (uint32_t)n : 0;
+        if (!log_flush_line(log)) {
+            // 行已经格式化好，下次调用时由log_flush_line发出
+            log->dropped_reported = dropped;
+            return 0;
+        }
+    }
+    log->dropped_reported = dropped;
+    return 1;
+}
+
+uint32_t log_process(log_t* log) {
+    if (log == NULL || log->slots == NULL) {
+        return 0;
+    }
+
+    // 先发完上次因发送队列已满而留下的行
+    if (!log_flush_line(log)) {
+        return 0;
+    }
+
+    uint32_t count = 0;
+    for (;;) {
+        if (!log_report_dropped(log)) {
+            break;
+        }
+
+        log_slot_t* slot = &log->slots[log->dequeue_pos & log->mask];
+        if (DRIVER_LOAD_ACQUIRE(&slot->sequence) != log->dequeue_pos + 1) {
+            // 队列为空，或者生产者还在写这个槽位
+            break;
+        }
+
+        if (log->output == LOG_OUTPUT_BINARY) {
+            if (log_send_binary(log, (uint32_t)(uintptr_t)slot->fmt, slot->tick, slot->level, slot->nargs,
+                                slot->args) != LED_STATUS_OK) {
+                break;
+            }
+        } else {
+            log_format(log, slot);
+        }
+
+        // 释放槽位：序号加上槽位数，表示它可以写入下一圈的同一位置
+        DRIVER_STORE_RELEASE(&slot->sequence, log->dequeue_pos + log->mask + 1);
+        log->dequeue_pos++;
+        count++;
+
+        // 格式化好的行已经离开槽位，发送失败时留在行缓冲区，下次再发
+        if (!log_flush_line(log)) {
+            break;
+        }
+    }
+    return count;
+}
+
+uint32_t log_get_dropped(log_t* log) {
+    if (log == NULL) {
+        return 0;
+    }
+    return DRIVER_LOAD_RELAXED(&log->dropped);
+}
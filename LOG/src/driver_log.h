@@ -0,0 +1,166 @@
+#ifndef __DRIVER_LOG_H
+#define __DRIVER_LOG_H
+
+#include "driver_uart.h"
+#include "driver_uart_frame.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 每条日志最多携带的参数个数
+ * @note  每个参数都按32位整数原样记录，格式化推迟到log_process (或PC端) 进行。
+ * 因此参数只能是整数、字符或指针：不支持浮点数和64位整数；
+ * %s对应的字符串必须在日志被输出之前一直有效 (例如字符串常量)。最多为6。
+ */
+#ifndef LOG_MAX_ARGS
+#define LOG_MAX_ARGS 6
+#endif
+#if LOG_MAX_ARGS > 6
+#error "LOG_MAX_ARGS must not exceed 6"
+#endif
+
+/**
+ * @brief 日志级别
+ */
+typedef enum {
+    LOG_LEVEL_ERROR = 0,
+    LOG_LEVEL_WARN,
+    LOG_LEVEL_INFO,
+    LOG_LEVEL_DEBUG,
+} log_level_t;
+
+/**
+ * @brief 编译期日志级别：高于该级别的日志语句被完全移除
+ */
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_DEBUG
+#endif
+
+/**
+ * @brief 日志输出格式
+ * @note  - TEXT:   在log_process中用snprintf格式化为一行文本："[节拍] 级别: 内容"。
+ * - BINARY: 不格式化，每条日志原样编码为一个COBS帧，由PC端根据固件的符号表还原。
+ *   帧内容 (小端)：格式字符串地址(4) 节拍(4) 级别(1) 参数个数(1) 参数(4*n)。
+ *   格式字符串地址就是这条日志的ID，在固件的.rodata段中可以查到对应的字符串。
+ *   地址为0的帧表示丢弃通知，唯一的参数是被丢弃的日志条数。
+ */
+typedef enum {
+    LOG_OUTPUT_TEXT = 0,
+    LOG_OUTPUT_BINARY
+} log_output_t;
+
+/**
+ * @brief 一条尚未输出的日志 (固定大小的槽位)
+ */
+typedef struct {
+    uint32_t sequence;              /**< 槽位序号，用于多生产者无锁入队 */
+    const char* fmt;                /**< 格式字符串 (同时作为日志ID) */
+    uint32_t tick;                  /**< 记录时的系统节拍 */
+    uint8_t level;                  /**< 日志级别 */
+    uint8_t nargs;                  /**< 参数个数 */
+    uint32_t args[LOG_MAX_ARGS];    /**< 原始参数 */
+} log_slot_t;
+
+/**
+ * @brief 延迟日志对象
+ * @note  记录端只做一次CAS和几十字节的拷贝，可以在任意上下文 (包括中断) 中调用，不会阻塞。
+ * 格式化和发送都在log_process中完成，它应在主循环的空闲时间里调用，唯一的消费者。
+ * 队列满时新日志被丢弃并计数，输出时会报告丢弃的条数。
+ */
+typedef struct {
+    uart_t* uart;                   /**< 输出使用的串口 (异步发送) */
+    log_output_t output;            /**< 输出格式 */
+    uart_frame_t frame;             /**< BINARY模式的COBS编码器 */
+    uint8_t frame_unused[1];        /**< 编码器的接收缓冲区 (日志只发送，不使用) */
+
+    log_slot_t* slots;              /**< 槽位数组 */
+    uint32_t mask;                  /**< 槽位数 - 1 (槽位数为2的幂) */
+    uint32_t enqueue_pos;           /**< 下一个写入位置 (生产者通过CAS推进) */
+    uint32_t dequeue_pos;           /**< 下一个读取位置 (只由log_process更新) */
+
+    uint32_t dropped;               /**< 因队列已满而丢弃的日志条数 (累计) */
+    uint32_t dropped_reported;      /**< 已经报告过的丢弃条数 */
+
+    char line[128];                 /**< TEXT模式的行缓冲区 */
+    uint32_t line_len;              /**< 已格式化但因发送队列已满而尚未发出的长度 */
+} log_t;
+
+/**
+ * @brief  初始化一个日志对象
+ * @param[in] log        - 指向log_t对象的指针
+ * @param[in] uart       - 已初始化的串口对象
+ * @param[in] output     - 输出格式
+ * @param[in] slots      - 槽位数组
+ * @param[in] slot_count - 槽位数，必须是2的幂
+ * @return led_status_t - 操作的状态码
+ */
+led_status_t log_init(log_t* log, uart_t* uart, log_output_t output, log_slot_t* slots, uint32_t slot_count);
+
+/**
+ * @brief  记录一条日志 (一般通过LOG_ERROR/LOG_WARN/LOG_INFO/LOG_DEBUG宏调用)
+ * @param[in] log   - 指向log_t对象的指针
+ * @param[in] level - 日志级别
+ * @param[in] fmt   - printf风格的格式字符串，必须是字符串常量
+ * @param[in] nargs - 参数个数 (超过LOG_MAX_ARGS的部分被忽略)
+ * @param[in] args  - 参数数组
+ * @return led_status_t - 操作的状态码。队列已满时返回LED_STATUS_BUSY，该日志被丢弃
+ */
+led_status_t log_record(log_t* log, log_level_t level, const char* fmt, uint32_t nargs, const uint32_t* args);
+
+/**
+ * @brief  输出队列中的日志
+ * @note   应在主循环中周期性调用。串口发送队列已满时提前返回，剩下的日志留到下次输出。
+ * @param[in] log - 指向log_t对象的指针
+ * @return uint32_t - 本次输出的日志条数
+ */
+uint32_t log_process(log_t* log);
+
+/**
+ * @brief  获取丢弃的日志条数 (累计)
+ * @param[in] log - 指向log_t对象的指针
+ * @return uint32_t - 丢弃条数
+ */
+uint32_t log_get_dropped(log_t* log);
+
+// 参数个数：借助一个以0开头的复合字面量计算，支持0个参数
+#define LOG_ARGS_(...)  ((const uint32_t[]){ 0, ##__VA_ARGS__ })
+#define LOG_NARGS_(...) (sizeof(LOG_ARGS_(__VA_ARGS__)) / sizeof(uint32_t) - 1)
+#define LOG_RECORD_(log, level, fmt, ...) \
+    log_record((log), (level), (fmt), LOG_NARGS_(__VA_ARGS__), &LOG_ARGS_(__VA_ARGS__)[1])
+
+/**
+ * @brief 日志记录宏。用法与printf相同，只是第一个参数是日志对象：
+ * LOG_INFO(&g_log, "value=%d\r\n", value);
+ */
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(log, fmt, ...) LOG_RECORD_(log, LOG_LEVEL_ERROR, fmt, ##__VA_ARGS__)
+#else
+#define LOG_ERROR(log, fmt, ...) ((void)0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WARN(log, fmt, ...) LOG_RECORD_(log, LOG_LEVEL_WARN, fmt, ##__VA_ARGS__)
+#else
+#define LOG_WARN(log, fmt, ...) ((void)0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(log, fmt, ...) LOG_RECORD_(log, LOG_LEVEL_INFO, fmt, ##__VA_ARGS__)
+#else
+#define LOG_INFO(log, fmt, ...) ((void)0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(log, fmt, ...) LOG_RECORD_(log, LOG_LEVEL_DEBUG, fmt, ##__VA_ARGS__)
+#else
+#define LOG_DEBUG(log, fmt, ...) ((void)0)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __DRIVER_LOG_H
@@ -0,0 +1,29 @@
+#ifndef __DRIVER_LOG_TEST_H
+#define __DRIVER_LOG_TEST_H
+
+#include "driver_log.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 日志功能测试：文本格式化、队列满时的丢弃计数与报告、发送队列满时的续传，
+ * 以及二进制模式的COBS帧内容 (用分帧器解码后逐字段核对)
+ * @return led_status_t - 全部通过返回LED_STATUS_OK
+ */
+led_status_t driver_log_test(void);
+
+/**
+ * @brief 日志记录开销基准测试：比较LOG_INFO与在调用处直接snprintf格式化的耗时
+ * @note  在目标板上使用DWT周期计数器 (单位为周期)，在PC上使用系统单调时钟 (单位为纳秒)。
+ * 结果通过g_uart1输出，需在g_uart1完成uart_init之后调用。
+ */
+void driver_log_benchmark(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
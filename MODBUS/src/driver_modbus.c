@@ -0,0 +1,380 @@
+#include "driver_modbus.h"
+
+#include <string.h> // For memset
+#include "driver_crc.h"
+
+/**
+ * @brief 协议规定的单次请求数量上限
+ */
+#define MODBUS_MAX_READ_BITS       2000u
+#define MODBUS_MAX_READ_REGISTERS  125u
+#define MODBUS_MAX_WRITE_BITS      1968u
+#define MODBUS_MAX_WRITE_REGISTERS 123u
+
+/* 帧访问辅助函数 -----------------------------------------------------------*/
+// 请求帧直接留在接收环形缓冲区中，最多分为两段；应答帧直接生成在发送队列的预留空间中，
+// 同样最多两段。下面的函数按帧内偏移访问字节，屏蔽回绕处的分段。
+
+static inline uint8_t span_get(const uart_span_t spans[2], uint32_t i) {
+    return (i < spans[0].len) ? spans[0].data[i] : spans[1].data[i - spans[0].len];
+}
+
+static inline uint16_t span_get16(const uart_span_t spans[2], uint32_t i) {
+    return (uint16_t)(((uint16_t)span_get(spans, i) << 8) | span_get(spans, i + 1));
+}
+
+static inline void span_put(uart_span_t spans[2], uint32_t i, uint8_t value) {
+    if (i < spans[0].len) {
+        spans[0].data[i] = value;
+    } else {
+        spans[1].data[i - spans[0].len] = value;
+    }
+}
+
+static inline void span_put16(uart_span_t spans[2], uint32_t i, uint16_t value) {
+    span_put(spans, i, (uint8_t)(value >> 8));
+    span_put(spans, i + 1, (uint8_t)value);
+}
+
+// 计算帧中前len个字节的CRC (直接在两段上计算，不拷贝)
+static uint16_t span_crc(const uart_span_t spans[2], uint32_t len) {
+    uint32_t first = (len < spans[0].len) ? len : spans[0].len;
+    uint16_t crc = crc16_modbus_update(crc16_modbus_init(), spans[0].data, first);
+    if (len > first) {
+        crc = crc16_modbus_update(crc, spans[1].data, len - first);
+    }
+    return crc16_modbus_final(crc);
+}
+
+/* 地址表 -------------------------------------------------------------------*/
+
+/**
+ * @brief 内部函数：查找完整包含 [address, address + count) 的数据段
+ * @return const modbus_block_t* - 找不到时返回NULL
+ */
+static const modbus_block_t* find_block(const modbus_table_t* table, uint16_t address, uint16_t count) {
+    // 二分查找起始地址不大于address的最后一段
+    uint32_t lo = 0;
+    uint32_t hi = table->count;
+    while (lo < hi) {
+        uint32_t mid = (lo + hi) / 2;
+        if (table->blocks[mid].start <= address) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo == 0) {
+        return NULL;
+    }
+
+    const modbus_block_t* block = &table->blocks[lo - 1];
+    if ((uint32_t)address + count > (uint32_t)block->start + block->count) {
+        return NULL;
+    }
+    return block;
+}
+
+/* 请求处理 -----------------------------------------------------------------*/
+
+/**
+ * @brief 应答帧的描述：长度确定后一次性在发送队列中预留，再原地填充
+ */
+typedef struct {
+    uint32_t len;               /**< 应答帧长度 (不含CRC)，0表示不应答 */
+    uint8_t exception;          /**< 非0时以该异常码应答 */
+} modbus_reply_t;
+
+/**
+ * @brief 内部函数：检查请求并执行写操作，确定应答的长度
+ * @note  读请求的数据在填充应答时才读取 (fill_reply)，这里只做检查。
+ */
+static modbus_reply_t execute(modbus_slave_t* slave, const uart_span_t req[2], uint32_t len) {
+    modbus_reply_t reply = { 0, 0 };
+    uint8_t fc = span_get(req, 1);
+    modbus_table_type_t type;
+    uint32_t max_qty;
+    uint8_t is_bits;
+
+    switch (fc) {
+        case MODBUS_FC_READ_COILS:             type = MODBUS_COILS;             max_qty = MODBUS_MAX_READ_BITS;       is_bits = 1; break;
+        case MODBUS_FC_READ_DISCRETE_INPUTS:   type = MODBUS_DISCRETE_INPUTS;   max_qty = MODBUS_MAX_READ_BITS;       is_bits = 1; break;
+        case MODBUS_FC_READ_HOLDING_REGISTERS: type = MODBUS_HOLDING_REGISTERS; max_qty = MODBUS_MAX_READ_REGISTERS;  is_bits = 0; break;
+        case MODBUS_FC_READ_INPUT_REGISTERS:   type = MODBUS_INPUT_REGISTERS;   max_qty = MODBUS_MAX_READ_REGISTERS;  is_bits = 0; break;
+        case MODBUS_FC_WRITE_SINGLE_COIL:      type = MODBUS_COILS;             max_qty = 1;                          is_bits = 1; break;
+        case MODBUS_FC_WRITE_SINGLE_REGISTER:  type = MODBUS_HOLDING_REGISTERS; max_qty = 1;                          is_bits = 0; break;
+        case MODBUS_FC_WRITE_MULTIPLE_COILS:   type = MODBUS_COILS;             max_qty = MODBUS_MAX_WRITE_BITS;      is_bits = 1; break;
+        case MODBUS_FC_WRITE_MULTIPLE_REGISTERS: type = MODBUS_HOLDING_REGISTERS; max_qty = MODBUS_MAX_WRITE_REGISTERS; is_bits = 0; break;
+        default:
+            reply.exception = MODBUS_EX_ILLEGAL_FUNCTION;
+            return reply;
+    }
+
+    // 所有支持的请求都以 地址(1) 功能码(1) 起始地址(2) 数量或值(2) 开头
+    if (len < 6) {
+        reply.exception = MODBUS_EX_ILLEGAL_DATA_VALUE;
+        return reply;
+    }
+    uint16_t address = span_get16(req, 2);
+    uint16_t value = span_get16(req, 4);
+    uint16_t qty = 1;
+    uint32_t expect_len = 6;
+
+    if (fc == MODBUS_FC_WRITE_SINGLE_COIL) {
+        if (value != 0xFF00u && value != 0x0000u) {
+            reply.exception = MODBUS_EX_ILLEGAL_DATA_VALUE;
+            return reply;
+        }
+    } else if (fc != MODBUS_FC_WRITE_SINGLE_REGISTER) {
+        qty = value;
+        if (qty == 0 || qty > max_qty) {
+            reply.exception = MODBUS_EX_ILLEGAL_DATA_VALUE;
+            return reply;
+        }
+        if (fc == MODBUS_FC_WRITE_MULTIPLE_COILS || fc == MODBUS_FC_WRITE_MULTIPLE_REGISTERS) {
+            // 字节数必须与数量一致，且与帧长度一致
+            uint32_t byte_count = is_bits ? ((uint32_t)qty + 7u) / 8u : (uint32_t)qty * 2u;
+            if (len < 7 || span_get(req, 6) != byte_count) {
+                reply.exception = MODBUS_EX_ILLEGAL_DATA_VALUE;
+                return reply;
+            }
+            expect_len = 7 + byte_count;
+        }
+    }
+    if (len != expect_len) {
+        reply.exception = MODBUS_EX_ILLEGAL_DATA_VALUE;
+        return reply;
+    }
+
+    const modbus_block_t* block = find_block(&slave->tables[type], address, qty);
+    if (block == NULL) {
+        reply.exception = MODBUS_EX_ILLEGAL_DATA_ADDRESS;
+        return reply;
+    }
+    uint32_t offset = (uint32_t)address - block->start;
+
+    switch (fc) {
+        case MODBUS_FC_READ_COILS:
+        case MODBUS_FC_READ_DISCRETE_INPUTS:
+            reply.len = 3 + ((uint32_t)qty + 7u) / 8u;
+            return reply;
+        case MODBUS_FC_READ_HOLDING_REGISTERS:
+        case MODBUS_FC_READ_INPUT_REGISTERS:
+            reply.len = 3 + (uint32_t)qty * 2u;
+            return reply;
+        default:
+            break;
+    }
+
+    // 写操作
+    if (block->read_only) {
+        reply.exception = MODBUS_EX_ILLEGAL_DATA_ADDRESS;
+        return reply;
+    }
+    if (fc == MODBUS_FC_WRITE_SINGLE_COIL) {
+        ((uint8_t*)block->data)[offset] = (value == 0xFF00u) ? 1 : 0;
+    } else if (fc == MODBUS_FC_WRITE_SINGLE_REGISTER) {
+        ((uint16_t*)block->data)[offset] = value;
+    } else if (fc == MODBUS_FC_WRITE_MULTIPLE_COILS) {
+        uint8_t* bits = (uint8_t*)block->data + offset;
+        for (uint32_t i = 0; i < qty; ++i) {
+            bits[i] = (uint8_t)((span_get(req, 7 + i / 8) >> (i % 8)) & 1u);
+        }
+    } else {
+        uint16_t* regs = (uint16_t*)block->data + offset;
+        for (uint32_t i = 0; i < qty; ++i) {
+            regs[i] = span_get16(req, 7 + 2 * i);
+        }
+    }
+
+    if (slave->on_write) {
+        slave->on_write(slave, type, address, qty, slave->user_data);
+    }
+    // 写操作的应答是请求的前6个字节
+    reply.len = 6;
+    return reply;
+}
+
+/**
+ * @brief 内部函数：在发送队列的预留空间中填充应答 (不含CRC)
+ */
+static void fill_reply(modbus_slave_t* slave, const uart_span_t req[2], uart_span_t rsp[2], modbus_reply_t reply) {
+    uint8_t fc = span_get(req, 1);
+    span_put(rsp, 0, slave->address);
+
+    if (reply.exception != 0) {
+        span_put(rsp, 1, (uint8_t)(fc | 0x80u));
+        span_put(rsp, 2, reply.exception);
+        return;
+    }
+
+    span_put(rsp, 1, fc);
+    if (fc >= MODBUS_FC_WRITE_SINGLE_COIL) {
+        for (uint32_t i = 2; i < 6; ++i) {
+            span_put(rsp, i, span_get(req, i));
+        }
+        return;
+    }
+
+    uint16_t address = span_get16(req, 2);
+    uint16_t qty = span_get16(req, 4);
+    modbus_table_type_t type = (modbus_table_type_t)(fc - MODBUS_FC_READ_COILS);
+    const modbus_block_t* block = find_block(&slave->tables[type], address, qty);
+    uint32_t offset = (uint32_t)address - block->start;
+    span_put(rsp, 2, (uint8_t)(reply.len - 3));
+
+    if (fc == MODBUS_FC_READ_COILS || fc == MODBUS_FC_READ_DISCRETE_INPUTS) {
+        // 位数据按字节打包，低位在前，最后一个字节的高位补0
+        const uint8_t* bits = (const uint8_t*)block->data + offset;
+        for (uint32_t i = 0; i < qty; i += 8) {
+            uint8_t byte = 0;
+            uint32_t n = (qty - i < 8) ? qty - i : 8;
+            for (uint32_t b = 0; b < n; ++b) {
+                if (bits[i + b]) {
+                    byte |= (uint8_t)(1u << b);
+                }
+            }
+            span_put(rsp, 3 + i / 8, byte);
+        }
+    } else {
+        const uint16_t* regs = (const uint16_t*)block->data + offset;
+        for (uint32_t i = 0; i < qty; ++i) {
+            span_put16(rsp, 3 + 2 * i, regs[i]);
+        }
+    }
+}
+
+/**
+ * @brief 内部函数：处理接收缓冲区中的一个完整帧
+ */
+static void handle_frame(modbus_slave_t* slave, const uart_span_t req[2], uint32_t len) {
+    slave->stats.frames++;
+
+    // 先比较地址：不是发给本站的帧连CRC都不用算
+    if (len < 1) {
+        return;
+    }
+    uint8_t address = span_get(req, 0);
+    if (address != slave->address && address != MODBUS_BROADCAST_ADDRESS) {
+        return;
+    }
+
+    // 最短的帧是 地址 功能码 CRC(2)
+    if (len < 4 || len > MODBUS_MAX_ADU) {
+        slave->stats.crc_errors++;
+        return;
+    }
+    uint16_t crc = span_crc(req, len - 2);
+    uint16_t received = (uint16_t)(span_get(req, len - 2) | ((uint16_t)span_get(req, len - 1) << 8));
+    if (crc != received) {
+        slave->stats.crc_errors++;
+        return;
+    }
+    slave->stats.requests++;
+
+    // 广播只执行写操作，不应答 (包括异常)
+    uint8_t fc = span_get(req, 1);
+    if (address == MODBUS_BROADCAST_ADDRESS) {
+        if (fc >= MODBUS_FC_WRITE_SINGLE_COIL) {
+            (void)execute(slave, req, len - 2);
+        }
+        return;
+    }
+
+    modbus_reply_t reply = execute(slave, req, len - 2);
+    if (reply.exception != 0) {
+        reply.len = 3;
+        slave->stats.exceptions++;
+    }
+
+    // 在发送队列中原地生成应答并立即启动DMA
+    uart_span_t rsp[2];
+    if (uart_write_reserve(slave->uart, reply.len + 2, rsp) != LED_STATUS_OK) {
+        slave->stats.tx_busy++;
+        return;
+    }
+    fill_reply(slave, req, rsp, reply);
+    crc = span_crc(rsp, reply.len);
+    span_put(rsp, reply.len, (uint8_t)crc);
+    span_put(rsp, reply.len + 1, (uint8_t)(crc >> 8));
+    (void)uart_write_commit(slave->uart, reply.len + 2);
+}
+
+/**
+ * @brief 内部函数：串口接收回调
+ * @note  IDLE事件表示主站发送完了一帧，此时接收缓冲区中的全部数据就是这一帧。
+ * HT/TC事件只是帧的一部分到达，忽略即可，数据会留在缓冲区中等到IDLE。
+ */
+static void modbus_on_rx(uart_t* uart, uart_rx_event_t event, uint32_t len, void* user_data) {
+    modbus_slave_t* slave = (modbus_slave_t*)user_data;
+    uart_span_t spans[2];
+    (void)len;
+
+    if (event != UART_RX_EVENT_IDLE) {
+        return;
+    }
+    uint32_t total = uart_peek(uart, spans);
+    if (total > 0) {
+        handle_frame(slave, spans, total);
+        uart_consume(uart, total);
+    }
+}
+
+/* 公共API ------------------------------------------------------------------*/
+
+led_status_t modbus_slave_init(modbus_slave_t* slave, uart_t* uart, uint8_t address) {
+    if (slave == NULL || uart == NULL || address == MODBUS_BROADCAST_ADDRESS || address > 247) {
+        return LED_STATUS_INV_ARG;
+    }
+    // 接收缓冲区必须能容纳一个最长的帧
+    if (uart->rx_ring.size < MODBUS_MAX_ADU) {
+        return LED_STATUS_INV_ARG;
+    }
+
+    memset(slave, 0, sizeof(*slave));
+    slave->uart = uart;
+    slave->address = address;
+
+    // 丢弃接管之前残留的数据，避免把它们当成第一帧的开头
+    uart_consume(uart, uart_get_bytes_available(uart));
+    return uart_register_rx_callback(uart, modbus_on_rx, slave);
+}
+
+led_status_t modbus_slave_set_table(modbus_slave_t* slave, modbus_table_type_t table, const modbus_block_t* blocks,
+                                    uint16_t count) {
+    if (slave == NULL || table >= MODBUS_TABLE_COUNT || (blocks == NULL && count != 0)) {
+        return LED_STATUS_INV_ARG;
+    }
+
+    // 检查排序和重叠：二分查找依赖这一点
+    for (uint16_t i = 0; i < count; ++i) {
+        if (blocks[i].data == NULL || blocks[i].count == 0 ||
+            (uint32_t)blocks[i].start + blocks[i].count > 0x10000u) {
+            return LED_STATUS_INV_ARG;
+        }
+        if (i > 0 && blocks[i].start < (uint32_t)blocks[i - 1].start + blocks[i - 1].count) {
+            return LED_STATUS_INV_ARG;
+        }
+    }
+
+    slave->tables[table].blocks = blocks;
+    slave->tables[table].count = count;
+    return LED_STATUS_OK;
+}
+
+led_status_t modbus_slave_register_callback(modbus_slave_t* slave, modbus_write_callback_t callback, void* user_data) {
+    if (slave == NULL) {
+        return LED_STATUS_INV_ARG;
+    }
+    slave->on_write = callback;
+    slave->user_data = user_data;
+    return LED_STATUS_OK;
+}
+
+led_status_t modbus_slave_get_stats(modbus_slave_t* slave, modbus_stats_t* stats) {
+    if (slave == NULL || stats == NULL) {
+        return LED_STATUS_INV_ARG;
+    }
+    *stats = slave->stats;
+    return LED_STATUS_OK;
+}
@@ -0,0 +1,157 @@
+#ifndef __DRIVER_MODBUS_H
+#define __DRIVER_MODBUS_H
+
+#include "driver_uart.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Modbus RTU帧的最大长度 (地址1 + PDU 253 + CRC 2)
+ */
+#define MODBUS_MAX_ADU 256
+
+/**
+ * @brief 广播地址：从站执行写操作但不应答
+ */
+#define MODBUS_BROADCAST_ADDRESS 0
+
+/**
+ * @brief 支持的功能码
+ */
+#define MODBUS_FC_READ_COILS               0x01
+#define MODBUS_FC_READ_DISCRETE_INPUTS     0x02
+#define MODBUS_FC_READ_HOLDING_REGISTERS   0x03
+#define MODBUS_FC_READ_INPUT_REGISTERS     0x04
+#define MODBUS_FC_WRITE_SINGLE_COIL        0x05
+#define MODBUS_FC_WRITE_SINGLE_REGISTER    0x06
+#define MODBUS_FC_WRITE_MULTIPLE_COILS     0x0F
+#define MODBUS_FC_WRITE_MULTIPLE_REGISTERS 0x10
+
+/**
+ * @brief 异常码 (应答的功能码最高位置1，后跟一个字节的异常码)
+ */
+#define MODBUS_EX_ILLEGAL_FUNCTION     0x01
+#define MODBUS_EX_ILLEGAL_DATA_ADDRESS 0x02
+#define MODBUS_EX_ILLEGAL_DATA_VALUE   0x03
+
+/**
+ * @brief 四种数据区
+ */
+typedef enum {
+    MODBUS_COILS = 0,           /**< 线圈 (可读写的位) */
+    MODBUS_DISCRETE_INPUTS,     /**< 离散输入 (只读的位) */
+    MODBUS_HOLDING_REGISTERS,   /**< 保持寄存器 (可读写的16位寄存器) */
+    MODBUS_INPUT_REGISTERS,     /**< 输入寄存器 (只读的16位寄存器) */
+    MODBUS_TABLE_COUNT
+} modbus_table_type_t;
+
+/**
+ * @brief 一段地址连续的数据
+ * @note  位数据 (线圈/离散输入) 每个元素一个uint8_t，非0表示1；寄存器每个元素一个uint16_t。
+ * 主站的一次请求必须完整落在同一段内，否则返回非法数据地址异常。
+ */
+typedef struct {
+    uint16_t start;             /**< 起始地址 */
+    uint16_t count;             /**< 数量 */
+    void* data;                 /**< 数据存储区 (uint8_t[]或uint16_t[]) */
+    uint8_t read_only;          /**< 非0时拒绝主站写入 (只对线圈和保持寄存器有意义) */
+} modbus_block_t;
+
+/**
+ * @brief 一个数据区的地址表
+ * @note  各段必须按起始地址升序排列且互不重叠，查找时使用二分查找。
+ */
+typedef struct {
+    const modbus_block_t* blocks; /**< 数据段数组 */
+    uint16_t count;               /**< 数据段数量 */
+} modbus_table_t;
+
+/**
+ * @brief 从站运行统计
+ */
+typedef struct {
+    uint32_t frames;            /**< 收到的完整帧数 (含不是发给本站的) */
+    uint32_t crc_errors;        /**< CRC错误或长度非法而丢弃的帧数 */
+    uint32_t requests;          /**< 发给本站 (含广播) 的有效请求数 */
+    uint32_t exceptions;        /**< 以异常应答的请求数 */
+    uint32_t tx_busy;           /**< 因发送队列已满而未能应答的次数 */
+} modbus_stats_t;
+
+// 前向声明
+struct modbus_slave_s;
+
+/**
+ * @brief  主站写入数据后的通知回调 (在串口接收中断上下文中被调用)
+ * @param[in] slave     - 从站对象
+ * @param[in] table     - 被写入的数据区
+ * @param[in] address   - 起始地址
+ * @param[in] count     - 数量
+ * @param[in] user_data - 注册时传入的用户数据
+ */
+typedef void (*modbus_write_callback_t)(struct modbus_slave_s* slave, modbus_table_type_t table, uint16_t address,
+                                        uint16_t count, void* user_data);
+
+/**
+ * @brief Modbus RTU从站
+ * @note  帧边界由串口的IDLE事件确定：每次IDLE事件时，接收缓冲区中的全部数据就是一帧。
+ * 请求在IDLE中断中直接处理：在接收环形缓冲区中原地校验和解析 (零拷贝)，
+ * 应答直接生成在发送队列中并立即启动DMA，因此应答时间不依赖主循环，远小于3.5个字符时间。
+ * 串口对象由从站独占：不要再对它调用读取函数或注册其他接收回调。
+ */
+typedef struct modbus_slave_s {
+    uart_t* uart;                               /**< 所属的串口对象 */
+    uint8_t address;                            /**< 本站地址 (1~247) */
+    modbus_table_t tables[MODBUS_TABLE_COUNT];  /**< 四个数据区的地址表 */
+
+    modbus_write_callback_t on_write;           /**< 写入通知回调 */
+    void* user_data;                            /**< 传给回调函数的用户数据 */
+
+    modbus_stats_t stats;                       /**< 运行统计 */
+} modbus_slave_t;
+
+/**
+ * @brief  初始化Modbus RTU从站，并接管串口的接收
+ * @param[in] slave   - 指向modbus_slave_t对象的指针
+ * @param[in] uart    - 已初始化的串口对象 (接收缓冲区至少MODBUS_MAX_ADU字节)
+ * @param[in] address - 本站地址 (1~247)
+ * @return led_status_t - 操作的状态码
+ */
+led_status_t modbus_slave_init(modbus_slave_t* slave, uart_t* uart, uint8_t address);
+
+/**
+ * @brief  设置一个数据区的地址表
+ * @note   应在初始化之后、主站开始访问之前调用。
+ * @param[in] slave  - 指向modbus_slave_t对象的指针
+ * @param[in] table  - 数据区
+ * @param[in] blocks - 数据段数组 (按起始地址升序、互不重叠)，可以为NULL表示该数据区为空
+ * @param[in] count  - 数据段数量
+ * @return led_status_t - 操作的状态码。未排序或有重叠时返回LED_STATUS_INV_ARG
+ */
+led_status_t modbus_slave_set_table(modbus_slave_t* slave, modbus_table_type_t table, const modbus_block_t* blocks,
+                                    uint16_t count);
+
+/**
+ * @brief  注册写入通知回调
+ * @param[in] slave     - 指向modbus_slave_t对象的指针
+ * @param[in] callback  - 回调函数，为NULL时取消注册
+ * @param[in] user_data - 传给回调函数的用户数据
+ * @return led_status_t - 操作的状态码
+ */
+led_status_t modbus_slave_register_callback(modbus_slave_t* slave, modbus_write_callback_t callback, void* user_data);
+
+/**
+ * @brief  获取从站运行统计
+ * @param[in]  slave - 指向modbus_slave_t对象的指针
+ * @param[out] stats - 用于存放统计的结构体
+ * @return led_status_t - 操作的状态码
+ */
+led_status_t modbus_slave_get_stats(modbus_slave_t* slave, modbus_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __DRIVER_MODBUS_H
@@ -0,0 +1,31 @@
+#ifndef __DRIVER_MODBUS_TEST_H
+#define __DRIVER_MODBUS_TEST_H
+
+#include "driver_modbus.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Modbus从站一致性测试：用主站模拟器逐一验证各功能码的应答、三种异常、
+ * CRC错误和其他地址的帧被忽略、广播只执行不应答，以及分段到达 (HT+IDLE、TC后空IDLE)
+ * 和跨越接收缓冲区回绕处的帧
+ * @note  使用模拟的uart_api_t，不依赖硬件。
+ * @return led_status_t - 全部通过返回LED_STATUS_OK
+ */
+led_status_t driver_modbus_test(void);
+
+/**
+ * @brief Modbus应答延迟基准测试：测量从IDLE事件到应答DMA启动的时间
+ * @note  在目标板上使用DWT周期计数器 (单位为周期)，在PC上使用系统单调时钟 (单位为纳秒)。
+ * 结果通过g_uart1输出 (需在g_uart1完成uart_init之后调用)，并给出115200波特率下3.5个字符时间 (约304us) 作为对照。
+ */
+void driver_modbus_benchmark(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
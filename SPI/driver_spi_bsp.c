@@ -1,6 +1,7 @@
 #include "driver_spi_bsp.h"
 
 #include <stddef.h>
+#include <string.h> // For memset
 
 // 假设我们使用SPI1，hspi1由CubeMX自动生成
 // 假设CS引脚为PA4
@@ -11,13 +12,69 @@ const bsp_spi_handle_t g_bsp_spi1 = {
     .cs_pin = GPIO_PIN_4
 };
 
+// 每个SPI外设的运行时状态，按SPI外设编号直接索引 (O(1)查找)
+typedef struct {
+    spi_complete_callback_t callback;   /**< 上层注册的传输完成回调 */
+    void* context;                      /**< 回调时传回的上下文 (上层的spi_t对象) */
+} bsp_spi_port_t;
 
-static led_status_t stm32_spi_init(void* handle) {
+static bsp_spi_port_t g_spi_ports[BSP_SPI_MAX_PORTS] = {0};
+
+// 中断模式只接收时的发送源：全部为0xFF，只会被读取，所有SPI外设共用
+static uint8_t s_spi_dummy_block[BSP_SPI_IT_DUMMY_SIZE];
+
+// 内部辅助函数，用于根据SPI外设获取其端口索引 (0 ~ BSP_SPI_MAX_PORTS-1)
+static int8_t get_port_index(const SPI_TypeDef* instance) {
+    if (instance == SPI1) return 0;
+    if (instance == SPI2) return 1;
+#if defined(SPI3)
+    if (instance == SPI3) return 2;
+#endif
+#if defined(SPI4)
+    if (instance == SPI4) return 3;
+#endif
+#if defined(SPI5)
+    if (instance == SPI5) return 4;
+#endif
+#if defined(SPI6)
+    if (instance == SPI6) return 5;
+#endif
+    return -1;
+}
+
+// 内部辅助函数，通知上层一次传输已经结束
+static void notify_complete(SPI_HandleTypeDef* hspi, led_status_t status) {
+    int8_t index = get_port_index(hspi->Instance);
+    if (index == -1) {
+        return;
+    }
+    bsp_spi_port_t* port = &g_spi_ports[index];
+    if (port->callback != NULL) {
+        port->callback(port->context, status);
+    }
+}
+
+static led_status_t stm32_spi_init(void* handle, spi_complete_callback_t callback, void* context) {
     // SPI和CS引脚的GPIO初始化通常由CubeMX生成的代码在main中自动完成。
     // 我们在这里需要确保CS引脚初始状态为高电平 (未选中)。
     const bsp_spi_handle_t* bsp_handle = (const bsp_spi_handle_t*)handle;
-    if (bsp_handle == NULL) return LED_STATUS_INV_ARG;
-    
+    if (bsp_handle == NULL || callback == NULL) return LED_STATUS_INV_ARG;
+
+    // 注册回调函数
+    int8_t index = get_port_index(bsp_handle->hspi->Instance);
+    if (index == -1) {
+        return LED_STATUS_ERROR;
+    }
+    g_spi_ports[index].callback = callback;
+    g_spi_ports[index].context = context;
+
+    // 中断模式只接收时的发送源 (只读，重复填充无副作用)
+    memset(s_spi_dummy_block, 0xFF, sizeof(s_spi_dummy_block));
+
+    // 使能DWT周期计数器，供delay_us和轮询超时使用 (重复使能无副作用)
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
     HAL_GPIO_WritePin(bsp_handle->cs_port, bsp_handle->cs_pin, GPIO_PIN_SET);
     return LED_STATUS_OK;
 }
@@ -26,29 +83,241 @@ static led_status_t stm32_spi_deinit(void* handle) {
     const bsp_spi_handle_t* bsp_handle = (const bsp_spi_handle_t*)handle;
     if (bsp_handle == NULL) return LED_STATUS_INV_ARG;
 
+    int8_t index = get_port_index(bsp_handle->hspi->Instance);
+    if (index != -1) {
+        g_spi_ports[index].callback = NULL;
+        g_spi_ports[index].context = NULL;
+    }
     if (HAL_SPI_DeInit(bsp_handle->hspi) != HAL_OK) {
         return LED_STATUS_ERROR;
     }
     return LED_STATUS_OK;
 }
 
+// 只接收时发送的固定字节。只会被DMA读取、从不写入，所以所有SPI外设共用一个字节是安全的
+static uint8_t s_spi_dummy_tx = 0xFF;
+
+// 内部辅助函数，设置发送DMA流的存储器地址是否递增
+// DMA_SetConfig不会改动MINC位，而流在两次传输之间处于禁止状态，所以可以在启动前直接修改CR
+static void set_tx_memory_increment(SPI_HandleTypeDef* hspi, uint8_t enable) {
+    DMA_HandleTypeDef* hdma = hspi->hdmatx;
+    if (enable) {
+        hdma->Instance->CR |= DMA_SxCR_MINC;
+        hdma->Init.MemInc = DMA_MINC_ENABLE;
+    } else {
+        hdma->Instance->CR &= ~DMA_SxCR_MINC;
+        hdma->Init.MemInc = DMA_MINC_DISABLE;
+    }
+}
+
 static led_status_t stm32_spi_transceive_dma(void* handle, const uint8_t* tx_data, uint8_t* rx_data, uint16_t len) {
     const bsp_spi_handle_t* bsp_handle = (const bsp_spi_handle_t*)handle;
     if (bsp_handle == NULL || tx_data == NULL || rx_data == NULL || len == 0) {
         return LED_STATUS_INV_ARG;
     }
 
+    // 只启动DMA，不等待：完成后HAL在DMA中断中调用HAL_SPI_TxRxCpltCallback
+    set_tx_memory_increment(bsp_handle->hspi, 1);
     if (HAL_SPI_TransmitReceive_DMA(bsp_handle->hspi, (uint8_t*)tx_data, rx_data, len) != HAL_OK) {
         return LED_STATUS_ERROR;
     }
-    
-    // 等待DMA传输完成
-    // 注意：在非阻塞的RTOS应用中，这里应该使用中断或信号量来同步，而不是轮询
-    while (HAL_SPI_GetState(bsp_handle->hspi) != HAL_SPI_STATE_READY);
+    return LED_STATUS_OK;
+}
 
+static led_status_t stm32_spi_transmit_dma(void* handle, const uint8_t* tx_data, uint16_t len) {
+    const bsp_spi_handle_t* bsp_handle = (const bsp_spi_handle_t*)handle;
+    if (bsp_handle == NULL || tx_data == NULL || len == 0) {
+        return LED_STATUS_INV_ARG;
+    }
+
+    // 只启动发送DMA，接收到的数据留在DR中被丢弃 (HAL在发送完成、BSY清零后清除OVR标志)，
+    // 完成后调用HAL_SPI_TxCpltCallback
+    set_tx_memory_increment(bsp_handle->hspi, 1);
+    if (HAL_SPI_Transmit_DMA(bsp_handle->hspi, (uint8_t*)tx_data, len) != HAL_OK) {
+        return LED_STATUS_ERROR;
+    }
     return LED_STATUS_OK;
 }
 
+static led_status_t stm32_spi_receive_dma(void* handle, uint8_t* rx_data, uint16_t len) {
+    const bsp_spi_handle_t* bsp_handle = (const bsp_spi_handle_t*)handle;
+    if (bsp_handle == NULL || rx_data == NULL || len == 0) {
+        return LED_STATUS_INV_ARG;
+    }
+
+    // 主机必须发送才能产生时钟。HAL_SPI_Receive_DMA会把接收缓冲区本身当作发送源 (发出的是旧数据)，
+    // 这里改为让发送DMA的存储器地址不递增，反复发送同一个0xFF字节
+    set_tx_memory_increment(bsp_handle->hspi, 0);
+    if (HAL_SPI_TransmitReceive_DMA(bsp_handle->hspi, &s_spi_dummy_tx, rx_data, len) != HAL_OK) {
+        return LED_STATUS_ERROR;
+    }
+    return LED_STATUS_OK;
+}
+
+// 内部辅助函数，轮询等待SR中的标志变为期望的状态
+// 用DWT计时 (可能在完成中断中调用，SysTick不会前进)；出现溢出或模式错误时立即返回，不会卡死
+static led_status_t poll_wait_flag(SPI_TypeDef* instance, uint32_t flag, uint32_t state) {
+    uint32_t start = DWT->CYCCNT;
+    uint32_t cycles = BSP_SPI_POLL_TIMEOUT_US * (SystemCoreClock / 1000000u);
+    for (;;) {
+        uint32_t sr = instance->SR;
+        if (sr & (SPI_SR_OVR | SPI_SR_MODF)) {
+            return LED_STATUS_ERROR;
+        }
+        if ((sr & flag) == state) {
+            return LED_STATUS_OK;
+        }
+        if ((uint32_t)(DWT->CYCCNT - start) >= cycles) {
+            return LED_STATUS_TIMEOUT;
+        }
+    }
+}
+
+static led_status_t stm32_spi_transceive_poll(void* handle, const uint8_t* tx_data, uint8_t* rx_data, uint16_t len) {
+    const bsp_spi_handle_t* bsp_handle = (const bsp_spi_handle_t*)handle;
+    if (bsp_handle == NULL || len == 0) {
+        return LED_STATUS_INV_ARG;
+    }
+
+    // 直接读写寄存器：每个字节写DR、等RXNE、读DR，没有HAL状态机和中断的开销
+    SPI_HandleTypeDef* hspi = bsp_handle->hspi;
+    SPI_TypeDef* instance = hspi->Instance;
+    instance->CR1 |= SPI_CR1_SPE;
+    led_status_t status = LED_STATUS_OK;
+    for (uint16_t i = 0; i < len; ++i) {
+        status = poll_wait_flag(instance, SPI_SR_TXE, SPI_SR_TXE);
+        if (status != LED_STATUS_OK) {
+            break;
+        }
+        *(volatile uint8_t*)&instance->DR = tx_data ? tx_data[i] : 0xFF;
+        status = poll_wait_flag(instance, SPI_SR_RXNE, SPI_SR_RXNE);
+        if (status != LED_STATUS_OK) {
+            break;
+        }
+        uint8_t byte = *(volatile uint8_t*)&instance->DR;
+        if (rx_data) {
+            rx_data[i] = byte;
+        }
+    }
+    // 等最后一个字节完全移出，之后才能取消片选
+    if (status == LED_STATUS_OK) {
+        status = poll_wait_flag(instance, SPI_SR_BSY, 0);
+    }
+    if (status == LED_STATUS_ERROR) {
+        // 清除错误标志。模式错误时硬件已经清除了SPE和MSTR，需要重新初始化SPI才能继续作为主机使用
+        __HAL_SPI_CLEAR_OVRFLAG(hspi);
+        __HAL_SPI_CLEAR_MODFFLAG(hspi);
+    }
+    return status;
+}
+
+static led_status_t stm32_spi_transceive_it(void* handle, const uint8_t* tx_data, uint8_t* rx_data, uint16_t len) {
+    const bsp_spi_handle_t* bsp_handle = (const bsp_spi_handle_t*)handle;
+    if (bsp_handle == NULL || (tx_data == NULL && rx_data == NULL) || len == 0) {
+        return LED_STATUS_INV_ARG;
+    }
+
+    HAL_StatusTypeDef result;
+    if (rx_data == NULL) {
+        // 只发送：完成后调用HAL_SPI_TxCpltCallback
+        result = HAL_SPI_Transmit_IT(bsp_handle->hspi, (uint8_t*)tx_data, len);
+    } else {
+        if (tx_data == NULL) {
+            // 只接收：HAL的中断传输从发送缓冲区逐字节取数，无法像DMA那样固定发送源
+            // (2线主机模式下HAL_SPI_Receive_IT也是把接收缓冲区当作发送源，发出的是旧数据)，
+            // 因此从全0xFF的只读缓冲区发送。超过其长度时 (中断模式的阈值设得很大) 才退化为
+            // 先把接收缓冲区填成0xFF再同时作为发送源
+            if (len <= sizeof(s_spi_dummy_block)) {
+                tx_data = s_spi_dummy_block;
+            } else {
+                memset(rx_data, 0xFF, len);
+                tx_data = rx_data;
+            }
+        }
+        result = HAL_SPI_TransmitReceive_IT(bsp_handle->hspi, (uint8_t*)tx_data, rx_data, len);
+    }
+    return result == HAL_OK ? LED_STATUS_OK : LED_STATUS_ERROR;
+}
+
+static led_status_t stm32_spi_abort(void* handle) {
+    const bsp_spi_handle_t* bsp_handle = (const bsp_spi_handle_t*)handle;
+    if (bsp_handle == NULL) return LED_STATUS_INV_ARG;
+
+    // 阻塞式中止：关闭DMA和SPI中断，返回后不会再有完成回调
+    if (HAL_SPI_Abort(bsp_handle->hspi) != HAL_OK) {
+        return LED_STATUS_ERROR;
+    }
+    return LED_STATUS_OK;
+}
+
+static void stm32_spi_wait_for_event(void* handle) {
+    (void)handle;
+    // DMA完成中断和SysTick都会唤醒CPU，调用者据此重新检查完成标志和超时
+    __WFI();
+}
+
+static void stm32_spi_delay_us(uint32_t us) {
+    // 用DWT周期计数器计时 (stm32_spi_init中已使能)，无符号减法在计数器回绕时同样正确
+    uint32_t start = DWT->CYCCNT;
+    uint32_t cycles = us * (SystemCoreClock / 1000000u);
+    while ((uint32_t)(DWT->CYCCNT - start) < cycles) {
+    }
+}
+
+static led_status_t stm32_spi_configure(void* handle, const spi_config_t* config) {
+    const bsp_spi_handle_t* bsp_handle = (const bsp_spi_handle_t*)handle;
+    if (bsp_handle == NULL || config == NULL) return LED_STATUS_INV_ARG;
+
+    // BR[2:0] = k 表示 fPCLK / 2^(k+1)，分频系数必须是2~256之间的2的幂
+    uint32_t br = 0;
+    while (br < 8 && (2u << br) != config->prescaler) {
+        br++;
+    }
+    if (br == 8) {
+        return LED_STATUS_INV_ARG;
+    }
+
+    // 直接改写CR1，比HAL_SPI_Init快得多；这些位只能在SPE=0时修改，下一次传输时HAL会重新使能SPE
+    SPI_TypeDef* instance = bsp_handle->hspi->Instance;
+    uint32_t cr1 = instance->CR1 & ~(SPI_CR1_SPE | SPI_CR1_CPOL | SPI_CR1_CPHA | SPI_CR1_BR);
+    cr1 |= (config->cpol ? SPI_CR1_CPOL : 0u) | (config->cpha ? SPI_CR1_CPHA : 0u) | (br << SPI_CR1_BR_Pos);
+    instance->CR1 &= ~SPI_CR1_SPE;
+    instance->CR1 = cr1;
+
+    // 同步HAL句柄中的配置，避免之后调用HAL_SPI_Init时恢复成旧配置
+    bsp_handle->hspi->Init.CLKPolarity = config->cpol ? SPI_POLARITY_HIGH : SPI_POLARITY_LOW;
+    bsp_handle->hspi->Init.CLKPhase = config->cpha ? SPI_PHASE_2EDGE : SPI_PHASE_1EDGE;
+    bsp_handle->hspi->Init.BaudRatePrescaler = br << SPI_CR1_BR_Pos;
+    return LED_STATUS_OK;
+}
+
+static uint32_t stm32_spi_lock(void) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    return primask;
+}
+
+static void stm32_spi_unlock(uint32_t state) {
+    // 只有进入之前中断是打开的才重新打开，支持嵌套
+    if (state == 0) {
+        __enable_irq();
+    }
+}
+
+// 以下函数覆盖了HAL库中的弱定义回调，由HAL_DMA_IRQHandler/HAL_SPI_IRQHandler调用
+
+void HAL_SPI_TxRxCpltCallback(SPI_HandleTypeDef *hspi) {
+    notify_complete(hspi, LED_STATUS_OK);
+}
+
+void HAL_SPI_TxCpltCallback(SPI_HandleTypeDef *hspi) {
+    notify_complete(hspi, LED_STATUS_OK);
+}
+
+void HAL_SPI_ErrorCallback(SPI_HandleTypeDef *hspi) {
+    notify_complete(hspi, LED_STATUS_ERROR);
+}
+
 static led_status_t stm32_spi_chip_select(void* handle) {
     const bsp_spi_handle_t* bsp_handle = (const bsp_spi_handle_t*)handle;
     if (bsp_handle == NULL) return LED_STATUS_INV_ARG;
@@ -71,9 +340,19 @@ static const spi_api_t s_spi_api_stm32 = {
     .init = stm32_spi_init,
     .deinit = stm32_spi_deinit,
     .transceive_dma = stm32_spi_transceive_dma,
+    .transmit_dma = stm32_spi_transmit_dma,
+    .receive_dma = stm32_spi_receive_dma,
+    .transceive_poll = stm32_spi_transceive_poll,
+    .transceive_it = stm32_spi_transceive_it,
     .chip_select = stm32_spi_chip_select,
     .chip_deselect = stm32_spi_chip_deselect,
     .get_tick = HAL_GetTick,
+    .abort = stm32_spi_abort,
+    .wait_for_event = stm32_spi_wait_for_event,
+    .delay_us = stm32_spi_delay_us,
+    .configure = stm32_spi_configure,
+    .lock = stm32_spi_lock,
+    .unlock = stm32_spi_unlock,
 };
 
 const spi_api_t* bsp_spi_get_api(void) {
@@ -4,9 +4,31 @@
 #include "driver_spi_interface.h"
 #include "stm32f4xx_hal.h"
 
+/**
+ * @brief BSP层最多支持的SPI外设数量 (STM32F4: SPI1 ~ SPI6)
+ */
+#define BSP_SPI_MAX_PORTS 6
+
+/**
+ * @brief 轮询传输中每次等待状态标志 (TXE/RXNE/BSY) 的最长时间 (微秒)
+ * @note  最慢的分频 (256) 下一个字节也只需几十微秒，超过该时间说明硬件异常，返回LED_STATUS_TIMEOUT。
+ */
+#ifndef BSP_SPI_POLL_TIMEOUT_US
+#define BSP_SPI_POLL_TIMEOUT_US 1000
+#endif
+
+/**
+ * @brief 中断模式只接收时使用的0xFF发送缓冲区大小
+ * @note  中断模式只用于短传输 (见SPI_IT_MAX_LEN)，只接收的块不超过该长度时从这块缓冲区发送0xFF。
+ */
+#ifndef BSP_SPI_IT_DUMMY_SIZE
+#define BSP_SPI_IT_DUMMY_SIZE 64
+#endif
+
 /**
  * @brief 包含STM32平台SPI硬件具体信息的句柄结构体。
  * @note  它不仅包含SPI外设句柄，还包含了手动控制的CS引脚信息。
+ * 使用总线管理器时，同一个SPI外设上的每个设备各定义一个句柄：hspi相同，CS引脚不同。
  */
 typedef struct {
     SPI_HandleTypeDef* const hspi;    /**< 指向HAL库SPI句柄的指针 */
@@ -16,6 +38,7 @@ typedef struct {
 
 /**
  * @brief 获取为STM32平台实现的SPI硬件API单例。
+ * @note  传输完成由HAL_SPI_TxRxCpltCallback通知，需要在CubeMX中使能SPI的DMA中断。
  * @return 一个指向spi_api_t结构体的常量指针。
  */
 const spi_api_t* bsp_spi_get_api(void);
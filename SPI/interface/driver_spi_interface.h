@@ -8,16 +8,34 @@
 extern "C" {
 #endif
 
+/**
+ * @brief 传输完成回调函数指针类型 (由BSP层在中断上下文中调用)
+ * @param[in] context - init时传入的上下文指针 (上层的spi_t对象)
+ * @param[in] status  - 传输结果：LED_STATUS_OK表示成功，LED_STATUS_ERROR表示硬件错误
+ */
+typedef void (*spi_complete_callback_t)(void* context, led_status_t status);
+
+/**
+ * @brief SPI总线的时序配置 (每个从设备可以不同)
+ */
+typedef struct {
+    uint8_t cpol;           /**< 时钟极性：0表示空闲时SCK为低电平，1表示为高电平 */
+    uint8_t cpha;           /**< 时钟相位：0表示在第一个边沿采样，1表示在第二个边沿采样 */
+    uint16_t prescaler;     /**< SCK分频系数：2, 4, 8, ..., 256 */
+} spi_config_t;
+
 /**
  * @brief 定义了SPI驱动所需的所有平台依赖项的API函数指针结构体。
  */
 typedef struct spi_api_s {
     /**
      * @brief 初始化SPI的底层硬件 (GPIO, SPI, DMA)。
-     * @param[in] handle - 指向硬件相关句柄的void指针。
+     * @param[in] handle   - 指向硬件相关句柄的void指针。
+     * @param[in] callback - 一次DMA传输完成 (或出错) 时需要被调用的回调函数。
+     * @param[in] context  - 调用回调函数时原样传回的上下文指针，用于区分不同的SPI实例。
      * @return led_status_t - 操作的状态码。
      */
-    led_status_t (*init)(void* handle);
+    led_status_t (*init)(void* handle, spi_complete_callback_t callback, void* context);
 
     /**
      * @brief 反初始化SPI的底层硬件。
@@ -27,7 +45,9 @@ typedef struct spi_api_s {
     led_status_t (*deinit)(void* handle);
 
     /**
-     * @brief 通过DMA同时发送和接收数据 (全双工)。
+     * @brief 通过DMA异步地同时发送和接收数据 (全双工)。
+     * @note  此函数启动DMA后立即返回，传输完成后调用init时注册的callback。
+     * 在回调到来之前，tx_data和rx_data指向的缓冲区必须保持有效。
      * @param[in]  handle  - 指向硬件相关句柄的指针。
      * @param[in]  tx_data - 指向要发送的数据缓冲区的指针。
      * @param[out] rx_data - 用于存放接收数据的缓冲区。
@@ -36,6 +56,52 @@ typedef struct spi_api_s {
      */
     led_status_t (*transceive_dma)(void* handle, const uint8_t* tx_data, uint8_t* rx_data, uint16_t len);
     
+    /**
+     * @brief (可选) 通过DMA只发送数据，接收到的数据被丢弃。
+     * @note  完成后调用init时注册的callback。为NULL时驱动退化为全双工传输，
+     * 接收数据写入spi_t内部的小缓冲区并按其大小分块。
+     * @param[in] handle  - 指向硬件相关句柄的指针。
+     * @param[in] tx_data - 指向要发送的数据缓冲区的指针。
+     * @param[in] len     - 要发送的数据长度。
+     * @return led_status_t - 操作的状态码。
+     */
+    led_status_t (*transmit_dma)(void* handle, const uint8_t* tx_data, uint16_t len);
+
+    /**
+     * @brief (可选) 通过DMA只接收数据，期间在MOSI上发送0xFF。
+     * @note  完成后调用init时注册的callback。为NULL时驱动退化为全双工传输，
+     * 先把接收缓冲区填成0xFF再把它同时作为发送源。
+     * @param[in]  handle  - 指向硬件相关句柄的指针。
+     * @param[out] rx_data - 用于存放接收数据的缓冲区。
+     * @param[in]  len     - 要接收的数据长度。
+     * @return led_status_t - 操作的状态码。
+     */
+    led_status_t (*receive_dma)(void* handle, uint8_t* rx_data, uint16_t len);
+
+    /**
+     * @brief (可选) 以轮询方式同步完成一次传输，不产生完成回调。
+     * @note  适合只有几个字节的传输：省去DMA的配置和完成中断。为NULL时不使用轮询模式。
+     * 可能在完成中断中被调用，每次等待都必须有时间上限，不能依赖get_tick计时。
+     * @param[in]  handle  - 指向硬件相关句柄的指针。
+     * @param[in]  tx_data - 要发送的数据，为NULL时发送0xFF。
+     * @param[out] rx_data - 存放接收数据的缓冲区，为NULL时丢弃接收数据。
+     * @param[in]  len     - 传输长度。
+     * @return led_status_t - 操作的状态码，返回时传输已经结束。硬件出错返回LED_STATUS_ERROR，
+     * 等待超时返回LED_STATUS_TIMEOUT。
+     */
+    led_status_t (*transceive_poll)(void* handle, const uint8_t* tx_data, uint8_t* rx_data, uint16_t len);
+
+    /**
+     * @brief (可选) 以中断方式 (每个字节一次中断) 异步传输，完成后调用init时注册的callback。
+     * @note  为NULL时不使用中断模式。
+     * @param[in]  handle  - 指向硬件相关句柄的指针。
+     * @param[in]  tx_data - 要发送的数据，为NULL时发送0xFF。
+     * @param[out] rx_data - 存放接收数据的缓冲区，为NULL时丢弃接收数据。
+     * @param[in]  len     - 传输长度。
+     * @return led_status_t - 操作的状态码。
+     */
+    led_status_t (*transceive_it)(void* handle, const uint8_t* tx_data, uint8_t* rx_data, uint16_t len);
+
     /**
      * @brief 片选使能 (将CS/NSS引脚拉低)。
      * @param[in] handle - 指向硬件相关句柄的指针。
@@ -56,6 +122,51 @@ typedef struct spi_api_s {
      */
     uint32_t (*get_tick)(void);
 
+    /**
+     * @brief (可选) 中止正在进行的DMA传输。
+     * @note  返回之后不会再调用完成回调。供阻塞传输超时时使用，可以为NULL
+     * (此时超时的传输继续在后台进行，直到完成回调到来才释放总线)。
+     * @param[in] handle - 指向硬件相关句柄的指针。
+     * @return led_status_t - 操作的状态码。
+     */
+    led_status_t (*abort)(void* handle);
+
+    /**
+     * @brief (可选) 让CPU进入低功耗等待，直到下一个中断到来。
+     * @note  供阻塞传输等待完成时使用，可以为NULL (此时退化为忙等待)。
+     * @param[in] handle - 指向硬件相关句柄的指针。
+     */
+    void (*wait_for_event)(void* handle);
+
+    /**
+     * @brief (可选) 忙等待指定的微秒数，用于多段事务的段间延时。
+     * @note  会在完成中断中被调用，延时应尽量短。为NULL时不支持段间延时。
+     * @param[in] us - 延时时间 (微秒)。
+     */
+    void (*delay_us)(uint32_t us);
+
+    /**
+     * @brief (可选) 修改总线的时序配置 (CPOL/CPHA/分频)。
+     * @note  只在总线空闲 (没有传输、片选均无效) 时被调用。为NULL时总线管理器不支持设备各自的配置。
+     * @param[in] handle - 指向硬件相关句柄的指针。
+     * @param[in] config - 新的配置。
+     * @return led_status_t - 操作的状态码。不支持的分频系数返回LED_STATUS_INV_ARG。
+     */
+    led_status_t (*configure)(void* handle, const spi_config_t* config);
+
+    /**
+     * @brief (可选) 进入临界区 (例如关中断)，保护总线管理器的请求队列。
+     * @note  为NULL时总线管理器不做保护，只能在单一上下文中提交请求。
+     * @return uint32_t - 进入前的状态，原样传给unlock。
+     */
+    uint32_t (*lock)(void);
+
+    /**
+     * @brief (可选) 退出临界区，与lock成对使用。
+     * @param[in] state - lock的返回值。
+     */
+    void (*unlock)(uint32_t state);
+
 } spi_api_t;
 
 
@@ -1,12 +1,166 @@
 #include "driver_spi.h"
 
-#include "driver_spi.h"
 #include <string.h> // For memset
+#include "driver_atomic.h"
+
+/**
+ * @brief 内部函数：启动当前段 (剩余部分) 的传输
+ * @note  按剩余长度选择模式：不超过poll_max_len时轮询 (在这里同步完成)，不超过it_max_len时用中断，
+ * 否则用DMA。平台没有提供对应钩子的模式被跳过。
+ * DMA模式下，平台提供了transmit_dma/receive_dma时单向的段直接使用它们，不受长度限制。
+ * 否则退化为全双工：只发送的段把接收数据丢进spi->sink，超出sink大小时分块传输；
+ * 只接收的段先把接收缓冲区填成0xFF，再把它同时作为发送源 (每个字节总是先发出、后收到，
+ * 所以发送DMA读到的一定还是0xFF)。
+ * @param[out] polled - 本块已经以轮询方式完成时置1，此时不会有完成中断
+ */
+static led_status_t start_segment(spi_t* spi, uint8_t* polled) {
+    const spi_transfer_t* seg = &spi->segments[spi->seg_index];
+    uint16_t offset = spi->seg_offset;
+    uint16_t len = seg->len - offset;
+    const uint8_t* tx_data = seg->tx_data ? seg->tx_data + offset : NULL;
+    uint8_t* rx_data = seg->rx_data ? seg->rx_data + offset : NULL;
+
+    *polled = 0;
+    spi->chunk_len = len;
+    if (len <= spi->poll_max_len && spi->api->transceive_poll != NULL) {
+        *polled = 1;
+        return spi->api->transceive_poll(spi->handle, tx_data, rx_data, len);
+    }
+    if (len <= spi->it_max_len && spi->api->transceive_it != NULL) {
+        return spi->api->transceive_it(spi->handle, tx_data, rx_data, len);
+    }
+
+    if (tx_data == NULL) {
+        if (spi->api->receive_dma != NULL) {
+            return spi->api->receive_dma(spi->handle, rx_data, len);
+        }
+        memset(rx_data, 0xFF, len);
+        tx_data = rx_data;
+    } else if (rx_data == NULL) {
+        if (spi->api->transmit_dma != NULL) {
+            return spi->api->transmit_dma(spi->handle, tx_data, len);
+        }
+        rx_data = spi->sink;
+        if (len > SPI_SINK_SIZE) {
+            len = SPI_SINK_SIZE;
+        }
+    }
+
+    spi->chunk_len = len;
+    return spi->api->transceive_dma(spi->handle, tx_data, rx_data, len);
+}
+
+/**
+ * @brief 内部函数：记录刚完成的一块，当前段结束时执行段间延时并转到下一段
+ */
+static void advance_segment(spi_t* spi) {
+    const spi_transfer_t* seg = &spi->segments[spi->seg_index];
+    spi->seg_offset += spi->chunk_len;
+    if (spi->seg_offset >= seg->len) {
+        if (seg->delay_us != 0) {
+            spi->api->delay_us(seg->delay_us);
+        }
+        spi->seg_index++;
+        spi->seg_offset = 0;
+    }
+}
+
+/**
+ * @brief 内部函数：从当前位置继续传输，轮询的块就地完成，直到启动了一个异步的块或全部完成
+ * @param[out] pending - 启动了异步的块 (等待完成中断) 时置1，全部完成时置0
+ */
+static led_status_t run_segments(spi_t* spi, uint8_t* pending) {
+    while (spi->seg_index < spi->seg_count) {
+        uint8_t polled;
+        led_status_t status = start_segment(spi, &polled);
+        if (status != LED_STATUS_OK) {
+            return status;
+        }
+        if (!polled) {
+            *pending = 1;
+            return LED_STATUS_OK;
+        }
+        advance_segment(spi);
+    }
+    *pending = 0;
+    return LED_STATUS_OK;
+}
+
+/**
+ * @brief 内部函数：结束整个事务：取消片选、释放总线，再通知上层
+ * @note  先释放总线，这样上层可以在回调中直接启动下一次传输。
+ */
+static void finish_transfer(spi_t* spi, led_status_t status) {
+    spi->api->chip_deselect(spi->handle);
+
+    spi_callback_t callback = spi->on_complete;
+    void* user_data = spi->user_data;
+    DRIVER_STORE_RELEASE(&spi->busy, 0);
+
+    if (callback != NULL) {
+        callback(spi, status, user_data);
+    }
+}
 
-// 定义用于便利性函数的内部静态缓冲区大小
-// 注意：这限制了spi_write和spi_read单次操作的最大长度。
-// 对于需要更大长度的操作，应直接使用spi_transceive函数。
-#define SPI_DUMMY_BUFFER_SIZE 256
+/**
+ * @brief 内部中断回调函数
+ * @note  这个函数是传递给BSP层的，中断或DMA传输完成 (或出错) 时在中断中被调用。
+ * 当前段还有剩余时继续传输，否则在段间延时后直接启动下一段；全部完成或出错时结束事务。
+ */
+static void internal_complete_callback(void* context, led_status_t status) {
+    spi_t* spi = (spi_t*)context;
+    if (spi == NULL) {
+        return;
+    }
+
+    if (status == LED_STATUS_OK) {
+        uint8_t pending;
+        advance_segment(spi);
+        status = run_segments(spi, &pending);
+        if (status == LED_STATUS_OK && pending) {
+            return;
+        }
+    }
+
+    finish_transfer(spi, status);
+}
+
+/**
+ * @brief 内部函数：阻塞传输使用的完成回调
+ */
+static void sync_complete_callback(spi_t* spi, led_status_t status, void* user_data) {
+    (void)user_data;
+    spi->sync_status = status;
+    DRIVER_STORE_RELEASE(&spi->sync_done, 1);
+}
+
+/**
+ * @brief 内部函数：等待阻塞传输完成 (带超时)
+ */
+static led_status_t wait_sync(spi_t* spi, uint32_t timeout_ms) {
+    uint32_t start = spi->api->get_tick();
+    while (!DRIVER_LOAD_ACQUIRE(&spi->sync_done)) {
+        // 无符号减法，系统节拍回绕时同样正确
+        if ((uint32_t)(spi->api->get_tick() - start) >= timeout_ms) {
+            if (spi->api->abort == NULL) {
+                // 无法中止：传输继续在后台进行，完成中断到来时释放总线
+                return LED_STATUS_TIMEOUT;
+            }
+            (void)spi->api->abort(spi->handle);
+            // 中止之后不会再有完成中断；如果传输恰好在中止之前完成，以完成的结果为准
+            if (DRIVER_LOAD_ACQUIRE(&spi->sync_done)) {
+                break;
+            }
+            spi->api->chip_deselect(spi->handle);
+            DRIVER_STORE_RELEASE(&spi->busy, 0);
+            return LED_STATUS_TIMEOUT;
+        }
+        if (spi->api->wait_for_event) {
+            spi->api->wait_for_event(spi->handle);
+        }
+    }
+    return spi->sync_status;
+}
 
 led_status_t spi_init(spi_t* spi, const spi_api_t* api, void* handle) {
     if (spi == NULL || api == NULL || handle == NULL) {
@@ -20,8 +174,20 @@ led_status_t spi_init(spi_t* spi, const spi_api_t* api, void* handle) {
 
     spi->api = api;
     spi->handle = handle;
+    spi->busy = 0;
+    spi->on_complete = NULL;
+    spi->user_data = NULL;
+    spi->sync_done = 0;
+    spi->sync_status = LED_STATUS_OK;
+    spi->segments = NULL;
+    spi->seg_count = 0;
+    spi->seg_index = 0;
+    spi->seg_offset = 0;
+    spi->chunk_len = 0;
+    spi->poll_max_len = SPI_POLL_MAX_LEN;
+    spi->it_max_len = SPI_IT_MAX_LEN;
 
-    return spi->api->init(spi->handle);
+    return spi->api->init(spi->handle, internal_complete_callback, spi);
 }
 
 led_status_t spi_deinit(spi_t* spi) {
@@ -31,64 +197,163 @@ led_status_t spi_deinit(spi_t* spi) {
     return spi->api->deinit(spi->handle);
 }
 
-led_status_t spi_transceive(spi_t* spi, const uint8_t* tx_data, uint8_t* rx_data, uint16_t len) {
-    if (spi == NULL || spi->api == NULL) {
+/**
+ * @brief 内部函数：在已经抢占总线之后开始一个事务
+ */
+static led_status_t begin_transfer(spi_t* spi, const spi_transfer_t* segments, uint8_t count,
+                                   spi_callback_t callback, void* user_data) {
+    spi->on_complete = callback;
+    spi->user_data = user_data;
+    spi->segments = segments;
+    spi->seg_count = count;
+    spi->seg_index = 0;
+    spi->seg_offset = 0;
+
+    // 1. 片选使能 (CS拉低)，整个事务期间保持有效
+    led_status_t status = spi->api->chip_select(spi->handle);
+    if (status != LED_STATUS_OK) {
+        DRIVER_STORE_RELEASE(&spi->busy, 0);
+        return status;
+    }
+
+    // 2. 启动第一段，后续各段在完成中断中依次启动，最后由中断取消片选
+    uint8_t pending;
+    status = run_segments(spi, &pending);
+    if (status != LED_STATUS_OK) {
+        // 没能启动就不会有完成中断，在这里释放总线
+        spi->api->chip_deselect(spi->handle);
+        DRIVER_STORE_RELEASE(&spi->busy, 0);
+        return status;
+    }
+    if (!pending) {
+        // 所有段都以轮询方式完成了，没有完成中断，在这里结束事务
+        finish_transfer(spi, LED_STATUS_OK);
+    }
+    return LED_STATUS_OK;
+}
+
+led_status_t spi_transfer_async(spi_t* spi, const spi_transfer_t* segments, uint8_t count, spi_callback_t callback,
+                               void* user_data) {
+    if (spi == NULL || spi->api == NULL || segments == NULL || count == 0) {
         return LED_STATUS_INV_ARG;
     }
-    if (tx_data == NULL || rx_data == NULL || len == 0) {
+    for (uint8_t i = 0; i < count; ++i) {
+        if (segments[i].len == 0 || (segments[i].tx_data == NULL && segments[i].rx_data == NULL)) {
+            return LED_STATUS_INV_ARG;
+        }
+        if (segments[i].delay_us != 0 && spi->api->delay_us == NULL) {
+            return LED_STATUS_NOT_SUPPORTED;
+        }
+    }
+
+    // 抢占总线：只有把busy从0置为1的一方可以启动传输
+    if (!driver_atomic_cas(&spi->busy, 0, 1)) {
+        return LED_STATUS_BUSY;
+    }
+    return begin_transfer(spi, segments, count, callback, user_data);
+}
+
+led_status_t spi_transfer_timeout(spi_t* spi, const spi_transfer_t* segments, uint8_t count, uint32_t timeout_ms) {
+    if (spi == NULL || spi->api == NULL) {
         return LED_STATUS_INV_ARG;
     }
-    
-    led_status_t status = LED_STATUS_OK;
 
-    // 1. 片选使能 (CS拉低)
-    status = spi->api->chip_select(spi->handle);
+    DRIVER_STORE_RELAXED(&spi->sync_done, 0);
+    led_status_t status = spi_transfer_async(spi, segments, count, sync_complete_callback, NULL);
     if (status != LED_STATUS_OK) {
         return status;
     }
+    return wait_sync(spi, timeout_ms);
+}
 
-    // 2. 调用底层API进行数据交换
-    status = spi->api->transceive_dma(spi->handle, tx_data, rx_data, len);
+led_status_t spi_transfer(spi_t* spi, const spi_transfer_t* segments, uint8_t count) {
+    return spi_transfer_timeout(spi, segments, count, SPI_DEFAULT_TIMEOUT_MS);
+}
 
-    // 3. 片选禁止 (CS拉高)
-    //    这是一个关键步骤：无论数据交换是否成功，都应尝试禁止片选，以释放总线。
-    spi->api->chip_deselect(spi->handle);
+/**
+ * @brief 内部函数：抢占总线并开始一个单段事务
+ * @note  段描述保存在对象内部，调用者不必保持它有效。
+ */
+static led_status_t start_single(spi_t* spi, const uint8_t* tx_data, uint8_t* rx_data, uint16_t len,
+                                 spi_callback_t callback, void* user_data) {
+    if (!driver_atomic_cas(&spi->busy, 0, 1)) {
+        return LED_STATUS_BUSY;
+    }
+    spi->single.tx_data = tx_data;
+    spi->single.rx_data = rx_data;
+    spi->single.len = len;
+    spi->single.delay_us = 0;
+    return begin_transfer(spi, &spi->single, 1, callback, user_data);
+}
 
-    return status;
+/**
+ * @brief 内部函数：执行一个单段事务并等待其完成
+ */
+static led_status_t single_timeout(spi_t* spi, const uint8_t* tx_data, uint8_t* rx_data, uint16_t len,
+                                   uint32_t timeout_ms) {
+    DRIVER_STORE_RELAXED(&spi->sync_done, 0);
+    led_status_t status = start_single(spi, tx_data, rx_data, len, sync_complete_callback, NULL);
+    if (status != LED_STATUS_OK) {
+        return status;
+    }
+    return wait_sync(spi, timeout_ms);
 }
 
-led_status_t spi_write(spi_t* spi, const uint8_t* tx_data, uint16_t len) {
-    if (spi == NULL || tx_data == NULL) {
+led_status_t spi_transceive_async(spi_t* spi, const uint8_t* tx_data, uint8_t* rx_data, uint16_t len,
+                                  spi_callback_t callback, void* user_data) {
+    if (spi == NULL || spi->api == NULL) {
         return LED_STATUS_INV_ARG;
     }
-    if (len > SPI_DUMMY_BUFFER_SIZE) {
-        // 如果需要写入的数据超过了内部缓冲区大小，返回错误
-        // 调用者应使用spi_transceive并自己管理接收缓冲区
+    if (tx_data == NULL || rx_data == NULL || len == 0) {
         return LED_STATUS_INV_ARG;
     }
-
-    // 对于只写操作，接收到的数据是无用的，但DMA仍需要一个有效的缓冲区来写入
-    static uint8_t dummy_rx_buffer[SPI_DUMMY_BUFFER_SIZE];
-    return spi_transceive(spi, tx_data, dummy_rx_buffer, len);
+    return start_single(spi, tx_data, rx_data, len, callback, user_data);
 }
 
-led_status_t spi_read(spi_t* spi, uint8_t* rx_data, uint16_t len) {
-    if (spi == NULL || rx_data == NULL) {
+led_status_t spi_transceive_timeout(spi_t* spi, const uint8_t* tx_data, uint8_t* rx_data, uint16_t len,
+                                    uint32_t timeout_ms) {
+    if (spi == NULL || spi->api == NULL) {
+        return LED_STATUS_INV_ARG;
+    }
+    if (tx_data == NULL || rx_data == NULL || len == 0) {
         return LED_STATUS_INV_ARG;
     }
-    if (len > SPI_DUMMY_BUFFER_SIZE) {
+    return single_timeout(spi, tx_data, rx_data, len, timeout_ms);
+}
+
+led_status_t spi_transceive(spi_t* spi, const uint8_t* tx_data, uint8_t* rx_data, uint16_t len) {
+    return spi_transceive_timeout(spi, tx_data, rx_data, len, SPI_DEFAULT_TIMEOUT_MS);
+}
+
+led_status_t spi_set_mode_thresholds(spi_t* spi, uint16_t poll_max_len, uint16_t it_max_len) {
+    if (spi == NULL) {
         return LED_STATUS_INV_ARG;
     }
+    // 两个阈值各自是一次16位写入，传输进行中修改也只会影响之后启动的块
+    spi->poll_max_len = poll_max_len;
+    spi->it_max_len = it_max_len;
+    return LED_STATUS_OK;
+}
 
-    // 对于只读操作，我们必须向总线发送一些虚拟数据 (通常是0xFF)
-    static uint8_t dummy_tx_buffer[SPI_DUMMY_BUFFER_SIZE];
-    static uint8_t is_inited = 0;
+uint8_t spi_is_busy(spi_t* spi) {
+    if (spi == NULL) {
+        return 0;
+    }
+    return DRIVER_LOAD_ACQUIRE(&spi->busy) ? 1 : 0;
+}
+
+led_status_t spi_write(spi_t* spi, const uint8_t* tx_data, uint16_t len) {
+    if (spi == NULL || spi->api == NULL || tx_data == NULL || len == 0) {
+        return LED_STATUS_INV_ARG;
+    }
+    // 只发送的单段事务：接收到的数据被丢弃，不需要调用者提供接收缓冲区
+    return single_timeout(spi, tx_data, NULL, len, SPI_DEFAULT_TIMEOUT_MS);
+}
 
-    // 仅在第一次调用时初始化虚拟发送缓冲区，提高效率
-    if (!is_inited) {
-        memset(dummy_tx_buffer, 0xFF, SPI_DUMMY_BUFFER_SIZE);
-        is_inited = 1;
+led_status_t spi_read(spi_t* spi, uint8_t* rx_data, uint16_t len) {
+    if (spi == NULL || spi->api == NULL || rx_data == NULL || len == 0) {
+        return LED_STATUS_INV_ARG;
     }
-    
-    return spi_transceive(spi, dummy_tx_buffer, rx_data, len);
+    // 只接收的单段事务：MOSI上发送0xFF
+    return single_timeout(spi, NULL, rx_data, len, SPI_DEFAULT_TIMEOUT_MS);
 }
@@ -4,12 +4,86 @@
 #include "driver_spi_interface.h"
 
 /**
- * @brief SPI驱动的 "对象" 或 "类" 定义
- * @note  它封装了SPI总线的操作接口。
+ * @brief 阻塞传输 (spi_transceive/spi_write/spi_read) 的默认超时时间 (毫秒)
+ */
+#ifndef SPI_DEFAULT_TIMEOUT_MS
+#define SPI_DEFAULT_TIMEOUT_MS 100
+#endif
+
+/**
+ * @brief 传输模式的默认长度阈值 (可以用spi_set_mode_thresholds在运行时修改)
+ * @note  一块传输的长度不超过SPI_POLL_MAX_LEN时轮询完成，不超过SPI_IT_MAX_LEN时用中断，否则用DMA。
+ * 几个字节的传输 (命令、读状态、读ID) 轮询最划算：DMA的配置和完成中断比传输本身还慢。
+ * 中断模式每个字节一次中断，在高速SPI时钟下比字节时间还长，默认不使用，
+ * 只在分频较大的慢速设备上才划算。具体的分界点用driver_spi_benchmark_modes测量。
+ */
+#ifndef SPI_POLL_MAX_LEN
+#define SPI_POLL_MAX_LEN 8
+#endif
+
+#ifndef SPI_IT_MAX_LEN
+#define SPI_IT_MAX_LEN 0
+#endif
+
+/**
+ * @brief 只发送的段使用的接收丢弃缓冲区大小
+ * @note  只在平台没有提供transmit_dma时使用：只发送的段按该大小分块以全双工方式传输，
+ * 每块之间经过一次完成中断。
+ */
+#ifndef SPI_SINK_SIZE
+#define SPI_SINK_SIZE 32
+#endif
+
+/**
+ * @brief 一个事务中的一段传输
+ * @note  - tx_data和rx_data都不为NULL：全双工；
+ * - rx_data为NULL：只发送，接收到的数据被丢弃 (平台提供transmit_dma时使用单向DMA)；
+ * - tx_data为NULL：只接收，发送0xFF (平台提供receive_dma时使用单向DMA)。
+ * 各段在同一次片选内依次进行，段与段之间由完成中断直接启动下一段的DMA。
  */
 typedef struct {
+    const uint8_t* tx_data;     /**< 发送缓冲区，只接收时为NULL */
+    uint8_t* rx_data;           /**< 接收缓冲区，只发送时为NULL */
+    uint16_t len;               /**< 本段长度 */
+    uint16_t delay_us;          /**< 本段结束后 (下一段开始或取消片选之前) 的延时，0表示不延时 */
+} spi_transfer_t;
+
+// 前向声明 spi_t 结构体
+struct spi_s;
+
+// 定义传输完成回调函数指针类型 (通常在中断上下文中被调用；事务全部轮询完成时在启动函数中直接调用。此时片选已经禁止)
+// 参数: spi_t* - 完成传输的SPI对象; status - 传输结果; void* - 用户自定义数据
+typedef void (*spi_callback_t)(struct spi_s* spi, led_status_t status, void* user_data);
+
+/**
+ * @brief SPI驱动的 "对象" 或 "类" 定义
+ * @note  它封装了SPI总线的操作接口。同一时间只能有一个传输在进行。
+ */
+typedef struct spi_s {
     const spi_api_t* api;    /**< 指向平台依赖API函数表的指针 */
     void* handle;               /**< 指向具体硬件实例句柄的void指针 */
+
+    // --- 异步传输 ---
+    uint32_t busy;              /**< 传输进行中标志，只有成功置位它的一方才能启动传输，完成中断中清零 */
+    spi_callback_t on_complete; /**< 本次传输的完成回调 */
+    void* user_data;            /**< 传递给完成回调的用户自定义数据 */
+
+    // --- 当前事务 (只由启动方和完成中断访问) ---
+    const spi_transfer_t* segments; /**< 段列表 */
+    uint8_t seg_count;          /**< 段数 */
+    uint8_t seg_index;          /**< 正在传输的段 */
+    uint16_t seg_offset;        /**< 当前段已完成的字节数 */
+    uint16_t chunk_len;         /**< 正在进行的DMA传输的长度 */
+    spi_transfer_t single;      /**< spi_transceive系列函数使用的单段描述 */
+    uint8_t sink[SPI_SINK_SIZE]; /**< 只发送的段的接收丢弃缓冲区 (平台没有transmit_dma时使用) */
+
+    // --- 传输模式 ---
+    uint16_t poll_max_len;      /**< 不超过该长度的块轮询完成 */
+    uint16_t it_max_len;        /**< 不超过该长度的块用中断传输，更长的用DMA */
+
+    // --- 阻塞传输 ---
+    uint32_t sync_done;         /**< 阻塞传输已完成标志 (由完成中断置位) */
+    led_status_t sync_status;   /**< 阻塞传输的结果 */
 } spi_t;
 
 
@@ -34,8 +108,74 @@ led_status_t spi_init(spi_t* spi, const spi_api_t* api, void* handle);
 led_status_t spi_deinit(spi_t* spi);
 
 /**
- * @brief  执行一次完整的SPI事务 (片选->数据交换->取消片选)。
- * @note   这是核心的、最灵活的函数。
+ * @brief  异步执行一个多段事务：整个段列表在同一次片选内依次传输。
+ * @note   适用于 "命令 + 地址 + 数据" 这类来自不同缓冲区的事务，调用者不必先拷贝到一个临时缓冲区。
+ * 在callback到来之前，段列表本身以及各段的缓冲区都必须保持有效。
+ * @param[in] spi       - 指向spi_t对象的指针。
+ * @param[in] segments  - 段列表。
+ * @param[in] count     - 段数。
+ * @param[in] callback  - 事务完成回调 (此时片选已经禁止)，可以为NULL。
+ * @param[in] user_data - 传递给回调函数的自定义数据指针。
+ * @return led_status_t - 操作的状态码。上一次传输尚未完成时返回LED_STATUS_BUSY；
+ * 有段要求延时而平台没有提供delay_us时返回LED_STATUS_NOT_SUPPORTED。
+ */
+led_status_t spi_transfer_async(spi_t* spi, const spi_transfer_t* segments, uint8_t count, spi_callback_t callback,
+                               void* user_data);
+
+/**
+ * @brief  执行一个多段事务，并等待其完成 (带超时)。
+ * @note   超时行为与spi_transceive_timeout相同。注意：平台没有提供abort时，
+ * 超时返回后事务仍在后台进行，段列表和缓冲区必须保持有效直到总线空闲。
+ * @param[in] spi        - 指向spi_t对象的指针。
+ * @param[in] segments   - 段列表。
+ * @param[in] count      - 段数。
+ * @param[in] timeout_ms - 超时时间 (毫秒)。
+ * @return led_status_t - 操作的状态码。超时返回LED_STATUS_TIMEOUT。
+ */
+led_status_t spi_transfer_timeout(spi_t* spi, const spi_transfer_t* segments, uint8_t count, uint32_t timeout_ms);
+
+/**
+ * @brief  执行一个多段事务，并等待其完成 (超时时间为SPI_DEFAULT_TIMEOUT_MS)。
+ * @param[in] spi      - 指向spi_t对象的指针。
+ * @param[in] segments - 段列表。
+ * @param[in] count    - 段数。
+ * @return led_status_t - 操作的状态码。
+ */
+led_status_t spi_transfer(spi_t* spi, const spi_transfer_t* segments, uint8_t count);
+
+/**
+ * @brief  异步执行一次完整的SPI事务 (片选->数据交换->取消片选)。
+ * @note   片选后启动DMA并立即返回，CPU可以继续做其他工作。传输完成后在中断中自动取消片选，
+ * 然后调用callback。可以在callback中直接启动下一次传输。
+ * 在callback到来之前，tx_data和rx_data指向的缓冲区必须保持有效。
+ * @param[in]  spi       - 指向spi_t对象的指针。
+ * @param[in]  tx_data   - 指向要发送的数据缓冲区的指针。
+ * @param[out] rx_data   - 用于存放接收数据的缓冲区。
+ * @param[in]  len       - 要交换的数据长度。
+ * @param[in]  callback  - 传输完成回调，可以为NULL。
+ * @param[in]  user_data - 传递给回调函数的自定义数据指针。
+ * @return led_status_t - 操作的状态码。上一次传输尚未完成时返回LED_STATUS_BUSY。
+ */
+led_status_t spi_transceive_async(spi_t* spi, const uint8_t* tx_data, uint8_t* rx_data, uint16_t len,
+                                  spi_callback_t callback, void* user_data);
+
+/**
+ * @brief  执行一次完整的SPI事务，并等待其完成 (带超时)。
+ * @note   等待期间如果提供了wait_for_event，CPU进入低功耗等待。超时后如果提供了abort，
+ * 传输被中止并取消片选；否则传输继续在后台进行，完成之前新的传输会返回LED_STATUS_BUSY。
+ * @param[in]  spi        - 指向spi_t对象的指针。
+ * @param[in]  tx_data    - 指向要发送的数据缓冲区的指针。
+ * @param[out] rx_data    - 用于存放接收数据的缓冲区。
+ * @param[in]  len        - 要交换的数据长度。
+ * @param[in]  timeout_ms - 超时时间 (毫秒)。
+ * @return led_status_t - 操作的状态码。超时返回LED_STATUS_TIMEOUT。
+ */
+led_status_t spi_transceive_timeout(spi_t* spi, const uint8_t* tx_data, uint8_t* rx_data, uint16_t len,
+                                    uint32_t timeout_ms);
+
+/**
+ * @brief  执行一次完整的SPI事务 (片选->数据交换->取消片选)，并等待其完成。
+ * @note   等同于超时时间为SPI_DEFAULT_TIMEOUT_MS的spi_transceive_timeout。
  * @param[in]  spi     - 指向spi_t对象的指针。
  * @param[in]  tx_data - 指向要发送的数据缓冲区的指针。
  * @param[out] rx_data - 用于存放接收数据的缓冲区。
@@ -45,8 +185,28 @@ led_status_t spi_deinit(spi_t* spi);
 led_status_t spi_transceive(spi_t* spi, const uint8_t* tx_data, uint8_t* rx_data, uint16_t len);
 
 /**
- * @brief  向SPI总线写入数据 (便利性封装函数)。
- * @note   在写入时，MISO线上的数据将被忽略。
+ * @brief  设置传输模式的长度阈值
+ * @note   一块传输的长度不超过poll_max_len时轮询完成，不超过it_max_len时用中断，否则用DMA。
+ * 平台没有提供transceive_poll/transceive_it时对应的模式被跳过。设为0即可关闭对应的模式。
+ * 注意：事务中所有的块都轮询完成时，完成回调在启动函数返回之前就在调用者的上下文中被调用。
+ * @param[in] spi          - 指向spi_t对象的指针
+ * @param[in] poll_max_len - 轮询模式的最大长度
+ * @param[in] it_max_len   - 中断模式的最大长度
+ * @return led_status_t - 操作的状态码
+ */
+led_status_t spi_set_mode_thresholds(spi_t* spi, uint16_t poll_max_len, uint16_t it_max_len);
+
+/**
+ * @brief  查询是否有传输正在进行
+ * @param[in] spi - 指向spi_t对象的指针
+ * @return uint8_t - 传输进行中返回1，否则返回0
+ */
+uint8_t spi_is_busy(spi_t* spi);
+
+/**
+ * @brief  向SPI总线写入数据 (便利性封装函数)，并等待其完成。
+ * @note   在写入时，MISO线上的数据将被忽略。长度不受限制，不使用任何共享缓冲区，
+ * 因此可以同时在多条总线上调用。
  * @param[in] spi     - 指向spi_t对象的指针。
  * @param[in] tx_data - 指向要发送的数据缓冲区的指针。
  * @param[in] len     - 要发送的数据长度。
@@ -55,8 +215,8 @@ led_status_t spi_transceive(spi_t* spi, const uint8_t* tx_data, uint8_t* rx_data
 led_status_t spi_write(spi_t* spi, const uint8_t* tx_data, uint16_t len);
 
 /**
- * @brief  从SPI总线读取数据 (便利性封装函数)。
- * @note   在读取时，会从MOSI线发送虚拟数据(通常是0xFF)。
+ * @brief  从SPI总线读取数据 (便利性封装函数)，并等待其完成。
+ * @note   在读取时，会从MOSI线发送0xFF。长度不受限制，不使用任何共享缓冲区。
  * @param[in]  spi     - 指向spi_t对象的指针。
  * @param[out] rx_data - 用于存放接收数据的缓冲区。
  * @param[in]  len     - 期望读取的数据长度。
@@ -0,0 +1,271 @@
+#include "driver_spi_bus.h"
+
+#include <stddef.h>
+
+/**
+ * @brief 内部函数：进入临界区 (平台没有提供lock时不做保护)
+ */
+static uint32_t bus_lock(spi_bus_t* bus) {
+    return bus->spi.api->lock ? bus->spi.api->lock() : 0;
+}
+
+static void bus_unlock(spi_bus_t* bus, uint32_t state) {
+    if (bus->spi.api->unlock) {
+        bus->spi.api->unlock(state);
+    }
+}
+
+/**
+ * @brief 内部函数：a是否应该排在b之前 (优先级高的在前，相同优先级先提交的在前)
+ * @note  序号用有符号差比较，回绕时同样正确。
+ */
+static uint8_t request_before(const spi_request_t* a, const spi_request_t* b) {
+    if (a->priority != b->priority) {
+        return a->priority > b->priority;
+    }
+    return (int32_t)(a->seq - b->seq) < 0;
+}
+
+static void heap_sift_up(spi_bus_t* bus, uint16_t i) {
+    spi_request_t* request = bus->queue[i];
+    while (i > 0) {
+        uint16_t parent = (uint16_t)((i - 1) / 2);
+        if (!request_before(request, bus->queue[parent])) {
+            break;
+        }
+        bus->queue[i] = bus->queue[parent];
+        i = parent;
+    }
+    bus->queue[i] = request;
+}
+
+static void heap_sift_down(spi_bus_t* bus, uint16_t i) {
+    spi_request_t* request = bus->queue[i];
+    for (;;) {
+        uint16_t child = (uint16_t)(2 * i + 1);
+        if (child >= bus->count) {
+            break;
+        }
+        if (child + 1 < bus->count && request_before(bus->queue[child + 1], bus->queue[child])) {
+            child++;
+        }
+        if (!request_before(bus->queue[child], request)) {
+            break;
+        }
+        bus->queue[i] = bus->queue[child];
+        i = child;
+    }
+    bus->queue[i] = request;
+}
+
+/**
+ * @brief 内部函数：删除堆中第i个元素 (调用者持有锁)
+ */
+static void heap_remove(spi_bus_t* bus, uint16_t i) {
+    bus->count--;
+    if (i == bus->count) {
+        return;
+    }
+    bus->queue[i] = bus->queue[bus->count];
+    heap_sift_down(bus, i);
+    heap_sift_up(bus, i);
+}
+
+/**
+ * @brief 内部函数：取出最优先的请求 (调用者持有锁)
+ */
+static spi_request_t* heap_pop(spi_bus_t* bus) {
+    if (bus->count == 0) {
+        return NULL;
+    }
+    spi_request_t* request = bus->queue[0];
+    heap_remove(bus, 0);
+    return request;
+}
+
+static uint8_t config_equal(const spi_config_t* a, const spi_config_t* b) {
+    return a->cpol == b->cpol && a->cpha == b->cpha && a->prescaler == b->prescaler;
+}
+
+static void bus_complete(spi_t* spi, led_status_t status, void* user_data);
+
+/**
+ * @brief 内部函数：在总线上启动一个请求 (此时总线空闲，且该请求已经是bus->active)
+ * @note  只有新设备的配置与总线当前配置不同时才重新配置，所以同一设备的连续请求、
+ * 以及配置相同的不同设备之间切换都没有额外开销。
+ */
+static led_status_t start_request(spi_bus_t* bus, spi_request_t* request) {
+    spi_device_t* device = request->device;
+
+    if (!bus->configured || !config_equal(&bus->config, &device->config)) {
+        bus->configured = 0;
+        led_status_t status = bus->spi.api->configure(device->handle, &device->config);
+        if (status != LED_STATUS_OK) {
+            return status;
+        }
+        bus->config = device->config;
+        bus->configured = 1;
+        bus->stats.reconfigs++;
+    }
+
+    // 底层spi_t使用设备自己的句柄，片选的就是这个设备的CS引脚
+    bus->spi.handle = device->handle;
+    return spi_transfer_async(&bus->spi, request->segments, request->count, bus_complete, bus);
+}
+
+/**
+ * @brief 内部函数：依次取出排队的请求并启动，直到有一个启动成功或队列为空
+ * @note  没能启动的请求直接以错误结束 (调用其回调)。请求全部以轮询方式完成时，
+ * bus_complete在start_request中被同步调用并再次进入这里，递归深度不超过队列长度。
+ */
+static void dispatch_next(spi_bus_t* bus) {
+    for (;;) {
+        uint32_t state = bus_lock(bus);
+        spi_request_t* request = heap_pop(bus);
+        bus->active = request;
+        bus_unlock(bus, state);
+
+        if (request == NULL) {
+            return;
+        }
+        led_status_t status = start_request(bus, request);
+        if (status == LED_STATUS_OK) {
+            return;
+        }
+        bus->stats.requests++;
+        bus->stats.errors++;
+        if (request->callback != NULL) {
+            request->callback(request, status, request->user_data);
+        }
+    }
+}
+
+/**
+ * @brief 内部函数：底层事务完成回调 (中断上下文)
+ * @note  先启动下一个请求再回调，使总线的空闲间隙尽量短。
+ */
+static void bus_complete(spi_t* spi, led_status_t status, void* user_data) {
+    (void)spi;
+    spi_bus_t* bus = (spi_bus_t*)user_data;
+    spi_request_t* done = bus->active;
+
+    bus->stats.requests++;
+    if (status != LED_STATUS_OK) {
+        bus->stats.errors++;
+    }
+
+    dispatch_next(bus);
+
+    if (done != NULL && done->callback != NULL) {
+        done->callback(done, status, done->user_data);
+    }
+}
+
+led_status_t spi_bus_init(spi_bus_t* bus, const spi_api_t* api, void* handle, spi_request_t** queue,
+                          uint16_t capacity) {
+    if (bus == NULL || api == NULL || queue == NULL || capacity == 0) {
+        return LED_STATUS_INV_ARG;
+    }
+
+    bus->queue = queue;
+    bus->capacity = capacity;
+    bus->count = 0;
+    bus->next_seq = 0;
+    bus->active = NULL;
+    bus->configured = 0;
+    bus->stats.requests = 0;
+    bus->stats.reconfigs = 0;
+    bus->stats.errors = 0;
+    bus->stats.queue_high_water = 0;
+
+    return spi_init(&bus->spi, api, handle);
+}
+
+led_status_t spi_bus_add_device(spi_bus_t* bus, spi_device_t* device, void* handle, const spi_config_t* config) {
+    if (bus == NULL || device == NULL || handle == NULL || config == NULL || bus->spi.api == NULL) {
+        return LED_STATUS_INV_ARG;
+    }
+    if (bus->spi.api->configure == NULL) {
+        return LED_STATUS_NOT_SUPPORTED;
+    }
+
+    device->bus = bus;
+    device->handle = handle;
+    device->config = *config;
+
+    // 总线上所有设备的片选都必须无效，否则第一次传输时会有两个设备同时响应
+    return bus->spi.api->chip_deselect(handle);
+}
+
+led_status_t spi_bus_submit(spi_request_t* request) {
+    if (request == NULL || request->device == NULL || request->device->bus == NULL || request->segments == NULL ||
+        request->count == 0) {
+        return LED_STATUS_INV_ARG;
+    }
+    spi_bus_t* bus = request->device->bus;
+
+    uint32_t state = bus_lock(bus);
+    request->seq = bus->next_seq++;
+    if (bus->active != NULL) {
+        if (bus->count >= bus->capacity) {
+            bus_unlock(bus, state);
+            return LED_STATUS_BUSY;
+        }
+        bus->queue[bus->count] = request;
+        heap_sift_up(bus, bus->count++);
+        if (bus->count > bus->stats.queue_high_water) {
+            bus->stats.queue_high_water = bus->count;
+        }
+        bus_unlock(bus, state);
+        return LED_STATUS_OK;
+    }
+    // 总线空闲：由本次调用启动，其他上下文此后提交的请求都会进入队列
+    bus->active = request;
+    bus_unlock(bus, state);
+
+    led_status_t status = start_request(bus, request);
+    if (status != LED_STATUS_OK) {
+        // 没能启动：错误直接返回给调用者 (不调用回调)，再把总线交给排队的请求
+        dispatch_next(bus);
+    }
+    return status;
+}
+
+led_status_t spi_bus_cancel(spi_request_t* request) {
+    if (request == NULL || request->device == NULL || request->device->bus == NULL) {
+        return LED_STATUS_INV_ARG;
+    }
+    spi_bus_t* bus = request->device->bus;
+    led_status_t status = LED_STATUS_BUSY;
+
+    uint32_t state = bus_lock(bus);
+    for (uint16_t i = 0; i < bus->count; ++i) {
+        if (bus->queue[i] == request) {
+            heap_remove(bus, i);
+            status = LED_STATUS_OK;
+            break;
+        }
+    }
+    bus_unlock(bus, state);
+    return status;
+}
+
+uint8_t spi_bus_is_idle(spi_bus_t* bus) {
+    if (bus == NULL) {
+        return 1;
+    }
+    uint32_t state = bus_lock(bus);
+    uint8_t idle = (bus->active == NULL && bus->count == 0) ? 1 : 0;
+    bus_unlock(bus, state);
+    return idle;
+}
+
+led_status_t spi_bus_get_stats(spi_bus_t* bus, spi_bus_stats_t* stats) {
+    if (bus == NULL || stats == NULL) {
+        return LED_STATUS_INV_ARG;
+    }
+    uint32_t state = bus_lock(bus);
+    *stats = bus->stats;
+    bus_unlock(bus, state);
+    return LED_STATUS_OK;
+}
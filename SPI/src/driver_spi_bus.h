@@ -0,0 +1,126 @@
+#ifndef __DRIVER_SPI_BUS_H
+#define __DRIVER_SPI_BUS_H
+
+#include "driver_spi.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 前向声明
+struct spi_bus_s;
+struct spi_request_s;
+
+/**
+ * @brief 挂在总线上的一个从设备
+ * @note  每个设备有自己的硬件句柄 (同一个SPI外设 + 自己的CS引脚) 和自己的时序配置。
+ */
+typedef struct {
+    struct spi_bus_s* bus;      /**< 所属的总线 */
+    void* handle;               /**< 设备的硬件句柄，与总线共用同一个SPI外设，片选引脚各自不同 */
+    spi_config_t config;        /**< 设备的时序配置 */
+} spi_device_t;
+
+// 定义请求完成回调函数指针类型 (在中断上下文中被调用，此时该请求的片选已经禁止，
+// 但下一个排队的请求可能已经开始，因此不能据此判断总线空闲)
+// 参数: request - 完成的请求; status - 传输结果; void* - 用户自定义数据
+typedef void (*spi_request_callback_t)(struct spi_request_s* request, led_status_t status, void* user_data);
+
+/**
+ * @brief 一个排队等待总线的事务请求
+ * @note  请求对象由调用者提供 (不做动态内存分配)，从提交到完成回调之前必须保持有效且不能修改。
+ */
+typedef struct spi_request_s {
+    spi_device_t* device;               /**< 目标设备 */
+    const spi_transfer_t* segments;     /**< 段列表 (同spi_transfer_async) */
+    uint8_t count;                      /**< 段数 */
+    uint8_t priority;                   /**< 优先级，数值越大越先执行；相同优先级按提交顺序执行 */
+    spi_request_callback_t callback;    /**< 完成回调，可以为NULL */
+    void* user_data;                    /**< 传递给回调函数的用户自定义数据 */
+    uint32_t seq;                       /**< 提交序号 (内部使用) */
+} spi_request_t;
+
+/**
+ * @brief 总线运行统计
+ */
+typedef struct {
+    uint32_t requests;          /**< 已完成的请求数 */
+    uint32_t reconfigs;         /**< 切换时序配置的次数 */
+    uint32_t errors;            /**< 以错误结束的请求数 */
+    uint16_t queue_high_water;  /**< 等待队列的最高长度 */
+} spi_bus_stats_t;
+
+/**
+ * @brief SPI总线管理器
+ * @note  多个客户端可以在任意上下文中向同一条总线提交请求，请求按优先级排队，
+ * 一个请求完成后在完成中断中直接启动下一个。切换到配置不同的设备时才重新配置总线。
+ */
+typedef struct spi_bus_s {
+    spi_t spi;                          /**< 底层SPI对象 */
+    spi_request_t** queue;              /**< 等待队列 (二叉堆)，存放请求指针 */
+    uint16_t capacity;                  /**< 队列容量 */
+    uint16_t count;                     /**< 队列中的请求数 */
+    uint32_t next_seq;                  /**< 下一个提交序号 */
+    spi_request_t* active;              /**< 正在执行的请求 */
+    spi_config_t config;                /**< 总线当前的时序配置 */
+    uint8_t configured;                 /**< config是否有效 (初始化后或配置失败后为0) */
+    spi_bus_stats_t stats;              /**< 运行统计 */
+} spi_bus_t;
+
+/**
+ * @brief  初始化一条SPI总线
+ * @param[in] bus      - 指向spi_bus_t对象的指针
+ * @param[in] api      - 指向底层硬件API函数表的指针
+ * @param[in] handle   - 总线的硬件句柄 (任意一个设备的句柄均可，用于初始化外设)
+ * @param[in] queue    - 等待队列的存储区
+ * @param[in] capacity - 队列容量 (同时等待的请求数上限)
+ * @return led_status_t - 操作的状态码
+ */
+led_status_t spi_bus_init(spi_bus_t* bus, const spi_api_t* api, void* handle, spi_request_t** queue,
+                          uint16_t capacity);
+
+/**
+ * @brief  把一个设备挂到总线上 (并确保其片选无效)
+ * @param[in] bus    - 指向spi_bus_t对象的指针
+ * @param[in] device - 指向spi_device_t对象的指针
+ * @param[in] handle - 设备的硬件句柄
+ * @param[in] config - 设备的时序配置
+ * @return led_status_t - 操作的状态码。平台不支持configure时返回LED_STATUS_NOT_SUPPORTED
+ */
+led_status_t spi_bus_add_device(spi_bus_t* bus, spi_device_t* device, void* handle, const spi_config_t* config);
+
+/**
+ * @brief  提交一个请求
+ * @note   总线空闲时立即开始执行，否则按优先级排队。
+ * @param[in] request - 已填好device、segments、count、priority和callback的请求
+ * @return led_status_t - 操作的状态码。队列已满时返回LED_STATUS_BUSY
+ */
+led_status_t spi_bus_submit(spi_request_t* request);
+
+/**
+ * @brief  取消一个还在排队的请求 (不会调用它的完成回调)
+ * @param[in] request - 之前提交的请求
+ * @return led_status_t - 操作的状态码。请求已经开始执行或不在队列中时返回LED_STATUS_BUSY
+ */
+led_status_t spi_bus_cancel(spi_request_t* request);
+
+/**
+ * @brief  查询总线是否空闲 (没有正在执行和排队的请求)
+ * @param[in] bus - 指向spi_bus_t对象的指针
+ * @return uint8_t - 空闲返回1，否则返回0
+ */
+uint8_t spi_bus_is_idle(spi_bus_t* bus);
+
+/**
+ * @brief  获取总线运行统计
+ * @param[in]  bus   - 指向spi_bus_t对象的指针
+ * @param[out] stats - 用于存放统计的结构体
+ * @return led_status_t - 操作的状态码
+ */
+led_status_t spi_bus_get_stats(spi_bus_t* bus, spi_bus_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __DRIVER_SPI_BUS_H
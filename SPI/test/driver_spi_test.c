@@ -1,99 +1,1240 @@
 #include "driver_spi_test.h"
-#include <stdio.h>
 
+#include <stdio.h>
+#include <string.h>
+#include "driver_bench.h"
 
 /* Private variables ---------------------------------------------------------*/
-// 定义SPI驱动对象
+// 定义SPI驱动对象和总线上的W25Q Flash
 spi_t g_spi1;
-extern const UART_HandleTypeDef huart1; // 假设UART1用于printf重定向
-
-
-// W25Q系列Flash JEDEC ID命令
-#define W25Q_CMD_JEDEC_ID 0x9F
-
+static w25q_t s_flash;
 
-// 为W25Q芯片封装一个读取JEDEC ID的函数
-led_status_t w25q_read_jedec_id(spi_t* spi, uint8_t* manufacturer_id, uint16_t* device_id);
-
-// printf重定向到UART1的实现
-#ifdef __GNUC__
-#define PUTCHAR_PROTOTYPE int __io_putchar(int ch)
-#else
-#define PUTCHAR_PROTOTYPE int fputc(int ch, FILE *f)
-#endif
-PUTCHAR_PROTOTYPE
-{
-  HAL_UART_Transmit(&huart1, (uint8_t *)&ch, 1, 0xFFFF);
-  return ch;
-}
+// 日志输出：通过UART1异步发送，记录日志不会阻塞SPI传输
+static uart_t s_log_uart;
+static uint8_t s_log_uart_rx_buffer[16];
+static uint8_t s_log_uart_tx_buffer[512];
+static log_slot_t s_log_slots[16];
+static log_t s_log;
 
 
-void driver_spi_test(void);
+void driver_spi_test(void)
 {
     HAL_Init();
     SystemClock_Config();
     // 注意: CubeMX生成的MX_GPIO_Init(), MX_SPI1_Init(), MX_DMA_Init(), MX_USART1_UART_Init()
     // 等函数应在此处被调用。
 
-    printf("\r\n--- SPI W25Q Flash Test Program ---\r\n");
+    uart_init(&s_log_uart, bsp_uart_get_api(), (void*) &g_bsp_usart1, s_log_uart_rx_buffer,
+              sizeof(s_log_uart_rx_buffer), s_log_uart_tx_buffer, sizeof(s_log_uart_tx_buffer));
+    log_init(&s_log, &s_log_uart, LOG_OUTPUT_TEXT, s_log_slots, 16);
+
+    LOG_INFO(&s_log, "--- SPI W25Q Flash Test Program ---\r\n");
 
     /* 驱动初始化 -------------------------------------------------------------*/
     const spi_api_t* spi_api = bsp_spi_get_api();
     spi_init(&g_spi1, spi_api, (void*) &g_bsp_spi1);
 
     /* 应用逻辑：读取Flash JEDEC ID -----------------------------------------*/
-    uint8_t manufacturer_id = 0;
-    uint16_t device_id = 0;
-
-    printf("Reading JEDEC ID from Flash...\r\n");
-    if (w25q_read_jedec_id(&g_spi1, &manufacturer_id, &device_id) == LED_STATUS_OK) {
-        printf("Read successful!\r\n");
-        printf(" - Manufacturer ID: 0x%02X\r\n", manufacturer_id);
-        printf(" - Device ID: 0x%04X\r\n", device_id);
+    // w25q_init读取JEDEC ID并由容量代码确定容量
+    LOG_INFO(&s_log, "Reading JEDEC ID from Flash...\r\n");
+    led_status_t status = w25q_init(&s_flash, &g_spi1);
+    if (status == LED_STATUS_OK || status == LED_STATUS_NOT_SUPPORTED) {
+        LOG_INFO(&s_log, "Read successful!\r\n");
+        LOG_INFO(&s_log, " - Manufacturer ID: 0x%02X\r\n", s_flash.manufacturer_id);
+        LOG_INFO(&s_log, " - Device ID: 0x%04X\r\n", s_flash.device_id);
 
         // W25Q128的制造商ID是0xEF, 设备ID是0x4018
-        if (manufacturer_id == 0xEF) {
-            printf("   (Winbond, Correct!)\r\n");
+        if (s_flash.manufacturer_id == 0xEF) {
+            LOG_INFO(&s_log, "   (Winbond, Correct!)\r\n");
+        }
+        if (status == LED_STATUS_OK) {
+            LOG_INFO(&s_log, " - Capacity: %lu bytes\r\n", (unsigned long)s_flash.capacity);
+        } else {
+            LOG_ERROR(&s_log, "Unsupported flash!\r\n");
         }
     } else {
-        printf("Read failed!\r\n");
+        LOG_ERROR(&s_log, "Read failed!\r\n");
     }
 
-    printf("--- Test Finished ---\r\n");
+    LOG_INFO(&s_log, "--- Test Finished ---\r\n");
 
     while (1) {
-        // 测试完成，主循环空闲
+        // 测试完成，主循环空闲时输出日志
+        log_process(&s_log);
+    }
+}
+
+
+
+/* 模拟SPI ------------------------------------------------------------------*/
+// 模拟的DMA传输在启动时只记录参数，完成中断由测试代码 (或等待钩子) 显式触发。
+// 模拟的从设备把收到的每个字节取反后送回；miso_counter非0时改为送回片选以来的字节序号。
+
+#define SPI_SIM_CAPTURE_SIZE 512
+
+typedef struct {
+    spi_complete_callback_t callback;
+    void* context;
+    const uint8_t* tx_data;
+    uint8_t* rx_data;
+    uint16_t len;
+    uint8_t cs_low;
+    uint32_t selects;
+    uint32_t starts;
+    uint32_t simplex_starts; /**< 单向传输 (transmit_dma/receive_dma) 的启动次数 */
+    uint32_t polls;         /**< 轮询传输的次数 */
+    uint32_t it_starts;     /**< 中断传输的启动次数 (也计入starts) */
+    uint8_t poll_error;     /**< 非0时轮询传输返回错误 */
+    uint32_t aborts;
+    uint32_t complete_at;   /**< 等待钩子在该节拍及之后完成传输，0表示永不完成 */
+    uint8_t miso_counter;
+    uint8_t mosi[SPI_SIM_CAPTURE_SIZE]; /**< 本次片选以来MOSI上的数据 */
+    uint32_t bus_pos;       /**< 本次片选以来传输的字节数 */
+    uint32_t delay_total;   /**< 累计延时 (微秒) */
+    uint32_t delay_pos;     /**< 最近一次延时发生时的bus_pos */
+} spi_sim_port_t;
+
+static spi_sim_port_t* s_spi_sim_delay_port = NULL;
+
+static uint32_t s_spi_sim_tick = 0;
+
+static led_status_t spi_sim_init(void* handle, spi_complete_callback_t callback, void* context) {
+    spi_sim_port_t* port = (spi_sim_port_t*)handle;
+    port->callback = callback;
+    port->context = context;
+    port->cs_low = 0;
+    return LED_STATUS_OK;
+}
+
+static led_status_t spi_sim_deinit(void* handle) {
+    (void)handle;
+    return LED_STATUS_OK;
+}
+
+static led_status_t spi_sim_transceive_dma(void* handle, const uint8_t* tx_data, uint8_t* rx_data, uint16_t len) {
+    spi_sim_port_t* port = (spi_sim_port_t*)handle;
+    if (port->len != 0 || !port->cs_low) {
+        return LED_STATUS_ERROR;
     }
+    port->tx_data = tx_data;
+    port->rx_data = rx_data;
+    port->len = len;
+    port->starts++;
+    return LED_STATUS_OK;
 }
 
+static led_status_t spi_sim_transmit_dma(void* handle, const uint8_t* tx_data, uint16_t len) {
+    spi_sim_port_t* port = (spi_sim_port_t*)handle;
+    led_status_t status = spi_sim_transceive_dma(handle, tx_data, NULL, len);
+    port->simplex_starts += (status == LED_STATUS_OK);
+    return status;
+}
+
+static led_status_t spi_sim_receive_dma(void* handle, uint8_t* rx_data, uint16_t len) {
+    spi_sim_port_t* port = (spi_sim_port_t*)handle;
+    led_status_t status = spi_sim_transceive_dma(handle, NULL, rx_data, len);
+    port->simplex_starts += (status == LED_STATUS_OK);
+    return status;
+}
+
+static led_status_t spi_sim_chip_select(void* handle) {
+    spi_sim_port_t* port = (spi_sim_port_t*)handle;
+    port->cs_low = 1;
+    port->selects++;
+    port->bus_pos = 0;
+    return LED_STATUS_OK;
+}
+
+static led_status_t spi_sim_chip_deselect(void* handle) {
+    ((spi_sim_port_t*)handle)->cs_low = 0;
+    return LED_STATUS_OK;
+}
 
+static uint32_t spi_sim_get_tick(void) {
+    return s_spi_sim_tick;
+}
 
+static led_status_t spi_sim_abort(void* handle) {
+    spi_sim_port_t* port = (spi_sim_port_t*)handle;
+    port->len = 0;
+    port->aborts++;
+    return LED_STATUS_OK;
+}
 
-/**
- * @brief  读取W25Q系列Flash的JEDEC ID
- * @note   这是一个更高层次的、针对具体设备的驱动函数。
- * @param[in]  spi             - 指向已初始化的spi_t对象的指针
- * @param[out] manufacturer_id - 用于存放制造商ID的指针
- * @param[out] device_id       - 用于存放设备ID的指针
- * @return led_status_t - 操作的状态码
- */
-led_status_t w25q_read_jedec_id(spi_t* spi, uint8_t* manufacturer_id, uint16_t* device_id) {
-    // JEDEC ID命令需要发送1个字节的命令(0x9F)，然后接收3个字节的数据。
-    // 所以总共需要进行4个字节的SPI事务。
-    uint8_t tx_buffer[4] = { W25Q_CMD_JEDEC_ID, 0xFF, 0xFF, 0xFF };
-    uint8_t rx_buffer[4] = { 0 };
+// 模拟总线上交换当前记录的数据 (单向传输时tx_data或rx_data为NULL：只接收时发送0xFF，只发送时丢弃接收数据)
+static void spi_sim_shift(spi_sim_port_t* port) {
+    for (uint16_t i = 0; i < port->len; ++i) {
+        // 先取发送字节，再写接收字节 (与硬件顺序一致，发送和接收可以是同一个缓冲区)
+        uint8_t mosi = port->tx_data ? port->tx_data[i] : 0xFF;
+        if (port->bus_pos < SPI_SIM_CAPTURE_SIZE) {
+            port->mosi[port->bus_pos] = mosi;
+        }
+        if (port->rx_data) {
+            port->rx_data[i] = port->miso_counter ? (uint8_t)port->bus_pos : (uint8_t)~mosi;
+        }
+        port->bus_pos++;
+    }
+}
 
-    // 调用我们通用的SPI驱动层函数来执行事务
-    led_status_t status = spi_transceive(spi, tx_buffer, rx_buffer, 4);
+// 模拟DMA (或中断) 传输完成中断
+static void spi_sim_complete(spi_sim_port_t* port, led_status_t status) {
+    spi_sim_shift(port);
+    port->len = 0;
+    port->callback(port->context, status);
+}
 
-    if (status == LED_STATUS_OK) {
-        // 如果通信成功，解析接收到的数据
-        // rx_buffer[0]是无用数据 (在发送命令时接收到的)
-        *manufacturer_id = rx_buffer[1];
-        *device_id = (rx_buffer[2] << 8) | rx_buffer[3];
+// 轮询传输：在调用中同步完成，不产生完成中断
+static led_status_t spi_sim_transceive_poll(void* handle, const uint8_t* tx_data, uint8_t* rx_data, uint16_t len) {
+    spi_sim_port_t* port = (spi_sim_port_t*)handle;
+    if (port->len != 0 || !port->cs_low || port->poll_error) {
+        return LED_STATUS_ERROR;
     }
+    port->tx_data = tx_data;
+    port->rx_data = rx_data;
+    port->len = len;
+    spi_sim_shift(port);
+    port->len = 0;
+    port->polls++;
+    return LED_STATUS_OK;
+}
 
+// 中断传输：与DMA一样由完成中断结束
+static led_status_t spi_sim_transceive_it(void* handle, const uint8_t* tx_data, uint8_t* rx_data, uint16_t len) {
+    spi_sim_port_t* port = (spi_sim_port_t*)handle;
+    led_status_t status = spi_sim_transceive_dma(handle, tx_data, rx_data, len);
+    port->it_starts += (status == LED_STATUS_OK);
     return status;
 }
 
+// 每次“休眠”经过一个节拍，到达指定节拍时传输完成
+static void spi_sim_wait_for_event(void* handle) {
+    spi_sim_port_t* port = (spi_sim_port_t*)handle;
+    s_spi_sim_tick++;
+    if (port->complete_at != 0 && s_spi_sim_tick >= port->complete_at && port->len != 0) {
+        spi_sim_complete(port, LED_STATUS_OK);
+    }
+}
+
+static void spi_sim_delay_us(uint32_t us) {
+    s_spi_sim_delay_port->delay_total += us;
+    s_spi_sim_delay_port->delay_pos = s_spi_sim_delay_port->bus_pos;
+}
+
+static const spi_api_t s_spi_sim_api = {
+    .init = spi_sim_init,
+    .deinit = spi_sim_deinit,
+    .transceive_dma = spi_sim_transceive_dma,
+    .chip_select = spi_sim_chip_select,
+    .chip_deselect = spi_sim_chip_deselect,
+    .get_tick = spi_sim_get_tick,
+    .abort = spi_sim_abort,
+    .wait_for_event = spi_sim_wait_for_event,
+    .delay_us = spi_sim_delay_us,
+};
+
+// 提供单向DMA的平台
+static const spi_api_t s_spi_sim_api_simplex = {
+    .init = spi_sim_init,
+    .deinit = spi_sim_deinit,
+    .transceive_dma = spi_sim_transceive_dma,
+    .transmit_dma = spi_sim_transmit_dma,
+    .receive_dma = spi_sim_receive_dma,
+    .chip_select = spi_sim_chip_select,
+    .chip_deselect = spi_sim_chip_deselect,
+    .get_tick = spi_sim_get_tick,
+    .abort = spi_sim_abort,
+    .wait_for_event = spi_sim_wait_for_event,
+    .delay_us = spi_sim_delay_us,
+};
+
+// 提供轮询和中断模式的平台
+static const spi_api_t s_spi_sim_api_modes = {
+    .init = spi_sim_init,
+    .deinit = spi_sim_deinit,
+    .transceive_dma = spi_sim_transceive_dma,
+    .transmit_dma = spi_sim_transmit_dma,
+    .receive_dma = spi_sim_receive_dma,
+    .transceive_poll = spi_sim_transceive_poll,
+    .transceive_it = spi_sim_transceive_it,
+    .chip_select = spi_sim_chip_select,
+    .chip_deselect = spi_sim_chip_deselect,
+    .get_tick = spi_sim_get_tick,
+    .abort = spi_sim_abort,
+    .wait_for_event = spi_sim_wait_for_event,
+    .delay_us = spi_sim_delay_us,
+};
+
+// 没有abort的平台
+static const spi_api_t s_spi_sim_api_no_abort = {
+    .init = spi_sim_init,
+    .deinit = spi_sim_deinit,
+    .transceive_dma = spi_sim_transceive_dma,
+    .chip_select = spi_sim_chip_select,
+    .chip_deselect = spi_sim_chip_deselect,
+    .get_tick = spi_sim_get_tick,
+    .wait_for_event = spi_sim_wait_for_event,
+};
+
+/* 异步传输测试 -------------------------------------------------------------*/
+
+typedef struct {
+    uint32_t calls;
+    led_status_t status;
+    uint8_t cs_low_in_callback;
+    uint8_t chain;          /**< 非0时在回调中启动下一次传输 */
+    led_status_t chain_status;
+} spi_async_ctx_t;
+
+static uint8_t s_chain_tx[2] = { 0x01, 0x02 };
+static uint8_t s_chain_rx[2];
+
+static void spi_async_on_complete(spi_t* spi, led_status_t status, void* user_data) {
+    spi_async_ctx_t* ctx = (spi_async_ctx_t*)user_data;
+    ctx->calls++;
+    ctx->status = status;
+    ctx->cs_low_in_callback = ((spi_sim_port_t*)spi->handle)->cs_low;
+    if (ctx->chain) {
+        ctx->chain = 0;
+        ctx->chain_status = spi_transceive_async(spi, s_chain_tx, s_chain_rx, sizeof(s_chain_tx),
+                                                 spi_async_on_complete, ctx);
+    }
+}
+
+led_status_t driver_spi_test_async(void) {
+    static spi_sim_port_t port;
+    static spi_t spi;
+    uint8_t tx[4] = { 0x9F, 0x00, 0x55, 0xFF };
+    uint8_t rx[4] = { 0 };
+    spi_async_ctx_t ctx;
+
+    memset(&port, 0, sizeof(port));
+    memset(&ctx, 0, sizeof(ctx));
+    s_spi_sim_tick = 0;
+    if (spi_init(&spi, &s_spi_sim_api, &port) != LED_STATUS_OK) {
+        return LED_STATUS_ERROR;
+    }
+
+    // 1. 异步传输：立即返回，片选保持有效；进行中的第二次传输返回BUSY
+    if (spi_transceive_async(&spi, tx, rx, sizeof(tx), spi_async_on_complete, &ctx) != LED_STATUS_OK ||
+        !port.cs_low || !spi_is_busy(&spi) || ctx.calls != 0 ||
+        spi_transceive_async(&spi, tx, rx, sizeof(tx), NULL, NULL) != LED_STATUS_BUSY || port.starts != 1) {
+        return LED_STATUS_ERROR;
+    }
+
+    // 2. 完成中断：先取消片选再回调；回调中可以直接启动下一次传输
+    ctx.chain = 1;
+    spi_sim_complete(&port, LED_STATUS_OK);
+    if (ctx.calls != 1 || ctx.status != LED_STATUS_OK || ctx.cs_low_in_callback || rx[0] != 0x60 ||
+        rx[3] != 0x00 || ctx.chain_status != LED_STATUS_OK || port.starts != 2 || !port.cs_low) {
+        return LED_STATUS_ERROR;
+    }
+    spi_sim_complete(&port, LED_STATUS_ERROR);
+    if (ctx.calls != 2 || ctx.status != LED_STATUS_ERROR || port.cs_low || spi_is_busy(&spi)) {
+        return LED_STATUS_ERROR;
+    }
+
+    // 3. 阻塞传输：第3个节拍完成，等待期间调用wait_for_event
+    port.complete_at = 3;
+    memset(rx, 0, sizeof(rx));
+    if (spi_transceive_timeout(&spi, tx, rx, sizeof(tx), 10) != LED_STATUS_OK || s_spi_sim_tick != 3 ||
+        rx[1] != 0xFF || port.cs_low || spi_is_busy(&spi)) {
+        return LED_STATUS_ERROR;
+    }
+
+    // 4. 超时：传输被中止，片选取消，总线立即可以再次使用
+    port.complete_at = 0;
+    s_spi_sim_tick = 0;
+    if (spi_transceive_timeout(&spi, tx, rx, sizeof(tx), 5) != LED_STATUS_TIMEOUT || s_spi_sim_tick != 5 ||
+        port.aborts != 1 || port.cs_low || spi_is_busy(&spi)) {
+        return LED_STATUS_ERROR;
+    }
+    port.complete_at = 2;
+    s_spi_sim_tick = 0;
+    if (spi_transceive(&spi, tx, rx, sizeof(tx)) != LED_STATUS_OK) {
+        return LED_STATUS_ERROR;
+    }
+
+    // 5. 没有abort的平台：超时后传输仍在进行，完成之前新的传输返回BUSY
+    spi_init(&spi, &s_spi_sim_api_no_abort, &port);
+    port.complete_at = 0;
+    s_spi_sim_tick = 0;
+    if (spi_transceive_timeout(&spi, tx, rx, sizeof(tx), 5) != LED_STATUS_TIMEOUT || !port.cs_low ||
+        !spi_is_busy(&spi) || spi_transceive_timeout(&spi, tx, rx, sizeof(tx), 5) != LED_STATUS_BUSY) {
+        return LED_STATUS_ERROR;
+    }
+    spi_sim_complete(&port, LED_STATUS_OK);
+    if (port.cs_low || spi_is_busy(&spi)) {
+        return LED_STATUS_ERROR;
+    }
+
+    spi_deinit(&spi);
+    return LED_STATUS_OK;
+}
+
+/* 多段事务测试 -------------------------------------------------------------*/
+
+// 模拟的DMA连续完成，直到事务结束
+static void spi_sim_run(spi_sim_port_t* port) {
+    while (port->len != 0) {
+        spi_sim_complete(port, LED_STATUS_OK);
+    }
+}
+
+led_status_t driver_spi_test_transfer(void) {
+    static spi_sim_port_t port;
+    static spi_t spi;
+    static uint8_t page[100];
+    static uint8_t data[300];
+    spi_async_ctx_t ctx;
+
+    memset(&port, 0, sizeof(port));
+    memset(&ctx, 0, sizeof(ctx));
+    s_spi_sim_tick = 0;
+    s_spi_sim_delay_port = &port;
+    spi_init(&spi, &s_spi_sim_api, &port);
+    for (uint32_t i = 0; i < sizeof(page); ++i) {
+        page[i] = (uint8_t)(0x80 + i);
+    }
+
+    // 1. 参数检查：空段、既不发送也不接收的段
+    const uint8_t cmd[4] = { 0x0B, 0x01, 0x02, 0x03 };
+    const spi_transfer_t bad[1] = { { cmd, NULL, 0, 0 } };
+    const spi_transfer_t none[1] = { { NULL, NULL, 4, 0 } };
+    if (spi_transfer_async(&spi, bad, 1, NULL, NULL) != LED_STATUS_INV_ARG ||
+        spi_transfer_async(&spi, none, 1, NULL, NULL) != LED_STATUS_INV_ARG ||
+        spi_transfer_async(&spi, bad, 0, NULL, NULL) != LED_STATUS_INV_ARG || port.selects != 0) {
+        return LED_STATUS_ERROR;
+    }
+
+    // 2. 快速读：命令+地址 (只发送)、1个空字节后延时、300字节数据 (只接收)，只片选一次
+    const uint8_t dummy = 0x00;
+    const spi_transfer_t read[3] = {
+        { cmd, NULL, sizeof(cmd), 0 },
+        { &dummy, NULL, 1, 5 },
+        { NULL, data, sizeof(data), 0 },
+    };
+    port.miso_counter = 1;
+    if (spi_transfer_async(&spi, read, 3, spi_async_on_complete, &ctx) != LED_STATUS_OK) {
+        return LED_STATUS_ERROR;
+    }
+    spi_sim_run(&port);
+    if (ctx.calls != 1 || ctx.status != LED_STATUS_OK || port.selects != 1 || port.cs_low || port.starts != 3 ||
+        port.bus_pos != 305 || memcmp(port.mosi, cmd, sizeof(cmd)) != 0 || port.mosi[4] != 0x00 ||
+        port.mosi[5] != 0xFF || port.mosi[304] != 0xFF || port.delay_total != 5 || port.delay_pos != 5) {
+        return LED_STATUS_ERROR;
+    }
+    for (uint32_t i = 0; i < sizeof(data); ++i) {
+        if (data[i] != (uint8_t)(5 + i)) {
+            return LED_STATUS_ERROR;
+        }
+    }
+
+    // 3. 页编程：命令 (只发送) + 100字节数据 (只发送，按SPI_SINK_SIZE分块)，仍然只片选一次
+    const uint8_t prog[4] = { 0x02, 0x00, 0x10, 0x00 };
+    const spi_transfer_t write[2] = {
+        { prog, NULL, sizeof(prog), 0 },
+        { page, NULL, sizeof(page), 0 },
+    };
+    port.starts = 0;
+    if (spi_transfer(&spi, write, 2) != LED_STATUS_TIMEOUT) {
+        // 模拟的DMA不会自动完成 (complete_at为0)，阻塞调用超时并中止
+        return LED_STATUS_ERROR;
+    }
+    port.complete_at = 1;
+    s_spi_sim_tick = 0;
+    port.starts = 0;
+    if (spi_transfer(&spi, write, 2) != LED_STATUS_OK || port.cs_low ||
+        port.starts != 1 + (sizeof(page) + SPI_SINK_SIZE - 1) / SPI_SINK_SIZE || port.bus_pos != 104 ||
+        memcmp(port.mosi, prog, sizeof(prog)) != 0 || memcmp(&port.mosi[4], page, sizeof(page)) != 0) {
+        return LED_STATUS_ERROR;
+    }
+
+    // 4. 中途出错：后面的段不再传输，片选取消，以错误结束
+    ctx.calls = 0;
+    port.starts = 0;
+    if (spi_transfer_async(&spi, read, 3, spi_async_on_complete, &ctx) != LED_STATUS_OK) {
+        return LED_STATUS_ERROR;
+    }
+    spi_sim_complete(&port, LED_STATUS_ERROR);
+    if (ctx.calls != 1 || ctx.status != LED_STATUS_ERROR || port.starts != 1 || port.cs_low || port.len != 0 ||
+        spi_is_busy(&spi)) {
+        return LED_STATUS_ERROR;
+    }
+
+    // 5. 平台不支持延时时，要求延时的事务被拒绝
+    spi_init(&spi, &s_spi_sim_api_no_abort, &port);
+    if (spi_transfer_async(&spi, read, 3, NULL, NULL) != LED_STATUS_NOT_SUPPORTED) {
+        return LED_STATUS_ERROR;
+    }
+
+    // 6. W25Q驱动读取JEDEC ID：命令段 + 3字节只接收段 (模拟从设备送回的ID无法识别，初始化返回NOT_SUPPORTED)
+    static w25q_t flash;
+    spi_init(&spi, &s_spi_sim_api, &port);
+    if (w25q_init(&flash, &spi) != LED_STATUS_NOT_SUPPORTED || flash.manufacturer_id != 1 ||
+        flash.device_id != 0x0203 || port.mosi[0] != W25Q_CMD_JEDEC_ID || port.mosi[1] != 0xFF) {
+        return LED_STATUS_ERROR;
+    }
+
+    spi_deinit(&spi);
+    return LED_STATUS_OK;
+}
+
+/* 单向传输测试 -------------------------------------------------------------*/
+
+led_status_t driver_spi_test_simplex(void) {
+    static spi_sim_port_t port;
+    static spi_t spi;
+    static uint8_t buffer[1000];
+
+    memset(&port, 0, sizeof(port));
+    s_spi_sim_tick = 0;
+    s_spi_sim_delay_port = &port;
+    port.complete_at = 1;
+    port.miso_counter = 1;
+    for (uint32_t i = 0; i < sizeof(buffer); ++i) {
+        buffer[i] = (uint8_t)(i * 7);
+    }
+
+    // 1. 平台提供单向DMA：超过256字节的写入和读取都只需要一次DMA，不经过全双工
+    spi_init(&spi, &s_spi_sim_api_simplex, &port);
+    if (spi_write(&spi, buffer, sizeof(buffer)) != LED_STATUS_OK || port.starts != 1 || port.simplex_starts != 1 ||
+        port.bus_pos != sizeof(buffer) || memcmp(port.mosi, buffer, SPI_SIM_CAPTURE_SIZE) != 0 || port.cs_low) {
+        return LED_STATUS_ERROR;
+    }
+    // 读取：MOSI上全是0xFF
+    s_spi_sim_tick = 0;
+    if (spi_read(&spi, buffer, sizeof(buffer)) != LED_STATUS_OK || port.starts != 2 || port.simplex_starts != 2 ||
+        port.bus_pos != sizeof(buffer) || port.mosi[0] != 0xFF || port.mosi[SPI_SIM_CAPTURE_SIZE - 1] != 0xFF) {
+        return LED_STATUS_ERROR;
+    }
+    for (uint32_t i = 0; i < sizeof(buffer); ++i) {
+        if (buffer[i] != (uint8_t)i) {
+            return LED_STATUS_ERROR;
+        }
+    }
+
+    // 2. 多段事务中的单向段同样直接使用单向DMA
+    const uint8_t cmd[4] = { 0x03, 0x00, 0x00, 0x00 };
+    const spi_transfer_t read[2] = {
+        { cmd, NULL, sizeof(cmd), 0 },
+        { NULL, buffer, 600, 0 },
+    };
+    s_spi_sim_tick = 0;
+    port.starts = 0;
+    port.simplex_starts = 0;
+    if (spi_transfer(&spi, read, 2) != LED_STATUS_OK || port.starts != 2 || port.simplex_starts != 2 ||
+        memcmp(port.mosi, cmd, sizeof(cmd)) != 0 || port.mosi[4] != 0xFF || buffer[0] != 4) {
+        return LED_STATUS_ERROR;
+    }
+
+    // 3. 参数检查
+    if (spi_write(&spi, NULL, 4) != LED_STATUS_INV_ARG || spi_read(&spi, buffer, 0) != LED_STATUS_INV_ARG) {
+        return LED_STATUS_ERROR;
+    }
+
+    // 4. 平台没有单向DMA：同样没有长度限制，写入按SPI_SINK_SIZE分块，读取仍只需一次DMA
+    spi_init(&spi, &s_spi_sim_api, &port);
+    s_spi_sim_tick = 0;
+    port.starts = 0;
+    port.simplex_starts = 0;
+    for (uint32_t i = 0; i < sizeof(buffer); ++i) {
+        buffer[i] = (uint8_t)(i * 7);
+    }
+    if (spi_write(&spi, buffer, sizeof(buffer)) != LED_STATUS_OK ||
+        port.starts != (sizeof(buffer) + SPI_SINK_SIZE - 1) / SPI_SINK_SIZE || port.simplex_starts != 0 ||
+        port.bus_pos != sizeof(buffer) || memcmp(port.mosi, buffer, SPI_SIM_CAPTURE_SIZE) != 0) {
+        return LED_STATUS_ERROR;
+    }
+    s_spi_sim_tick = 0;
+    port.starts = 0;
+    if (spi_read(&spi, buffer, sizeof(buffer)) != LED_STATUS_OK || port.starts != 1 || port.mosi[0] != 0xFF ||
+        buffer[sizeof(buffer) - 1] != (uint8_t)(sizeof(buffer) - 1)) {
+        return LED_STATUS_ERROR;
+    }
+
+    spi_deinit(&spi);
+    return LED_STATUS_OK;
+}
+
+/* 总线管理器测试 -----------------------------------------------------------*/
+// 模拟一条SPI总线 (一个外设，一套配置) 上挂多个设备，每个设备有自己的片选。
+// 每次DMA启动时检查：恰好一个设备被选中，且总线配置正是该设备要求的配置。
+
+#define SPI_BUS_SIM_TRACE_SIZE 32
+
+typedef struct {
+    spi_complete_callback_t callback;
+    void* context;
+    const uint8_t* tx_data;
+    uint8_t* rx_data;
+    uint16_t len;
+    spi_config_t config;        /**< 外设当前的配置 */
+    uint32_t configures;
+    uint8_t selected;           /**< 片选有效的设备数 */
+    uint8_t owner;              /**< 最近一次被选中的设备编号 */
+    uint32_t lock_depth;
+    uint32_t errors;            /**< 片选冲突、配置不符、选中期间改配置等违规次数 */
+    uint8_t trace[SPI_BUS_SIM_TRACE_SIZE]; /**< 每次片选的设备编号 */
+    uint32_t trace_len;
+} spi_bus_sim_t;
+
+typedef struct {
+    spi_bus_sim_t* wire;
+    uint8_t id;
+    uint8_t cs_low;
+    spi_config_t expect;        /**< 设备要求的配置 */
+} spi_bus_sim_device_t;
+
+static spi_bus_sim_t s_spi_bus_sim;
+
+static led_status_t spi_bus_sim_init(void* handle, spi_complete_callback_t callback, void* context) {
+    spi_bus_sim_t* wire = ((spi_bus_sim_device_t*)handle)->wire;
+    wire->callback = callback;
+    wire->context = context;
+    return LED_STATUS_OK;
+}
+
+static led_status_t spi_bus_sim_transceive_dma(void* handle, const uint8_t* tx_data, uint8_t* rx_data,
+                                               uint16_t len) {
+    spi_bus_sim_device_t* device = (spi_bus_sim_device_t*)handle;
+    spi_bus_sim_t* wire = device->wire;
+    if (wire->len != 0 || wire->selected != 1 || !device->cs_low) {
+        wire->errors++;
+        return LED_STATUS_ERROR;
+    }
+    if (wire->config.cpol != device->expect.cpol || wire->config.cpha != device->expect.cpha ||
+        wire->config.prescaler != device->expect.prescaler) {
+        wire->errors++;
+    }
+    wire->tx_data = tx_data;
+    wire->rx_data = rx_data;
+    wire->len = len;
+    return LED_STATUS_OK;
+}
+
+static led_status_t spi_bus_sim_chip_select(void* handle) {
+    spi_bus_sim_device_t* device = (spi_bus_sim_device_t*)handle;
+    spi_bus_sim_t* wire = device->wire;
+    if (wire->selected != 0) {
+        wire->errors++;
+    }
+    device->cs_low = 1;
+    wire->selected++;
+    wire->owner = device->id;
+    if (wire->trace_len < SPI_BUS_SIM_TRACE_SIZE) {
+        wire->trace[wire->trace_len] = device->id;
+    }
+    wire->trace_len++;
+    return LED_STATUS_OK;
+}
+
+static led_status_t spi_bus_sim_chip_deselect(void* handle) {
+    spi_bus_sim_device_t* device = (spi_bus_sim_device_t*)handle;
+    if (device->cs_low) {
+        device->cs_low = 0;
+        device->wire->selected--;
+    }
+    return LED_STATUS_OK;
+}
+
+static led_status_t spi_bus_sim_configure(void* handle, const spi_config_t* config) {
+    spi_bus_sim_t* wire = ((spi_bus_sim_device_t*)handle)->wire;
+    if (wire->selected != 0 || wire->len != 0) {
+        wire->errors++;
+        return LED_STATUS_ERROR;
+    }
+    if (config->prescaler < 2 || config->prescaler > 256 || (config->prescaler & (config->prescaler - 1)) != 0) {
+        return LED_STATUS_INV_ARG;
+    }
+    wire->config = *config;
+    wire->configures++;
+    return LED_STATUS_OK;
+}
 
+static uint32_t spi_bus_sim_lock(void) {
+    return s_spi_bus_sim.lock_depth++;
+}
+
+static void spi_bus_sim_unlock(uint32_t state) {
+    s_spi_bus_sim.lock_depth = state;
+}
+
+// 模拟DMA传输完成中断：从设备把收到的每个字节加上自己的编号后送回
+static void spi_bus_sim_complete(spi_bus_sim_t* wire, led_status_t status) {
+    for (uint16_t i = 0; i < wire->len; ++i) {
+        uint8_t mosi = wire->tx_data[i];
+        wire->rx_data[i] = (uint8_t)(mosi + wire->owner);
+    }
+    wire->len = 0;
+    wire->callback(wire->context, status);
+}
+
+static void spi_bus_sim_run(spi_bus_sim_t* wire) {
+    while (wire->len != 0) {
+        spi_bus_sim_complete(wire, LED_STATUS_OK);
+    }
+}
+
+static const spi_api_t s_spi_bus_sim_api = {
+    .init = spi_bus_sim_init,
+    .deinit = spi_sim_deinit,
+    .transceive_dma = spi_bus_sim_transceive_dma,
+    .chip_select = spi_bus_sim_chip_select,
+    .chip_deselect = spi_bus_sim_chip_deselect,
+    .get_tick = spi_sim_get_tick,
+    .configure = spi_bus_sim_configure,
+    .lock = spi_bus_sim_lock,
+    .unlock = spi_bus_sim_unlock,
+};
+
+// 请求完成记录
+typedef struct {
+    uint32_t calls;
+    led_status_t status;
+    uint8_t order[SPI_BUS_SIM_TRACE_SIZE]; /**< 按完成顺序记录请求的user_data编号 */
+    uint32_t errors;            /**< 回调时仍持有锁的次数 */
+    spi_request_t* chain;       /**< 非NULL时在回调中提交它 */
+    led_status_t chain_status;
+} spi_bus_record_t;
+
+static spi_bus_record_t s_spi_bus_record;
+
+static void spi_bus_on_complete(spi_request_t* request, led_status_t status, void* user_data) {
+    spi_bus_record_t* record = &s_spi_bus_record;
+    (void)request;
+    if (s_spi_bus_sim.lock_depth != 0) {
+        record->errors++;
+    }
+    if (record->calls < SPI_BUS_SIM_TRACE_SIZE) {
+        record->order[record->calls] = (uint8_t)(uintptr_t)user_data;
+    }
+    record->calls++;
+    record->status = status;
+    if (record->chain != NULL) {
+        spi_request_t* chain = record->chain;
+        record->chain = NULL;
+        record->chain_status = spi_bus_submit(chain);
+    }
+}
+
+static void spi_bus_request_fill(spi_request_t* request, spi_device_t* device, const spi_transfer_t* segment,
+                                 uint8_t priority, uint8_t tag) {
+    request->device = device;
+    request->segments = segment;
+    request->count = 1;
+    request->priority = priority;
+    request->callback = spi_bus_on_complete;
+    request->user_data = (void*)(uintptr_t)tag;
+}
+
+// 三个设备：Flash (模式0，2分频)、显示屏 (模式3，4分频)、ADC (模式1，16分频)，
+// 外加一个与Flash配置相同的第二片Flash
+enum { SPI_BUS_DEV_FLASH = 1, SPI_BUS_DEV_DISPLAY, SPI_BUS_DEV_ADC, SPI_BUS_DEV_FLASH2, SPI_BUS_DEV_COUNT = 4 };
+
+static spi_bus_t s_spi_bus;
+static spi_request_t* s_spi_bus_queue[4];
+static spi_bus_sim_device_t s_spi_bus_sim_devices[SPI_BUS_DEV_COUNT];
+static spi_device_t s_spi_bus_devices[SPI_BUS_DEV_COUNT];
+
+static const spi_config_t s_spi_bus_configs[SPI_BUS_DEV_COUNT] = {
+    { 0, 0, 2 },
+    { 1, 1, 4 },
+    { 0, 1, 16 },
+    { 0, 0, 2 },
+};
+
+static led_status_t spi_bus_test_setup(void) {
+    memset(&s_spi_bus_sim, 0, sizeof(s_spi_bus_sim));
+    memset(&s_spi_bus_record, 0, sizeof(s_spi_bus_record));
+    for (uint8_t i = 0; i < SPI_BUS_DEV_COUNT; ++i) {
+        s_spi_bus_sim_devices[i].wire = &s_spi_bus_sim;
+        s_spi_bus_sim_devices[i].id = (uint8_t)(i + 1);
+        s_spi_bus_sim_devices[i].cs_low = 0;
+        s_spi_bus_sim_devices[i].expect = s_spi_bus_configs[i];
+    }
+    if (spi_bus_init(&s_spi_bus, &s_spi_bus_sim_api, &s_spi_bus_sim_devices[0], s_spi_bus_queue, 4) !=
+        LED_STATUS_OK) {
+        return LED_STATUS_ERROR;
+    }
+    for (uint8_t i = 0; i < SPI_BUS_DEV_COUNT; ++i) {
+        if (spi_bus_add_device(&s_spi_bus, &s_spi_bus_devices[i], &s_spi_bus_sim_devices[i],
+                               &s_spi_bus_configs[i]) != LED_STATUS_OK) {
+            return LED_STATUS_ERROR;
+        }
+    }
+    return LED_STATUS_OK;
+}
+
+led_status_t driver_spi_test_bus(void) {
+    static spi_request_t requests[8];
+    static uint8_t tx[8][4];
+    static uint8_t rx[8][4];
+    spi_transfer_t segments[8];
+    spi_bus_stats_t stats;
+    spi_device_t* flash = &s_spi_bus_devices[0];
+    spi_device_t* display = &s_spi_bus_devices[1];
+    spi_device_t* adc = &s_spi_bus_devices[2];
+    spi_device_t* flash2 = &s_spi_bus_devices[3];
+
+    if (spi_bus_test_setup() != LED_STATUS_OK) {
+        return LED_STATUS_ERROR;
+    }
+    for (uint8_t i = 0; i < 8; ++i) {
+        memset(tx[i], 0x10 * i, sizeof(tx[i]));
+        segments[i].tx_data = tx[i];
+        segments[i].rx_data = rx[i];
+        segments[i].len = sizeof(tx[i]);
+        segments[i].delay_us = 0;
+    }
+
+    // 1. 空闲总线上的请求立即开始；之后的请求按优先级排队，相同优先级先到先服务
+    spi_bus_request_fill(&requests[0], flash, &segments[0], 1, 0);
+    spi_bus_request_fill(&requests[1], adc, &segments[1], 1, 1);
+    spi_bus_request_fill(&requests[2], display, &segments[2], 3, 2);
+    spi_bus_request_fill(&requests[3], adc, &segments[3], 3, 3);
+    spi_bus_request_fill(&requests[4], display, &segments[4], 0, 4);
+    if (spi_bus_submit(&requests[0]) != LED_STATUS_OK || s_spi_bus_sim.trace_len != 1 ||
+        s_spi_bus_sim.configures != 1) {
+        return LED_STATUS_ERROR;
+    }
+    for (uint8_t i = 1; i < 5; ++i) {
+        if (spi_bus_submit(&requests[i]) != LED_STATUS_OK) {
+            return LED_STATUS_ERROR;
+        }
+    }
+
+    // 2. 队列已满返回BUSY；取消排队中的请求成功，取消正在执行的请求返回BUSY
+    spi_bus_request_fill(&requests[5], flash, &segments[5], 9, 5);
+    if (spi_bus_submit(&requests[5]) != LED_STATUS_BUSY || spi_bus_cancel(&requests[4]) != LED_STATUS_OK ||
+        spi_bus_cancel(&requests[4]) != LED_STATUS_BUSY || spi_bus_cancel(&requests[0]) != LED_STATUS_BUSY) {
+        return LED_STATUS_ERROR;
+    }
+
+    // 3. 执行顺序：0 (Flash)，2 (显示屏，优先级3)，3 (ADC，优先级3)，1 (ADC，优先级1)；
+    // 连续两次访问ADC时不重新配置
+    spi_bus_sim_run(&s_spi_bus_sim);
+    const uint8_t expect_order[4] = { 0, 2, 3, 1 };
+    const uint8_t expect_trace[4] = { SPI_BUS_DEV_FLASH, SPI_BUS_DEV_DISPLAY, SPI_BUS_DEV_ADC, SPI_BUS_DEV_ADC };
+    spi_bus_get_stats(&s_spi_bus, &stats);
+    if (s_spi_bus_record.calls != 4 || memcmp(s_spi_bus_record.order, expect_order, 4) != 0 ||
+        memcmp(s_spi_bus_sim.trace, expect_trace, 4) != 0 || s_spi_bus_sim.configures != 3 ||
+        stats.reconfigs != 3 || stats.requests != 4 || stats.errors != 0 || stats.queue_high_water != 4 ||
+        s_spi_bus_sim.errors != 0 || s_spi_bus_record.errors != 0 || !spi_bus_is_idle(&s_spi_bus)) {
+        return LED_STATUS_ERROR;
+    }
+    // 每个设备的数据都由它自己应答 (送回的字节 = 发送字节 + 设备编号)
+    if (rx[0][0] != 0x00 + SPI_BUS_DEV_FLASH || rx[2][3] != 0x20 + SPI_BUS_DEV_DISPLAY ||
+        rx[1][1] != 0x10 + SPI_BUS_DEV_ADC) {
+        return LED_STATUS_ERROR;
+    }
+
+    // 4. 配置相同的两片Flash之间切换不需要重新配置
+    memset(&s_spi_bus_record, 0, sizeof(s_spi_bus_record));
+    s_spi_bus_sim.trace_len = 0;
+    spi_bus_request_fill(&requests[0], flash, &segments[0], 0, 0);
+    spi_bus_request_fill(&requests[1], flash2, &segments[1], 0, 1);
+    spi_bus_request_fill(&requests[2], flash, &segments[2], 0, 2);
+    for (uint8_t i = 0; i < 3; ++i) {
+        spi_bus_submit(&requests[i]);
+    }
+    spi_bus_sim_run(&s_spi_bus_sim);
+    const uint8_t expect_flash[3] = { SPI_BUS_DEV_FLASH, SPI_BUS_DEV_FLASH2, SPI_BUS_DEV_FLASH };
+    if (s_spi_bus_record.calls != 3 || memcmp(s_spi_bus_sim.trace, expect_flash, 3) != 0 ||
+        s_spi_bus_sim.configures != 4 || s_spi_bus_sim.errors != 0) {
+        return LED_STATUS_ERROR;
+    }
+
+    // 5. 传输出错：该请求以错误结束，排在后面的请求照常执行；在回调中提交的请求也能执行
+    memset(&s_spi_bus_record, 0, sizeof(s_spi_bus_record));
+    spi_bus_request_fill(&requests[0], display, &segments[0], 0, 0);
+    spi_bus_request_fill(&requests[1], adc, &segments[1], 0, 1);
+    spi_bus_request_fill(&requests[2], flash, &segments[2], 0, 2);
+    spi_bus_submit(&requests[0]);
+    spi_bus_submit(&requests[1]);
+    spi_bus_sim_complete(&s_spi_bus_sim, LED_STATUS_ERROR);
+    if (s_spi_bus_record.calls != 1 || s_spi_bus_record.status != LED_STATUS_ERROR || s_spi_bus_sim.len == 0) {
+        return LED_STATUS_ERROR;
+    }
+    s_spi_bus_record.chain = &requests[2];
+    spi_bus_sim_run(&s_spi_bus_sim);
+    spi_bus_get_stats(&s_spi_bus, &stats);
+    if (s_spi_bus_record.calls != 3 || s_spi_bus_record.status != LED_STATUS_OK ||
+        s_spi_bus_record.chain_status != LED_STATUS_OK || s_spi_bus_record.order[2] != 2 || stats.errors != 1 ||
+        s_spi_bus_sim.errors != 0 || s_spi_bus_record.errors != 0 || !spi_bus_is_idle(&s_spi_bus)) {
+        return LED_STATUS_ERROR;
+    }
+
+    // 6. 配置失败 (不支持的分频)：错误直接返回，总线回到空闲，下一个请求重新配置
+    spi_device_t bad;
+    spi_bus_sim_device_t bad_sim = { &s_spi_bus_sim, 9, 0, { 0, 0, 3 } };
+    const spi_config_t bad_config = { 0, 0, 3 };
+    spi_bus_add_device(&s_spi_bus, &bad, &bad_sim, &bad_config);
+    spi_bus_request_fill(&requests[0], &bad, &segments[0], 0, 0);
+    uint32_t configures = s_spi_bus_sim.configures;
+    if (spi_bus_submit(&requests[0]) != LED_STATUS_INV_ARG || !spi_bus_is_idle(&s_spi_bus) ||
+        s_spi_bus_sim.selected != 0) {
+        return LED_STATUS_ERROR;
+    }
+    spi_bus_request_fill(&requests[1], flash, &segments[1], 0, 1);
+    if (spi_bus_submit(&requests[1]) != LED_STATUS_OK || s_spi_bus_sim.configures != configures + 1) {
+        return LED_STATUS_ERROR;
+    }
+    spi_bus_sim_run(&s_spi_bus_sim);
+
+    // 7. 参数检查：平台不支持configure时不能挂设备
+    static spi_bus_t plain;
+    static spi_request_t* plain_queue[1];
+    spi_device_t plain_device;
+    spi_bus_init(&plain, &s_spi_sim_api, &s_spi_bus_sim_devices[0], plain_queue, 1);
+    if (spi_bus_add_device(&plain, &plain_device, &s_spi_bus_sim_devices[0], &s_spi_bus_configs[0]) !=
+        LED_STATUS_NOT_SUPPORTED) {
+        return LED_STATUS_ERROR;
+    }
+
+    return LED_STATUS_OK;
+}
+
+/* 重新配置开销基准测试 -----------------------------------------------------*/
+// 同一组请求以两种顺序提交：三个设备轮流访问 (每次都要重新配置) 和按设备分组访问，
+// 比较重新配置的次数；再测量一次configure调用本身的耗时，两者相乘即为重新配置的总开销。
+
+#define SPI_BENCH_ROUNDS 300
+
+// 提交一批请求 (队列容量为1：每次等前一个完成后再提交下一个) 并返回平均每个请求的软件开销
+static uint32_t spi_bench_trace(const uint8_t* device_of, uint32_t count, uint32_t* reconfigs) {
+    static spi_request_t request;
+    static uint8_t tx[4];
+    static uint8_t rx[4];
+    const spi_transfer_t segment = { tx, rx, sizeof(tx), 0 };
+    spi_bus_stats_t before;
+    spi_bus_stats_t after;
+    uint32_t total = 0;
+
+    spi_bus_get_stats(&s_spi_bus, &before);
+    for (uint32_t i = 0; i < count; ++i) {
+        spi_bus_request_fill(&request, &s_spi_bus_devices[device_of[i]], &segment, 0, 0);
+        request.callback = NULL;
+        uint32_t t0 = bench_now();
+        spi_bus_submit(&request);
+        spi_bus_sim_complete(&s_spi_bus_sim, LED_STATUS_OK);
+        total += bench_now() - t0;
+    }
+    spi_bus_get_stats(&s_spi_bus, &after);
+    *reconfigs = after.reconfigs - before.reconfigs;
+    return total / count;
+}
+
+void driver_spi_benchmark_bus(void) {
+    static uint8_t interleaved[SPI_BENCH_ROUNDS];
+    static uint8_t grouped[SPI_BENCH_ROUNDS];
+    uint32_t reconfigs;
+
+    if (spi_bus_test_setup() != LED_STATUS_OK) {
+        return;
+    }
+    bench_cycle_counter_init();
+    for (uint32_t i = 0; i < SPI_BENCH_ROUNDS; ++i) {
+        interleaved[i] = (uint8_t)(i % 3);
+        grouped[i] = (uint8_t)(i * 3 / SPI_BENCH_ROUNDS);
+    }
+
+    bench_report("spi bus, %u requests over flash/display/adc (%s per request, submit to DMA done)\r\n",
+                 (unsigned)SPI_BENCH_ROUNDS, BENCH_UNIT);
+    uint32_t avg = spi_bench_trace(interleaved, SPI_BENCH_ROUNDS, &reconfigs);
+    bench_report("%-12s avg %6lu, reconfigs %4lu\r\n", "interleaved", (unsigned long)avg, (unsigned long)reconfigs);
+    avg = spi_bench_trace(grouped, SPI_BENCH_ROUNDS, &reconfigs);
+    bench_report("%-12s avg %6lu, reconfigs %4lu\r\n", "grouped", (unsigned long)avg, (unsigned long)reconfigs);
+
+    // 单次configure的耗时：在目标板上测量真实的寄存器改写，在PC上只是模拟函数
+#if defined(__arm__)
+    const spi_api_t* api = bsp_spi_get_api();
+    void* handle = (void*)&g_bsp_spi1;
+#else
+    const spi_api_t* api = &s_spi_bus_sim_api;
+    void* handle = &s_spi_bus_sim_devices[0];
+#endif
+    uint32_t t0 = bench_now();
+    for (uint32_t i = 0; i < SPI_BENCH_ROUNDS; ++i) {
+        api->configure(handle, &s_spi_bus_configs[i % 3]);
+    }
+    uint32_t per_configure = (bench_now() - t0) / SPI_BENCH_ROUNDS;
+    bench_report("configure    avg %6lu\r\n", (unsigned long)per_configure);
+}
+
+/* 传输模式测试 -------------------------------------------------------------*/
+
+led_status_t driver_spi_test_modes(void) {
+    static spi_sim_port_t port;
+    static spi_t spi;
+    static uint8_t data[300];
+    static uint8_t status_reg[2];
+    spi_async_ctx_t ctx;
+
+    memset(&port, 0, sizeof(port));
+    memset(&ctx, 0, sizeof(ctx));
+    s_spi_sim_tick = 0;
+    s_spi_sim_delay_port = &port;
+    port.miso_counter = 1;
+    spi_init(&spi, &s_spi_sim_api_modes, &port);
+
+    // 1. 默认阈值：JEDEC ID (1字节命令 + 3字节数据) 两段都轮询完成，不启动DMA、不等待
+    // (模拟从设备送回的ID无法识别，w25q_init返回NOT_SUPPORTED，但ID已经读出)
+    static w25q_t flash;
+    if (w25q_init(&flash, &spi) != LED_STATUS_NOT_SUPPORTED || port.polls != 2 || port.starts != 0 ||
+        s_spi_sim_tick != 0 || flash.manufacturer_id != 1 || flash.device_id != 0x0203 || port.cs_low ||
+        spi_is_busy(&spi)) {
+        return LED_STATUS_ERROR;
+    }
+
+    // 2. 全部轮询的异步事务：回调在启动函数返回之前调用，此时片选已经取消、总线已经释放
+    const uint8_t read_status[2] = { 0x05, 0x00 };
+    if (spi_transceive_async(&spi, read_status, status_reg, 2, spi_async_on_complete, &ctx) != LED_STATUS_OK ||
+        ctx.calls != 1 || ctx.status != LED_STATUS_OK || ctx.cs_low_in_callback || spi_is_busy(&spi) ||
+        status_reg[1] != 1) {
+        return LED_STATUS_ERROR;
+    }
+
+    // 3. 混合事务：4字节轮询、50字节中断、2字节轮询 (在完成中断中完成)、300字节DMA
+    const uint8_t cmd[4] = { 0x0B, 0x00, 0x10, 0x00 };
+    const uint8_t dummy[2] = { 0x00, 0x00 };
+    const spi_transfer_t mixed[4] = {
+        { cmd, NULL, sizeof(cmd), 0 },
+        { NULL, data, 50, 0 },
+        { dummy, NULL, sizeof(dummy), 0 },
+        { NULL, data + 50, 250, 0 },
+    };
+    spi_set_mode_thresholds(&spi, 4, 64);
+    memset(&ctx, 0, sizeof(ctx));
+    port.polls = 0;
+    port.starts = 0;
+    port.selects = 0;
+    if (spi_transfer_async(&spi, mixed, 4, spi_async_on_complete, &ctx) != LED_STATUS_OK || port.polls != 1 ||
+        port.it_starts != 1 || port.len != 50 || ctx.calls != 0) {
+        return LED_STATUS_ERROR;
+    }
+    spi_sim_complete(&port, LED_STATUS_OK);
+    if (port.polls != 2 || port.starts != 2 || port.it_starts != 1 || port.simplex_starts != 1 || port.len != 250) {
+        return LED_STATUS_ERROR;
+    }
+    spi_sim_complete(&port, LED_STATUS_OK);
+    if (ctx.calls != 1 || ctx.status != LED_STATUS_OK || port.selects != 1 || port.bus_pos != 306 ||
+        memcmp(port.mosi, cmd, sizeof(cmd)) != 0 || port.mosi[4] != 0xFF || port.mosi[54] != 0x00 ||
+        data[0] != 4 || data[49] != 53 || data[50] != 56 || data[299] != (uint8_t)305) {
+        return LED_STATUS_ERROR;
+    }
+
+    // 4. 轮询出错：事务以错误结束 (同步返回)，片选取消，总线释放
+    port.poll_error = 1;
+    if (spi_transfer_async(&spi, mixed, 4, spi_async_on_complete, &ctx) != LED_STATUS_ERROR || port.cs_low ||
+        spi_is_busy(&spi) || ctx.calls != 1) {
+        return LED_STATUS_ERROR;
+    }
+    port.poll_error = 0;
+
+    // 5. 阈值为0时关闭轮询和中断，所有块都用DMA
+    spi_set_mode_thresholds(&spi, 0, 0);
+    port.polls = 0;
+    port.it_starts = 0;
+    port.starts = 0;
+    port.complete_at = 1;
+    s_spi_sim_tick = 0;
+    if (spi_transceive(&spi, read_status, status_reg, 2) != LED_STATUS_OK || port.polls != 0 ||
+        port.it_starts != 0 || port.starts != 1) {
+        return LED_STATUS_ERROR;
+    }
+
+    // 6. 平台没有轮询钩子时即使在阈值内也用DMA
+    spi_init(&spi, &s_spi_sim_api, &port);
+    s_spi_sim_tick = 0;
+    port.starts = 0;
+    if (spi_transceive(&spi, read_status, status_reg, 2) != LED_STATUS_OK || port.polls != 0 || port.starts != 1) {
+        return LED_STATUS_ERROR;
+    }
+
+    spi_deinit(&spi);
+    return LED_STATUS_OK;
+}
+
+/* 传输模式校准基准测试 -----------------------------------------------------*/
+// 比较的是CPU占用而不是延迟：轮询的延迟总是最短，但期间CPU什么也做不了。
+// 在目标板上测量真实的BSP路径：启动传输后前台循环不断计数直到传输完成，
+// 总耗时减去前台循环本身用掉的周期，就是启动、中断服务和完成处理占用的CPU周期。
+// PC上没有真实的SPI外设，改用周期成本模型代替硬件。
+
+#define SPI_MODE_BENCH_MAX_LEN 256
+
+static const uint16_t s_spi_mode_bench_prescalers[] = { 2, 8, 32, 128 };
+static const uint16_t s_spi_mode_bench_lengths[] = { 1, 2, 4, 8, 16, 32, 64, 256 };
+static uint8_t s_spi_mode_bench_tx[SPI_MODE_BENCH_MAX_LEN];
+static uint8_t s_spi_mode_bench_rx[SPI_MODE_BENCH_MAX_LEN];
+
+// 强制使用某一种模式 (0 轮询, 1 中断, 2 DMA) 完成一次len字节的传输，返回占用CPU的周期
+typedef uint32_t (*spi_mode_cost_t)(spi_t* spi, uint8_t mode, uint16_t len);
+
+static void spi_mode_bench_force(spi_t* spi, uint8_t mode) {
+    spi_set_mode_thresholds(spi, mode == 0 ? 0xFFFF : 0, mode == 1 ? 0xFFFF : 0);
+}
+
+#if defined(__arm__)
+
+#define SPI_MODE_BENCH_ROUNDS 8
+#define SPI_MODE_BENCH_SPINS  1000u
+
+static uint32_t s_spi_spin_cycles_x100; /**< 前台循环每次迭代的周期数 x100 */
+
+// 前台循环每次迭代的耗时：循环体与下面等待传输完成的循环相同
+static void spi_mode_bench_calibrate(spi_t* spi) {
+    volatile uint32_t spins = 0;
+    uint32_t t0 = bench_now();
+    while (spi_is_busy(spi) == 0 && spins < SPI_MODE_BENCH_SPINS) {
+        spins++;
+    }
+    s_spi_spin_cycles_x100 = (bench_now() - t0) * 100u / SPI_MODE_BENCH_SPINS;
+}
+
+static uint32_t spi_hw_cost(spi_t* spi, uint8_t mode, uint16_t len) {
+    uint32_t best = 0xFFFFFFFFu;
+    spi_mode_bench_force(spi, mode);
+    // 取多次测量的最小值，排除SysTick等无关中断的干扰
+    for (uint32_t round = 0; round < SPI_MODE_BENCH_ROUNDS; ++round) {
+        volatile uint32_t spins = 0;
+        uint32_t t0 = bench_now();
+        if (spi_transceive_async(spi, s_spi_mode_bench_tx, s_spi_mode_bench_rx, len, NULL, NULL) != LED_STATUS_OK) {
+            return 0;
+        }
+        // 与校准循环的形式相同 (多出的比较不会成立)，每次迭代的耗时一致
+        while (spi_is_busy(spi) && spins < 0xFFFFFFFFu) {
+            spins++;
+        }
+        uint32_t elapsed = bench_now() - t0;
+        uint32_t idle = (uint32_t)((uint64_t)spins * s_spi_spin_cycles_x100 / 100u);
+        uint32_t cost = elapsed > idle ? elapsed - idle : 0;
+        if (cost < best) {
+            best = cost;
+        }
+    }
+    return best;
+}
+
+#else
+
+// 模型的常数是STM32F4 @168MHz、APB2 84MHz使用HAL时的典型值，只用于在PC上验证选择逻辑和报告格式
+
+#define SPI_MODEL_POLL_SETUP     30u    /**< 轮询：进入函数、使能SPE、等待BSY */
+#define SPI_MODEL_POLL_PER_BYTE  20u    /**< 轮询：每字节的寄存器读写 (字节时间更长时等于字节时间) */
+#define SPI_MODEL_IT_SETUP       250u   /**< 中断：HAL_SPI_TransmitReceive_IT */
+#define SPI_MODEL_IT_PER_BYTE    150u   /**< 中断：每字节一次HAL_SPI_IRQHandler */
+#define SPI_MODEL_IT_COMPLETE    200u   /**< 中断：结束处理和完成回调 */
+#define SPI_MODEL_DMA_SETUP      400u   /**< DMA：配置两个DMA流并使能 */
+#define SPI_MODEL_DMA_COMPLETE   350u   /**< DMA：完成中断、等待BSY、完成回调 */
+
+static spi_sim_port_t s_spi_model_port;
+static uint32_t s_spi_model_byte_cycles;
+static uint32_t s_spi_model_cpu;
+
+static led_status_t spi_model_poll(void* handle, const uint8_t* tx_data, uint8_t* rx_data, uint16_t len) {
+    uint32_t per_byte = s_spi_model_byte_cycles > SPI_MODEL_POLL_PER_BYTE ? s_spi_model_byte_cycles
+                                                                          : SPI_MODEL_POLL_PER_BYTE;
+    s_spi_model_cpu += SPI_MODEL_POLL_SETUP + len * per_byte;
+    return spi_sim_transceive_poll(handle, tx_data, rx_data, len);
+}
+
+static led_status_t spi_model_it(void* handle, const uint8_t* tx_data, uint8_t* rx_data, uint16_t len) {
+    s_spi_model_cpu += SPI_MODEL_IT_SETUP + len * SPI_MODEL_IT_PER_BYTE + SPI_MODEL_IT_COMPLETE;
+    return spi_sim_transceive_it(handle, tx_data, rx_data, len);
+}
+
+static led_status_t spi_model_dma(void* handle, const uint8_t* tx_data, uint8_t* rx_data, uint16_t len) {
+    s_spi_model_cpu += SPI_MODEL_DMA_SETUP + SPI_MODEL_DMA_COMPLETE;
+    return spi_sim_transceive_dma(handle, tx_data, rx_data, len);
+}
+
+static const spi_api_t s_spi_model_api = {
+    .init = spi_sim_init,
+    .deinit = spi_sim_deinit,
+    .transceive_dma = spi_model_dma,
+    .transceive_poll = spi_model_poll,
+    .transceive_it = spi_model_it,
+    .chip_select = spi_sim_chip_select,
+    .chip_deselect = spi_sim_chip_deselect,
+    .get_tick = spi_sim_get_tick,
+};
+
+static uint32_t spi_model_cost(spi_t* spi, uint8_t mode, uint16_t len) {
+    spi_mode_bench_force(spi, mode);
+    s_spi_model_cpu = 0;
+    spi_transceive_async(spi, s_spi_mode_bench_tx, s_spi_mode_bench_rx, len, NULL, NULL);
+    spi_sim_run(&s_spi_model_port);
+    return s_spi_model_cpu;
+}
+
+#endif
+
+// 输出当前分频下的开销表和分界点：从1字节开始，最省CPU的模式依次是轮询、中断、DMA，
+// 记录各自最后一个最优的长度
+static void spi_mode_bench_report(spi_t* spi, spi_mode_cost_t cost_of) {
+    bench_report("  %5s %8s %8s %8s\r\n", "len", "poll", "it", "dma");
+    for (uint32_t i = 0; i < sizeof(s_spi_mode_bench_lengths) / sizeof(s_spi_mode_bench_lengths[0]); ++i) {
+        uint16_t len = s_spi_mode_bench_lengths[i];
+        bench_report("  %5u %8lu %8lu %8lu\r\n", len, (unsigned long)cost_of(spi, 0, len),
+                     (unsigned long)cost_of(spi, 1, len), (unsigned long)cost_of(spi, 2, len));
+    }
+
+    uint16_t poll_max = 0;
+    uint16_t it_max = 0;
+    for (uint16_t len = 1; len <= SPI_MODE_BENCH_MAX_LEN; ++len) {
+        uint32_t cost[3];
+        for (uint8_t mode = 0; mode < 3; ++mode) {
+            cost[mode] = cost_of(spi, mode, len);
+        }
+        if (cost[0] <= cost[1] && cost[0] <= cost[2]) {
+            poll_max = len;
+        } else if (cost[1] <= cost[2]) {
+            it_max = len;
+        }
+    }
+    if (it_max < poll_max) {
+        it_max = 0;
+    }
+    bench_report("  crossover: poll up to %u, it up to %u -> spi_set_mode_thresholds(spi, %u, %u)\r\n", poll_max,
+                 it_max, poll_max, it_max);
+}
+
+void driver_spi_benchmark_modes(void) {
+    static spi_t spi;
+
+    memset(s_spi_mode_bench_tx, 0xFF, sizeof(s_spi_mode_bench_tx));
+    bench_cycle_counter_init();
+
+#if defined(__arm__)
+    // 直接使用SPI1的BSP (从设备收到的都是0xFF)，测量期间不能有其他代码使用SPI1
+    const spi_api_t* api = bsp_spi_get_api();
+    if (spi_init(&spi, api, (void*)&g_bsp_spi1) != LED_STATUS_OK || api->configure == NULL) {
+        return;
+    }
+    spi_mode_bench_calibrate(&spi);
+    bench_report("spi mode calibration (measured, CPU cycles per transfer, loop %lu.%02lu cycles)\r\n",
+                 (unsigned long)(s_spi_spin_cycles_x100 / 100u), (unsigned long)(s_spi_spin_cycles_x100 % 100u));
+    for (uint32_t p = 0; p < sizeof(s_spi_mode_bench_prescalers) / sizeof(s_spi_mode_bench_prescalers[0]); ++p) {
+        const spi_config_t config = { 0, 0, s_spi_mode_bench_prescalers[p] };
+        if (api->configure((void*)&g_bsp_spi1, &config) != LED_STATUS_OK) {
+            continue;
+        }
+        bench_report("prescaler %3u\r\n", s_spi_mode_bench_prescalers[p]);
+        spi_mode_bench_report(&spi, spi_hw_cost);
+    }
+#else
+    memset(&s_spi_model_port, 0, sizeof(s_spi_model_port));
+    spi_init(&spi, &s_spi_model_api, &s_spi_model_port);
+    bench_report("spi mode calibration (model, CPU cycles per transfer @168MHz)\r\n");
+    for (uint32_t p = 0; p < sizeof(s_spi_mode_bench_prescalers) / sizeof(s_spi_mode_bench_prescalers[0]); ++p) {
+        // 一个字节8个SCK周期，SCK = 84MHz / prescaler，CPU周期是APB2周期的一半
+        s_spi_model_byte_cycles = 8u * 2u * s_spi_mode_bench_prescalers[p];
+        bench_report("prescaler %3u (byte = %4lu cycles)\r\n", s_spi_mode_bench_prescalers[p],
+                     (unsigned long)s_spi_model_byte_cycles);
+        spi_mode_bench_report(&spi, spi_model_cost);
+    }
+#endif
+
+    spi_deinit(&spi);
+}
@@ -3,6 +3,10 @@
 
 #include "driver_spi_bsp.h"
 #include "driver_spi.h"
+#include "driver_spi_bus.h"
+#include "driver_w25q.h"
+#include "driver_uart_bsp.h"
+#include "driver_log.h"
 
 
 #ifdef __cplusplus
@@ -11,6 +15,63 @@ extern "C" {
 
 void driver_spi_test(void);
 
+/**
+ * @brief 异步传输测试：传输启动后立即返回、完成中断中自动取消片选并回调、
+ * 在回调中启动下一次传输、阻塞封装的正常完成与超时中止 (含没有abort的平台)
+ * @note  使用模拟的spi_api_t，不依赖硬件。
+ * @return led_status_t - 全部通过返回LED_STATUS_OK
+ */
+led_status_t driver_spi_test_async(void);
+
+/**
+ * @brief 多段事务测试：命令/地址/数据分别来自不同缓冲区、只片选一次，
+ * 只发送段的分块、只接收段发送0xFF、段间延时、中途出错，以及W25Q驱动基于多段事务的JEDEC ID读取
+ * @note  使用模拟的spi_api_t，不依赖硬件。
+ * @return led_status_t - 全部通过返回LED_STATUS_OK
+ */
+led_status_t driver_spi_test_transfer(void);
+
+/**
+ * @brief 单向传输测试：spi_write/spi_read超过256字节、只发送和只接收的段使用单向DMA、
+ * 只接收时MOSI上发送0xFF，以及平台没有单向DMA时退化为全双工
+ * @note  使用模拟的spi_api_t，不依赖硬件。
+ * @return led_status_t - 全部通过返回LED_STATUS_OK
+ */
+led_status_t driver_spi_test_simplex(void);
+
+/**
+ * @brief 传输模式测试：按长度阈值选择轮询/中断/DMA、短事务全部轮询时同步完成、
+ * 混合事务中各段使用不同模式 (含在完成中断中轮询)、轮询出错、关闭模式和平台没有对应钩子时的退化
+ * @note  使用模拟的spi_api_t，不依赖硬件。
+ * @return led_status_t - 全部通过返回LED_STATUS_OK
+ */
+led_status_t driver_spi_test_modes(void);
+
+/**
+ * @brief 传输模式校准基准测试：在几种分频下比较轮询、中断、DMA三种模式传输不同长度时占用的CPU周期，
+ * 并给出各模式的分界点 (可直接用于spi_set_mode_thresholds)
+ * @note  在目标板上用DWT测量SPI1真实的BSP路径 (测量期间独占SPI1，从设备收到的都是0xFF)，
+ * 在PC上使用周期成本模型代替硬件。结果通过g_uart1输出，需在g_uart1完成uart_init之后调用。
+ */
+void driver_spi_benchmark_modes(void);
+
+/**
+ * @brief 总线管理器测试：一条总线上挂Flash、显示屏、ADC等模式和分频各不相同的设备，
+ * 验证优先级和先到先服务的执行顺序、每次只选中目标设备、只在配置变化时重新配置、
+ * 队列满与取消、传输出错后继续执行排队的请求、配置失败的处理
+ * @note  使用模拟的spi_api_t，不依赖硬件。
+ * @return led_status_t - 全部通过返回LED_STATUS_OK
+ */
+led_status_t driver_spi_test_bus(void);
+
+/**
+ * @brief 重新配置开销基准测试：三个设备轮流访问与按设备分组访问时的重新配置次数和每个请求的软件开销，
+ * 以及单次configure的耗时
+ * @note  在目标板上使用DWT周期计数器 (单位为周期)，在PC上使用系统单调时钟 (单位为纳秒)。
+ * 结果通过g_uart1输出，需在g_uart1完成uart_init之后调用。
+ */
+void driver_spi_benchmark_bus(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -4,37 +4,106 @@
 
 // 假设我们使用USART1
 extern UART_HandleTypeDef huart1;
-const bsp_uart_handle_t g_bsp_usart1 = {&huart1};
+const bsp_uart_handle_t g_bsp_usart1 = {&huart1, NULL, 0};
 
-// 定义接收缓冲区大小
+// 定义每个串口的循环DMA接收缓冲区大小
+// HT/TC中断保证每半个缓冲区至少处理一次，因此中断响应延迟只需小于半个缓冲区的接收时间
 #define RX_BUFFER_SIZE 256
-static uint8_t g_rx_buffer[RX_BUFFER_SIZE];
 
-// 定义回调函数指针
-static uart_rx_callback_t g_rx_callback = NULL;
+// 每个串口端口的运行时状态
+// 为了简单高效，我们使用一个固定大小的数组，按USART外设编号直接索引 (O(1)查找)
+typedef struct {
+    uart_rx_callback_t callback;    /**< 上层注册的接收回调 */
+    uart_tx_callback_t tx_callback; /**< 上层注册的发送完成回调 */
+    void* context;                  /**< 回调时传回的上下文 (上层的uart_t对象) */
+    uart_rx_dma_cursor_t cursor;    /**< 循环DMA的读位置 */
+} bsp_uart_port_t;
+
+static bsp_uart_port_t g_uart_ports[BSP_UART_MAX_PORTS] = {0};
+static uint8_t g_rx_buffers[BSP_UART_MAX_PORTS][RX_BUFFER_SIZE];
+
+// 内部辅助函数，用于根据USART外设获取其端口索引 (0 ~ BSP_UART_MAX_PORTS-1)
+static int8_t get_port_index(const USART_TypeDef* instance) {
+    if (instance == USART1) return 0;
+    if (instance == USART2) return 1;
+#if defined(USART3)
+    if (instance == USART3) return 2;
+#endif
+#if defined(UART4)
+    if (instance == UART4)  return 3;
+#endif
+#if defined(UART5)
+    if (instance == UART5)  return 4;
+#endif
+#if defined(USART6)
+    if (instance == USART6) return 5;
+#endif
+    return -1;
+}
 
-static led_status_t stm32_uart_init(void* handle, uart_rx_callback_t callback) {
+// 内部辅助函数，启动 (或重新启动) 循环DMA接收
+static led_status_t start_circular_rx(UART_HandleTypeDef* huart, int8_t index) {
+    // 确保接收DMA工作在循环模式，这样DMA永远不会停止，也就不存在重启窗口内的丢数据问题
+    if (huart->hdmarx->Init.Mode != DMA_CIRCULAR) {
+        huart->hdmarx->Init.Mode = DMA_CIRCULAR;
+        if (HAL_DMA_Init(huart->hdmarx) != HAL_OK) {
+            return LED_STATUS_ERROR;
+        }
+    }
 
-    /******* 这里有问题 *****/
-    const bsp_uart_handle_t* bsp_handle = (const bsp_uart_handle_t*)handle;
+    uart_rx_dma_cursor_reset(&g_uart_ports[index].cursor);
+    if (HAL_UART_Receive_DMA(huart, g_rx_buffers[index], RX_BUFFER_SIZE) != HAL_OK) {
+        return LED_STATUS_ERROR;
+    }
+    return LED_STATUS_OK;
+}
+
+// 内部辅助函数，把DMA缓冲区中自上次处理以来的新数据交给上层
+static void process_rx_event(UART_HandleTypeDef* huart, uart_rx_event_t event) {
+    int8_t index = get_port_index(huart->Instance);
+    if (index == -1) {
+        return;
+    }
+    bsp_uart_port_t* port = &g_uart_ports[index];
+    if (port->callback == NULL) {
+        return;
+    }
 
+    uart_rx_dma_advance(&port->cursor, g_rx_buffers[index], RX_BUFFER_SIZE,
+                        __HAL_DMA_GET_COUNTER(huart->hdmarx),
+                        event, port->callback, port->context);
+}
+
+// 高分辨率时间戳：DWT周期计数器 (168MHz下约25秒回绕一次，远大于数据在缓冲区中的停留时间)
+static uint32_t stm32_uart_get_timestamp(void) {
+    return DWT->CYCCNT;
+}
+
+static led_status_t stm32_uart_init(void* handle, uart_rx_callback_t callback, uart_tx_callback_t tx_callback, void* context) {
+    const bsp_uart_handle_t* bsp_handle = (const bsp_uart_handle_t*)handle;
 
     if (bsp_handle == NULL || callback == NULL) {
         return LED_STATUS_INV_ARG;
     }
 
     // 注册回调函数
-    g_rx_callback = callback;
+    int8_t index = get_port_index(bsp_handle->huart->Instance);
+    if (index == -1) {
+        return LED_STATUS_ERROR;
+    }
+    g_uart_ports[index].callback = callback;
+    g_uart_ports[index].tx_callback = tx_callback;
+    g_uart_ports[index].context = context;
+
+    // 使能DWT周期计数器，供get_timestamp使用 (重复使能无副作用)
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
 
     // 使能IDLE中断
     __HAL_UART_ENABLE_IT(bsp_handle->huart, UART_IT_IDLE);
 
-    // 启动DMA接收
-    if (HAL_UART_Receive_DMA(bsp_handle->huart, g_rx_buffer, RX_BUFFER_SIZE) != HAL_OK) {
-        return LED_STATUS_ERROR;
-    }
-
-    return LED_STATUS_OK;
+    // 启动循环DMA接收 (HAL会同时使能DMA的HT和TC中断)
+    return start_circular_rx(bsp_handle->huart, index);
 }
 
 static led_status_t stm32_uart_deinit(void* handle) {
@@ -42,50 +111,100 @@ static led_status_t stm32_uart_deinit(void* handle) {
     if (bsp_handle == NULL) return LED_STATUS_INV_ARG;
     
     // 实际项目中可以调用 HAL_UART_DeInit 等
-    g_rx_callback = NULL;
+    int8_t index = get_port_index(bsp_handle->huart->Instance);
+    if (index != -1) {
+        g_uart_ports[index].callback = NULL;
+        g_uart_ports[index].tx_callback = NULL;
+        g_uart_ports[index].context = NULL;
+    }
+    HAL_UART_DMAStop(bsp_handle->huart);
     return LED_STATUS_OK;
 }
 
-static led_status_t stm32_uart_transmit_dma(void* handle, const uint8_t* data, uint16_t len) {
+static led_status_t stm32_uart_transmit_dma(void* handle, const uint8_t* data, uint32_t len) {
     const bsp_uart_handle_t* bsp_handle = (const bsp_uart_handle_t*)handle;
-    if (bsp_handle == NULL || data == NULL || len == 0) {
+    if (bsp_handle == NULL || data == NULL || len == 0 || len > UART_DMA_MAX_TRANSFER) {
         return LED_STATUS_INV_ARG;
     }
 
-    if (HAL_UART_Transmit_DMA(bsp_handle->huart, (uint8_t*)data, len) != HAL_OK) {
+    if (HAL_UART_Transmit_DMA(bsp_handle->huart, (uint8_t*)data, (uint16_t)len) != HAL_OK) {
         return LED_STATUS_ERROR;
     }
     return LED_STATUS_OK;
 }
 
-// BSP层提供的中断处理函数
+// BSP层提供的中断处理函数，它会根据触发中断的外设分发到对应端口的回调
 void bsp_uart_irq_handler(UART_HandleTypeDef *huart) {
     // 检查是否是IDLE中断
     if (__HAL_UART_GET_FLAG(huart, UART_FLAG_IDLE) != RESET) {
         __HAL_UART_CLEAR_IDLEFLAG(huart); // 清除IDLE标志位
 
-        // 停止DMA，防止新数据覆盖缓冲区
-        HAL_UART_DMAStop(huart);
+        // 循环DMA不需要停止，直接交出自上次处理以来的新数据
+        process_rx_event(huart, UART_RX_EVENT_IDLE);
+    }
+}
 
-        // 计算接收到的数据长度
-        uint16_t len = RX_BUFFER_SIZE - __HAL_DMA_GET_COUNTER(huart->hdmarx);
+// 以下函数覆盖了HAL库中的弱定义回调，由HAL_DMA_IRQHandler/HAL_UART_IRQHandler调用
 
-        if (len > 0 && g_rx_callback != NULL) {
-            // 调用上层注册的回调函数，处理数据
-            g_rx_callback((void*)&g_bsp_usart1, g_rx_buffer, len);
-        }
+void HAL_UART_RxHalfCpltCallback(UART_HandleTypeDef *huart) {
+    process_rx_event(huart, UART_RX_EVENT_HALF);
+}
 
-        // 重新启动DMA接收
-        HAL_UART_Receive_DMA(huart, g_rx_buffer, RX_BUFFER_SIZE);
+void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart) {
+    process_rx_event(huart, UART_RX_EVENT_COMPLETE);
+}
+
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart) {
+    int8_t index = get_port_index(huart->Instance);
+    if (index == -1) {
+        return;
+    }
+    // 通知上层本次DMA发送已完成，上层可以在回调中直接启动下一次发送
+    bsp_uart_port_t* port = &g_uart_ports[index];
+    if (port->tx_callback != NULL) {
+        port->tx_callback(port->context);
     }
 }
 
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart) {
+    // 发生溢出(ORE)等错误时HAL会中止接收DMA，这里先交出已收到的数据，再重新启动循环接收
+    int8_t index = get_port_index(huart->Instance);
+    if (index == -1 || huart->RxState != HAL_UART_STATE_READY) {
+        return;
+    }
+    process_rx_event(huart, UART_RX_EVENT_IDLE);
+    start_circular_rx(huart, index);
+}
+
+static void stm32_uart_wait_for_event(void* handle) {
+    (void)handle;
+    // 任何中断 (DMA HT/TC、USART IDLE、SysTick) 都会唤醒CPU，
+    // 最坏情况下在一个SysTick周期 (1ms) 内返回，调用者据此重新检查数据和超时
+    __WFI();
+}
+
+static led_status_t stm32_uart_set_rts(void* handle, uint8_t ready) {
+    const bsp_uart_handle_t* bsp_handle = (const bsp_uart_handle_t*)handle;
+    if (bsp_handle == NULL) {
+        return LED_STATUS_INV_ARG;
+    }
+    if (bsp_handle->rts_port == NULL) {
+        return LED_STATUS_NOT_SUPPORTED;
+    }
+    // RTS低电平有效：低电平表示本端可以接收
+    HAL_GPIO_WritePin(bsp_handle->rts_port, bsp_handle->rts_pin, ready ? GPIO_PIN_RESET : GPIO_PIN_SET);
+    return LED_STATUS_OK;
+}
+
 // 填充API结构体实例
 static const uart_api_t s_uart_api_stm32 = {
     .init = stm32_uart_init,
     .deinit = stm32_uart_deinit,
     .transmit_dma = stm32_uart_transmit_dma,
     .get_tick = HAL_GetTick,
+    .wait_for_event = stm32_uart_wait_for_event,
+    .set_rts = stm32_uart_set_rts,
+    .get_timestamp = stm32_uart_get_timestamp,
 };
 
 const uart_api_t* bsp_uart_get_api(void) {
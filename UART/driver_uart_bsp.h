@@ -4,12 +4,18 @@
 #include "driver_uart_interface.h"
 #include "stm32f4xx_hal.h"
 
+/**
+ * @brief BSP层最多支持的串口数量 (STM32F4: USART1/2/3, UART4/5, USART6)
+ */
+#define BSP_UART_MAX_PORTS 6
+
 /**
  * @brief 包含STM32平台串口硬件具体信息的句柄结构体。
  */
 typedef struct {
     UART_HandleTypeDef* const huart; /**< 指向HAL库UART句柄的指针 */
-
+    GPIO_TypeDef* const rts_port;    /**< (可选) RTS引脚所在的GPIO端口，不使用流控时为NULL */
+    const uint16_t rts_pin;          /**< RTS引脚号 (需在CubeMX中配置为推挽输出，低电平有效) */
 } bsp_uart_handle_t;
 
 /**
@@ -20,7 +26,8 @@ const uart_api_t* bsp_uart_get_api(void);
 
 /**
  * @brief BSP层提供的中断处理函数。
- * @note  这个函数需要在真正的STM32中断服务函数 `USART1_IRQHandler` 中被调用。
+ * @note  这个函数需要在每个使用中的串口的中断服务函数 (如 `USART1_IRQHandler`、
+ * `USART2_IRQHandler`) 中被调用，它会根据huart自动分发到对应的驱动对象。
  * @param[in] huart - 触发中断的UART句柄。
  */
 void bsp_uart_irq_handler(UART_HandleTypeDef *huart);
@@ -1 +1,35 @@
-#include "driver_uart_interface.h"
\ No newline at end of file
+#include "driver_uart_interface.h"
+
+void uart_rx_dma_cursor_reset(uart_rx_dma_cursor_t* cursor) {
+    if (cursor != NULL) {
+        cursor->last_pos = 0;
+    }
+}
+
+void uart_rx_dma_advance(uart_rx_dma_cursor_t* cursor, uint8_t* buffer, uint32_t size, uint32_t remaining,
+                         uart_rx_event_t event, uart_rx_callback_t callback, void* context) {
+    if (cursor == NULL || buffer == NULL || size == 0 || callback == NULL) {
+        return;
+    }
+
+    // DMA当前的写位置。循环模式下计数器到0后会自动重装为size，因此pos==size等价于0
+    uint32_t pos = size - remaining;
+    if (pos >= size) {
+        pos = 0;
+    }
+    uint32_t last = cursor->last_pos;
+
+    if (pos > last) {
+        // 新数据是连续的一段
+        callback(context, &buffer[last], pos - last, event);
+    } else if (pos < last) {
+        // DMA已经回绕：先交出缓冲区末尾的一段，再交出开头的一段
+        callback(context, &buffer[last], size - last, UART_RX_EVENT_DATA);
+        callback(context, buffer, pos, event);
+    } else {
+        // 没有新数据，仍然通知上层发生了该事件
+        callback(context, &buffer[pos], 0, event);
+    }
+
+    cursor->last_pos = pos;
+}
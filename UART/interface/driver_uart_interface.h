@@ -11,13 +11,47 @@ extern "C" {
 // 前向声明，避免循环包含
 struct uart_api_s;
 
+/**
+ * @brief 单次DMA传输的最大长度
+ * @note  STM32的DMA计数器 (NDTR) 是16位的。驱动层保证每次调用transmit_dma时
+ * len不超过该值，更长的数据由驱动层自动拆分为多次DMA传输。
+ */
+#define UART_DMA_MAX_TRANSFER 0xFFFFu
+
+/**
+ * @brief 触发接收回调的硬件事件类型
+ */
+typedef enum {
+    UART_RX_EVENT_DATA,     /**< 普通数据段：同一事件的后续数据还会继续回调 (数据跨越DMA缓冲区末尾时) */
+    UART_RX_EVENT_HALF,     /**< DMA半传输完成 (HT) */
+    UART_RX_EVENT_COMPLETE, /**< DMA传输完成 (TC)，循环模式下DMA会自动回到缓冲区开头 */
+    UART_RX_EVENT_IDLE,     /**< 总线空闲 (IDLE) */
+} uart_rx_event_t;
+
 /**
  * @brief 定义串口接收回调函数指针类型
- * @param[in] handle - 指向硬件相关句柄的void指针
- * @param[in] data   - 指向接收到的数据缓冲区的指针
- * @param[in] len    - 接收到的数据长度
+ * @note  每个硬件事件的最后一次回调会携带该事件的类型，此时len可能为0 (事件发生时没有新数据)。
+ * @param[in] context - 注册回调时传入的上下文指针 (通常指向上层的uart_t对象)
+ * @param[in] data    - 指向接收到的数据缓冲区的指针
+ * @param[in] len     - 接收到的数据长度
+ * @param[in] event   - 触发本次回调的事件类型
  */
-typedef void (*uart_rx_callback_t)(void* handle, uint8_t* data, uint16_t len);
+typedef void (*uart_rx_callback_t)(void* context, uint8_t* data, uint32_t len, uart_rx_event_t event);
+
+/**
+ * @brief 定义串口DMA发送完成回调函数指针类型
+ * @param[in] context - 注册回调时传入的上下文指针 (通常指向上层的uart_t对象)
+ */
+typedef void (*uart_tx_callback_t)(void* context);
+
+/**
+ * @brief 循环DMA接收的读位置游标
+ * @note  循环DMA永不停止，BSP层只需记录上次处理到的位置，
+ * 每次HT/TC/IDLE事件时把 [上次位置, 当前DMA写位置) 之间的新数据交给上层。
+ */
+typedef struct {
+    uint32_t last_pos;      /**< 上次已交给上层的DMA缓冲区位置 */
+} uart_rx_dma_cursor_t;
 
 /**
  * @brief 定义了串口驱动所需的所有平台依赖项的API函数指针结构体。
@@ -26,10 +60,12 @@ typedef struct uart_api_s {
     /**
      * @brief 初始化串口的底层硬件 (GPIO, UART, DMA, 中断)。
      * @param[in] handle - 指向硬件相关句柄的void指针。
-     * @param[in] callback - 当接收到数据时，需要被调用的回调函数。
+     * @param[in] rx_callback - 当接收到数据时，需要被调用的回调函数。
+     * @param[in] tx_callback - 当一次DMA发送完成时，需要被调用的回调函数。
+     * @param[in] context     - 调用回调函数时原样传回的上下文指针，用于区分不同的串口实例。
      * @return led_status_t - 操作的状态码。
      */
-    led_status_t (*init)(void* handle, uart_rx_callback_t callback);
+    led_status_t (*init)(void* handle, uart_rx_callback_t rx_callback, uart_tx_callback_t tx_callback, void* context);
 
     /**
      * @brief 反初始化串口的底层硬件。
@@ -40,13 +76,14 @@ typedef struct uart_api_s {
 
     /**
      * @brief 通过DMA异步发送数据。
-     * @note  此函数会立即返回，发送过程在后台由DMA完成。
+     * @note  此函数会立即返回，发送过程在后台由DMA完成，完成后调用init时注册的tx_callback。
+     * 在完成回调到来之前，data指向的缓冲区必须保持有效。
      * @param[in] handle - 指向硬件相关句柄的指针。
      * @param[in] data   - 指向要发送的数据缓冲区的指针。
-     * @param[in] len    - 要发送的数据长度。
+     * @param[in] len    - 要发送的数据长度 (不超过UART_DMA_MAX_TRANSFER)。
      * @return led_status_t - 操作的状态码。
      */
-    led_status_t (*transmit_dma)(void* handle, const uint8_t* data, uint16_t len);
+    led_status_t (*transmit_dma)(void* handle, const uint8_t* data, uint32_t len);
     
     /**
      * @brief 获取系统时间戳 (单位: 毫秒)。
@@ -54,9 +91,57 @@ typedef struct uart_api_s {
      */
     uint32_t (*get_tick)(void);
 
+    /**
+     * @brief (可选) 让CPU进入低功耗等待，直到下一个中断到来。
+     * @note  供阻塞读取在等待数据时使用，可以为NULL (此时退化为忙等待)。
+     * 接收事件和系统节拍中断都会唤醒CPU，因此数据到达和超时都能被及时发现。
+     * @param[in] handle - 指向硬件相关句柄的指针。
+     */
+    void (*wait_for_event)(void* handle);
+
+    /**
+     * @brief (可选) 控制RTS流控线，用于接收方向的背压。
+     * @note  可以由硬件RTS引脚或普通GPIO模拟实现，可以为NULL (此时不支持流控)。
+     * 会在接收中断中被调用，实现必须足够快且可重入。
+     * @param[in] handle - 指向硬件相关句柄的指针。
+     * @param[in] ready  - 1: 有效RTS，允许对端发送；0: 撤销RTS，要求对端暂停发送。
+     * @return led_status_t - 操作的状态码。该端口没有RTS引脚时返回LED_STATUS_NOT_SUPPORTED。
+     */
+    led_status_t (*set_rts)(void* handle, uint8_t ready);
+
+    /**
+     * @brief (可选) 获取高分辨率时间戳，用于测量接收数据在缓冲区中的停留时间。
+     * @note  单位由平台决定 (例如CPU周期)，只要求单调递增、按32位回绕。
+     * 未提供时驱动使用get_tick (毫秒)。
+     * @return 当前时间戳。
+     */
+    uint32_t (*get_timestamp)(void);
+
 } uart_api_t;
 
 
+/**
+ * @brief  复位循环DMA接收游标 (重新启动DMA接收时调用)
+ * @param[in] cursor - 指向游标的指针
+ */
+void uart_rx_dma_cursor_reset(uart_rx_dma_cursor_t* cursor);
+
+/**
+ * @brief  根据DMA计数器推进游标，并把新到达的数据交给接收回调
+ * @note   这是一个与平台无关的辅助函数，供BSP层在HT/TC/IDLE中断中调用。
+ * 只要两次调用之间到达的数据不超过缓冲区的一半 (HT/TC中断保证了这一点)，就不会丢失数据。
+ * @param[in] cursor    - 指向游标的指针
+ * @param[in] buffer    - 循环DMA接收缓冲区
+ * @param[in] size      - 缓冲区大小
+ * @param[in] remaining - DMA计数器的当前值 (剩余传输数，即NDTR)
+ * @param[in] event     - 触发本次处理的事件类型
+ * @param[in] callback  - 接收回调
+ * @param[in] context   - 传给回调的上下文
+ */
+void uart_rx_dma_advance(uart_rx_dma_cursor_t* cursor, uint8_t* buffer, uint32_t size, uint32_t remaining,
+                         uart_rx_event_t event, uart_rx_callback_t callback, void* context);
+
+
 #ifdef __cplusplus
 }
 #endif
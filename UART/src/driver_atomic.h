@@ -0,0 +1,69 @@
+#ifndef __DRIVER_ATOMIC_H
+#define __DRIVER_ATOMIC_H
+
+#include <stdint.h>
+
+/**
+ * @brief 驱动层使用的最小原子操作集合。
+ * @note  环形缓冲区等在中断和主循环之间共享的数据，仅靠 volatile 只能阻止编译器缓存变量，
+ * 无法保证“先写数据、后发布索引”的顺序。这里统一封装 acquire/release 语义：
+ * - 生产者写完数据后用 RELEASE 存储发布索引；
+ * - 消费者用 ACQUIRE 读取索引后才能访问对应的数据。
+ * 在 Cortex-M 上，GCC/Clang 会为其生成必要的 DMB 指令。
+ */
+#if defined(__GNUC__) || defined(__clang__)
+
+#define DRIVER_LOAD_ACQUIRE(p)      __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define DRIVER_LOAD_RELAXED(p)      __atomic_load_n((p), __ATOMIC_RELAXED)
+#define DRIVER_STORE_RELEASE(p, v)  __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define DRIVER_STORE_RELAXED(p, v)  __atomic_store_n((p), (v), __ATOMIC_RELAXED)
+#define DRIVER_STORE_SEQ_CST(p, v)  __atomic_store_n((p), (v), __ATOMIC_SEQ_CST)
+
+/**
+ * @brief  比较并交换：如果*p等于expected，则写入desired
+ * @return uint8_t - 交换成功返回1，否则返回0
+ */
+static inline uint8_t driver_atomic_cas(uint32_t* p, uint32_t expected, uint32_t desired) {
+    return __atomic_compare_exchange_n(p, &expected, desired, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST) ? 1 : 0;
+}
+
+/**
+ * @brief  原子加法
+ * @return uint32_t - 相加之前的值
+ */
+static inline uint32_t driver_atomic_fetch_add(uint32_t* p, uint32_t value) {
+    return __atomic_fetch_add(p, value, __ATOMIC_SEQ_CST);
+}
+
+#else
+
+// 其他编译器 (如ARMCC5) 的退化实现：单核Cortex-M上对齐的32位访问本身是原子的，
+// 这里只依靠 volatile 访问保证不被编译器合并或重排。
+#define DRIVER_LOAD_ACQUIRE(p)      (*(volatile __typeof__(*(p))*)(p))
+#define DRIVER_LOAD_RELAXED(p)      (*(volatile __typeof__(*(p))*)(p))
+#define DRIVER_STORE_RELEASE(p, v)  (*(volatile __typeof__(*(p))*)(p) = (v))
+#define DRIVER_STORE_RELAXED(p, v)  (*(volatile __typeof__(*(p))*)(p) = (v))
+#define DRIVER_STORE_SEQ_CST(p, v)  (*(volatile __typeof__(*(p))*)(p) = (v))
+
+// 使用ARMCC的LDREX/STREX内建函数实现比较并交换
+static __inline uint8_t driver_atomic_cas(uint32_t* p, uint32_t expected, uint32_t desired) {
+    do {
+        if (__ldrex(p) != expected) {
+            __clrex();
+            return 0;
+        }
+    } while (__strex(desired, p) != 0);
+    return 1;
+}
+
+static __inline uint32_t driver_atomic_fetch_add(uint32_t* p, uint32_t value) {
+    uint32_t old;
+    do {
+        old = __ldrex(p);
+    } while (__strex(old + value, p) != 0);
+    return old;
+}
+
+#endif
+
+#endif // __DRIVER_ATOMIC_H
@@ -0,0 +1,254 @@
+#include "driver_ringbuf.h"
+
+#include <string.h> // For memcpy
+#include "driver_atomic.h"
+
+led_status_t ringbuf_init(ringbuf_t* rb, uint8_t* buffer, uint32_t size) {
+    if (rb == NULL || buffer == NULL || size == 0) {
+        return LED_STATUS_INV_ARG;
+    }
+    // 容量必须是2的幂，这样才能用掩码代替取模
+    if ((size & (size - 1)) != 0) {
+        return LED_STATUS_INV_ARG;
+    }
+
+    rb->buffer = buffer;
+    rb->size = size;
+    rb->mask = size - 1;
+    rb->head = 0;
+    rb->tail = 0;
+    return LED_STATUS_OK;
+}
+
+void ringbuf_reset(ringbuf_t* rb) {
+    if (rb == NULL) {
+        return;
+    }
+    DRIVER_STORE_RELAXED(&rb->head, 0);
+    DRIVER_STORE_RELAXED(&rb->tail, 0);
+}
+
+uint32_t ringbuf_push(ringbuf_t* rb, const uint8_t* data, uint32_t len) {
+    if (rb == NULL || data == NULL || len == 0) {
+        return 0;
+    }
+
+    // head只有生产者自己写，可以直接读取；tail需要acquire，确保消费者已经读完了这部分空间
+    uint32_t head = DRIVER_LOAD_RELAXED(&rb->head);
+    uint32_t tail = DRIVER_LOAD_ACQUIRE(&rb->tail);
+    uint32_t space = rb->size - (head - tail);
+    if (len > space) {
+        len = space;
+    }
+    if (len == 0) {
+        return 0;
+    }
+
+    // 最多两段拷贝：[offset, size) 和 [0, 剩余)
+    uint32_t offset = head & rb->mask;
+    uint32_t first = rb->size - offset;
+    if (first > len) {
+        first = len;
+    }
+    memcpy(&rb->buffer[offset], data, first);
+    if (len > first) {
+        memcpy(rb->buffer, data + first, len - first);
+    }
+
+    // 数据写完之后再发布新的head
+    DRIVER_STORE_RELEASE(&rb->head, head + len);
+    return len;
+}
+
+uint8_t ringbuf_reserve(ringbuf_t* rb, uint32_t len, ringbuf_span_t spans[2]) {
+    if (rb == NULL || spans == NULL) {
+        return 0;
+    }
+
+    uint32_t head = DRIVER_LOAD_RELAXED(&rb->head);
+    uint32_t tail = DRIVER_LOAD_ACQUIRE(&rb->tail);
+    if (len > rb->size - (head - tail)) {
+        return 0;
+    }
+
+    uint32_t offset = head & rb->mask;
+    uint32_t first = rb->size - offset;
+    if (first > len) {
+        first = len;
+    }
+    spans[0].data = &rb->buffer[offset];
+    spans[0].len = first;
+    spans[1].data = rb->buffer;
+    spans[1].len = len - first;
+    return 1;
+}
+
+void ringbuf_commit(ringbuf_t* rb, uint32_t len) {
+    if (rb == NULL) {
+        return;
+    }
+    // 填充数据必须在发布head之前完成
+    uint32_t head = DRIVER_LOAD_RELAXED(&rb->head);
+    DRIVER_STORE_RELEASE(&rb->head, head + len);
+}
+
+uint32_t ringbuf_pop(ringbuf_t* rb, uint8_t* data, uint32_t len) {
+    if (rb == NULL || data == NULL || len == 0) {
+        return 0;
+    }
+
+    // head需要acquire，确保能看到生产者在发布head之前写入的数据
+    uint32_t tail = DRIVER_LOAD_RELAXED(&rb->tail);
+    uint32_t head = DRIVER_LOAD_ACQUIRE(&rb->head);
+    uint32_t used = head - tail;
+    if (len > used) {
+        len = used;
+    }
+    if (len == 0) {
+        return 0;
+    }
+
+    uint32_t offset = tail & rb->mask;
+    uint32_t first = rb->size - offset;
+    if (first > len) {
+        first = len;
+    }
+    memcpy(data, &rb->buffer[offset], first);
+    if (len > first) {
+        memcpy(data + first, rb->buffer, len - first);
+    }
+
+    // 数据读完之后再释放空间
+    DRIVER_STORE_RELEASE(&rb->tail, tail + len);
+    return len;
+}
+
+uint32_t ringbuf_peek(const ringbuf_t* rb, ringbuf_span_t spans[2]) {
+    if (rb == NULL || spans == NULL) {
+        return 0;
+    }
+
+    uint32_t tail = DRIVER_LOAD_RELAXED(&rb->tail);
+    uint32_t head = DRIVER_LOAD_ACQUIRE(&rb->head);
+    uint32_t used = head - tail;
+
+    uint32_t offset = tail & rb->mask;
+    uint32_t first = rb->size - offset;
+    if (first > used) {
+        first = used;
+    }
+    spans[0].data = &rb->buffer[offset];
+    spans[0].len = first;
+    spans[1].data = rb->buffer;
+    spans[1].len = used - first;
+    return used;
+}
+
+uint32_t ringbuf_consume(ringbuf_t* rb, uint32_t len) {
+    if (rb == NULL) {
+        return 0;
+    }
+
+    uint32_t tail = DRIVER_LOAD_RELAXED(&rb->tail);
+    uint32_t head = DRIVER_LOAD_ACQUIRE(&rb->head);
+    uint32_t used = head - tail;
+    if (len > used) {
+        len = used;
+    }
+
+    // 调用者对数据的访问必须在释放空间之前完成
+    DRIVER_STORE_RELEASE(&rb->tail, tail + len);
+    return len;
+}
+
+/**
+ * @brief 内部函数：在一段连续内存中查找指定字节 (SWAR，一次比较4个字节)
+ * @note  对于字 w，令 x = w ^ (value * 0x01010101)，则目标字节在 x 中变为 0x00；
+ * (x - 0x01010101) & ~x & 0x80808080 非零，当且仅当 x 中存在为0的字节。
+ * @return 找到时返回该字节的下标，否则返回len
+ */
+static uint32_t scan_byte(const uint8_t* data, uint32_t len, uint8_t value) {
+    uint32_t i = 0;
+
+    // 逐字节处理到4字节对齐
+    while (i < len && (((uintptr_t)&data[i]) & 3u) != 0) {
+        if (data[i] == value) {
+            return i;
+        }
+        i++;
+    }
+
+    // 按字并行比较
+    const uint32_t pattern = 0x01010101u * value;
+    while (i + 4 <= len) {
+        uint32_t word;
+        memcpy(&word, &data[i], sizeof(word)); // 已对齐，会被编译为单条LDR
+        uint32_t x = word ^ pattern;
+        if (((x - 0x01010101u) & ~x & 0x80808080u) != 0) {
+            break; // 目标字节就在这个字里，交给下面的逐字节循环定位
+        }
+        i += 4;
+    }
+
+    // 剩余字节 (以及命中的那个字)
+    while (i < len) {
+        if (data[i] == value) {
+            return i;
+        }
+        i++;
+    }
+    return len;
+}
+
+uint8_t ringbuf_find(const ringbuf_t* rb, uint8_t value, uint32_t start, uint32_t* offset, uint32_t* scanned) {
+    if (rb == NULL || offset == NULL) {
+        return 0;
+    }
+
+    // 只查找快照中的数据，未找到时报告的已查找长度也以快照为准
+    ringbuf_span_t spans[2];
+    uint32_t used = ringbuf_peek(rb, spans);
+    if (scanned != NULL) {
+        *scanned = (start > used) ? start : used;
+    }
+    if (start >= used) {
+        return 0;
+    }
+
+    // 第一段
+    if (start < spans[0].len) {
+        uint32_t n = spans[0].len - start;
+        uint32_t pos = scan_byte(spans[0].data + start, n, value);
+        if (pos < n) {
+            *offset = start + pos;
+            return 1;
+        }
+        start = spans[0].len;
+    }
+
+    // 回绕后的第二段
+    uint32_t skip = start - spans[0].len;
+    uint32_t n = spans[1].len - skip;
+    uint32_t pos = scan_byte(spans[1].data + skip, n, value);
+    if (pos < n) {
+        *offset = start + pos;
+        return 1;
+    }
+    return 0;
+}
+
+uint32_t ringbuf_used(const ringbuf_t* rb) {
+    if (rb == NULL) {
+        return 0;
+    }
+    uint32_t tail = DRIVER_LOAD_ACQUIRE(&rb->tail);
+    uint32_t head = DRIVER_LOAD_ACQUIRE(&rb->head);
+    return head - tail;
+}
+
+uint32_t ringbuf_free(const ringbuf_t* rb) {
+    if (rb == NULL) {
+        return 0;
+    }
+    return rb->size - ringbuf_used(rb);
+}
@@ -0,0 +1,132 @@
+#ifndef __DRIVER_RINGBUF_H
+#define __DRIVER_RINGBUF_H
+
+#include "driver_led_interface.h" // 复用led_status_t等定义
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 单生产者/单消费者 (SPSC) 无锁字节环形缓冲区
+ * @note  - 容量必须是2的幂，下标通过掩码计算，避免了逐字节的取模运算。
+ * - head/tail 是自由增长的32位计数器，已用字节数 = head - tail，
+ *   因此整个缓冲区都可以被使用 (无需保留一个空位来区分空和满)。
+ * - head 只由生产者写入 (通常是中断/DMA回调)，tail 只由消费者写入 (通常是应用层)。
+ * - 每次 push/pop 最多拆成两段 memcpy (缓冲区末尾一段 + 开头一段)。
+ */
+typedef struct {
+    uint8_t* buffer;        /**< 指向数据存储区的指针 */
+    uint32_t size;          /**< 缓冲区容量 (2的幂) */
+    uint32_t mask;          /**< 下标掩码 (size - 1) */
+    uint32_t head;          /**< 写计数器 (仅由生产者更新) */
+    uint32_t tail;          /**< 读计数器 (仅由消费者更新) */
+} ringbuf_t;
+
+/**
+ * @brief 描述环形缓冲区中一段连续内存的结构体
+ */
+typedef struct {
+    uint8_t* data;          /**< 指向该段起始位置的指针 */
+    uint32_t len;           /**< 该段的长度 */
+} ringbuf_span_t;
+
+/**
+ * @brief  初始化一个环形缓冲区
+ * @param[in] rb     - 指向ringbuf_t对象的指针
+ * @param[in] buffer - 数据存储区
+ * @param[in] size   - 存储区大小，必须是2的幂
+ * @return led_status_t - 如果size不是2的幂，返回LED_STATUS_INV_ARG
+ */
+led_status_t ringbuf_init(ringbuf_t* rb, uint8_t* buffer, uint32_t size);
+
+/**
+ * @brief  清空环形缓冲区
+ * @note   只能在生产者和消费者都停止时调用。
+ * @param[in] rb - 指向ringbuf_t对象的指针
+ */
+void ringbuf_reset(ringbuf_t* rb);
+
+/**
+ * @brief  (生产者) 写入数据，空间不足时只写入能容纳的部分
+ * @param[in] rb   - 指向ringbuf_t对象的指针
+ * @param[in] data - 要写入的数据
+ * @param[in] len  - 要写入的长度
+ * @return uint32_t - 实际写入的字节数
+ */
+uint32_t ringbuf_push(ringbuf_t* rb, const uint8_t* data, uint32_t len);
+
+/**
+ * @brief  (生产者) 预留一段可写空间，用于原地生成数据 (零拷贝写入)
+ * @note   预留的空间最多分为两段连续内存。填充完成后调用ringbuf_commit发布，
+ * 在发布之前消费者看不到这些数据。
+ * @param[in]  rb    - 指向ringbuf_t对象的指针
+ * @param[in]  len   - 需要预留的长度
+ * @param[out] spans - 两个元素的数组，用于返回预留的空间；未使用的段长度为0
+ * @return uint8_t - 空间足够返回1，否则返回0且不预留任何空间
+ */
+uint8_t ringbuf_reserve(ringbuf_t* rb, uint32_t len, ringbuf_span_t spans[2]);
+
+/**
+ * @brief  (生产者) 发布之前预留并已填充的数据
+ * @param[in] rb  - 指向ringbuf_t对象的指针
+ * @param[in] len - 实际填充的长度 (不能超过预留的长度)
+ */
+void ringbuf_commit(ringbuf_t* rb, uint32_t len);
+
+/**
+ * @brief  (消费者) 读出数据
+ * @param[in]  rb   - 指向ringbuf_t对象的指针
+ * @param[out] data - 存放数据的缓冲区
+ * @param[in]  len  - 期望读取的长度
+ * @return uint32_t - 实际读取的字节数
+ */
+uint32_t ringbuf_pop(ringbuf_t* rb, uint8_t* data, uint32_t len);
+
+/**
+ * @brief  (消费者) 零拷贝查看可读数据，不移动读指针
+ * @note   可读数据在缓冲区中最多分为两段连续内存 (回绕前的一段 + 回绕后的一段)。
+ * 调用者处理完之后，需要调用ringbuf_consume释放已处理的数据。
+ * @param[in]  rb    - 指向ringbuf_t对象的指针
+ * @param[out] spans - 两个元素的数组，用于返回两段数据；未使用的段长度为0
+ * @return uint32_t - 可读数据的总长度
+ */
+uint32_t ringbuf_peek(const ringbuf_t* rb, ringbuf_span_t spans[2]);
+
+/**
+ * @brief  (消费者) 释放已处理的数据，移动读指针
+ * @param[in] rb  - 指向ringbuf_t对象的指针
+ * @param[in] len - 要释放的长度 (超过可读长度时按可读长度处理)
+ * @return uint32_t - 实际释放的字节数
+ */
+uint32_t ringbuf_consume(ringbuf_t* rb, uint32_t len);
+
+/**
+ * @brief  (消费者) 在可读数据中查找指定字节，不移动读指针
+ * @note   直接在缓冲区内部查找 (跨越回绕处)，按字(32位)并行比较，每次处理4个字节。
+ * @param[in]  rb     - 指向ringbuf_t对象的指针
+ * @param[in]  value  - 要查找的字节
+ * @param[in]  start  - 从距离读指针多少字节处开始查找 (跳过已经查找过的部分)
+ * @param[out] offset - 找到时，返回该字节距离读指针的偏移
+ * @param[out] scanned - 可选 (可为NULL)：未找到时，返回已经查找过的长度 (距离读指针)。
+ *                      查找期间生产者新写入的数据不包括在内，下次应从这里继续查找
+ * @return uint8_t - 找到返回1，否则返回0
+ */
+uint8_t ringbuf_find(const ringbuf_t* rb, uint8_t value, uint32_t start, uint32_t* offset, uint32_t* scanned);
+
+/**
+ * @brief  (消费者) 获取当前可读的字节数
+ */
+uint32_t ringbuf_used(const ringbuf_t* rb);
+
+/**
+ * @brief  (生产者) 获取当前剩余的可写空间
+ */
+uint32_t ringbuf_free(const ringbuf_t* rb);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __DRIVER_RINGBUF_H
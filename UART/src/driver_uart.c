@@ -1,41 +1,359 @@
 #include "driver_uart.h"
 
 #include <string.h> // For memcpy
+#include "driver_atomic.h"
+#if UART_ENABLE_RX_TIMESTAMP
+#include <stdio.h>  // For snprintf
+#endif
+
+// 统计计数器只在中断上下文中累加，关闭UART_ENABLE_STATS后这些语句会被完全移除
+#if UART_ENABLE_STATS
+#define UART_STATS_ADD(uart, field, n) ((uart)->stats.field += (n))
+#else
+#define UART_STATS_ADD(uart, field, n) ((void)0)
+#endif
 
 /**
  * @brief 内部中断回调函数
- * @note  这个函数是传递给BSP层的，当硬件通过DMA+IDLE接收到数据时，它被调用。
+ * @note  这个函数是传递给BSP层的，当循环DMA产生HT/TC/IDLE事件并有新数据时，它被调用。
  * 它的职责是将接收到的数据块安全地写入环形缓冲区。
  */
-static void internal_rx_callback(void* handle, uint8_t* data, uint16_t len) {
-    // 在BSP的实现中，handle总是指向bsp_uart_handle_t，但我们的驱动对象需要它
-    // 为了解耦，我们这里假设只有一个uart实例，或者需要一个更复杂的机制来查找uart对象
-    // 在测试层，我们会确保只有一个实例。
-    extern uart_t g_uart1; // 假设在测试层有一个全局的uart对象
-    uart_t* uart = &g_uart1;
+static void internal_rx_callback(void* context, uint8_t* data, uint32_t len, uart_rx_event_t event) {
+    // context是uart_init时注册给BSP层的驱动对象自身，因此每个串口实例都能找到自己的缓冲区
+    uart_t* uart = (uart_t*)context;
+    if (uart == NULL) {
+        return;
+    }
 
-    if (uart == NULL || data == NULL || len == 0) {
+    switch (event) {
+        case UART_RX_EVENT_IDLE:     UART_STATS_ADD(uart, rx_idle_events, 1);     break;
+        case UART_RX_EVENT_HALF:     UART_STATS_ADD(uart, rx_half_events, 1);     break;
+        case UART_RX_EVENT_COMPLETE: UART_STATS_ADD(uart, rx_complete_events, 1); break;
+        case UART_RX_EVENT_DATA:
+        default:
+            break;
+    }
+
+    if (data != NULL && len > 0) {
+#if UART_ENABLE_RX_TIMESTAMP
+        uint32_t stamp = uart->rx_clock();
+        uint32_t pos = uart->rx_ring.head;
+#endif
+        // 将数据整块写入环形缓冲区 (最多两段memcpy)
+        // 缓冲区已满时，放不下的数据会被丢弃，并计入丢弃统计
+        uint32_t pushed = ringbuf_push(&uart->rx_ring, data, len);
+#if UART_ENABLE_RX_TIMESTAMP
+        // 为这个数据块记录时间戳；记录已满时不记录，这些数据归入前一个数据块
+        uint32_t stamp_head = uart->rx_stamp_head;
+        if (pushed > 0 && stamp_head - DRIVER_LOAD_ACQUIRE(&uart->rx_stamp_tail) < UART_RX_STAMP_DEPTH) {
+            uart_rx_stamp_t* entry = &uart->rx_stamps[stamp_head & (UART_RX_STAMP_DEPTH - 1)];
+            entry->pos = pos;
+            entry->stamp = stamp;
+            DRIVER_STORE_RELEASE(&uart->rx_stamp_head, stamp_head + 1);
+        }
+#endif
+        uart->rx_event_len += pushed;
+        UART_STATS_ADD(uart, rx_bytes, pushed);
+        if (pushed < len) {
+            UART_STATS_ADD(uart, rx_dropped, len - pushed);
+            UART_STATS_ADD(uart, rx_overflows, 1);
+        }
+
+        uint32_t used = ringbuf_used(&uart->rx_ring);
+#if UART_ENABLE_STATS
+        // 应用层请求过清零：高水位从清零时的占用重新统计
+        uint32_t reset = DRIVER_LOAD_ACQUIRE(&uart->rx_high_water_reset);
+        if (reset != uart->rx_high_water_ack) {
+            uart->stats.rx_high_water = uart->rx_high_water_floor;
+            DRIVER_STORE_RELEASE(&uart->rx_high_water_ack, reset);
+        }
+        if (used > uart->stats.rx_high_water) {
+            uart->stats.rx_high_water = used;
+        }
+#endif
+
+        // 达到高水位：撤销RTS，让对端在缓冲区溢出之前暂停发送
+        if (uart->rts_high != 0 && used >= uart->rts_high && DRIVER_LOAD_RELAXED(&uart->rts_paused) == 0) {
+            DRIVER_STORE_SEQ_CST(&uart->rts_paused, 1);
+            (void)uart->api->set_rts(uart->handle, 0);
+            UART_STATS_ADD(uart, rx_flow_pauses, 1);
+        }
+    }
+
+    // 一个硬件事件可能分几次回调 (数据跨越DMA缓冲区末尾)，在最后一次回调时统一通知。
+    // 数据恰好在HT/TC处结束时，随后的IDLE没有新数据，但它仍是这批数据的结束标志，同样通知
+    if (event != UART_RX_EVENT_DATA) {
+        uint32_t event_len = uart->rx_event_len;
+        uint8_t notify = (event_len > 0);
+        if (event == UART_RX_EVENT_IDLE) {
+            notify = notify || uart->rx_burst_open;
+            uart->rx_burst_open = 0;
+        } else if (event_len > 0) {
+            uart->rx_burst_open = 1;
+        }
+        uart->rx_event_len = 0;
+        if (notify && uart->on_rx_event) {
+            uart->on_rx_event(uart, event, event_len, uart->rx_user_data);
+        }
+    }
+}
+
+/**
+ * @brief 内部函数：应用层取走数据后，如果占用已回落到低水位，重新有效RTS
+ * @note  rts_paused由接收中断置位、由这里清零。清零并有效RTS之后再检查一次：
+ * 如果接收中断恰好在这之间又撤销了RTS，就再撤销一次，保证线路状态与rts_paused一致。
+ */
+static void rx_flow_release(uart_t* uart) {
+    if (uart->rts_high == 0 || DRIVER_LOAD_ACQUIRE(&uart->rts_paused) == 0) {
+        return;
+    }
+    if (ringbuf_used(&uart->rx_ring) > uart->rts_low) {
+        return;
+    }
+    if (!driver_atomic_cas(&uart->rts_paused, 1, 0)) {
         return;
+    }
+    (void)uart->api->set_rts(uart->handle, 1);
+    if (DRIVER_LOAD_ACQUIRE(&uart->rts_paused) != 0) {
+        (void)uart->api->set_rts(uart->handle, 0);
+    }
+}
 
+#if UART_ENABLE_RX_TIMESTAMP
+/**
+ * @brief 内部函数：把一次延迟计入直方图
+ */
+static void rx_latency_record(uart_rx_latency_t* latency, uint32_t value) {
+    uint32_t bin = 0;
+    while (value >> bin) {
+        bin++;
     }
+    if (bin >= UART_RX_LATENCY_BINS) {
+        bin = UART_RX_LATENCY_BINS - 1;
+    }
+    latency->bins[bin]++;
+    latency->count++;
+    if (value > latency->max) {
+        latency->max = value;
+    }
+}
+
+/**
+ * @brief 内部函数：应用层取走数据后，更新时间戳记录
+ * @note  第一个字节已被读走的数据块计入延迟直方图；下一个数据块的第一个字节也已被读走时，
+ * 说明这个数据块已经读完，释放它的记录。最新的一条记录总是保留，直到后面有新的数据块。
+ */
+static void rx_stamp_update(uart_t* uart) {
+    uint32_t tail = uart->rx_ring.tail;
+    uint32_t head = DRIVER_LOAD_ACQUIRE(&uart->rx_stamp_head);
+    uint32_t now = uart->rx_clock();
 
-    // 将数据写入环形缓冲区
-    for (uint16_t i = 0; i < len; ++i) {
-        uint16_t next_head = (uart->head + 1) % uart->rx_buffer_size;
-        // 检查缓冲区是否已满 (写指针追上读指针)
-        if (next_head == uart->tail) {
-            // 缓冲区已满，丢弃后续数据。在实际产品中，这里可以设置一个溢出标志位。
+    while (uart->rx_stamp_next != head) {
+        const uart_rx_stamp_t* entry = &uart->rx_stamps[uart->rx_stamp_next & (UART_RX_STAMP_DEPTH - 1)];
+        if ((int32_t)(tail - entry->pos) <= 0) {
             break;
         }
-        uart->rx_buffer[uart->head] = data[i];
-        uart->head = next_head;
+        rx_latency_record(&uart->rx_latency, now - entry->stamp);
+        uart->rx_stamp_next++;
+    }
+
+    uint32_t stamp_tail = uart->rx_stamp_tail;
+    while (head - stamp_tail >= 2 &&
+           (int32_t)(tail - uart->rx_stamps[(stamp_tail + 1) & (UART_RX_STAMP_DEPTH - 1)].pos) >= 0) {
+        stamp_tail++;
+    }
+    DRIVER_STORE_RELEASE(&uart->rx_stamp_tail, stamp_tail);
+}
+#endif
+
+/**
+ * @brief 内部函数：应用层从接收缓冲区取走数据之后调用
+ */
+static void rx_consumed(uart_t* uart) {
+#if UART_ENABLE_RX_TIMESTAMP
+    rx_stamp_update(uart);
+#endif
+    rx_flow_release(uart);
+}
+
+/**
+ * @brief 内部函数：从发送队列中取出下一段连续数据并启动DMA
+ * @note  调用者必须已经持有tx_busy。如果队列为空，则释放tx_busy；
+ * 释放之后会再检查一次队列，以免错过在“检查为空”和“释放”之间写入的数据。
+ * @return uint8_t - 成功启动了新的DMA发送返回1
+ */
+static uint8_t tx_start_next(uart_t* uart) {
+    for (;;) {
+        uart_span_t spans[2];
+        (void)ringbuf_peek(&uart->tx_ring, spans);
+
+        // 只发送连续的第一段，回绕后的第二段由下一次完成中断接续
+        uint32_t len = spans[0].len;
+        if (len > UART_DMA_MAX_TRANSFER) {
+            len = UART_DMA_MAX_TRANSFER;
+        }
+        if (len > 0) {
+            uart->tx_in_flight = len;
+            if (uart->api->transmit_dma(uart->handle, spans[0].data, len) == LED_STATUS_OK) {
+                return 1;
+            }
+            // 硬件拒绝了本次发送 (例如被其他代码占用)，数据保留在队列中，等待下一次写入时重试
+            uart->tx_in_flight = 0;
+            DRIVER_STORE_SEQ_CST(&uart->tx_busy, 0);
+            return 0;
+        }
+
+        DRIVER_STORE_SEQ_CST(&uart->tx_busy, 0);
+        if (ringbuf_used(&uart->tx_ring) == 0 || !driver_atomic_cas(&uart->tx_busy, 0, 1)) {
+            return 0;
+        }
+    }
+}
+
+/**
+ * @brief 内部函数：如果DMA空闲，就启动发送
+ */
+static void tx_kick(uart_t* uart) {
+    if (driver_atomic_cas(&uart->tx_busy, 0, 1)) {
+        (void)tx_start_next(uart);
+    }
+}
+
+/**
+ * @brief 内部函数：新数据写入发送队列之后调用，决定是立即发送还是继续合并
+ * @note  未启用合并时直接启动发送。启用合并时，待发送数据达到阈值才启动DMA，
+ * 否则从第一个未发送的字节开始计时，由uart_process在超时后发出。
+ * DMA正在发送时，完成中断会把期间积累的数据一次接续发出，这本身也是一种合并。
+ */
+static void tx_submit(uart_t* uart) {
+    if (uart->tx_coalesce_threshold != 0 && ringbuf_used(&uart->tx_ring) < uart->tx_coalesce_threshold) {
+        // 多个生产者可能同时开始计时，谁写入的时间戳都可以，误差不超过一个节拍
+        if (!DRIVER_LOAD_RELAXED(&uart->tx_deadline_armed)) {
+            DRIVER_STORE_RELAXED(&uart->tx_deadline_start, uart->api->get_tick());
+            DRIVER_STORE_RELEASE(&uart->tx_deadline_armed, 1);
+        }
+        return;
+    }
+    DRIVER_STORE_RELAXED(&uart->tx_deadline_armed, 0);
+    tx_kick(uart);
+}
+
+/**
+ * @brief 内部函数：(多生产者) 在发送队列中预留len字节
+ * @note  用CAS推进预留位置，成功的一方独占[pos, pos+len)，可以在任意上下文 (包括中断) 中调用。
+ * 先读tail再读预留位置：tail可能已过时 (偏小)，只会让剩余空间算得偏小，不会越界。
+ * @return uint8_t - 空间不足时不预留，返回0
+ */
+static uint8_t tx_reserve(uart_t* uart, uint32_t len, uint32_t* pos) {
+    for (;;) {
+        uint32_t tail = DRIVER_LOAD_ACQUIRE(&uart->tx_ring.tail);
+        uint32_t reserved = DRIVER_LOAD_ACQUIRE(&uart->tx_reserved);
+        if (uart->tx_ring.size - (reserved - tail) < len) {
+            return 0;
+        }
+        if (driver_atomic_cas(&uart->tx_reserved, reserved, reserved + len)) {
+            *pos = reserved;
+            return 1;
+        }
     }
 }
 
-led_status_t uart_init(uart_t* uart, const uart_api_t* api, void* handle, uint8_t* rx_buffer, uint16_t rx_buffer_size) {
+/**
+ * @brief 内部函数：把预留位置pos开始的len字节描述为最多两段连续内存
+ */
+static void tx_spans(uart_t* uart, uint32_t pos, uint32_t len, uart_span_t spans[2]) {
+    uint32_t offset = pos & uart->tx_ring.mask;
+    uint32_t first = uart->tx_ring.size - offset;
+    if (first > len) {
+        first = len;
+    }
+    spans[0].data = &uart->tx_ring.buffer[offset];
+    spans[0].len = first;
+    spans[1].data = uart->tx_ring.buffer;
+    spans[1].len = len - first;
+}
+
+/**
+ * @brief 内部函数：把数据拷贝到预留位置，返回下一个位置
+ */
+static uint32_t tx_fill(uart_t* uart, uint32_t pos, const uint8_t* data, uint32_t len) {
+    uart_span_t spans[2];
+    tx_spans(uart, pos, len, spans);
+    memcpy(spans[0].data, data, spans[0].len);
+    memcpy(spans[1].data, data + spans[0].len, spans[1].len);
+    return pos + len;
+}
+
+/**
+ * @brief 内部函数：(多生产者) 提交已填充的len字节，并尝试发布给DMA
+ * @note  各生产者的填充可能乱序完成，因此不能各自发布。每个生产者提交时累加已填充总数，
+ * 如果累加后恰好等于预留位置，说明此刻之前预留的空间都已填充完毕，就把它整体发布 (推进head)。
+ * 否则还有生产者在填充，由最后一个完成提交的生产者发布。
+ * 中断打断主循环的写入时，中断写入的数据要等主循环提交后才一起发出，但不会错乱或丢失。
+ */
+static void tx_commit(uart_t* uart, uint32_t len) {
+    uint32_t committed = driver_atomic_fetch_add(&uart->tx_committed, len) + len;
+    if (committed == DRIVER_LOAD_ACQUIRE(&uart->tx_reserved)) {
+        // 多个提交者可能先后发布不同的值，只允许head向前推进
+        for (;;) {
+            uint32_t head = DRIVER_LOAD_ACQUIRE(&uart->tx_ring.head);
+            if ((int32_t)(committed - head) <= 0 || driver_atomic_cas(&uart->tx_ring.head, head, committed)) {
+                break;
+            }
+        }
+    }
+    tx_submit(uart);
+}
+
+/**
+ * @brief 内部函数：整体写入一段数据，空间不足时不写入
+ */
+static uint8_t tx_write(uart_t* uart, const uint8_t* data, uint32_t len) {
+    uint32_t pos;
+    if (!tx_reserve(uart, len, &pos)) {
+        return 0;
+    }
+    (void)tx_fill(uart, pos, data, len);
+    tx_commit(uart, len);
+    return 1;
+}
+
+/**
+ * @brief 内部发送完成回调函数
+ * @note  这个函数是传递给BSP层的，在DMA发送完成中断中被调用。
+ * 它释放已发送的数据，并立即接续发送队列中的剩余数据，整个过程无需应用层参与。
+ */
+static void internal_tx_callback(void* context) {
+    uart_t* uart = (uart_t*)context;
+    if (uart == NULL) {
+        return;
+    }
+
+    uint32_t sent = uart->tx_in_flight;
+    uart->tx_in_flight = 0;
+    (void)ringbuf_consume(&uart->tx_ring, sent);
+    UART_STATS_ADD(uart, tx_bytes, sent);
+
+    if (uart->on_tx_event) {
+        uart->on_tx_event(uart, UART_TX_EVENT_COMPLETE, sent, uart->tx_user_data);
+    }
+
+    // 此时仍持有tx_busy，直接接续下一段
+    if (!tx_start_next(uart) && ringbuf_used(&uart->tx_ring) == 0) {
+        if (uart->on_tx_event) {
+            uart->on_tx_event(uart, UART_TX_EVENT_FLUSHED, 0, uart->tx_user_data);
+        }
+    }
+}
+
+led_status_t uart_init(uart_t* uart, const uart_api_t* api, void* handle, uint8_t* rx_buffer, uint32_t rx_buffer_size,
+                       uint8_t* tx_buffer, uint32_t tx_buffer_size) {
     if (uart == NULL || api == NULL || handle == NULL || rx_buffer == NULL || rx_buffer_size == 0) {
         return LED_STATUS_INV_ARG;
     }
+    if (tx_buffer == NULL || tx_buffer_size == 0) {
+        return LED_STATUS_INV_ARG;
+    }
     if (api->init == NULL || api->transmit_dma == NULL || api->get_tick == NULL) {
         return LED_STATUS_INV_ARG;
     }
@@ -44,13 +362,49 @@ led_status_t uart_init(uart_t* uart, const uart_api_t* api, void* handle, uint8_
     uart->api = api;
     
     uart->handle = handle;
-    uart->rx_buffer = rx_buffer;
-    uart->rx_buffer_size = rx_buffer_size;
-    uart->head = 0;
-    uart->tail = 0;
+    if (ringbuf_init(&uart->rx_ring, rx_buffer, rx_buffer_size) != LED_STATUS_OK) {
+        return LED_STATUS_INV_ARG;
+    }
+    if (ringbuf_init(&uart->tx_ring, tx_buffer, tx_buffer_size) != LED_STATUS_OK) {
+        return LED_STATUS_INV_ARG;
+    }
+    uart->rx_scan_pos = 0;
+    uart->rx_scan_delim = 0;
+    uart->on_rx_event = NULL;
+    uart->rx_user_data = NULL;
+    uart->rx_event_len = 0;
+    uart->rx_burst_open = 0;
+    uart->rts_high = 0;
+    uart->rts_low = 0;
+    uart->rts_paused = 0;
+#if UART_ENABLE_RX_TIMESTAMP
+    uart->rx_clock = (api->get_timestamp != NULL) ? api->get_timestamp : api->get_tick;
+    uart->rx_stamp_head = 0;
+    uart->rx_stamp_tail = 0;
+    uart->rx_stamp_next = 0;
+    memset(&uart->rx_latency, 0, sizeof(uart->rx_latency));
+#endif
+    uart->tx_reserved = 0;
+    uart->tx_committed = 0;
+    uart->tx_busy = 0;
+    uart->tx_in_flight = 0;
+    uart->tx_coalesce_threshold = 0;
+    uart->tx_coalesce_timeout = 0;
+    uart->tx_deadline_start = 0;
+    uart->tx_deadline_armed = 0;
+    uart->on_tx_event = NULL;
+    uart->tx_user_data = NULL;
+#if UART_ENABLE_STATS
+    memset(&uart->stats, 0, sizeof(uart->stats));
+    memset(&uart->stats_base, 0, sizeof(uart->stats_base));
+    uart->rx_high_water_floor = 0;
+    uart->rx_high_water_reset = 0;
+    uart->rx_high_water_ack = 0;
+#endif
 
     // 调用底层API初始化硬件，并将内部回调函数注册进去
-    return uart->api->init(uart->handle, internal_rx_callback);
+    // 注意：这里传递的上下文是uart_t对象自身，而不是硬件句柄
+    return uart->api->init(uart->handle, internal_rx_callback, internal_tx_callback, uart);
 }
 
 led_status_t uart_deinit(uart_t* uart) {
@@ -60,37 +414,480 @@ led_status_t uart_deinit(uart_t* uart) {
     return uart->api->deinit(uart->handle);
 }
 
-uint16_t uart_read(uart_t* uart, uint8_t* data, uint16_t len) {
+uint32_t uart_read(uart_t* uart, uint8_t* data, uint32_t len) {
     if (uart == NULL || data == NULL || len == 0) {
         return 0;
     }
 
-    uint16_t bytes_to_read = 0;
-    for (bytes_to_read = 0; bytes_to_read < len; ++bytes_to_read) {
-        // 检查缓冲区是否为空 (读指针追上写指针)
-        if (uart->tail == uart->head) {
-            break;
+    uint32_t n = ringbuf_pop(&uart->rx_ring, data, len);
+    rx_consumed(uart);
+    return n;
+}
+
+uint32_t uart_read_stamped(uart_t* uart, uint8_t* data, uint32_t len, uint32_t* timestamp) {
+#if UART_ENABLE_RX_TIMESTAMP
+    if (uart == NULL || data == NULL || len == 0) {
+        return 0;
+    }
+
+    // 先取时间戳再读数据：读之前最早的未读字节就是读出的第一个字节
+    uint32_t stamp;
+    if (uart_get_rx_timestamp(uart, &stamp) != LED_STATUS_OK) {
+        return 0;
+    }
+    uint32_t n = uart_read(uart, data, len);
+    if (n > 0 && timestamp != NULL) {
+        *timestamp = stamp;
+    }
+    return n;
+#else
+    (void)uart;
+    (void)data;
+    (void)len;
+    (void)timestamp;
+    return 0;
+#endif
+}
+
+led_status_t uart_get_rx_timestamp(uart_t* uart, uint32_t* timestamp) {
+    if (uart == NULL || timestamp == NULL) {
+        return LED_STATUS_INV_ARG;
+    }
+#if UART_ENABLE_RX_TIMESTAMP
+    if (ringbuf_used(&uart->rx_ring) == 0) {
+        return LED_STATUS_ERROR;
+    }
+
+    // 找到第一个字节位置不晚于读指针的最后一条记录，它就是最早的未读字节所属的数据块
+    uint32_t tail = uart->rx_ring.tail;
+    uint32_t head = DRIVER_LOAD_ACQUIRE(&uart->rx_stamp_head);
+    uint32_t index = uart->rx_stamp_tail;
+    if (index == head) {
+        return LED_STATUS_ERROR;
+    }
+    while (index + 1 != head &&
+           (int32_t)(tail - uart->rx_stamps[(index + 1) & (UART_RX_STAMP_DEPTH - 1)].pos) >= 0) {
+        index++;
+    }
+    *timestamp = uart->rx_stamps[index & (UART_RX_STAMP_DEPTH - 1)].stamp;
+    return LED_STATUS_OK;
+#else
+    return LED_STATUS_NOT_SUPPORTED;
+#endif
+}
+
+led_status_t uart_get_rx_latency(uart_t* uart, uart_rx_latency_t* latency, uint8_t reset) {
+    if (uart == NULL || latency == NULL) {
+        return LED_STATUS_INV_ARG;
+    }
+#if UART_ENABLE_RX_TIMESTAMP
+    // 直方图只在应用层更新，直接拷贝即可
+    *latency = uart->rx_latency;
+    if (reset) {
+        memset(&uart->rx_latency, 0, sizeof(uart->rx_latency));
+    }
+    return LED_STATUS_OK;
+#else
+    (void)reset;
+    return LED_STATUS_NOT_SUPPORTED;
+#endif
+}
+
+uint32_t uart_format_rx_latency(const uart_rx_latency_t* latency, char* buffer, uint32_t size) {
+    if (latency == NULL || buffer == NULL || size == 0) {
+        return 0;
+    }
+#if UART_ENABLE_RX_TIMESTAMP
+    uint32_t pos = 0;
+    int n = snprintf(buffer, size, "rx latency: count %lu, max %lu\r\n",
+                     (unsigned long)latency->count, (unsigned long)latency->max);
+    for (uint32_t bin = 0; n >= 0 && pos + (uint32_t)n < size && bin < UART_RX_LATENCY_BINS; ++bin) {
+        pos += (uint32_t)n;
+        n = 0;
+        if (latency->bins[bin] == 0) {
+            continue;
         }
-        data[bytes_to_read] = uart->rx_buffer[uart->tail];
-        uart->tail = (uart->tail + 1) % uart->rx_buffer_size;
+        uint32_t low = (bin == 0) ? 0 : (1u << (bin - 1));
+        if (bin == UART_RX_LATENCY_BINS - 1) {
+            n = snprintf(&buffer[pos], size - pos, "[%10lu,        max] %lu\r\n",
+                         (unsigned long)low, (unsigned long)latency->bins[bin]);
+        } else {
+            n = snprintf(&buffer[pos], size - pos, "[%10lu, %10lu) %lu\r\n",
+                         (unsigned long)low, (unsigned long)(1u << bin), (unsigned long)latency->bins[bin]);
+        }
+    }
+    // 最后一行被截断时，只保留完整的行
+    if (n > 0 && pos + (uint32_t)n < size) {
+        pos += (uint32_t)n;
     }
-    return bytes_to_read;
+    buffer[pos] = '\0';
+    return pos;
+#else
+    buffer[0] = '\0';
+    return 0;
+#endif
 }
 
-led_status_t uart_write(uart_t* uart, const uint8_t* data, uint16_t len) {
-    if (uart == NULL || uart->api == NULL || uart->api->transmit_dma == NULL) {
+uint32_t uart_wait(uart_t* uart, uint32_t min_len, uint32_t timeout_ms) {
+    if (uart == NULL || uart->api == NULL) {
+        return 0;
+    }
+
+    uint32_t start = uart->api->get_tick();
+    for (;;) {
+        uint32_t used = ringbuf_used(&uart->rx_ring);
+        // 缓冲区已满时不可能再等到更多数据
+        if (used >= min_len || used == uart->rx_ring.size) {
+            return used;
+        }
+        // 无符号减法，系统节拍回绕时同样正确
+        if (timeout_ms != UART_WAIT_FOREVER && (uint32_t)(uart->api->get_tick() - start) >= timeout_ms) {
+            return used;
+        }
+        if (uart->api->wait_for_event) {
+            uart->api->wait_for_event(uart->handle);
+        }
+    }
+}
+
+uint32_t uart_read_timeout(uart_t* uart, uint8_t* data, uint32_t len, uint32_t min_len, uint32_t timeout_ms) {
+    if (uart == NULL || data == NULL || len == 0) {
+        return 0;
+    }
+    if (min_len > len) {
+        min_len = len;
+    }
+
+    (void)uart_wait(uart, min_len, timeout_ms);
+    uint32_t n = ringbuf_pop(&uart->rx_ring, data, len);
+    rx_consumed(uart);
+    return n;
+}
+
+led_status_t uart_register_rx_callback(uart_t* uart, uart_rx_event_callback_t callback, void* user_data) {
+    if (uart == NULL) {
         return LED_STATUS_INV_ARG;
     }
-    return uart->api->transmit_dma(uart->handle, data, len);
+    uart->on_rx_event = callback;
+    uart->rx_user_data = user_data;
+    return LED_STATUS_OK;
 }
 
-uint16_t uart_get_bytes_available(uart_t* uart) {
+uint32_t uart_peek(uart_t* uart, uart_span_t spans[2]) {
+    if (uart == NULL || spans == NULL) {
+        return 0;
+    }
+    return ringbuf_peek(&uart->rx_ring, spans);
+}
+
+uint32_t uart_consume(uart_t* uart, uint32_t len) {
     if (uart == NULL) {
         return 0;
     }
-    if (uart->head >= uart->tail) {
-        return uart->head - uart->tail;
+    uint32_t n = ringbuf_consume(&uart->rx_ring, len);
+    rx_consumed(uart);
+    return n;
+}
+
+int32_t uart_find(uart_t* uart, uint8_t delim) {
+    if (uart == NULL) {
+        return -1;
+    }
+
+    // 从上次查找结束的位置继续。rx_scan_pos是绝对位置，读指针越过它之后自然从头开始
+    uint32_t tail = uart->rx_ring.tail;
+    uint32_t start = 0;
+    if (delim == uart->rx_scan_delim && (int32_t)(uart->rx_scan_pos - tail) > 0) {
+        start = uart->rx_scan_pos - tail;
+    }
+
+    uint32_t offset;
+    uint32_t scanned;
+    if (ringbuf_find(&uart->rx_ring, delim, start, &offset, &scanned)) {
+        uart->rx_scan_pos = tail + offset;
+        uart->rx_scan_delim = delim;
+        return (int32_t)offset;
+    }
+
+    // 记录实际扫描过的范围 (查找期间中断新写入的数据不算)，下次只查找之后的数据
+    uart->rx_scan_pos = tail + scanned;
+    uart->rx_scan_delim = delim;
+    return -1;
+}
+
+uint32_t uart_peek_until(uart_t* uart, uint8_t delim, uart_span_t spans[2]) {
+    if (uart == NULL || spans == NULL) {
+        return 0;
+    }
+
+    int32_t offset = uart_find(uart, delim);
+    if (offset < 0) {
+        return 0;
+    }
+
+    // 把两段数据截断为恰好一帧
+    uint32_t frame_len = (uint32_t)offset + 1;
+    (void)ringbuf_peek(&uart->rx_ring, spans);
+    if (spans[0].len >= frame_len) {
+        spans[0].len = frame_len;
+        spans[1].len = 0;
+    } else {
+        spans[1].len = frame_len - spans[0].len;
+    }
+    return frame_len;
+}
+
+uint32_t uart_read_until(uart_t* uart, uint8_t delim, uint8_t* data, uint32_t len) {
+    if (uart == NULL || data == NULL || len == 0) {
+        return 0;
+    }
+
+    int32_t offset = uart_find(uart, delim);
+    uint32_t frame_len;
+    if (offset >= 0) {
+        frame_len = (uint32_t)offset + 1;
+    } else if (ringbuf_free(&uart->rx_ring) == 0) {
+        // 缓冲区已满仍没有分隔符，只能先交出部分数据，否则接收将永远停滞
+        frame_len = len;
     } else {
-        return uart->rx_buffer_size - uart->tail + uart->head;
+        return 0;
+    }
+
+    if (frame_len > len) {
+        frame_len = len;
+    }
+    uint32_t n = ringbuf_pop(&uart->rx_ring, data, frame_len);
+    rx_consumed(uart);
+    return n;
+}
+
+led_status_t uart_write(uart_t* uart, const uint8_t* data, uint32_t len) {
+    if (uart == NULL || uart->api == NULL || uart->api->transmit_dma == NULL) {
+        return LED_STATUS_INV_ARG;
+    }
+    if (data == NULL || len == 0) {
+        return LED_STATUS_INV_ARG;
+    }
+
+    // 比整个发送队列还大的数据永远无法整体入队，应使用uart_write_timeout
+    if (len > uart->tx_ring.size) {
+        return LED_STATUS_INV_ARG;
+    }
+
+    // 要么整体入队，要么直接返回忙，避免发送出半条消息
+    if (!tx_write(uart, data, len)) {
+        return LED_STATUS_BUSY;
+    }
+    return LED_STATUS_OK;
+}
+
+uint32_t uart_write_timeout(uart_t* uart, const uint8_t* data, uint32_t len, uint32_t timeout_ms) {
+    if (uart == NULL || uart->api == NULL || uart->api->transmit_dma == NULL) {
+        return 0;
+    }
+    if (data == NULL || len == 0) {
+        return 0;
+    }
+
+    // 有多少空间就写入多少，启动DMA后休眠等待发送完成中断释放空间
+    uint32_t written = 0;
+    uint32_t start = uart->api->get_tick();
+    for (;;) {
+        uint32_t tail = DRIVER_LOAD_ACQUIRE(&uart->tx_ring.tail);
+        uint32_t chunk = uart->tx_ring.size - (DRIVER_LOAD_ACQUIRE(&uart->tx_reserved) - tail);
+        if (chunk > len - written) {
+            chunk = len - written;
+        }
+        // 其他生产者可能抢先占用了空间，这时本轮不写入，下一轮重试
+        if (chunk > 0 && tx_write(uart, data + written, chunk)) {
+            written += chunk;
+        }
+        if (written == len) {
+            return written;
+        }
+        if (timeout_ms != UART_WAIT_FOREVER && (uint32_t)(uart->api->get_tick() - start) >= timeout_ms) {
+            return written;
+        }
+        if (uart->api->wait_for_event) {
+            uart->api->wait_for_event(uart->handle);
+        }
+    }
+}
+
+led_status_t uart_writev(uart_t* uart, const uart_span_t* spans, uint8_t count) {
+    if (uart == NULL || uart->api == NULL || uart->api->transmit_dma == NULL) {
+        return LED_STATUS_INV_ARG;
+    }
+    if (spans == NULL || count == 0) {
+        return LED_STATUS_INV_ARG;
+    }
+
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < count; ++i) {
+        total += spans[i].len;
+    }
+    if (total == 0) {
+        return LED_STATUS_INV_ARG;
+    }
+    uint32_t pos;
+    if (total > uart->tx_ring.size || !tx_reserve(uart, total, &pos)) {
+        return LED_STATUS_BUSY;
+    }
+    for (uint8_t i = 0; i < count; ++i) {
+        pos = tx_fill(uart, pos, spans[i].data, spans[i].len);
+    }
+
+    tx_commit(uart, total);
+    return LED_STATUS_OK;
+}
+
+led_status_t uart_write_reserve(uart_t* uart, uint32_t len, uart_span_t spans[2]) {
+    if (uart == NULL || spans == NULL || len == 0) {
+        return LED_STATUS_INV_ARG;
+    }
+    uint32_t pos;
+    if (len > uart->tx_ring.size || !tx_reserve(uart, len, &pos)) {
+        return LED_STATUS_BUSY;
+    }
+    tx_spans(uart, pos, len, spans);
+    return LED_STATUS_OK;
+}
+
+led_status_t uart_write_commit(uart_t* uart, uint32_t len) {
+    if (uart == NULL || uart->api == NULL) {
+        return LED_STATUS_INV_ARG;
+    }
+    if (len > 0) {
+        tx_commit(uart, len);
+    }
+    return LED_STATUS_OK;
+}
+
+led_status_t uart_set_flow_control(uart_t* uart, uint32_t high_water, uint32_t low_water) {
+    if (uart == NULL || uart->api == NULL) {
+        return LED_STATUS_INV_ARG;
+    }
+    if (uart->api->set_rts == NULL) {
+        return LED_STATUS_NOT_SUPPORTED;
+    }
+
+    if (high_water == 0) {
+        // 关闭流控：先停止中断中的水位检查，再有效RTS
+        DRIVER_STORE_SEQ_CST(&uart->rts_high, 0);
+        DRIVER_STORE_SEQ_CST(&uart->rts_paused, 0);
+        return uart->api->set_rts(uart->handle, 1);
+    }
+    if (low_water >= high_water || high_water > uart->rx_ring.size) {
+        return LED_STATUS_INV_ARG;
+    }
+
+    led_status_t status = uart->api->set_rts(uart->handle, 1);
+    if (status != LED_STATUS_OK) {
+        return status;
+    }
+    uart->rts_low = low_water;
+    DRIVER_STORE_SEQ_CST(&uart->rts_paused, 0);
+    DRIVER_STORE_SEQ_CST(&uart->rts_high, high_water);
+    return LED_STATUS_OK;
+}
+
+led_status_t uart_set_tx_coalescing(uart_t* uart, uint32_t threshold, uint32_t timeout_ms) {
+    if (uart == NULL || uart->api == NULL) {
+        return LED_STATUS_INV_ARG;
+    }
+    if (threshold > uart->tx_ring.size) {
+        return LED_STATUS_INV_ARG;
+    }
+
+    uart->tx_coalesce_threshold = threshold;
+    uart->tx_coalesce_timeout = timeout_ms;
+    // 关闭合并时，把已经积累的数据立即发出
+    if (threshold == 0) {
+        return uart_flush(uart);
+    }
+    return LED_STATUS_OK;
+}
+
+led_status_t uart_flush(uart_t* uart) {
+    if (uart == NULL || uart->api == NULL) {
+        return LED_STATUS_INV_ARG;
+    }
+    DRIVER_STORE_RELAXED(&uart->tx_deadline_armed, 0);
+    tx_kick(uart);
+    return LED_STATUS_OK;
+}
+
+led_status_t uart_process(uart_t* uart) {
+    if (uart == NULL || uart->api == NULL) {
+        return LED_STATUS_INV_ARG;
+    }
+
+    // 合并等待超时：不论积累了多少数据都发出去
+    if (DRIVER_LOAD_ACQUIRE(&uart->tx_deadline_armed) &&
+        (uint32_t)(uart->api->get_tick() - DRIVER_LOAD_RELAXED(&uart->tx_deadline_start)) >= uart->tx_coalesce_timeout) {
+        DRIVER_STORE_RELAXED(&uart->tx_deadline_armed, 0);
+        tx_kick(uart);
+    }
+    return LED_STATUS_OK;
+}
+
+led_status_t uart_register_tx_callback(uart_t* uart, uart_tx_event_callback_t callback, void* user_data) {
+    if (uart == NULL) {
+        return LED_STATUS_INV_ARG;
+    }
+    uart->on_tx_event = callback;
+    uart->tx_user_data = user_data;
+    return LED_STATUS_OK;
+}
+
+led_status_t uart_get_stats(uart_t* uart, uart_stats_t* stats, uint8_t reset) {
+    if (uart == NULL || stats == NULL) {
+        return LED_STATUS_INV_ARG;
+    }
+#if UART_ENABLE_STATS
+    // 先拷贝一份当前值，再与基准快照相减 (无符号减法对计数器回绕同样正确)。
+    // 拷贝期间接收中断执行了清零请求时重新拷贝，保证高水位与请求状态一致
+    uart_stats_t now;
+    uint32_t ack;
+    do {
+        ack = DRIVER_LOAD_ACQUIRE(&uart->rx_high_water_ack);
+        memcpy(&now, (const void*)&uart->stats, sizeof(now));
+    } while (DRIVER_LOAD_ACQUIRE(&uart->rx_high_water_ack) != ack);
+
+    stats->rx_bytes           = now.rx_bytes           - uart->stats_base.rx_bytes;
+    stats->rx_dropped         = now.rx_dropped         - uart->stats_base.rx_dropped;
+    stats->rx_overflows       = now.rx_overflows       - uart->stats_base.rx_overflows;
+    stats->rx_idle_events     = now.rx_idle_events     - uart->stats_base.rx_idle_events;
+    stats->rx_half_events     = now.rx_half_events     - uart->stats_base.rx_half_events;
+    stats->rx_complete_events = now.rx_complete_events - uart->stats_base.rx_complete_events;
+    stats->rx_flow_pauses     = now.rx_flow_pauses     - uart->stats_base.rx_flow_pauses;
+    stats->tx_bytes           = now.tx_bytes           - uart->stats_base.tx_bytes;
+    // 清零请求还没有被接收中断执行：此后没有新数据写入，高水位就是清零时的占用
+    stats->rx_high_water      = (ack != uart->rx_high_water_reset) ? uart->rx_high_water_floor : now.rx_high_water;
+
+    if (reset) {
+        // 高水位由接收中断重置 (先写好起点，再发布请求)，这里不写中断正在比较更新的字段
+        uart->stats_base = now;
+        uart->rx_high_water_floor = ringbuf_used(&uart->rx_ring);
+        DRIVER_STORE_RELEASE(&uart->rx_high_water_reset, uart->rx_high_water_reset + 1);
+    }
+    return LED_STATUS_OK;
+#else
+    (void)reset;
+    return LED_STATUS_NOT_SUPPORTED;
+#endif
+}
+
+uint32_t uart_get_tx_pending(uart_t* uart) {
+    if (uart == NULL) {
+        return 0;
+    }
+    return ringbuf_used(&uart->tx_ring);
+}
+
+uint32_t uart_get_bytes_available(uart_t* uart) {
+    if (uart == NULL) {
+        return 0;
     }
+    return ringbuf_used(&uart->rx_ring);
 }
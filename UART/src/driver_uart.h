@@ -2,19 +2,157 @@
 #define __DRIVER_UART_H
 
 #include "driver_uart_interface.h"
+#include "driver_ringbuf.h"
 
 /**
- * @brief 串口驱动的 "对象" 或 "类" 定义
+ * @brief 是否编译串口统计计数器
+ * @note  设为0可以把统计相关的代码和内存开销从驱动中完全移除。
+ */
+#ifndef UART_ENABLE_STATS
+#define UART_ENABLE_STATS 1
+#endif
+
+/**
+ * @brief 是否为接收数据打时间戳
+ * @note  开启后，驱动在每次接收回调时记录一个时间戳，读取数据时可以得到其中最早字节的到达时间，
+ * 并自动统计数据在接收缓冲区中的停留时间分布 (延迟直方图)。关闭时相关代码和内存开销被完全移除。
+ */
+#ifndef UART_ENABLE_RX_TIMESTAMP
+#define UART_ENABLE_RX_TIMESTAMP 0
+#endif
+
+/**
+ * @brief 每个串口最多记录多少个尚未读完的数据块时间戳，必须是2的幂
+ * @note  记录已满时新到的数据块不再单独打时间戳，而是归入前一个数据块，
+ * 因此测得的延迟只会偏大，不会偏小。
+ */
+#ifndef UART_RX_STAMP_DEPTH
+#define UART_RX_STAMP_DEPTH 16
+#endif
+
+/**
+ * @brief 延迟直方图的区间数
+ * @note  区间0只统计延迟为0的数据块，区间k (k>=1) 统计延迟在 [2^(k-1), 2^k) 之间的数据块，
+ * 最后一个区间同时统计所有更大的延迟。
+ */
+#define UART_RX_LATENCY_BINS 32
+
+/**
+ * @brief 接收数据块的时间戳记录
  */
 typedef struct {
+    uint32_t pos;                   /**< 数据块第一个字节在接收缓冲区中的绝对写位置 */
+    uint32_t stamp;                 /**< 数据块到达时的时间戳 */
+} uart_rx_stamp_t;
+
+/**
+ * @brief 接收延迟直方图 (数据块从到达到第一个字节被读取的时间)
+ * @note  时间单位与时间戳相同：提供了get_timestamp时为其单位，否则为毫秒。
+ */
+typedef struct {
+    uint32_t bins[UART_RX_LATENCY_BINS];    /**< 各区间的数据块数 */
+    uint32_t count;                         /**< 统计的数据块总数 */
+    uint32_t max;                           /**< 最大延迟 */
+} uart_rx_latency_t;
+
+/**
+ * @brief 串口运行统计
+ */
+typedef struct {
+    uint32_t rx_bytes;              /**< 成功写入接收缓冲区的字节数 */
+    uint32_t rx_dropped;            /**< 因接收缓冲区已满而丢弃的字节数 */
+    uint32_t rx_overflows;          /**< 发生丢弃的次数 (溢出事件数) */
+    uint32_t rx_high_water;         /**< 接收缓冲区的最高占用字节数 */
+    uint32_t rx_idle_events;        /**< IDLE事件次数 */
+    uint32_t rx_half_events;        /**< DMA半传输(HT)事件次数 */
+    uint32_t rx_complete_events;    /**< DMA传输完成(TC)事件次数 */
+    uint32_t rx_flow_pauses;        /**< 因达到高水位而撤销RTS的次数 */
+    uint32_t tx_bytes;              /**< DMA已发送完成的字节数 */
+} uart_stats_t;
+
+/**
+ * @brief 描述接收缓冲区中一段连续数据的结构体 (用于零拷贝访问)
+ */
+typedef ringbuf_span_t uart_span_t;
+
+/**
+ * @brief 定义发送事件类型
+ */
+typedef enum {
+    UART_TX_EVENT_COMPLETE, /**< 一次DMA发送完成，len为本次发送的字节数 */
+    UART_TX_EVENT_FLUSHED,  /**< 发送队列中的数据已全部发送完毕 */
+} uart_tx_event_t;
+
+// 前向声明 uart_t 结构体
+struct uart_s;
+
+// 定义数据到达回调函数指针类型 (在中断上下文中被调用)
+// 参数: uart_t* - 指向触发事件的串口对象; event - 触发本次通知的硬件事件 (HT/TC/IDLE);
+//       len - 本次事件新写入接收缓冲区的字节数; void* - 用户自定义数据
+typedef void (*uart_rx_event_callback_t)(struct uart_s* uart, uart_rx_event_t event, uint32_t len, void* user_data);
+
+// 定义发送事件回调函数指针类型 (在中断上下文中被调用)
+// 参数: uart_t* - 指向触发事件的串口对象; event - 事件类型; len - 相关字节数; void* - 用户自定义数据
+typedef void (*uart_tx_event_callback_t)(struct uart_s* uart, uart_tx_event_t event, uint32_t len, void* user_data);
+
+/**
+ * @brief 串口驱动的 "对象" 或 "类" 定义
+ */
+typedef struct uart_s {
     const uart_api_t* api;    /**< 指向平台依赖API函数表的指针 */
     void* handle;               /**< 指向具体硬件实例句柄的void指针 */
 
     // --- 内部环形缓冲区 (Ring Buffer) ---
-    uint8_t* rx_buffer;         /**< 指向用于接收的环形缓冲区的指针 */
-    uint16_t rx_buffer_size;    /**< 环形缓冲区的大小 */
-    volatile uint16_t head;     /**< 缓冲区写指针 (由中断/DMA回调更新) */
-    volatile uint16_t tail;     /**< 缓冲区读指针 (由应用层读取更新) */
+    ringbuf_t rx_ring;          /**< 接收环形缓冲区 (生产者: 中断/DMA回调, 消费者: 应用层) */
+    uint32_t rx_scan_pos;       /**< 分隔符查找的进度 (绝对读位置)，之前的数据已确认不含rx_scan_delim */
+    uint8_t rx_scan_delim;      /**< 上次查找的分隔符 */
+
+    // --- 数据到达通知 ---
+    uart_rx_event_callback_t on_rx_event;   /**< 数据到达回调函数指针 */
+    void* rx_user_data;                     /**< 传递给回调函数的用户自定义数据 */
+    uint32_t rx_event_len;      /**< 当前硬件事件已写入的字节数 (只由中断上下文更新) */
+    uint8_t rx_burst_open;      /**< 已通知过HT/TC数据、尚未遇到IDLE (只由中断上下文更新) */
+
+    // --- 接收流控 ---
+    uint32_t rts_high;          /**< 高水位：接收缓冲区占用达到该值时撤销RTS，0表示未启用流控 */
+    uint32_t rts_low;           /**< 低水位：占用回落到该值及以下时重新有效RTS */
+    uint32_t rts_paused;        /**< RTS已撤销标志 (由中断置位，由应用层清零) */
+
+#if UART_ENABLE_RX_TIMESTAMP
+    // --- 接收时间戳 ---
+    uint32_t (*rx_clock)(void); /**< 时间戳来源 (get_timestamp或get_tick) */
+    uart_rx_stamp_t rx_stamps[UART_RX_STAMP_DEPTH]; /**< 尚未读完的数据块的时间戳 */
+    uint32_t rx_stamp_head;     /**< 时间戳写计数器 (只由中断上下文更新) */
+    uint32_t rx_stamp_tail;     /**< 时间戳读计数器 (只由应用层更新) */
+    uint32_t rx_stamp_next;     /**< 下一个待计入直方图的时间戳 (只由应用层更新) */
+    uart_rx_latency_t rx_latency; /**< 接收延迟直方图 (只由应用层更新) */
+#endif
+
+    // --- 发送队列 ---
+    ringbuf_t tx_ring;          /**< 发送环形缓冲区 (生产者: 任意上下文, 消费者: DMA发送完成中断)，head为已发布的位置 */
+    uint32_t tx_reserved;       /**< 已预留的位置 (生产者通过CAS推进) */
+    uint32_t tx_committed;      /**< 已填充完毕的字节总数 (生产者通过原子加法累加) */
+    uint32_t tx_busy;           /**< DMA发送进行中标志，只有成功置位它的一方才能启动DMA */
+    uint32_t tx_in_flight;      /**< 当前DMA正在发送的字节数 */
+
+    // --- 小数据合并发送 ---
+    uint32_t tx_coalesce_threshold; /**< 待发送数据达到该字节数时立即发送，0表示不合并 */
+    uint32_t tx_coalesce_timeout;   /**< 合并等待的最长时间 (毫秒) */
+    uint32_t tx_deadline_start;     /**< 第一个未发送字节写入时的时间戳 */
+    uint8_t tx_deadline_armed;      /**< 是否有数据在等待合并超时 */
+
+    // --- 发送事件回调 ---
+    uart_tx_event_callback_t on_tx_event;   /**< 发送事件回调函数指针 */
+    void* tx_user_data;                     /**< 传递给回调函数的用户自定义数据 */
+
+#if UART_ENABLE_STATS
+    // --- 运行统计 ---
+    uart_stats_t stats;         /**< 累计计数 (只由中断上下文更新) */
+    uart_stats_t stats_base;    /**< 上次清零时的快照 (只由应用层更新) */
+    uint32_t rx_high_water_floor;   /**< 清零时的接收缓冲区占用，高水位从它重新开始 (只由应用层更新) */
+    uint32_t rx_high_water_reset;   /**< 高水位清零请求计数 (只由应用层更新) */
+    uint32_t rx_high_water_ack;     /**< 已在接收中断中执行的清零请求计数 (只由中断上下文更新) */
+#endif
 
 } uart_t;
 
@@ -29,10 +167,13 @@ typedef struct {
  * @param[in] api            - 指向底层硬件API函数表的指针
  * @param[in] handle         - 指向具体硬件实例句柄的void指针
  * @param[in] rx_buffer      - 上层应用提供的用于接收的缓冲区
- * @param[in] rx_buffer_size - 接收缓冲区的大小
+ * @param[in] rx_buffer_size - 接收缓冲区的大小，必须是2的幂 (如 256, 1024)
+ * @param[in] tx_buffer      - 上层应用提供的用于发送队列的缓冲区
+ * @param[in] tx_buffer_size - 发送缓冲区的大小，必须是2的幂
  * @return led_status_t - 操作的状态码
  */
-led_status_t uart_init(uart_t* uart, const uart_api_t* api, void* handle, uint8_t* rx_buffer, uint16_t rx_buffer_size);
+led_status_t uart_init(uart_t* uart, const uart_api_t* api, void* handle, uint8_t* rx_buffer, uint32_t rx_buffer_size,
+                       uint8_t* tx_buffer, uint32_t tx_buffer_size);
 
 /**
  * @brief  反初始化一个串口对象
@@ -46,24 +187,280 @@ led_status_t uart_deinit(uart_t* uart);
  * @param[in]  uart   - 指向uart_t对象的指针
  * @param[out] data   - 用于存放读取数据的缓冲区
  * @param[in]  len    - 期望读取的数据长度
- * @return uint16_t - 实际读取到的数据长度 (可能小于期望长度)
+ * @return uint32_t - 实际读取到的数据长度 (可能小于期望长度)
+ */
+uint32_t uart_read(uart_t* uart, uint8_t* data, uint32_t len);
+
+/**
+ * @brief  从串口读取数据，并给出其中最早一个字节的到达时间
+ * @note   需要UART_ENABLE_RX_TIMESTAMP为1。时间戳是接收中断处理该数据块时记录的，
+ * 因此包含了DMA和中断的响应延迟 (IDLE事件约为一个字符时间，HT/TC事件最长为半个DMA缓冲区的接收时间)。
+ * @param[in]  uart      - 指向uart_t对象的指针
+ * @param[out] data      - 用于存放读取数据的缓冲区
+ * @param[in]  len       - 期望读取的数据长度
+ * @param[out] timestamp - 读到数据时，写入其中最早字节的到达时间戳；未读到数据时不修改
+ * @return uint32_t - 实际读取到的数据长度。UART_ENABLE_RX_TIMESTAMP为0时返回0
+ */
+uint32_t uart_read_stamped(uart_t* uart, uint8_t* data, uint32_t len, uint32_t* timestamp);
+
+/**
+ * @brief  获取接收缓冲区中最早的未读字节的到达时间
+ * @note   可以在uart_read_until、uart_read_timeout、uart_peek等读取之前调用，
+ * 得到即将读出的第一个字节的时间戳。
+ * @param[in]  uart      - 指向uart_t对象的指针
+ * @param[out] timestamp - 到达时间戳
+ * @return led_status_t - 操作的状态码。缓冲区为空时返回LED_STATUS_ERROR，
+ * UART_ENABLE_RX_TIMESTAMP为0时返回LED_STATUS_NOT_SUPPORTED
+ */
+led_status_t uart_get_rx_timestamp(uart_t* uart, uint32_t* timestamp);
+
+/**
+ * @brief  获取接收延迟直方图，并可选择清零
+ * @note   每个数据块在它的第一个字节被任意一个读取函数读走时计入一次。
+ * @param[in]  uart    - 指向uart_t对象的指针
+ * @param[out] latency - 用于存放直方图的结构体
+ * @param[in]  reset   - 非0表示读取后清零
+ * @return led_status_t - 操作的状态码。UART_ENABLE_RX_TIMESTAMP为0时返回LED_STATUS_NOT_SUPPORTED
+ */
+led_status_t uart_get_rx_latency(uart_t* uart, uart_rx_latency_t* latency, uint8_t reset);
+
+/**
+ * @brief  把延迟直方图格式化为可读的文本，便于通过串口或日志输出
+ * @note   只输出非空的区间，每个区间一行："[下限, 上限) 数量"。
+ * @param[in]  latency - 由uart_get_rx_latency得到的直方图
+ * @param[out] buffer  - 文本缓冲区
+ * @param[in]  size    - 缓冲区大小 (输出被截断时仍以'\0'结尾)
+ * @return uint32_t - 写入的字符数 (不含'\0')
+ */
+uint32_t uart_format_rx_latency(const uart_rx_latency_t* latency, char* buffer, uint32_t size);
+
+/**
+ * @brief  永久等待，用于uart_wait/uart_read_timeout的timeout_ms参数
+ */
+#define UART_WAIT_FOREVER 0xFFFFFFFFu
+
+/**
+ * @brief  等待接收缓冲区中至少有min_len字节可读
+ * @note   等待期间调用api->wait_for_event让CPU休眠，由接收中断或系统节拍中断唤醒，
+ * 而不是持续轮询。接收缓冲区已满时即使不足min_len也会立即返回。
+ * @param[in] uart       - 指向uart_t对象的指针
+ * @param[in] min_len    - 需要等待的最少字节数
+ * @param[in] timeout_ms - 超时时间 (毫秒)，0表示不等待，UART_WAIT_FOREVER表示永久等待
+ * @return uint32_t - 返回时可读的字节数 (超时返回时可能小于min_len)
+ */
+uint32_t uart_wait(uart_t* uart, uint32_t min_len, uint32_t timeout_ms);
+
+/**
+ * @brief  带超时的阻塞读取
+ * @note   等待直到至少有min_len字节可读或超时，然后读出当前可读的数据 (最多len字节)。
+ * 超时返回时读出已经到达的部分数据。
+ * @param[in]  uart       - 指向uart_t对象的指针
+ * @param[out] data       - 用于存放读取数据的缓冲区
+ * @param[in]  len        - 缓冲区的大小
+ * @param[in]  min_len    - 至少要等到的字节数 (大于len时按len处理)
+ * @param[in]  timeout_ms - 超时时间 (毫秒)，0表示不等待，UART_WAIT_FOREVER表示永久等待
+ * @return uint32_t - 实际读取到的数据长度
  */
-uint16_t uart_read(uart_t* uart, uint8_t* data, uint16_t len);
+uint32_t uart_read_timeout(uart_t* uart, uint8_t* data, uint32_t len, uint32_t min_len, uint32_t timeout_ms);
 
 /**
- * @brief  向串口写入数据
+ * @brief  为串口注册数据到达回调函数
+ * @note   回调在接收中断中被调用：每个HT/TC/IDLE事件如果写入了新数据，就触发一次。
+ * 例外：数据恰好在HT/TC处结束时，随后的IDLE事件即使没有新数据 (len为0) 也会触发一次，
+ * 因此IDLE回调总是标志着一批数据 (一帧) 的结束。
+ * 可以在回调中释放信号量、设置事件标志来唤醒等待数据的任务，但不应在其中做耗时处理。
+ * @param[in] uart      - 指向uart_t对象的指针
+ * @param[in] callback  - 当数据到达时要调用的回调函数，为NULL时取消注册
+ * @param[in] user_data - 需要传递给回调函数的自定义数据指针
+ * @return led_status_t - 操作的状态码
+ */
+led_status_t uart_register_rx_callback(uart_t* uart, uart_rx_event_callback_t callback, void* user_data);
+
+/**
+ * @brief  零拷贝查看接收缓冲区中的数据，不移动读指针
+ * @note   返回的指针直接指向rx_buffer内部，数据最多分为两段 (缓冲区回绕处)。
+ * 这些数据在调用uart_consume之前保持有效，协议解析器可以直接在其上解析或转发。
+ * @param[in]  uart  - 指向uart_t对象的指针
+ * @param[out] spans - 两个元素的数组，用于返回两段数据；未使用的段长度为0
+ * @return uint32_t - 可读数据的总长度
+ */
+uint32_t uart_peek(uart_t* uart, uart_span_t spans[2]);
+
+/**
+ * @brief  释放已经处理完的接收数据 (移动读指针)
+ * @param[in] uart - 指向uart_t对象的指针
+ * @param[in] len  - 要释放的字节数
+ * @return uint32_t - 实际释放的字节数
+ */
+uint32_t uart_consume(uart_t* uart, uint32_t len);
+
+/**
+ * @brief  在接收缓冲区中查找分隔符，不移动读指针
+ * @note   直接在环形缓冲区内部按字并行查找 (跨越回绕处)。对同一个分隔符的重复查找
+ * 会从上次查找结束的位置继续，已经确认不含分隔符的数据不会被重复扫描。
+ * @param[in] uart  - 指向uart_t对象的指针
+ * @param[in] delim - 分隔符，例如 '\n' 或 0x7E
+ * @return int32_t - 分隔符距离读指针的偏移；未找到返回-1
+ */
+int32_t uart_find(uart_t* uart, uint8_t delim);
+
+/**
+ * @brief  零拷贝获取一个以分隔符结尾的完整帧，不移动读指针
+ * @note   spans描述的数据恰好是一帧 (包含分隔符)，处理完后调用uart_consume释放。
+ * @param[in]  uart  - 指向uart_t对象的指针
+ * @param[in]  delim - 分隔符
+ * @param[out] spans - 两个元素的数组，用于返回帧数据；未使用的段长度为0
+ * @return uint32_t - 帧长度 (包含分隔符)；缓冲区中还没有完整的帧时返回0
+ */
+uint32_t uart_peek_until(uart_t* uart, uint8_t delim, uart_span_t spans[2]);
+
+/**
+ * @brief  读取一个以分隔符结尾的完整帧 (包含分隔符)
+ * @note   缓冲区中还没有完整的帧时不拷贝任何数据，直接返回0，不完整的数据留在缓冲区中。
+ * 如果帧比len长，或者接收缓冲区已满却仍没有分隔符 (不可能再凑成完整的帧)，
+ * 则读出len字节的部分数据，调用者可以通过最后一个字节是否为分隔符来判断。
+ * @param[in]  uart  - 指向uart_t对象的指针
+ * @param[in]  delim - 分隔符
+ * @param[out] data  - 用于存放帧数据的缓冲区
+ * @param[in]  len   - 缓冲区的大小
+ * @return uint32_t - 读取到的字节数
+ */
+uint32_t uart_read_until(uart_t* uart, uint8_t delim, uint8_t* data, uint32_t len);
+
+/**
+ * @brief  向串口写入数据 (异步)
+ * @note   数据被整体拷贝进发送队列后立即返回，调用者的缓冲区随即可以复用。
+ * 如果DMA空闲，会立即启动发送；否则由DMA发送完成中断自动接续发送。
+ * 所有写入函数都可以在主循环和中断中同时调用 (多生产者无锁)，每次写入的数据在发送流中保持连续。
  * @param[in] uart - 指向uart_t对象的指针
  * @param[in] data - 指向要发送的数据的指针
  * @param[in] len  - 要发送的数据长度
+ * @return led_status_t - 操作的状态码。队列剩余空间不足时返回LED_STATUS_BUSY，且不写入任何数据；
+ * len超过发送队列的容量时返回LED_STATUS_INV_ARG
+ */
+led_status_t uart_write(uart_t* uart, const uint8_t* data, uint32_t len);
+
+/**
+ * @brief  带超时的阻塞写入，可以发送任意长度的数据
+ * @note   数据分批写入发送队列，队列满时调用api->wait_for_event休眠，
+ * 等待DMA发送完成中断释放空间后继续写入。超过单次DMA上限的数据由驱动自动拆分。
+ * 不能在中断中调用。
+ * @param[in] uart       - 指向uart_t对象的指针
+ * @param[in] data       - 指向要发送的数据的指针
+ * @param[in] len        - 要发送的数据长度
+ * @param[in] timeout_ms - 超时时间 (毫秒)，UART_WAIT_FOREVER表示永久等待
+ * @return uint32_t - 实际写入发送队列的字节数 (超时返回时可能小于len)
+ */
+uint32_t uart_write_timeout(uart_t* uart, const uint8_t* data, uint32_t len, uint32_t timeout_ms);
+
+/**
+ * @brief  聚合写入：把多段不连续的数据作为一个整体放入发送队列 (异步)
+ * @note   各段数据会按顺序连续发送；要么全部入队，要么一个字节也不入队。
+ * @param[in] uart  - 指向uart_t对象的指针
+ * @param[in] spans - 数据段数组
+ * @param[in] count - 数据段的数量
+ * @return led_status_t - 操作的状态码。队列剩余空间不足时返回LED_STATUS_BUSY
+ */
+led_status_t uart_writev(uart_t* uart, const uart_span_t* spans, uint8_t count);
+
+/**
+ * @brief  在发送队列中预留空间，用于原地生成要发送的数据 (零拷贝写入)
+ * @note   适用于编码器等需要边生成边写入的场景，省去一次中间缓冲区拷贝。
+ * 填充完成后必须调用uart_write_commit提交全部预留的长度。预留之后、提交之前，
+ * 其他上下文写入的数据也要等到本次提交后才会发出，因此填充过程应尽量短。
+ * @param[in]  uart  - 指向uart_t对象的指针
+ * @param[in]  len   - 需要预留的长度
+ * @param[out] spans - 两个元素的数组，用于返回预留的空间 (发送队列回绕处最多两段)
+ * @return led_status_t - 操作的状态码。空间不足时返回LED_STATUS_BUSY
+ */
+led_status_t uart_write_reserve(uart_t* uart, uint32_t len, uart_span_t spans[2]);
+
+/**
+ * @brief  提交之前预留并已填充的数据，并启动发送
+ * @param[in] uart - 指向uart_t对象的指针
+ * @param[in] len  - 预留的长度 (必须与uart_write_reserve的len相同)
+ * @return led_status_t - 操作的状态码
+ */
+led_status_t uart_write_commit(uart_t* uart, uint32_t len);
+
+/**
+ * @brief  配置基于接收缓冲区水位的RTS流控
+ * @note   接收中断写入数据后，如果缓冲区占用达到high_water，就撤销RTS让对端暂停发送；
+ * 应用层通过uart_read/uart_consume等函数取走数据，占用回落到low_water及以下时重新有效RTS。
+ * 对端看到RTS撤销后可能还会再发出几个字节 (FIFO和响应延迟)，
+ * 因此high_water与缓冲区容量之间要留出余量，建议至少为一个DMA接收缓冲区的一半。
+ * @param[in] uart       - 指向uart_t对象的指针
+ * @param[in] high_water - 高水位 (字节)，0表示关闭流控并有效RTS
+ * @param[in] low_water  - 低水位 (字节)，必须小于high_water
+ * @return led_status_t - 操作的状态码。底层不支持RTS时返回LED_STATUS_NOT_SUPPORTED
+ */
+led_status_t uart_set_flow_control(uart_t* uart, uint32_t high_water, uint32_t low_water);
+
+/**
+ * @brief  配置小数据合并发送
+ * @note   启用后，写入的数据先在发送队列中积累，满足以下任一条件时才启动DMA发送：
+ * 待发送数据达到threshold字节；自第一个未发送字节写入起超过timeout_ms (由uart_process检查)；
+ * 调用uart_flush。这样大量零碎的小写入只需要少数几次DMA传输。
+ * @param[in] uart       - 指向uart_t对象的指针
+ * @param[in] threshold  - 立即发送的阈值 (字节)，不能超过发送队列容量；0表示关闭合并
+ * @param[in] timeout_ms - 最长等待时间 (毫秒)
+ * @return led_status_t - 操作的状态码
+ */
+led_status_t uart_set_tx_coalescing(uart_t* uart, uint32_t threshold, uint32_t timeout_ms);
+
+/**
+ * @brief  立即发送发送队列中积累的数据
+ * @note   只负责启动发送，不等待发送完成。需要确认发送完毕时，
+ * 可以检查uart_get_tx_pending或等待UART_TX_EVENT_FLUSHED事件。
+ * @param[in] uart - 指向uart_t对象的指针
+ * @return led_status_t - 操作的状态码
+ */
+led_status_t uart_flush(uart_t* uart);
+
+/**
+ * @brief  串口周期处理函数
+ * @note   启用合并发送时，此函数必须在主循环或定时器中被周期性地调用，
+ * 用于发出等待超时的数据。其调用周期决定了超时的精度。
+ * @param[in] uart - 指向uart_t对象的指针
+ * @return led_status_t - 操作的状态码
+ */
+led_status_t uart_process(uart_t* uart);
+
+/**
+ * @brief  为串口注册发送事件回调函数
+ * @note   回调在DMA发送完成中断中被调用：每完成一次DMA发送触发UART_TX_EVENT_COMPLETE，
+ * 发送队列全部发完时再触发UART_TX_EVENT_FLUSHED。
+ * @param[in] uart      - 指向uart_t对象的指针
+ * @param[in] callback  - 当事件发生时要调用的回调函数
+ * @param[in] user_data - 需要传递给回调函数的自定义数据指针
  * @return led_status_t - 操作的状态码
  */
-led_status_t uart_write(uart_t* uart, const uint8_t* data, uint16_t len);
+led_status_t uart_register_tx_callback(uart_t* uart, uart_tx_event_callback_t callback, void* user_data);
+
+/**
+ * @brief  获取串口运行统计的快照，并可选择清零
+ * @note   清零只记录一个基准快照，不会改写中断中正在累加的计数器，因此无需关中断。
+ * 高水位不是增量，清零时只提交一个请求，由下一次接收中断把它重置为清零时的缓冲区占用，
+ * 应用层从不直接写入中断正在比较更新的字段；请求尚未执行时读到的高水位就是清零时的占用。
+ * @param[in]  uart  - 指向uart_t对象的指针
+ * @param[out] stats - 用于存放统计快照的结构体 (自上次清零以来的增量)
+ * @param[in]  reset - 非0表示读取后清零
+ * @return led_status_t - 操作的状态码。UART_ENABLE_STATS为0时返回LED_STATUS_NOT_SUPPORTED
+ */
+led_status_t uart_get_stats(uart_t* uart, uart_stats_t* stats, uint8_t reset);
+
+/**
+ * @brief  获取发送队列中尚未发送完成的字节数 (包括正在由DMA发送的部分)
+ * @param[in] uart - 指向uart_t对象的指针
+ * @return uint32_t - 待发送的字节数
+ */
+uint32_t uart_get_tx_pending(uart_t* uart);
 
 /**
  * @brief  获取当前环形缓冲区中可读的数据字节数
  * @param[in] uart - 指向uart_t对象的指针
- * @return uint16_t - 可读的字节数
+ * @return uint32_t - 可读的字节数
  */
-uint16_t uart_get_bytes_available(uart_t* uart);
+uint32_t uart_get_bytes_available(uart_t* uart);
 
 #endif // __DRIVER_UART_H
\ No newline at end of file
@@ -0,0 +1,291 @@
+#include "driver_uart_frame.h"
+
+#include <stddef.h> // For NULL
+
+/**
+ * @brief 内部结构体：向预留的发送空间 (最多两段) 按下标写入
+ * @note  COBS编码需要回填每个数据块前面的编码字节，因此写入器支持按下标随机写。
+ * spans为NULL时只计数，用于计算编码长度。
+ */
+typedef struct {
+    uart_span_t* spans;
+    uint32_t pos;
+} frame_writer_t;
+
+static inline void writer_set(frame_writer_t* w, uint32_t index, uint8_t value) {
+    if (w->spans == NULL) {
+        return;
+    }
+    if (index < w->spans[0].len) {
+        w->spans[0].data[index] = value;
+    } else {
+        w->spans[1].data[index - w->spans[0].len] = value;
+    }
+}
+
+static inline void writer_put(frame_writer_t* w, uint8_t value) {
+    writer_set(w, w->pos, value);
+    w->pos++;
+}
+
+/**
+ * @brief 内部函数：COBS编码，最后追加帧分隔符0x00
+ */
+static void cobs_encode(frame_writer_t* w, const uint8_t* data, uint32_t len) {
+    uint32_t code_index = w->pos;
+    uint8_t code = 1;
+    writer_put(w, 0); // 编码字节占位，数据块结束时回填
+
+    for (uint32_t i = 0; i < len; ++i) {
+        if (data[i] == 0) {
+            writer_set(w, code_index, code);
+            code_index = w->pos;
+            code = 1;
+            writer_put(w, 0);
+            continue;
+        }
+        writer_put(w, data[i]);
+        code++;
+        if (code == 0xFF) {
+            // 满254字节的数据块，后面没有隐含的0
+            writer_set(w, code_index, code);
+            code_index = w->pos;
+            code = 1;
+            writer_put(w, 0);
+        }
+    }
+    writer_set(w, code_index, code);
+    writer_put(w, 0x00);
+}
+
+/**
+ * @brief 内部函数：SLIP编码，帧前后各加一个END (帧前的END用于冲掉线路上的噪声)
+ */
+static void slip_encode(frame_writer_t* w, const uint8_t* data, uint32_t len) {
+    writer_put(w, UART_FRAME_SLIP_END);
+    for (uint32_t i = 0; i < len; ++i) {
+        if (data[i] == UART_FRAME_SLIP_END) {
+            writer_put(w, UART_FRAME_SLIP_ESC);
+            writer_put(w, UART_FRAME_SLIP_ESC_END);
+        } else if (data[i] == UART_FRAME_SLIP_ESC) {
+            writer_put(w, UART_FRAME_SLIP_ESC);
+            writer_put(w, UART_FRAME_SLIP_ESC_ESC);
+        } else {
+            writer_put(w, data[i]);
+        }
+    }
+    writer_put(w, UART_FRAME_SLIP_END);
+}
+
+static void frame_encode(uart_frame_type_t type, frame_writer_t* w, const uint8_t* data, uint32_t len) {
+    if (type == UART_FRAME_SLIP) {
+        slip_encode(w, data, len);
+    } else {
+        cobs_encode(w, data, len);
+    }
+}
+
+/**
+ * @brief 内部函数：一帧结束 (遇到分隔符)，交付或丢弃当前帧，并复位解码状态
+ * @return uint32_t - 交付了一帧返回1
+ */
+static uint32_t frame_end(uart_frame_t* frame) {
+    uint32_t delivered = 0;
+    if (frame->discard) {
+        frame->errors++;
+    } else {
+        frame->frames++;
+        delivered = 1;
+        if (frame->on_frame) {
+            frame->on_frame(frame, frame->buffer, frame->len, frame->user_data);
+        }
+    }
+    uart_frame_reset(frame);
+    return delivered;
+}
+
+/**
+ * @brief 内部函数：向帧缓冲区追加一个字节，超长时将本帧标记为丢弃
+ */
+static inline void frame_append(uart_frame_t* frame, uint8_t value) {
+    if (frame->len < frame->buffer_size) {
+        frame->buffer[frame->len++] = value;
+    } else {
+        frame->discard = 1;
+    }
+}
+
+/**
+ * @brief 内部函数：COBS增量解码
+ * @note  数据块之间隐含的0要等到下一个数据块开始时才写入，这样帧的最后一个数据块
+ * 不会多出一个0，也就不需要提前知道帧在哪里结束。
+ */
+static uint32_t cobs_feed(uart_frame_t* frame, const uint8_t* data, uint32_t len) {
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < len; ++i) {
+        uint8_t byte = data[i];
+        if (byte == 0x00) {
+            // 空帧 (连续分隔符) 直接忽略；数据块未收完说明帧被截断
+            if (frame->in_block || frame->discard) {
+                if (frame->remaining != 0) {
+                    frame->discard = 1;
+                }
+                count += frame_end(frame);
+            }
+            continue;
+        }
+        if (frame->discard) {
+            continue;
+        }
+
+        if (frame->remaining == 0) {
+            // 编码字节：开始一个新的数据块
+            if (frame->in_block && frame->code != 0xFF) {
+                frame_append(frame, 0x00);
+            }
+            frame->code = byte;
+            frame->remaining = (uint8_t)(byte - 1);
+            frame->in_block = 1;
+        } else {
+            frame_append(frame, byte);
+            frame->remaining--;
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief 内部函数：SLIP增量解码
+ */
+static uint32_t slip_feed(uart_frame_t* frame, const uint8_t* data, uint32_t len) {
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < len; ++i) {
+        uint8_t byte = data[i];
+        if (byte == UART_FRAME_SLIP_END) {
+            // 空帧 (帧前的END) 直接忽略
+            if (frame->len > 0 || frame->discard || frame->escape) {
+                if (frame->escape) {
+                    frame->discard = 1;
+                }
+                count += frame_end(frame);
+            }
+            continue;
+        }
+        if (frame->discard) {
+            continue;
+        }
+
+        if (frame->escape) {
+            frame->escape = 0;
+            if (byte == UART_FRAME_SLIP_ESC_END) {
+                frame_append(frame, UART_FRAME_SLIP_END);
+            } else if (byte == UART_FRAME_SLIP_ESC_ESC) {
+                frame_append(frame, UART_FRAME_SLIP_ESC);
+            } else {
+                frame->discard = 1; // 非法的转义序列
+            }
+        } else if (byte == UART_FRAME_SLIP_ESC) {
+            frame->escape = 1;
+        } else {
+            frame_append(frame, byte);
+        }
+    }
+    return count;
+}
+
+led_status_t uart_frame_init(uart_frame_t* frame, uart_t* uart, uart_frame_type_t type, uint8_t* buffer,
+                             uint32_t buffer_size) {
+    if (frame == NULL || uart == NULL || buffer == NULL || buffer_size == 0) {
+        return LED_STATUS_INV_ARG;
+    }
+    if (type != UART_FRAME_COBS && type != UART_FRAME_SLIP) {
+        return LED_STATUS_INV_ARG;
+    }
+
+    frame->uart = uart;
+    frame->type = type;
+    frame->buffer = buffer;
+    frame->buffer_size = buffer_size;
+    frame->frames = 0;
+    frame->errors = 0;
+    frame->on_frame = NULL;
+    frame->user_data = NULL;
+    uart_frame_reset(frame);
+    return LED_STATUS_OK;
+}
+
+led_status_t uart_frame_register_callback(uart_frame_t* frame, uart_frame_callback_t callback, void* user_data) {
+    if (frame == NULL) {
+        return LED_STATUS_INV_ARG;
+    }
+    frame->on_frame = callback;
+    frame->user_data = user_data;
+    return LED_STATUS_OK;
+}
+
+void uart_frame_reset(uart_frame_t* frame) {
+    if (frame == NULL) {
+        return;
+    }
+    frame->len = 0;
+    frame->code = 0;
+    frame->remaining = 0;
+    frame->in_block = 0;
+    frame->escape = 0;
+    frame->discard = 0;
+}
+
+uint32_t uart_frame_feed(uart_frame_t* frame, const uint8_t* data, uint32_t len) {
+    if (frame == NULL || data == NULL || len == 0) {
+        return 0;
+    }
+    if (frame->type == UART_FRAME_SLIP) {
+        return slip_feed(frame, data, len);
+    }
+    return cobs_feed(frame, data, len);
+}
+
+uint32_t uart_frame_process(uart_frame_t* frame) {
+    if (frame == NULL || frame->uart == NULL) {
+        return 0;
+    }
+
+    // 直接在接收环形缓冲区中解码，两段数据分别送入，解码状态自然跨越回绕处
+    uart_span_t spans[2];
+    uint32_t used = uart_peek(frame->uart, spans);
+    if (used == 0) {
+        return 0;
+    }
+    uint32_t count = uart_frame_feed(frame, spans[0].data, spans[0].len);
+    count += uart_frame_feed(frame, spans[1].data, spans[1].len);
+    (void)uart_consume(frame->uart, used);
+    return count;
+}
+
+uint32_t uart_frame_encoded_size(uart_frame_type_t type, const uint8_t* data, uint32_t len) {
+    if (data == NULL && len > 0) {
+        return 0;
+    }
+    frame_writer_t w = { NULL, 0 };
+    frame_encode(type, &w, data, len);
+    return w.pos;
+}
+
+led_status_t uart_frame_send(uart_frame_t* frame, const uint8_t* data, uint32_t len) {
+    if (frame == NULL || frame->uart == NULL || (data == NULL && len > 0)) {
+        return LED_STATUS_INV_ARG;
+    }
+
+    // 先只计数得到准确的编码长度，再按该长度预留，避免按最坏情况预留导致误报忙
+    uint32_t size = uart_frame_encoded_size(frame->type, data, len);
+
+    uart_span_t spans[2];
+    led_status_t status = uart_write_reserve(frame->uart, size, spans);
+    if (status != LED_STATUS_OK) {
+        return status;
+    }
+
+    frame_writer_t w = { spans, 0 };
+    frame_encode(frame->type, &w, data, len);
+    return uart_write_commit(frame->uart, w.pos);
+}
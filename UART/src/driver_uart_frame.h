@@ -0,0 +1,136 @@
+#ifndef __DRIVER_UART_FRAME_H
+#define __DRIVER_UART_FRAME_H
+
+#include "driver_uart.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 串口帧编码方式
+ * @note  - COBS: 每帧以0x00结尾，帧内不会出现0x00，开销最多为每254字节1个字节。
+ * - SLIP (RFC 1055): 帧前后各一个0xC0，帧内的0xC0/0xDB被转义为两个字节。
+ *   SLIP无法区分空帧和连续的END，因此长度为0的帧不会被交付。
+ */
+typedef enum {
+    UART_FRAME_COBS = 0,
+    UART_FRAME_SLIP
+} uart_frame_type_t;
+
+// SLIP特殊字符
+#define UART_FRAME_SLIP_END     0xC0u
+#define UART_FRAME_SLIP_ESC     0xDBu
+#define UART_FRAME_SLIP_ESC_END 0xDCu
+#define UART_FRAME_SLIP_ESC_ESC 0xDDu
+
+// 前向声明
+struct uart_frame_s;
+
+/**
+ * @brief  帧接收完成回调函数类型
+ * @param[in] frame     - 产生该帧的分帧器
+ * @param[in] data      - 解码后的帧数据 (仅在回调期间有效)
+ * @param[in] len       - 帧长度
+ * @param[in] user_data - 注册时传入的用户数据
+ */
+typedef void (*uart_frame_callback_t)(struct uart_frame_s* frame, const uint8_t* data, uint32_t len, void* user_data);
+
+/**
+ * @brief 串口流式分帧器
+ * @note  解码是增量式的：状态保存在本结构体中，数据可以任意切分后分多次送入，
+ * 帧可以跨越多次DMA中断、环形缓冲区的回绕处到达。解码结果直接写入用户提供的帧缓冲区。
+ */
+typedef struct uart_frame_s {
+    uart_t* uart;                   /**< 所属的串口对象 */
+    uart_frame_type_t type;         /**< 编码方式 */
+
+    uint8_t* buffer;                /**< 解码后帧数据的存储区 */
+    uint32_t buffer_size;           /**< 存储区大小，即可接收的最大帧长 */
+    uint32_t len;                   /**< 当前帧已解码的长度 */
+
+    uint8_t code;                   /**< COBS: 当前数据块的编码字节 */
+    uint8_t remaining;              /**< COBS: 当前数据块还剩多少字节 */
+    uint8_t in_block;               /**< COBS: 是否已读到本帧的第一个编码字节 */
+    uint8_t escape;                 /**< SLIP: 上一个字节是否为转义字符 */
+    uint8_t discard;                /**< 本帧出错，丢弃数据直到下一个帧分隔符 */
+
+    uint32_t frames;                /**< 成功接收的帧数 */
+    uint32_t errors;                /**< 因格式错误或超长被丢弃的帧数 */
+
+    uart_frame_callback_t on_frame; /**< 帧接收完成回调函数 */
+    void* user_data;                /**< 传给回调函数的用户数据 */
+} uart_frame_t;
+
+/**
+ * @brief  初始化一个分帧器
+ * @param[in] frame       - 指向uart_frame_t对象的指针
+ * @param[in] uart        - 已初始化的串口对象
+ * @param[in] type        - 编码方式
+ * @param[in] buffer      - 解码后帧数据的存储区
+ * @param[in] buffer_size - 存储区大小
+ * @return led_status_t - 操作的状态码
+ */
+led_status_t uart_frame_init(uart_frame_t* frame, uart_t* uart, uart_frame_type_t type, uint8_t* buffer,
+                             uint32_t buffer_size);
+
+/**
+ * @brief  注册帧接收完成回调函数
+ * @param[in] frame     - 指向uart_frame_t对象的指针
+ * @param[in] callback  - 回调函数，为NULL时取消注册
+ * @param[in] user_data - 传给回调函数的用户数据
+ * @return led_status_t - 操作的状态码
+ */
+led_status_t uart_frame_register_callback(uart_frame_t* frame, uart_frame_callback_t callback, void* user_data);
+
+/**
+ * @brief  清除解码状态，丢弃已接收的半帧
+ * @param[in] frame - 指向uart_frame_t对象的指针
+ */
+void uart_frame_reset(uart_frame_t* frame);
+
+/**
+ * @brief  向解码器送入一段原始数据
+ * @note   每解出一帧就调用一次回调函数。数据可以任意切分，解码状态会跨调用保持。
+ * @param[in] frame - 指向uart_frame_t对象的指针
+ * @param[in] data  - 原始数据
+ * @param[in] len   - 数据长度
+ * @return uint32_t - 本次解出的帧数
+ */
+uint32_t uart_frame_feed(uart_frame_t* frame, const uint8_t* data, uint32_t len);
+
+/**
+ * @brief  处理串口接收缓冲区中的全部数据
+ * @note   应在主循环中周期性调用。数据直接在接收环形缓冲区中原地解码 (零拷贝)，
+ * 处理完后释放。
+ * @param[in] frame - 指向uart_frame_t对象的指针
+ * @return uint32_t - 本次解出的帧数
+ */
+uint32_t uart_frame_process(uart_frame_t* frame);
+
+/**
+ * @brief  计算一帧数据编码后的长度 (含帧分隔符)
+ * @param[in] type - 编码方式
+ * @param[in] data - 帧数据
+ * @param[in] len  - 帧长度
+ * @return uint32_t - 编码后的长度
+ */
+uint32_t uart_frame_encoded_size(uart_frame_type_t type, const uint8_t* data, uint32_t len);
+
+/**
+ * @brief  编码并发送一帧数据
+ * @note   编码结果直接写入串口的发送队列 (uart_write_reserve/uart_write_commit)，
+ * 不需要额外的中间缓冲区。要么整帧入队，要么返回忙。
+ * @param[in] frame - 指向uart_frame_t对象的指针
+ * @param[in] data  - 帧数据
+ * @param[in] len   - 帧长度
+ * @return led_status_t - 操作的状态码。发送队列空间不足时返回LED_STATUS_BUSY
+ */
+led_status_t uart_frame_send(uart_frame_t* frame, const uint8_t* data, uint32_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __DRIVER_UART_FRAME_H
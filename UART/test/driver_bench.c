@@ -0,0 +1,49 @@
+#include "driver_bench.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+
+#if defined(__arm__)
+#include "stm32f4xx_hal.h"
+#else
+#include <time.h>
+#endif
+
+// 一行结果的最大长度和等待发送队列腾出空间的最长时间
+#define BENCH_REPORT_LINE_SIZE  160
+#define BENCH_REPORT_TIMEOUT_MS 1000
+
+#if defined(__arm__)
+void bench_cycle_counter_init(void) {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+uint32_t bench_now(void) {
+    return DWT->CYCCNT;
+}
+#else
+void bench_cycle_counter_init(void) {
+}
+
+uint32_t bench_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec);
+}
+#endif
+
+void bench_report(const char* format, ...) {
+    char line[BENCH_REPORT_LINE_SIZE];
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    if (len <= 0) {
+        return;
+    }
+    if ((uint32_t)len >= sizeof(line)) {
+        len = (int)sizeof(line) - 1;
+    }
+    (void)uart_write_timeout(&g_uart1, (const uint8_t*)line, (uint32_t)len, BENCH_REPORT_TIMEOUT_MS);
+}
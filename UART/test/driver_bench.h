@@ -0,0 +1,48 @@
+#ifndef __DRIVER_BENCH_H
+#define __DRIVER_BENCH_H
+
+#include "driver_uart.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 基准测试的计时单位：目标板上为DWT周期数，PC上为系统单调时钟的纳秒数
+ */
+#if defined(__arm__)
+#define BENCH_UNIT "cycles"
+#else
+#define BENCH_UNIT "ns"
+#endif
+
+/**
+ * @brief 基准测试结果输出的串口，需在调用基准测试之前完成uart_init
+ */
+extern uart_t g_uart1;
+
+/**
+ * @brief 启用DWT周期计数器
+ * @note  只启用，不清零：串口接收时间戳也使用这个计数器，清零会打乱正在统计的接收延迟。
+ * 计时一律取两次读数的差值 (无符号减法，回绕后仍然正确)。在PC上什么也不做。
+ */
+void bench_cycle_counter_init(void);
+
+/**
+ * @brief  读取当前时刻
+ * @return uint32_t - 目标板上为DWT周期计数，PC上为纳秒 (截断为32位)，单位见BENCH_UNIT
+ */
+uint32_t bench_now(void);
+
+/**
+ * @brief 格式化一行基准测试结果，通过g_uart1输出
+ * @note  发送队列满时等待DMA发送腾出空间 (最多1秒)，不能在中断中调用。一行最多159个字符。
+ */
+void bench_report(const char* format, ...);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __DRIVER_BENCH_H
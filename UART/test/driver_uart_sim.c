@@ -0,0 +1,115 @@
+#include "driver_uart_sim.h"
+
+#include <stddef.h>
+#include "driver_atomic.h"
+
+uint32_t g_sim_uart_tick = 0;
+
+void (*g_sim_uart_wait_hook)(void* handle) = NULL;
+
+void (*g_sim_uart_transmit_hook)(sim_uart_port_t* port) = NULL;
+
+static led_status_t sim_uart_init(void* handle, uart_rx_callback_t callback, uart_tx_callback_t tx_callback, void* context) {
+    sim_uart_port_t* port = (sim_uart_port_t*)handle;
+    if (port == NULL || callback == NULL) {
+        return LED_STATUS_INV_ARG;
+    }
+    port->callback = callback;
+    port->tx_callback = tx_callback;
+    port->context = context;
+    port->tx_bytes = 0;
+    port->tx_starts = 0;
+    port->tx_len = 0;
+    port->rts_ready = 1;
+    return LED_STATUS_OK;
+}
+
+static led_status_t sim_uart_deinit(void* handle) {
+    sim_uart_port_t* port = (sim_uart_port_t*)handle;
+    if (port == NULL) return LED_STATUS_INV_ARG;
+    port->callback = NULL;
+    port->context = NULL;
+    return LED_STATUS_OK;
+}
+
+static led_status_t sim_uart_transmit_dma(void* handle, const uint8_t* data, uint32_t len) {
+    sim_uart_port_t* port = (sim_uart_port_t*)handle;
+    if (port == NULL || data == NULL || len == 0) {
+        return LED_STATUS_INV_ARG;
+    }
+    // 与HAL一致：上一次发送尚未完成时拒绝新的发送
+    if (port->tx_len != 0) {
+        return LED_STATUS_ERROR;
+    }
+    port->tx_data = data;
+    port->tx_starts++;
+    // 多线程压力测试中，另一个线程据此判断“DMA”是否在发送
+    DRIVER_STORE_RELEASE(&port->tx_len, len);
+    if (g_sim_uart_transmit_hook != NULL) {
+        g_sim_uart_transmit_hook(port);
+    }
+    return LED_STATUS_OK;
+}
+
+static uint32_t sim_uart_get_tick(void) {
+    return g_sim_uart_tick;
+}
+
+static void sim_uart_wait_for_event(void* handle) {
+    // 每次等待相当于过去了一个系统节拍
+    g_sim_uart_tick++;
+    if (g_sim_uart_wait_hook != NULL) {
+        g_sim_uart_wait_hook(handle);
+    }
+}
+
+static led_status_t sim_uart_set_rts(void* handle, uint8_t ready) {
+    ((sim_uart_port_t*)handle)->rts_ready = ready;
+    return LED_STATUS_OK;
+}
+
+static const uart_api_t s_sim_uart_api = {
+    .init = sim_uart_init,
+    .deinit = sim_uart_deinit,
+    .transmit_dma = sim_uart_transmit_dma,
+    .get_tick = sim_uart_get_tick,
+    .wait_for_event = sim_uart_wait_for_event,
+    .set_rts = sim_uart_set_rts,
+};
+
+const uart_api_t* sim_uart_get_api(void) {
+    return &s_sim_uart_api;
+}
+
+void sim_uart_complete_tx(sim_uart_port_t* port) {
+    if (port->tx_len == 0) {
+        return;
+    }
+    for (uint32_t i = 0; i < port->tx_len; ++i) {
+        if (port->capture != NULL && port->tx_bytes + i < port->capture_size) {
+            port->capture[port->tx_bytes + i] = port->tx_data[i];
+        }
+    }
+    port->tx_bytes += port->tx_len;
+    port->tx_len = 0;
+    if (port->tx_callback != NULL) {
+        port->tx_callback(port->context);
+    }
+}
+
+void sim_uart_drain(sim_uart_port_t* port) {
+    // 完成回调会立即接续队列中的下一段
+    while (port->tx_len != 0) {
+        sim_uart_complete_tx(port);
+    }
+}
+
+void sim_uart_receive(sim_uart_port_t* port, uint8_t* data, uint32_t len, uart_rx_event_t event) {
+    if (port->callback != NULL) {
+        port->callback(port->context, data, len, event);
+    }
+}
+
+void sim_uart_inject(sim_uart_port_t* port, uint8_t* data, uint32_t len) {
+    sim_uart_receive(port, data, len, UART_RX_EVENT_IDLE);
+}
@@ -0,0 +1,84 @@
+#ifndef __DRIVER_UART_SIM_H
+#define __DRIVER_UART_SIM_H
+
+#include "driver_uart.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 模拟串口端口：一个不依赖硬件的uart_api_t实现
+ * @note  接收回调由测试代码直接注入数据，“DMA发送”只记录数据和长度，
+ * 完成中断由测试代码调用sim_uart_complete_tx显式触发。
+ * 它让驱动层和建立在uart_t之上的模块 (日志、Modbus等) 可以在没有真实USART的情况下被验证。
+ */
+typedef struct {
+    uart_rx_callback_t callback;    /**< 驱动注册的接收回调 */
+    uart_tx_callback_t tx_callback; /**< 驱动注册的发送完成回调 */
+    void* context;                  /**< 驱动注册的上下文 */
+    uint32_t tx_bytes;              /**< 累计发送的字节数 */
+    uint32_t tx_starts;             /**< 累计启动DMA发送的次数 */
+    const uint8_t* tx_data;         /**< 正在“DMA发送”的数据 */
+    uint32_t tx_len;                /**< 正在“DMA发送”的长度，0表示空闲 */
+    uint8_t* capture;               /**< 可选：记录所有已发送数据的缓冲区 */
+    uint32_t capture_size;          /**< 记录缓冲区的大小 */
+    uint8_t rts_ready;              /**< RTS线状态，1表示允许对端发送 */
+} sim_uart_port_t;
+
+/**
+ * @brief 模拟的系统节拍，由测试代码直接设置；每次wait_for_event加1
+ */
+extern uint32_t g_sim_uart_tick;
+
+/**
+ * @brief 可选：模拟“休眠等待中断”期间发生的事情 (例如推进时间、注入数据)
+ */
+extern void (*g_sim_uart_wait_hook)(void* handle);
+
+/**
+ * @brief 可选：“DMA发送”启动时调用 (例如记录启动时刻)
+ */
+extern void (*g_sim_uart_transmit_hook)(sim_uart_port_t* port);
+
+/**
+ * @brief  获取模拟端口的API实例，handle为sim_uart_port_t对象
+ * @return const uart_api_t* - API实例
+ */
+const uart_api_t* sim_uart_get_api(void);
+
+/**
+ * @brief 模拟DMA发送完成中断：记录已发送的数据，然后调用驱动注册的完成回调
+ * @param[in] port - 模拟端口
+ */
+void sim_uart_complete_tx(sim_uart_port_t* port);
+
+/**
+ * @brief 让模拟的DMA把发送队列中的数据全部发完
+ * @param[in] port - 模拟端口
+ */
+void sim_uart_drain(sim_uart_port_t* port);
+
+/**
+ * @brief 模拟一次接收事件：把一块数据交给驱动注册的回调
+ * @param[in] port  - 模拟端口
+ * @param[in] data  - 数据
+ * @param[in] len   - 长度
+ * @param[in] event - 事件类型 (UART_RX_EVENT_HALF/COMPLETE/IDLE)
+ */
+void sim_uart_receive(sim_uart_port_t* port, uint8_t* data, uint32_t len, uart_rx_event_t event);
+
+/**
+ * @brief 模拟一次IDLE事件：把一块数据交给驱动注册的回调
+ * @param[in] port - 模拟端口
+ * @param[in] data - 数据
+ * @param[in] len  - 长度
+ */
+void sim_uart_inject(sim_uart_port_t* port, uint8_t* data, uint32_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __DRIVER_UART_SIM_H
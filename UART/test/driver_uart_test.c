@@ -1,10 +1,15 @@
 #include "driver_uart_test.h"
 
 // 1. 定义驱动对象和其所需的接收缓冲区
-uart_t g_uart1; // 定义一个全局的驱动对象，以匹配驱动层中的extern声明
+uart_t g_uart1; // 定义一个全局的驱动对象
 uint8_t g_uart1_rx_buffer[256]; // 为其分配一个256字节的环形缓冲区
+uint8_t g_uart1_tx_buffer[1024]; // 为其分配一个1024字节的发送队列
 
+#include <stdio.h>
 #include <string.h>
+#include "driver_atomic.h"
+#include "driver_bench.h"
+#include "driver_uart_sim.h"
 
 void driver_uart_test(void) {
 
@@ -13,31 +18,1633 @@ void driver_uart_test(void) {
     const uart_api_t* uart_api = bsp_uart_get_api();
 
     // b. 使用获取到的API实例和硬件句柄，来初始化通用的驱动对象
-    uart_init(&g_uart1, uart_api, (void*) &g_bsp_usart1, g_uart1_rx_buffer, sizeof(g_uart1_rx_buffer));
+    uart_init(&g_uart1, uart_api, (void*) &g_bsp_usart1, g_uart1_rx_buffer, sizeof(g_uart1_rx_buffer),
+              g_uart1_tx_buffer, sizeof(g_uart1_tx_buffer));
 
     /* 应用逻辑 -----------------------------------------------------------------*/
     // 发送一条欢迎信息
     char* welcome_msg = "UART Driver Initialized. Start Echo Test...\r\n";
     uart_write(&g_uart1, (uint8_t*) welcome_msg, strlen(welcome_msg));
 
-    // 定义一个用于临时存放从环形缓冲区读出数据的缓冲区
-    uint8_t temp_buffer[64];
-
     while (1) {
-        // 检查环形缓冲区中是否有可读的数据
-        uint16_t bytes_available = uart_get_bytes_available(&g_uart1);
+        // 没有数据时CPU在uart_wait中休眠，由接收中断唤醒，不再空转占满CPU
+        uart_wait(&g_uart1, 1, UART_WAIT_FOREVER);
+
+        // 零拷贝地查看环形缓冲区中的数据 (最多两段，直接指向rx_buffer)
+        uart_span_t spans[2];
+        uint32_t bytes_available = uart_peek(&g_uart1, spans);
 
         if (bytes_available > 0) {
-            // 从驱动的环形缓冲区中读取数据到临时缓冲区
-            uint16_t bytes_read = uart_read(&g_uart1, temp_buffer, sizeof(temp_buffer));
+            // 回环测试：把两段数据作为一个整体放入发送队列，入队成功后立即释放接收缓冲区，
+            // 队列已满时保留数据，下次循环重试
+            if (uart_writev(&g_uart1, spans, 2) == LED_STATUS_OK) {
+                uart_consume(&g_uart1, bytes_available);
+            }
+        }
+
+    }
+}
+
+
+/* 环形缓冲区基准测试 -------------------------------------------------------*/
+// 测量原逐字节取模实现与ringbuf_t批量拷贝实现的吞吐量 (目标板上以DWT周期计时，PC上以纳秒计时)。
+// 模拟DMA回调每次写入一个数据块，应用层每次读出64字节，统计总字节数/总耗时。
+
+#define BENCH_RING_SIZE     256
+#define BENCH_TOTAL_BYTES   (64u * 1024u)
+
+static uint8_t s_bench_ring_storage[BENCH_RING_SIZE];
+
+// 原实现的环形缓冲区 (逐字节、每字节一次取模)，仅用于对比
+typedef struct {
+    uint8_t* buffer;
+    uint16_t size;
+    volatile uint16_t head;
+    volatile uint16_t tail;
+} legacy_ring_t;
+
+static void legacy_ring_push(legacy_ring_t* rb, const uint8_t* data, uint16_t len) {
+    for (uint16_t i = 0; i < len; ++i) {
+        uint16_t next_head = (rb->head + 1) % rb->size;
+        if (next_head == rb->tail) {
+            break;
+        }
+        rb->buffer[rb->head] = data[i];
+        rb->head = next_head;
+    }
+}
+
+static uint16_t legacy_ring_pop(legacy_ring_t* rb, uint8_t* data, uint16_t len) {
+    uint16_t n = 0;
+    for (n = 0; n < len; ++n) {
+        if (rb->tail == rb->head) {
+            break;
+        }
+        data[n] = rb->buffer[rb->tail];
+        rb->tail = (rb->tail + 1) % rb->size;
+    }
+    return n;
+}
+
+static uint32_t bench_legacy(const uint8_t* chunk, uint16_t chunk_len, uint8_t* out) {
+    // 原实现会保留一个空位，实际容量比新实现少1字节，对结果的影响可以忽略
+    legacy_ring_t rb = { s_bench_ring_storage, BENCH_RING_SIZE, 0, 0 };
+    uint32_t moved = 0;
+    uint32_t start = bench_now();
+    while (moved < BENCH_TOTAL_BYTES) {
+        legacy_ring_push(&rb, chunk, chunk_len);
+        uint16_t n;
+        while ((n = legacy_ring_pop(&rb, out, 64)) > 0) {
+            moved += n;
+        }
+    }
+    return bench_now() - start;
+}
+
+static uint32_t bench_ringbuf(const uint8_t* chunk, uint16_t chunk_len, uint8_t* out) {
+    ringbuf_t rb;
+    ringbuf_init(&rb, s_bench_ring_storage, BENCH_RING_SIZE);
+    uint32_t moved = 0;
+    uint32_t start = bench_now();
+    while (moved < BENCH_TOTAL_BYTES) {
+        ringbuf_push(&rb, chunk, chunk_len);
+        uint32_t n;
+        while ((n = ringbuf_pop(&rb, out, 64)) > 0) {
+            moved += n;
+        }
+    }
+    return bench_now() - start;
+}
+
+// 每1000个计时单位传送的字节数 (计时精度不够、耗时为0时按1计)
+static uint32_t bench_ring_rate(uint32_t elapsed) {
+    return (uint32_t)((uint64_t)BENCH_TOTAL_BYTES * 1000u / (elapsed != 0 ? elapsed : 1u));
+}
+
+void driver_uart_benchmark_ringbuf(void) {
+    static const uint16_t chunk_sizes[] = { 1, 16, 64, 128, 255 };
+    uint8_t chunk[255];
+    uint8_t out[64];
+
+    for (uint16_t i = 0; i < sizeof(chunk); ++i) {
+        chunk[i] = (uint8_t)i;
+    }
+
+    bench_cycle_counter_init();
+    bench_report("ring benchmark (%u bytes, bytes per 1000 %s)\r\n", (unsigned)BENCH_TOTAL_BYTES, BENCH_UNIT);
+    for (uint32_t i = 0; i < sizeof(chunk_sizes) / sizeof(chunk_sizes[0]); ++i) {
+        uint32_t legacy_elapsed = bench_legacy(chunk, chunk_sizes[i], out);
+        uint32_t ring_elapsed = bench_ringbuf(chunk, chunk_sizes[i], out);
+        bench_report("chunk %3u: legacy %5lu, ringbuf %5lu\r\n", (unsigned)chunk_sizes[i],
+                     (unsigned long)bench_ring_rate(legacy_elapsed), (unsigned long)bench_ring_rate(ring_elapsed));
+    }
+}
+
+/* 多实例测试 ---------------------------------------------------------------*/
+// 同时运行4个模拟端口，每个端口以不同的块大小交错接收各自带标记的数据流，
+// 验证每个uart_t只会收到属于自己的数据，且顺序和内容完全正确。
+
+#define MULTI_PORT_COUNT        4
+#define MULTI_PORT_RING_SIZE    128
+#define MULTI_PORT_STREAM_LEN   4096
+
+led_status_t driver_uart_test_multi_port(void) {
+    static sim_uart_port_t ports[MULTI_PORT_COUNT];
+    static uart_t uarts[MULTI_PORT_COUNT];
+    static uint8_t rings[MULTI_PORT_COUNT][MULTI_PORT_RING_SIZE];
+    static uint8_t tx_rings[MULTI_PORT_COUNT][MULTI_PORT_RING_SIZE];
+    uint32_t sent[MULTI_PORT_COUNT] = {0};
+    uint32_t received[MULTI_PORT_COUNT] = {0};
+    uint8_t chunk[32];
+
+    for (uint8_t p = 0; p < MULTI_PORT_COUNT; ++p) {
+        if (uart_init(&uarts[p], sim_uart_get_api(), &ports[p], rings[p], MULTI_PORT_RING_SIZE,
+                      tx_rings[p], MULTI_PORT_RING_SIZE) != LED_STATUS_OK) {
+            return LED_STATUS_ERROR;
+        }
+    }
+
+    uint8_t done = 0;
+    while (!done) {
+        done = 1;
+        for (uint8_t p = 0; p < MULTI_PORT_COUNT; ++p) {
+            // 每个端口的数据字节 = (端口号 << 6) | (序号 & 0x3F)，块大小随端口不同
+            uint16_t len = (uint16_t)(3 + p * 7);
+            if (sent[p] + len > MULTI_PORT_STREAM_LEN) {
+                len = (uint16_t)(MULTI_PORT_STREAM_LEN - sent[p]);
+            }
+            for (uint16_t i = 0; i < len; ++i) {
+                chunk[i] = (uint8_t)((p << 6) | ((sent[p] + i) & 0x3F));
+            }
+            if (len > 0) {
+                sim_uart_inject(&ports[p], chunk, len);
+                sent[p] += len;
+            }
+
+            // 应用层读出并校验
+            uint8_t rx[32];
+            uint32_t n;
+            while ((n = uart_read(&uarts[p], rx, sizeof(rx))) > 0) {
+                for (uint16_t i = 0; i < n; ++i) {
+                    if (rx[i] != (uint8_t)((p << 6) | ((received[p] + i) & 0x3F))) {
+                        return LED_STATUS_ERROR;
+                    }
+                }
+                received[p] += n;
+            }
+
+            if (received[p] < MULTI_PORT_STREAM_LEN) {
+                done = 0;
+            }
+        }
+    }
+
+    for (uint8_t p = 0; p < MULTI_PORT_COUNT; ++p) {
+        uart_deinit(&uarts[p]);
+    }
+    return LED_STATUS_OK;
+}
+
+/* 循环DMA模拟器 -------------------------------------------------------------*/
+// 用软件模拟一个循环模式的DMA通道：每收到一个字节，写入DMA缓冲区并递减计数器(NDTR)，
+// 计数器越过一半/到达0时挂起HT/TC中断，到0后自动重装。中断在若干字节之后才被“响应”，
+// 以模拟真实的中断延迟。数据以远大于DMA缓冲区的突发连续到达，突发之间才有IDLE事件。
+// 驱动侧通过uart_rx_dma_advance取数据，最终校验应用层读到的数据流完整无缺。
+
+#define SIM_DMA_SIZE        64
+#define SIM_DMA_TOTAL_BYTES 200000u
+
+typedef struct {
+    uint8_t buffer[SIM_DMA_SIZE];   /**< 循环DMA缓冲区 */
+    uint16_t ndtr;                  /**< 模拟的DMA剩余计数器 */
+    uint8_t half_pending;           /**< HT中断挂起 */
+    uint8_t complete_pending;       /**< TC中断挂起 */
+    uart_rx_dma_cursor_t cursor;    /**< 驱动使用的读位置游标 */
+} sim_dma_t;
+
+static uint32_t s_sim_rand = 12345;
+
+static uint32_t sim_rand(void) {
+    s_sim_rand = s_sim_rand * 1103515245u + 12345u;
+    return (s_sim_rand >> 16) & 0x7FFF;
+}
+
+// DMA硬件行为：写入一个字节并更新计数器
+static void sim_dma_receive_byte(sim_dma_t* dma, uint8_t byte) {
+    dma->buffer[SIM_DMA_SIZE - dma->ndtr] = byte;
+    dma->ndtr--;
+    if (dma->ndtr == SIM_DMA_SIZE / 2) {
+        dma->half_pending = 1;
+    }
+    if (dma->ndtr == 0) {
+        dma->ndtr = SIM_DMA_SIZE;
+        dma->complete_pending = 1;
+    }
+}
+
+// 中断服务：与BSP层的HT/TC/IDLE处理完全相同的调用方式
+static void sim_dma_service(sim_dma_t* dma, sim_uart_port_t* port, uart_rx_event_t event) {
+    uart_rx_dma_advance(&dma->cursor, dma->buffer, SIM_DMA_SIZE, dma->ndtr,
+                        event, port->callback, port->context);
+}
+
+led_status_t driver_uart_test_circular_dma(void) {
+    static sim_uart_port_t port;
+    static uart_t uart;
+    static uint8_t ring[256];
+    static uint8_t tx_ring[64];
+    static sim_dma_t dma;
+    uint32_t sent = 0;
+    uint32_t received = 0;
+    uint16_t latency = 0;
+
+    if (uart_init(&uart, sim_uart_get_api(), &port, ring, sizeof(ring), tx_ring, sizeof(tx_ring)) != LED_STATUS_OK) {
+        return LED_STATUS_ERROR;
+    }
+    memset(&dma, 0, sizeof(dma));
+    dma.ndtr = SIM_DMA_SIZE;
+    uart_rx_dma_cursor_reset(&dma.cursor);
+
+    while (sent < SIM_DMA_TOTAL_BYTES) {
+        // 一次突发：长度远超DMA缓冲区，突发内部没有任何空闲间隙
+        uint32_t burst = 1 + sim_rand() % (SIM_DMA_SIZE * 40);
+        for (uint32_t i = 0; i < burst && sent < SIM_DMA_TOTAL_BYTES; ++i) {
+            sim_dma_receive_byte(&dma, (uint8_t)(sent * 7 + (sent >> 8)));
+            sent++;
+
+            // 中断挂起后，经过0 ~ (半个缓冲区-1)个字节的延迟才被响应
+            if (dma.half_pending || dma.complete_pending) {
+                if (latency == 0) {
+                    latency = (uint16_t)(1 + sim_rand() % (SIM_DMA_SIZE / 2 - 1));
+                }
+                if (--latency == 0) {
+                    if (dma.half_pending) {
+                        dma.half_pending = 0;
+                        sim_dma_service(&dma, &port, UART_RX_EVENT_HALF);
+                    }
+                    if (dma.complete_pending) {
+                        dma.complete_pending = 0;
+                        sim_dma_service(&dma, &port, UART_RX_EVENT_COMPLETE);
+                    }
+                }
+            }
+
+            // 应用层及时读取数据并校验
+            uint8_t rx[64];
+            uint32_t n;
+            while ((n = uart_read(&uart, rx, sizeof(rx))) > 0) {
+                for (uint16_t k = 0; k < n; ++k) {
+                    uint32_t idx = received + k;
+                    if (rx[k] != (uint8_t)(idx * 7 + (idx >> 8))) {
+                        return LED_STATUS_ERROR;
+                    }
+                }
+                received += n;
+            }
+        }
+
+        // 突发结束，总线空闲：先处理仍挂起的HT/TC，再处理IDLE
+        if (dma.half_pending) {
+            dma.half_pending = 0;
+            sim_dma_service(&dma, &port, UART_RX_EVENT_HALF);
+        }
+        if (dma.complete_pending) {
+            dma.complete_pending = 0;
+            sim_dma_service(&dma, &port, UART_RX_EVENT_COMPLETE);
+        }
+        latency = 0;
+        sim_dma_service(&dma, &port, UART_RX_EVENT_IDLE);
+    }
+
+    uint8_t rx[64];
+    uint32_t n;
+    while ((n = uart_read(&uart, rx, sizeof(rx))) > 0) {
+        received += n;
+    }
+#if UART_ENABLE_STATS
+    // 零丢失也必须体现在驱动的统计中
+    uart_stats_t stats;
+    uart_get_stats(&uart, &stats, 0);
+    if (stats.rx_dropped != 0 || stats.rx_bytes != sent) {
+        return LED_STATUS_ERROR;
+    }
+#endif
+    uart_deinit(&uart);
+
+    // 零丢失：收到的字节数必须与发送的完全一致
+    return (received == sent) ? LED_STATUS_OK : LED_STATUS_ERROR;
+}
+
+/* 发送队列测试 ---------------------------------------------------------------*/
+// 多个“生产者”以不同长度交替调用uart_write/uart_writev写入带序号的数据，
+// 模拟的DMA在随机时刻完成发送。验证：写入立即返回、DMA由完成中断自动接续、
+// 线路上的数据顺序与写入顺序完全一致，且最终收到FLUSHED事件。
+
+#define TX_TEST_TOTAL_BYTES 20000u
+
+typedef struct {
+    uint32_t complete_events;
+    uint32_t completed_bytes;
+    uint32_t flushed_events;
+} tx_test_events_t;
+
+static void tx_test_on_event(uart_t* uart, uart_tx_event_t event, uint32_t len, void* user_data) {
+    tx_test_events_t* events = (tx_test_events_t*)user_data;
+    (void)uart;
+    if (event == UART_TX_EVENT_COMPLETE) {
+        events->complete_events++;
+        events->completed_bytes += len;
+    } else if (event == UART_TX_EVENT_FLUSHED) {
+        events->flushed_events++;
+    }
+}
+
+led_status_t driver_uart_test_tx_queue(void) {
+    static sim_uart_port_t port;
+    static uart_t uart;
+    static uint8_t rx_ring[64];
+    static uint8_t tx_ring[256];
+    static uint8_t capture[TX_TEST_TOTAL_BYTES];
+    tx_test_events_t events = {0};
+    uint32_t written = 0;
+
+    memset(&port, 0, sizeof(port));
+    port.capture = capture;
+    port.capture_size = sizeof(capture);
+    if (uart_init(&uart, sim_uart_get_api(), &port, rx_ring, sizeof(rx_ring), tx_ring, sizeof(tx_ring)) != LED_STATUS_OK) {
+        return LED_STATUS_ERROR;
+    }
+    uart_register_tx_callback(&uart, tx_test_on_event, &events);
+
+    while (written < TX_TEST_TOTAL_BYTES) {
+        uint8_t a[24];
+        uint8_t b[9];
+        uint16_t len_a = (uint16_t)(1 + sim_rand() % sizeof(a));
+        uint16_t len_b = (uint16_t)(sim_rand() % sizeof(b));
+        if (written + len_a + len_b > TX_TEST_TOTAL_BYTES) {
+            len_a = (uint16_t)(TX_TEST_TOTAL_BYTES - written);
+            len_b = 0;
+        }
+        for (uint16_t i = 0; i < len_a; ++i) {
+            a[i] = (uint8_t)(written + i);
+        }
+        for (uint16_t i = 0; i < len_b; ++i) {
+            b[i] = (uint8_t)(written + len_a + i);
+        }
+
+        led_status_t status;
+        if (len_b == 0) {
+            status = uart_write(&uart, a, len_a);
+        } else {
+            uart_span_t spans[2] = { { a, len_a }, { b, len_b } };
+            status = uart_writev(&uart, spans, 2);
+        }
+
+        if (status == LED_STATUS_OK) {
+            written += len_a + len_b;
+        } else if (status != LED_STATUS_BUSY) {
+            return LED_STATUS_ERROR;
+        }
+
+        // DMA在随机时刻完成；队列满时一定会有一次完成
+        if (status == LED_STATUS_BUSY || (sim_rand() & 3) == 0) {
+            sim_uart_complete_tx(&port);
+        }
+    }
+
+    // 等待发送队列排空
+    while (port.tx_len != 0) {
+        sim_uart_complete_tx(&port);
+    }
+
+    if (uart_get_tx_pending(&uart) != 0 || port.tx_bytes != TX_TEST_TOTAL_BYTES) {
+        return LED_STATUS_ERROR;
+    }
+    if (events.completed_bytes != TX_TEST_TOTAL_BYTES || events.complete_events != port.tx_starts ||
+        events.flushed_events == 0) {
+        return LED_STATUS_ERROR;
+    }
+    for (uint32_t i = 0; i < TX_TEST_TOTAL_BYTES; ++i) {
+        if (capture[i] != (uint8_t)i) {
+            return LED_STATUS_ERROR;
+        }
+    }
+
+    uart_deinit(&uart);
+    return LED_STATUS_OK;
+}
+
+/* 统计计数测试 ---------------------------------------------------------------*/
+// 向64字节的接收缓冲区注入超量数据，验证接收/丢弃/溢出/高水位/事件计数，
+// 以及快照清零之后计数从零重新开始。
+
+led_status_t driver_uart_test_stats(void) {
+#if UART_ENABLE_STATS
+    static sim_uart_port_t port;
+    static uart_t uart;
+    static uint8_t rx_ring[64];
+    static uint8_t tx_ring[64];
+    uint8_t data[48];
+    uart_stats_t stats;
+
+    memset(&port, 0, sizeof(port));
+    if (uart_init(&uart, sim_uart_get_api(), &port, rx_ring, sizeof(rx_ring), tx_ring, sizeof(tx_ring)) != LED_STATUS_OK) {
+        return LED_STATUS_ERROR;
+    }
+    memset(data, 0x55, sizeof(data));
+
+    // 48 + 48 字节写入64字节的缓冲区：丢弃32字节，发生1次溢出
+    sim_uart_inject(&port, data, sizeof(data));
+    sim_uart_inject(&port, data, sizeof(data));
+    port.callback(port.context, data, 0, UART_RX_EVENT_HALF);
+    uart_write(&uart, data, 10);
+    sim_uart_complete_tx(&port);
+
+    uart_get_stats(&uart, &stats, 1);
+    if (stats.rx_bytes != 64 || stats.rx_dropped != 32 || stats.rx_overflows != 1 ||
+        stats.rx_high_water != 64 || stats.rx_idle_events != 2 || stats.rx_half_events != 1 ||
+        stats.rx_complete_events != 0 || stats.tx_bytes != 10) {
+        return LED_STATUS_ERROR;
+    }
+
+    // 清零后：计数从零开始，高水位从清零时的占用开始 (下一次接收中断之前读到的也是它)
+    uint8_t rx[16];
+    uart_read(&uart, rx, sizeof(rx));
+    uart_get_stats(&uart, &stats, 0);
+    if (stats.rx_bytes != 0 || stats.rx_high_water != 64) {
+        return LED_STATUS_ERROR;
+    }
+    sim_uart_inject(&port, data, 8);
+    uart_get_stats(&uart, &stats, 0);
+    if (stats.rx_bytes != 8 || stats.rx_dropped != 0 || stats.rx_overflows != 0 ||
+        stats.rx_high_water != 64 || stats.rx_idle_events != 1 || stats.tx_bytes != 0) {
+        return LED_STATUS_ERROR;
+    }
+
+    // 清零请求由接收中断执行：占用40字节时清零，之后收到20字节，高水位为60
+    uart_get_stats(&uart, &stats, 1);
+    while (uart_read(&uart, rx, sizeof(rx)) != 0) {
+    }
+    sim_uart_inject(&port, data, 40);
+    uart_get_stats(&uart, &stats, 1);
+    sim_uart_inject(&port, data, 20);
+    uart_get_stats(&uart, &stats, 0);
+    if (stats.rx_high_water != 60 || stats.rx_bytes != 20) {
+        return LED_STATUS_ERROR;
+    }
+
+    uart_deinit(&uart);
+    return LED_STATUS_OK;
+#else
+    return LED_STATUS_NOT_SUPPORTED;
+#endif
+}
+
+/* 分隔符帧读取测试 -----------------------------------------------------------*/
+// 以随机块大小注入以'\n'结尾的随机长度帧，帧经常跨越环形缓冲区的回绕处。
+// 交替使用uart_read_until和uart_peek_until读取，验证每一帧都完整且内容正确。
+
+#define LINE_TEST_FRAMES 2000
+
+led_status_t driver_uart_test_read_until(void) {
+    static sim_uart_port_t port;
+    static uart_t uart;
+    static uint8_t rx_ring[128];
+    static uint8_t tx_ring[64];
+    static uint8_t stream[64];
+    uint32_t frames_sent = 0;
+    uint32_t frames_received = 0;
+    uint16_t stream_len = 0;
+    uint16_t stream_pos = 0;
+
+    memset(&port, 0, sizeof(port));
+    if (uart_init(&uart, sim_uart_get_api(), &port, rx_ring, sizeof(rx_ring), tx_ring, sizeof(tx_ring)) != LED_STATUS_OK) {
+        return LED_STATUS_ERROR;
+    }
+
+    while (frames_received < LINE_TEST_FRAMES) {
+        // 生成下一帧：内容为帧序号的低位重复，长度为1~40，以'\n'结尾
+        if (stream_pos == stream_len && frames_sent < LINE_TEST_FRAMES) {
+            stream_len = (uint16_t)(1 + sim_rand() % 40);
+            for (uint16_t i = 0; i + 1 < stream_len; ++i) {
+                stream[i] = (uint8_t)('A' + (frames_sent % 26));
+            }
+            stream[stream_len - 1] = '\n';
+            stream_pos = 0;
+            frames_sent++;
+        }
+
+        // 以随机块大小注入 (不足以保证整帧到达)
+        uint16_t chunk = (uint16_t)(1 + sim_rand() % 16);
+        if (chunk > stream_len - stream_pos) {
+            chunk = (uint16_t)(stream_len - stream_pos);
+        }
+        if (chunk > ringbuf_free(&uart.rx_ring)) {
+            chunk = (uint16_t)ringbuf_free(&uart.rx_ring);
+        }
+        if (chunk > 0) {
+            sim_uart_inject(&port, &stream[stream_pos], chunk);
+            stream_pos = (uint16_t)(stream_pos + chunk);
+        }
+
+        for (;;) {
+            uint8_t frame[64];
+            uint32_t n;
+            if (frames_received & 1) {
+                n = uart_read_until(&uart, '\n', frame, sizeof(frame));
+            } else {
+                uart_span_t spans[2];
+                n = uart_peek_until(&uart, '\n', spans);
+                if (n > 0) {
+                    memcpy(frame, spans[0].data, spans[0].len);
+                    memcpy(&frame[spans[0].len], spans[1].data, spans[1].len);
+                    uart_consume(&uart, n);
+                }
+            }
+            if (n == 0) {
+                break;
+            }
+            if (frame[n - 1] != '\n') {
+                return LED_STATUS_ERROR;
+            }
+            for (uint32_t i = 0; i + 1 < n; ++i) {
+                if (frame[i] != (uint8_t)('A' + (frames_received % 26))) {
+                    return LED_STATUS_ERROR;
+                }
+            }
+            frames_received++;
+        }
+    }
+
+    // 未找到时报告的已查找长度就是查找时的数据量，之后到达的数据下次继续查找
+    uint32_t offset;
+    uint32_t scanned;
+    sim_uart_inject(&port, (uint8_t*)"abc", 3);
+    if (ringbuf_find(&uart.rx_ring, '\n', 1, &offset, &scanned) || scanned != 3 || uart_find(&uart, '\n') >= 0) {
+        return LED_STATUS_ERROR;
+    }
+    sim_uart_inject(&port, (uint8_t*)"d\n", 2);
+    if (uart_find(&uart, '\n') != 4 || uart_read_until(&uart, '\n', stream, sizeof(stream)) != 5) {
+        return LED_STATUS_ERROR;
+    }
+
+    uart_deinit(&uart);
+    return LED_STATUS_OK;
+}
+
+/* 分隔符查找基准测试 ---------------------------------------------------------*/
+// 在1024字节的环形缓冲区中，对不同帧长，比较逐字节循环与按字并行查找的耗时。
+
+#define FIND_BENCH_RING_SIZE 1024
+#define FIND_BENCH_ROUNDS    32
+
+static uint8_t s_find_bench_storage[FIND_BENCH_RING_SIZE];
+
+// 逐字节查找的对照实现 (应用层原先的做法)
+static uint8_t naive_find(const ringbuf_t* rb, uint8_t value, uint32_t start, uint32_t* offset) {
+    uint32_t used = rb->head - rb->tail;
+    for (uint32_t i = start; i < used; ++i) {
+        if (rb->buffer[(rb->tail + i) & rb->mask] == value) {
+            *offset = i;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+void driver_uart_benchmark_find(void) {
+    static const uint16_t frame_lengths[] = { 16, 64, 256, 1000 };
+    ringbuf_t rb;
+
+    bench_cycle_counter_init();
+    bench_report("find benchmark (%s per byte x100)\r\n", BENCH_UNIT);
+
+    for (uint32_t f = 0; f < sizeof(frame_lengths) / sizeof(frame_lengths[0]); ++f) {
+        uint32_t naive_time = 0;
+        uint32_t swar_time = 0;
+        uint32_t scanned = 0;
+
+        // 让读指针停在缓冲区中间，数据跨越回绕处
+        ringbuf_init(&rb, s_find_bench_storage, FIND_BENCH_RING_SIZE);
+        rb.head = rb.tail = FIND_BENCH_RING_SIZE / 2 + 3;
+        for (uint32_t i = 0; i < FIND_BENCH_RING_SIZE; ++i) {
+            uint8_t byte = ((i + 1) % frame_lengths[f] == 0) ? '\n' : (uint8_t)('a' + (i % 26));
+            ringbuf_push(&rb, &byte, 1);
+        }
+
+        for (uint32_t round = 0; round < FIND_BENCH_ROUNDS; ++round) {
+            uint32_t start = 0;
+            uint32_t offset_naive = 0;
+            uint32_t offset_swar = 0;
+            for (;;) {
+                uint32_t t0 = bench_now();
+                uint8_t found_naive = naive_find(&rb, '\n', start, &offset_naive);
+                uint32_t t1 = bench_now();
+                uint8_t found_swar = ringbuf_find(&rb, '\n', start, &offset_swar, NULL);
+                uint32_t t2 = bench_now();
+                naive_time += t1 - t0;
+                swar_time += t2 - t1;
+                if (!found_naive || !found_swar || offset_naive != offset_swar) {
+                    break;
+                }
+                scanned += offset_swar + 1 - start;
+                start = offset_swar + 1;
+            }
+        }
+
+        if (scanned == 0) {
+            continue;
+        }
+        bench_report("frame %4u: naive %4lu, swar %4lu\r\n", (unsigned)frame_lengths[f],
+                     (unsigned long)((uint64_t)naive_time * 100u / scanned),
+                     (unsigned long)((uint64_t)swar_time * 100u / scanned));
+    }
+}
+
+/* 分帧器模糊测试 -------------------------------------------------------------*/
+// 两个模拟端口回环：发送端用uart_frame_send编码，发送出去的数据以随机块大小注入接收端，
+// 接收端用uart_frame_process增量解码。负载中大量出现0x00/0xC0/0xDB/0xFF，
+// 长度覆盖0、254、255等COBS边界以及超过接收缓冲区的超长帧；其间穿插随机噪声，
+// 验证解码器在噪声之后能够在下一个分隔符处重新同步。
+
+#define FRAME_FUZZ_ROUNDS   1500
+#define FRAME_FUZZ_MAX_LEN  300
+#define FRAME_FUZZ_BUF_SIZE 256
+
+typedef struct {
+    const uint8_t* expected;    /**< 当前期望收到的帧 */
+    uint32_t expected_len;
+    uint8_t ignore;             /**< 噪声阶段：不校验收到的帧 */
+    uint32_t matched;
+    uint32_t mismatched;
+} frame_fuzz_ctx_t;
+
+static void frame_fuzz_on_frame(uart_frame_t* frame, const uint8_t* data, uint32_t len, void* user_data) {
+    frame_fuzz_ctx_t* ctx = (frame_fuzz_ctx_t*)user_data;
+    (void)frame;
+    if (ctx->ignore) {
+        return;
+    }
+    if (len == ctx->expected_len && memcmp(data, ctx->expected, len) == 0) {
+        ctx->matched++;
+    } else {
+        ctx->mismatched++;
+    }
+}
+
+// 把发送端正在“DMA发送”的数据以随机块大小交给接收端，直到发送队列清空
+static void frame_fuzz_pump(sim_uart_port_t* tx_port, sim_uart_port_t* rx_port, uart_t* rx_uart,
+                            uart_frame_t* decoder) {
+    while (tx_port->tx_len != 0) {
+        uint32_t pos = 0;
+        while (pos < tx_port->tx_len) {
+            uint32_t chunk = 1 + sim_rand() % 40;
+            if (chunk > tx_port->tx_len - pos) {
+                chunk = tx_port->tx_len - pos;
+            }
+            if (chunk > ringbuf_free(&rx_uart->rx_ring)) {
+                chunk = ringbuf_free(&rx_uart->rx_ring);
+            }
+            sim_uart_inject(rx_port, (uint8_t*)&tx_port->tx_data[pos], chunk);
+            pos += chunk;
+            uart_frame_process(decoder);
+        }
+        sim_uart_complete_tx(tx_port);
+    }
+}
+
+static led_status_t frame_fuzz_run(uart_frame_type_t type) {
+    static sim_uart_port_t tx_port;
+    static sim_uart_port_t rx_port;
+    static uart_t tx_uart;
+    static uart_t rx_uart;
+    static uint8_t tx_ring[1024];
+    static uint8_t tx_unused[16];
+    static uint8_t rx_ring[128];
+    static uint8_t rx_unused[16];
+    static uint8_t frame_buffer[FRAME_FUZZ_BUF_SIZE];
+    static uint8_t payload[FRAME_FUZZ_MAX_LEN];
+    static const uint8_t specials[] = { 0x00, UART_FRAME_SLIP_END, UART_FRAME_SLIP_ESC, 0xFF };
+    static const uint16_t edge_lengths[] = { 0, 1, 253, 254, 255, 256, 508, 509 };
+    uart_frame_t encoder;
+    uart_frame_t decoder;
+    frame_fuzz_ctx_t ctx;
+    uint32_t expected_frames = 0;
+    uint32_t expected_errors = 0;
+
+    memset(&tx_port, 0, sizeof(tx_port));
+    memset(&rx_port, 0, sizeof(rx_port));
+    memset(&ctx, 0, sizeof(ctx));
+    if (uart_init(&tx_uart, sim_uart_get_api(), &tx_port, tx_unused, sizeof(tx_unused), tx_ring, sizeof(tx_ring)) != LED_STATUS_OK ||
+        uart_init(&rx_uart, sim_uart_get_api(), &rx_port, rx_ring, sizeof(rx_ring), rx_unused, sizeof(rx_unused)) != LED_STATUS_OK) {
+        return LED_STATUS_ERROR;
+    }
+    uart_frame_init(&encoder, &tx_uart, type, frame_buffer, sizeof(frame_buffer));
+    uart_frame_init(&decoder, &rx_uart, type, frame_buffer, sizeof(frame_buffer));
+    uart_frame_register_callback(&decoder, frame_fuzz_on_frame, &ctx);
+
+    for (uint32_t round = 0; round < FRAME_FUZZ_ROUNDS; ++round) {
+        // 生成负载：一部分使用边界长度，内容中约一半是特殊字节
+        uint16_t len = (uint16_t)(sim_rand() % (FRAME_FUZZ_MAX_LEN + 1));
+        if ((round & 7) == 0) {
+            len = edge_lengths[(round >> 3) % (sizeof(edge_lengths) / sizeof(edge_lengths[0]))];
+            if (len > FRAME_FUZZ_MAX_LEN) {
+                len = FRAME_FUZZ_MAX_LEN;
+            }
+        }
+        uint8_t nonzero = (round & 15) == 8; // 不含0的长数据块，覆盖COBS的0xFF编码
+        for (uint16_t i = 0; i < len; ++i) {
+            uint32_t r = sim_rand();
+            payload[i] = (r & 1) ? specials[(r >> 1) & 3] : (uint8_t)(r >> 8);
+            if (nonzero && payload[i] == 0) {
+                payload[i] = 0x5A;
+            }
+        }
+
+        // 每隔一段插入随机噪声，再用一个分隔符强制重新同步
+        if ((round % 50) == 49) {
+            uint8_t noise[64];
+            uint16_t noise_len = (uint16_t)(1 + sim_rand() % sizeof(noise));
+            for (uint16_t i = 0; i < noise_len; ++i) {
+                noise[i] = (uint8_t)sim_rand();
+            }
+            noise[noise_len - 1] = (type == UART_FRAME_COBS) ? 0x00 : UART_FRAME_SLIP_END;
+            ctx.ignore = 1;
+            uart_write(&tx_uart, noise, noise_len);
+            frame_fuzz_pump(&tx_port, &rx_port, &rx_uart, &decoder);
+            ctx.ignore = 0;
+            decoder.frames = 0;
+            decoder.errors = 0;
+            expected_frames = 0;
+            expected_errors = 0;
+            ctx.matched = 0;
+        }
+
+        ctx.expected = payload;
+        ctx.expected_len = len;
+        if (uart_frame_send(&encoder, payload, len) != LED_STATUS_OK) {
+            return LED_STATUS_ERROR;
+        }
+        frame_fuzz_pump(&tx_port, &rx_port, &rx_uart, &decoder);
+
+        // SLIP无法表示空帧；超过接收缓冲区的帧应被丢弃并计为错误
+        if (len > FRAME_FUZZ_BUF_SIZE) {
+            expected_errors++;
+        } else if (len > 0 || type == UART_FRAME_COBS) {
+            expected_frames++;
+        }
+        if (ctx.mismatched != 0 || ctx.matched != expected_frames ||
+            decoder.frames != expected_frames || decoder.errors != expected_errors) {
+            return LED_STATUS_ERROR;
+        }
+    }
+
+    uart_deinit(&tx_uart);
+    uart_deinit(&rx_uart);
+    return LED_STATUS_OK;
+}
+
+led_status_t driver_uart_test_frame_fuzz(void) {
+    if (frame_fuzz_run(UART_FRAME_COBS) != LED_STATUS_OK) {
+        return LED_STATUS_ERROR;
+    }
+    return frame_fuzz_run(UART_FRAME_SLIP);
+}
+
+/* 分帧器吞吐量基准测试 -------------------------------------------------------*/
+// 分别测量COBS/SLIP编码 (直接写入发送队列) 和解码的每字节周期数。
+// 负载为256字节随机数据，其中约1/8为需要特殊处理的字节。
 
-            if (bytes_read > 0) {
-                // 回环测试：将读取到的数据再原样发送回去
-                uart_write(&g_uart1, temp_buffer, bytes_read);
+#define FRAME_BENCH_LEN    256
+#define FRAME_BENCH_ROUNDS 64
+
+void driver_uart_benchmark_frame(void) {
+    static sim_uart_port_t port;
+    static uart_t uart;
+    static uint8_t rx_unused[16];
+    static uint8_t tx_ring[1024];
+    static uint8_t payload[FRAME_BENCH_LEN];
+    static uint8_t frame_buffer[FRAME_BENCH_LEN];
+    static const char* const names[] = { "cobs", "slip" };
+    static const uint8_t specials[] = { 0x00, UART_FRAME_SLIP_END, UART_FRAME_SLIP_ESC, 0xFF };
+
+    for (uint16_t i = 0; i < FRAME_BENCH_LEN; ++i) {
+        uint32_t r = sim_rand();
+        payload[i] = ((r & 7) == 0) ? specials[(r >> 3) & 3] : (uint8_t)(r >> 8);
+    }
+
+    bench_cycle_counter_init();
+    bench_report("frame benchmark (%s per byte x100)\r\n", BENCH_UNIT);
+
+    for (uint8_t t = 0; t < 2; ++t) {
+        uart_frame_type_t type = (t == 0) ? UART_FRAME_COBS : UART_FRAME_SLIP;
+        uart_frame_t frame;
+        uint32_t encode_time = 0;
+        uint32_t decode_time = 0;
+
+        memset(&port, 0, sizeof(port));
+        uart_init(&uart, sim_uart_get_api(), &port, rx_unused, sizeof(rx_unused), tx_ring, sizeof(tx_ring));
+        uart_frame_init(&frame, &uart, type, frame_buffer, sizeof(frame_buffer));
+
+        for (uint32_t round = 0; round < FRAME_BENCH_ROUNDS; ++round) {
+            uint32_t t0 = bench_now();
+            uart_frame_send(&frame, payload, FRAME_BENCH_LEN);
+            uint32_t t1 = bench_now();
+            encode_time += t1 - t0;
+
+            // 把发送端DMA送出的编码数据直接交给解码器 (发送队列回绕时分两段)
+            while (port.tx_len != 0) {
+                uint32_t t2 = bench_now();
+                uart_frame_feed(&frame, port.tx_data, port.tx_len);
+                uint32_t t3 = bench_now();
+                decode_time += t3 - t2;
+                sim_uart_complete_tx(&port);
+            }
+        }
+
+        bench_report("%s: encode %4lu, decode %4lu, frames %lu\r\n", names[t],
+                     (unsigned long)((uint64_t)encode_time * 100u / (FRAME_BENCH_LEN * FRAME_BENCH_ROUNDS)),
+                     (unsigned long)((uint64_t)decode_time * 100u / (FRAME_BENCH_LEN * FRAME_BENCH_ROUNDS)),
+                     (unsigned long)frame.frames);
+        uart_deinit(&uart);
+    }
+}
+
+/* 阻塞读取与数据到达通知测试 -------------------------------------------------*/
+// 模拟的wait_for_event每调用一次推进一个节拍，并按预定的时间表注入数据。
+// 验证：数据提前到达时立即返回、超时时返回部分数据、超时精确、不等待模式、
+// 以及数据到达回调在每个硬件事件只触发一次并携带正确的事件类型和长度。
+
+typedef struct {
+    uint32_t calls;
+    uint32_t bytes;
+    uart_rx_event_t last_event;
+} rx_notify_ctx_t;
+
+static void rx_notify_on_event(uart_t* uart, uart_rx_event_t event, uint32_t len, void* user_data) {
+    rx_notify_ctx_t* ctx = (rx_notify_ctx_t*)user_data;
+    (void)uart;
+    ctx->calls++;
+    ctx->bytes += len;
+    ctx->last_event = event;
+}
+
+// 每隔5个节拍“到达”4字节数据
+static void read_timeout_wait_hook(void* handle) {
+    static uint8_t chunk[4] = { 'a', 'b', 'c', 'd' };
+    if ((g_sim_uart_tick % 5) == 0) {
+        sim_uart_inject((sim_uart_port_t*)handle, chunk, sizeof(chunk));
+    }
+}
+
+led_status_t driver_uart_test_read_timeout(void) {
+    static sim_uart_port_t port;
+    static uart_t uart;
+    static uint8_t rx_ring[64];
+    static uint8_t tx_ring[16];
+    rx_notify_ctx_t ctx;
+    uint8_t buf[64];
+    led_status_t result = LED_STATUS_OK;
+
+    memset(&port, 0, sizeof(port));
+    memset(&ctx, 0, sizeof(ctx));
+    if (uart_init(&uart, sim_uart_get_api(), &port, rx_ring, sizeof(rx_ring), tx_ring, sizeof(tx_ring)) != LED_STATUS_OK) {
+        return LED_STATUS_ERROR;
+    }
+    uart_register_rx_callback(&uart, rx_notify_on_event, &ctx);
+    g_sim_uart_tick = 1;
+    g_sim_uart_wait_hook = read_timeout_wait_hook;
+
+    // 1. 不等待：缓冲区为空时立即返回0，且没有经过任何节拍
+    if (uart_read_timeout(&uart, buf, sizeof(buf), 1, 0) != 0 || g_sim_uart_tick != 1) {
+        result = LED_STATUS_ERROR;
+    }
+
+    // 2. 等待8字节：第5和第10个节拍各到达4字节，应在第10个节拍返回
+    if (result == LED_STATUS_OK &&
+        (uart_read_timeout(&uart, buf, sizeof(buf), 8, 100) != 8 || g_sim_uart_tick != 10 ||
+         memcmp(buf, "abcdabcd", 8) != 0)) {
+        result = LED_STATUS_ERROR;
+    }
+
+    // 3. 超时：3个节拍内只能等到第15个节拍之前的数据 (没有)，应在恰好3个节拍后返回0
+    if (result == LED_STATUS_OK && (uart_read_timeout(&uart, buf, sizeof(buf), 4, 3) != 0 || g_sim_uart_tick != 13)) {
+        result = LED_STATUS_ERROR;
+    }
+
+    // 4. 超时返回部分数据：要求20字节、等待10个节拍，只能收到第15和第20个节拍的8字节
+    if (result == LED_STATUS_OK && (uart_read_timeout(&uart, buf, sizeof(buf), 20, 10) != 8 || g_sim_uart_tick != 23)) {
+        result = LED_STATUS_ERROR;
+    }
+
+    // 5. 数据到达回调：上面共4次IDLE事件，每次4字节
+    if (result == LED_STATUS_OK && (ctx.calls != 4 || ctx.bytes != 16 || ctx.last_event != UART_RX_EVENT_IDLE)) {
+        result = LED_STATUS_ERROR;
+    }
+
+    // 6. 一个硬件事件分两次回调 (数据跨越DMA缓冲区末尾)，只通知一次；没有新数据的事件不通知
+    if (result == LED_STATUS_OK) {
+        uint8_t tail[3] = { 1, 2, 3 };
+        ctx.calls = 0;
+        ctx.bytes = 0;
+        port.callback(port.context, tail, sizeof(tail), UART_RX_EVENT_DATA);
+        port.callback(port.context, tail, 2, UART_RX_EVENT_COMPLETE);
+        port.callback(port.context, NULL, 0, UART_RX_EVENT_HALF);
+        if (ctx.calls != 1 || ctx.bytes != 5 || ctx.last_event != UART_RX_EVENT_COMPLETE) {
+            result = LED_STATUS_ERROR;
+        }
+    }
+
+    g_sim_uart_wait_hook = NULL;
+    uart_deinit(&uart);
+    return result;
+}
+
+/* 大缓冲区与长数据测试 -------------------------------------------------------*/
+// 使用128KB的环形缓冲区 (例如放在外部SRAM中)，验证：
+// 1. 一次接收回调交付超过64KB的数据，读出的数据完整；
+// 2. 一次uart_write超过单次DMA上限 (65535字节) 的数据，被自动拆分为多次DMA传输；
+// 3. uart_write_timeout可以发送比整个发送队列还大的数据。
+// 注意：本测试需要约230KB的RAM，适合在PC上或带外部SRAM的板子上运行。
+
+#define LARGE_RING_SIZE (128u * 1024u)
+#define LARGE_BLOB_SIZE 100000u
+
+static uint8_t large_pattern(uint32_t i) {
+    return (uint8_t)((i * 7u) ^ (i >> 9));
+}
+
+// 每次“休眠”期间，正在进行的DMA发送完成
+static void large_transfer_wait_hook(void* handle) {
+    sim_uart_complete_tx((sim_uart_port_t*)handle);
+}
+
+led_status_t driver_uart_test_large_transfer(void) {
+    static sim_uart_port_t port;
+    static uart_t uart;
+    static uint8_t large_ring[LARGE_RING_SIZE];
+    static uint8_t blob[LARGE_BLOB_SIZE];
+    static uint8_t small_ring[16];
+    uart_span_t spans[2];
+    led_status_t result = LED_STATUS_OK;
+
+    for (uint32_t i = 0; i < LARGE_BLOB_SIZE; ++i) {
+        blob[i] = large_pattern(i);
+    }
+
+    // 1. 128KB接收缓冲区，一次交付100000字节
+    memset(&port, 0, sizeof(port));
+    if (uart_init(&uart, sim_uart_get_api(), &port, large_ring, LARGE_RING_SIZE, small_ring, sizeof(small_ring)) != LED_STATUS_OK) {
+        return LED_STATUS_ERROR;
+    }
+    sim_uart_inject(&port, blob, LARGE_BLOB_SIZE);
+    if (uart_get_bytes_available(&uart) != LARGE_BLOB_SIZE || uart_peek(&uart, spans) != LARGE_BLOB_SIZE ||
+        memcmp(spans[0].data, blob, spans[0].len) != 0 || uart_consume(&uart, LARGE_BLOB_SIZE) != LARGE_BLOB_SIZE) {
+        result = LED_STATUS_ERROR;
+    }
+    uart_deinit(&uart);
+
+    // 2. 128KB发送队列，一次写入100000字节：第一次DMA传输65535字节，第二次传输剩余部分
+    if (result == LED_STATUS_OK) {
+        memset(&port, 0, sizeof(port));
+        uart_init(&uart, sim_uart_get_api(), &port, small_ring, sizeof(small_ring), large_ring, LARGE_RING_SIZE);
+        if (uart_write(&uart, blob, LARGE_BLOB_SIZE) != LED_STATUS_OK || port.tx_len != UART_DMA_MAX_TRANSFER) {
+            result = LED_STATUS_ERROR;
+        }
+        sim_uart_complete_tx(&port);
+        if (port.tx_len != LARGE_BLOB_SIZE - UART_DMA_MAX_TRANSFER) {
+            result = LED_STATUS_ERROR;
+        }
+        sim_uart_complete_tx(&port);
+        if (port.tx_bytes != LARGE_BLOB_SIZE || port.tx_starts != 2 || uart_get_tx_pending(&uart) != 0) {
+            result = LED_STATUS_ERROR;
+        }
+        uart_deinit(&uart);
+    }
+
+    // 3. 16KB发送队列发送100000字节：uart_write直接拒绝，uart_write_timeout分批完成
+    //    已发送的数据记录在large_ring的后半部分，用于校验
+    if (result == LED_STATUS_OK) {
+        memset(&port, 0, sizeof(port));
+        port.capture = &large_ring[16u * 1024u];
+        port.capture_size = LARGE_RING_SIZE - 16u * 1024u;
+        uart_init(&uart, sim_uart_get_api(), &port, small_ring, sizeof(small_ring), large_ring, 16u * 1024u);
+        g_sim_uart_wait_hook = large_transfer_wait_hook;
+        if (uart_write(&uart, blob, LARGE_BLOB_SIZE) != LED_STATUS_INV_ARG ||
+            uart_write_timeout(&uart, blob, LARGE_BLOB_SIZE, UART_WAIT_FOREVER) != LARGE_BLOB_SIZE) {
+            result = LED_STATUS_ERROR;
+        }
+        while (port.tx_len != 0) {
+            sim_uart_complete_tx(&port);
+        }
+        if (port.tx_bytes != LARGE_BLOB_SIZE || memcmp(port.capture, blob, LARGE_BLOB_SIZE) != 0) {
+            result = LED_STATUS_ERROR;
+        }
+        g_sim_uart_wait_hook = NULL;
+        uart_deinit(&uart);
+    }
+
+    return result;
+}
+
+/* RTS流控测试 ---------------------------------------------------------------*/
+// 对端每个节拍发送1~24字节，但只在“上一个节拍”看到RTS有效时才开始发送 (模拟响应延迟)；
+// 应用层每个节拍只读3字节，远慢于对端。
+// 开启流控时必须零丢失且数据顺序正确；关闭流控作为对照，同样的负载必然溢出。
+
+#define FLOW_TEST_TOTAL_BYTES 20000u
+#define FLOW_TEST_RING_SIZE   256u
+#define FLOW_TEST_MAX_CHUNK   24u
+
+static uint8_t flow_pattern(uint32_t i) {
+    return (uint8_t)(i ^ (i >> 8));
+}
+
+// 运行一次慢消费者场景，返回丢失的字节数；数据顺序错误时返回0xFFFFFFFF
+static uint32_t flow_test_run(uint8_t enable_flow, uint32_t* pauses) {
+    static sim_uart_port_t port;
+    static uart_t uart;
+    static uint8_t rx_ring[FLOW_TEST_RING_SIZE];
+    static uint8_t tx_ring[16];
+    uint8_t chunk[FLOW_TEST_MAX_CHUNK];
+    uint8_t out[3];
+    uint32_t sent = 0;
+    uint32_t received = 0;
+    uint32_t toggles = 0;
+    uint8_t rts_seen = 1;
+    uint8_t rts_prev = 1;
+
+    memset(&port, 0, sizeof(port));
+    if (uart_init(&uart, sim_uart_get_api(), &port, rx_ring, sizeof(rx_ring), tx_ring, sizeof(tx_ring)) != LED_STATUS_OK) {
+        return 0xFFFFFFFFu;
+    }
+    if (enable_flow) {
+        // 余量：对端晚一个节拍才能看到RTS撤销，这期间最多再收到2个数据块
+        uart_set_flow_control(&uart, FLOW_TEST_RING_SIZE - 3 * FLOW_TEST_MAX_CHUNK, FLOW_TEST_RING_SIZE / 4);
+    }
+
+    while (received < sent || sent < FLOW_TEST_TOTAL_BYTES) {
+        // 对端：根据上一个节拍看到的RTS状态决定是否发送
+        if (rts_seen && sent < FLOW_TEST_TOTAL_BYTES) {
+            uint32_t n = 1 + sim_rand() % FLOW_TEST_MAX_CHUNK;
+            if (n > FLOW_TEST_TOTAL_BYTES - sent) {
+                n = FLOW_TEST_TOTAL_BYTES - sent;
+            }
+            for (uint32_t i = 0; i < n; ++i) {
+                chunk[i] = flow_pattern(sent + i);
+            }
+            sim_uart_inject(&port, chunk, n);
+            sent += n;
+        }
+        rts_seen = port.rts_ready;
+        if (port.rts_ready != rts_prev) {
+            toggles++;
+            rts_prev = port.rts_ready;
+        }
+
+        // 慢消费者：每个节拍只读3字节
+        uint32_t n = uart_read(&uart, out, sizeof(out));
+        for (uint32_t i = 0; i < n; ++i) {
+            if (out[i] != flow_pattern(received + i) && enable_flow) {
+                uart_deinit(&uart);
+                return 0xFFFFFFFFu;
+            }
+        }
+        received += n;
+
+        // 关闭流控时，溢出后received永远追不上sent，缓冲区读空即结束
+        if (sent >= FLOW_TEST_TOTAL_BYTES && n == 0) {
+            break;
+        }
+    }
+
+    if (pauses != NULL) {
+        *pauses = toggles / 2;
+    }
+    uart_deinit(&uart);
+    return sent - received;
+}
+
+led_status_t driver_uart_test_flow_control(void) {
+    uint32_t pauses = 0;
+
+    // 开启流控：零丢失，且RTS确实被多次撤销
+    if (flow_test_run(1, &pauses) != 0 || pauses == 0) {
+        return LED_STATUS_ERROR;
+    }
+    // 对照：关闭流控时同样的负载会丢失数据
+    if (flow_test_run(0, NULL) == 0) {
+        return LED_STATUS_ERROR;
+    }
+    return LED_STATUS_OK;
+}
+
+/* 合并发送基准测试 ---------------------------------------------------------*/
+// 模拟日志/回环这类负载：每个节拍 (1ms) 写入0~2条1~16字节的短消息。
+// 模拟的DMA每个节拍发送12字节 (约115200波特率)，每次启动都要付出一次设置开销。
+// 分别统计关闭和开启合并时每KB数据的DMA启动次数，以及消息从写入到发送完毕的平均/最大延迟。
+
+#define COALESCE_BENCH_TICKS      1000u
+#define COALESCE_BENCH_MAX_MSGS   (2u * COALESCE_BENCH_TICKS)
+#define COALESCE_BENCH_BYTES_TICK 12u
+
+typedef struct {
+    uint32_t starts;
+    uint32_t bytes;
+    uint32_t latency_sum;
+    uint32_t latency_max;
+    uint32_t msgs;
+} coalesce_bench_result_t;
+
+static void coalesce_bench_run(uint32_t threshold, uint32_t timeout_ms, coalesce_bench_result_t* result) {
+    static sim_uart_port_t port;
+    static uart_t uart;
+    static uint8_t rx_unused[16];
+    static uint8_t tx_ring[1024];
+    static uint32_t msg_end[COALESCE_BENCH_MAX_MSGS];
+    static uint32_t msg_tick[COALESCE_BENCH_MAX_MSGS];
+    uint8_t msg[16];
+    uint32_t written = 0;
+    uint32_t head = 0;
+    uint32_t tail = 0;
+    uint32_t seen_starts = 0;
+    uint32_t done_tick = 0;
+
+    memset(&port, 0, sizeof(port));
+    memset(result, 0, sizeof(*result));
+    g_sim_uart_tick = 0;
+    s_sim_rand = 2024;
+    uart_init(&uart, sim_uart_get_api(), &port, rx_unused, sizeof(rx_unused), tx_ring, sizeof(tx_ring));
+    uart_set_tx_coalescing(&uart, threshold, timeout_ms);
+
+    while (g_sim_uart_tick < COALESCE_BENCH_TICKS || tail < head) {
+        // DMA发送完成：结算已经完整发出的消息的延迟
+        if (port.tx_len != 0 && g_sim_uart_tick >= done_tick) {
+            sim_uart_complete_tx(&port);
+            while (tail < head && msg_end[tail] <= port.tx_bytes) {
+                uint32_t latency = g_sim_uart_tick - msg_tick[tail];
+                result->latency_sum += latency;
+                if (latency > result->latency_max) {
+                    result->latency_max = latency;
+                }
+                tail++;
+            }
+        }
+
+        // 应用层：写入若干条短消息
+        if (g_sim_uart_tick < COALESCE_BENCH_TICKS) {
+            uint32_t count = sim_rand() % 3;
+            for (uint32_t m = 0; m < count; ++m) {
+                uint32_t len = 1 + sim_rand() % sizeof(msg);
+                memset(msg, (int)('a' + m), len);
+                if (uart_write(&uart, msg, len) != LED_STATUS_OK) {
+                    continue;
+                }
+                written += len;
+                msg_end[head] = written;
+                msg_tick[head] = g_sim_uart_tick;
+                head++;
+            }
+        }
+        uart_process(&uart);
+
+        // 记录新启动的DMA，按长度计算它完成的时刻
+        if (port.tx_starts != seen_starts) {
+            seen_starts = port.tx_starts;
+            done_tick = g_sim_uart_tick + (port.tx_len + COALESCE_BENCH_BYTES_TICK - 1) / COALESCE_BENCH_BYTES_TICK;
+        }
+        g_sim_uart_tick++;
+    }
+
+    result->starts = port.tx_starts;
+    result->bytes = port.tx_bytes;
+    result->msgs = head;
+    uart_deinit(&uart);
+}
+
+void driver_uart_benchmark_coalesce(void) {
+    static const uint32_t thresholds[] = { 0, 32, 64, 128 };
+    char report[320];
+    int pos = 0;
+
+    pos += snprintf(&report[pos], sizeof(report) - pos,
+                    "coalesce benchmark (timeout 5ms)\r\nthreshold  starts/KB  avg ms x10  max ms\r\n");
+    for (uint32_t i = 0; i < sizeof(thresholds) / sizeof(thresholds[0]); ++i) {
+        coalesce_bench_result_t r;
+        coalesce_bench_run(thresholds[i], 5, &r);
+        pos += snprintf(&report[pos], sizeof(report) - pos, "%9lu  %9lu  %10lu  %6lu\r\n",
+                        (unsigned long)thresholds[i],
+                        (unsigned long)(r.bytes ? (uint64_t)r.starts * 1024u / r.bytes : 0),
+                        (unsigned long)(r.msgs ? (uint64_t)r.latency_sum * 10u / r.msgs : 0),
+                        (unsigned long)r.latency_max);
+    }
+
+    uart_write(&g_uart1, (uint8_t*)report, (uint32_t)pos);
+}
+
+/* 合并发送测试 -------------------------------------------------------------*/
+// 阈值16字节、超时5ms：验证不足阈值时不启动DMA，达到阈值、超时和显式冲刷时立即发出，
+// DMA发送期间积累的数据由完成中断接续发出，关闭合并时发出积累的数据，线路上的数据与写入顺序一致。
+
+#define COALESCE_TEST_THRESHOLD 16u
+#define COALESCE_TEST_TIMEOUT   5u
+
+// 写入len字节的递增序列，接着上一次写入的值
+static led_status_t coalesce_test_write(uart_t* uart, uint32_t len, uint8_t* next) {
+    uint8_t data[COALESCE_TEST_THRESHOLD];
+    for (uint32_t i = 0; i < len; ++i) {
+        data[i] = (*next)++;
+    }
+    return uart_write(uart, data, len);
+}
+
+led_status_t driver_uart_test_coalesce(void) {
+    static sim_uart_port_t port;
+    static uart_t uart;
+    static uint8_t rx_unused[16];
+    static uint8_t tx_ring[64];
+    static uint8_t capture[128];
+    uint8_t next = 0;
+
+    memset(&port, 0, sizeof(port));
+    port.capture = capture;
+    port.capture_size = sizeof(capture);
+    g_sim_uart_tick = 100;
+    if (uart_init(&uart, sim_uart_get_api(), &port, rx_unused, sizeof(rx_unused), tx_ring, sizeof(tx_ring)) != LED_STATUS_OK) {
+        return LED_STATUS_ERROR;
+    }
+    if (uart_set_tx_coalescing(&uart, sizeof(tx_ring) + 1, COALESCE_TEST_TIMEOUT) != LED_STATUS_INV_ARG ||
+        uart_set_tx_coalescing(&uart, COALESCE_TEST_THRESHOLD, COALESCE_TEST_TIMEOUT) != LED_STATUS_OK) {
+        return LED_STATUS_ERROR;
+    }
+
+    // 1. 超时：从第一个未发送的字节写入时开始计时，之后的写入不会推迟发送
+    coalesce_test_write(&uart, 5, &next);
+    g_sim_uart_tick = 103;
+    coalesce_test_write(&uart, 5, &next);
+    g_sim_uart_tick = 104;
+    uart_process(&uart);
+    if (port.tx_starts != 0 || uart_get_tx_pending(&uart) != 10) {
+        return LED_STATUS_ERROR;
+    }
+    g_sim_uart_tick = 105;
+    uart_process(&uart);
+    if (port.tx_starts != 1 || port.tx_len != 10) {
+        return LED_STATUS_ERROR;
+    }
+    sim_uart_complete_tx(&port);
+
+    // 2. 阈值：达到16字节时在写入中立即启动，不等超时；发出后不再有待超时的数据
+    coalesce_test_write(&uart, 10, &next);
+    if (port.tx_starts != 1) {
+        return LED_STATUS_ERROR;
+    }
+    coalesce_test_write(&uart, 6, &next);
+    if (port.tx_starts != 2 || port.tx_len != 16) {
+        return LED_STATUS_ERROR;
+    }
+    sim_uart_complete_tx(&port);
+    g_sim_uart_tick = 200;
+    uart_process(&uart);
+    if (port.tx_starts != 2 || uart_get_tx_pending(&uart) != 0) {
+        return LED_STATUS_ERROR;
+    }
+
+    // 3. 显式冲刷：不足阈值的数据立即发出，之后超时不会再启动空的发送
+    coalesce_test_write(&uart, 3, &next);
+    if (port.tx_starts != 2 || uart_flush(&uart) != LED_STATUS_OK || port.tx_starts != 3 || port.tx_len != 3) {
+        return LED_STATUS_ERROR;
+    }
+    sim_uart_complete_tx(&port);
+    g_sim_uart_tick = 300;
+    uart_process(&uart);
+    if (port.tx_starts != 3) {
+        return LED_STATUS_ERROR;
+    }
+
+    // 4. DMA发送期间写入的不足阈值的数据，由完成中断直接接续发出
+    coalesce_test_write(&uart, 16, &next);
+    coalesce_test_write(&uart, 4, &next);
+    if (port.tx_starts != 4 || port.tx_len != 16) {
+        return LED_STATUS_ERROR;
+    }
+    sim_uart_complete_tx(&port);
+    if (port.tx_starts != 5 || port.tx_len != 4) {
+        return LED_STATUS_ERROR;
+    }
+    sim_uart_complete_tx(&port);
+
+    // 5. 关闭合并：积累的数据立即发出，之后的写入不再等待
+    coalesce_test_write(&uart, 2, &next);
+    if (port.tx_starts != 5 || uart_set_tx_coalescing(&uart, 0, 0) != LED_STATUS_OK || port.tx_starts != 6) {
+        return LED_STATUS_ERROR;
+    }
+    sim_uart_complete_tx(&port);
+    coalesce_test_write(&uart, 1, &next);
+    if (port.tx_starts != 7) {
+        return LED_STATUS_ERROR;
+    }
+    sim_uart_complete_tx(&port);
+
+    // 线路上的数据与写入顺序一致
+    if (port.tx_bytes != next) {
+        return LED_STATUS_ERROR;
+    }
+    for (uint32_t i = 0; i < port.tx_bytes; ++i) {
+        if (capture[i] != (uint8_t)i) {
+            return LED_STATUS_ERROR;
+        }
+    }
+
+    uart_deinit(&uart);
+    return LED_STATUS_OK;
+}
+
+/* 接收时间戳测试 -----------------------------------------------------------*/
+// 在已知的节拍注入数据块，验证读取时得到的时间戳是最早字节所属数据块的到达时间，
+// 部分读取、跨块读取、时间戳记录溢出 (只会偏早) 都正确，延迟直方图的计数和区间正确。
+
+#define STAMP_TEST_CHUNKS 40u
+
+led_status_t driver_uart_test_rx_timestamp(void) {
+#if UART_ENABLE_RX_TIMESTAMP
+    static sim_uart_port_t port;
+    static uart_t uart;
+    static uint8_t rx_ring[256];
+    static uint8_t tx_ring[16];
+    uint8_t data[8];
+    uint8_t out[32];
+    uint32_t stamp = 0;
+    uart_rx_latency_t latency;
+
+    memset(&port, 0, sizeof(port));
+    g_sim_uart_tick = 1000;
+    if (uart_init(&uart, sim_uart_get_api(), &port, rx_ring, sizeof(rx_ring), tx_ring, sizeof(tx_ring)) != LED_STATUS_OK) {
+        return LED_STATUS_ERROR;
+    }
+    memset(data, 0x5A, sizeof(data));
+
+    // 空缓冲区没有时间戳
+    if (uart_get_rx_timestamp(&uart, &stamp) != LED_STATUS_ERROR || uart_read_stamped(&uart, out, 1, &stamp) != 0) {
+        return LED_STATUS_ERROR;
+    }
+
+    // 三个8字节的数据块分别在1000、1003、1010到达
+    sim_uart_inject(&port, data, 8);
+    g_sim_uart_tick = 1003;
+    sim_uart_inject(&port, data, 8);
+    g_sim_uart_tick = 1010;
+    sim_uart_inject(&port, data, 8);
+
+    // 1020时读5字节：时间戳为第一块，直方图记录第一块的延迟20
+    g_sim_uart_tick = 1020;
+    if (uart_read_stamped(&uart, out, 5, &stamp) != 5 || stamp != 1000) {
+        return LED_STATUS_ERROR;
+    }
+    // 读剩下的3字节+第二块的4字节：时间戳仍是第一块，第二块的延迟17
+    if (uart_read_stamped(&uart, out, 7, &stamp) != 7 || stamp != 1000) {
+        return LED_STATUS_ERROR;
+    }
+    // 从第二块中间开始，跨到第三块 (延迟10)
+    if (uart_get_rx_timestamp(&uart, &stamp) != LED_STATUS_OK || stamp != 1003) {
+        return LED_STATUS_ERROR;
+    }
+    if (uart_read(&uart, out, 12) != 12) {
+        return LED_STATUS_ERROR;
+    }
+
+    uart_get_rx_latency(&uart, &latency, 1);
+    // 20 -> [16,32) 区间5；17 -> 区间5；10 -> [8,16) 区间4
+    if (latency.count != 3 || latency.max != 20 || latency.bins[5] != 2 || latency.bins[4] != 1) {
+        return LED_STATUS_ERROR;
+    }
+    uart_get_rx_latency(&uart, &latency, 0);
+    if (latency.count != 0) {
+        return LED_STATUS_ERROR;
+    }
+
+    // 记录溢出：连续40个1字节数据块 (每节拍一个) 而不读取。第三块的记录仍被保留 (最新的记录总是保留)，
+    // 因此只有前UART_RX_STAMP_DEPTH-1个新数据块有独立的时间戳。
+    // 逐字节读取时，时间戳单调不减，且永远不晚于真实的到达时间
+    uint32_t base = g_sim_uart_tick;
+    for (uint32_t i = 0; i < STAMP_TEST_CHUNKS; ++i) {
+        g_sim_uart_tick = base + i;
+        sim_uart_inject(&port, data, 1);
+    }
+    g_sim_uart_tick = base + 100;
+    uint32_t prev = 0;
+    for (uint32_t i = 0; i < STAMP_TEST_CHUNKS; ++i) {
+        if (uart_read_stamped(&uart, out, 1, &stamp) != 1) {
+            return LED_STATUS_ERROR;
+        }
+        if (stamp > base + i || stamp < prev || (i < UART_RX_STAMP_DEPTH - 1 && stamp != base + i)) {
+            return LED_STATUS_ERROR;
+        }
+        prev = stamp;
+        // 读完之后记录被释放，新的数据块又能获得准确的时间戳
+        if (i == STAMP_TEST_CHUNKS - 1) {
+            g_sim_uart_tick = base + 200;
+            sim_uart_inject(&port, data, 1);
+            if (uart_read_stamped(&uart, out, 1, &stamp) != 1 || stamp != base + 200) {
+                return LED_STATUS_ERROR;
+            }
+        }
+    }
+
+    // 直方图格式化
+    char text[256];
+    uart_get_rx_latency(&uart, &latency, 0);
+    uint32_t text_len = uart_format_rx_latency(&latency, text, sizeof(text));
+    if (latency.count != UART_RX_STAMP_DEPTH || text_len == 0 || text_len != strlen(text)) {
+        return LED_STATUS_ERROR;
+    }
+    if (uart_format_rx_latency(&latency, text, 8) != 0 || text[0] != '\0') {
+        return LED_STATUS_ERROR;
+    }
+
+    uart_deinit(&uart);
+    return LED_STATUS_OK;
+#else
+    return LED_STATUS_NOT_SUPPORTED;
+#endif
+}
+
+/* 多生产者发送压力测试 -----------------------------------------------------*/
+// 仅在PC上运行：用多个线程代替中断和主循环，同时向同一个串口写入带编号的消息，
+// 另一个线程扮演DMA发送完成中断。发送队列只有256字节，生产者经常要争抢空间。
+// 验证发送流中每条消息都完整连续、没有交错，且每个生产者的消息按顺序、一条不少。
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <pthread.h>
+#include <sched.h>
+
+#define MPSC_PRODUCERS     4u
+#define MPSC_MESSAGES      20000u
+#define MPSC_MAX_PAYLOAD   24u
+#define MPSC_HEADER_LEN    4u
+
+typedef struct {
+    uart_t* uart;
+    uint8_t id;
+} mpsc_producer_t;
+
+static uint8_t mpsc_payload(uint8_t id, uint32_t seq, uint32_t i) {
+    return (uint8_t)(id * 31u + seq * 7u + i);
+}
+
+// 消息格式：[id][序号低8位][序号高8位][负载长度][负载]，用三种写入函数交替发送
+static void* mpsc_producer_thread(void* arg) {
+    mpsc_producer_t* p = (mpsc_producer_t*)arg;
+    uint8_t msg[MPSC_HEADER_LEN + MPSC_MAX_PAYLOAD];
+
+    for (uint32_t seq = 0; seq < MPSC_MESSAGES; ++seq) {
+        uint32_t len = 1 + (seq * 13u + p->id) % MPSC_MAX_PAYLOAD;
+        msg[0] = p->id;
+        msg[1] = (uint8_t)seq;
+        msg[2] = (uint8_t)(seq >> 8);
+        msg[3] = (uint8_t)len;
+        for (uint32_t i = 0; i < len; ++i) {
+            msg[MPSC_HEADER_LEN + i] = mpsc_payload(p->id, seq, i);
+        }
+
+        for (;;) {
+            led_status_t status;
+            if (seq % 3 == 0) {
+                status = uart_write(p->uart, msg, MPSC_HEADER_LEN + len);
+            } else if (seq % 3 == 1) {
+                uart_span_t spans[2] = { { msg, MPSC_HEADER_LEN }, { &msg[MPSC_HEADER_LEN], len } };
+                status = uart_writev(p->uart, spans, 2);
+            } else {
+                uart_span_t spans[2];
+                status = uart_write_reserve(p->uart, MPSC_HEADER_LEN + len, spans);
+                if (status == LED_STATUS_OK) {
+                    // 模拟填充过程被打断：其他生产者趁机预留并提交，它们的数据必须等本次提交后才能发出
+                    sched_yield();
+                    memcpy(spans[0].data, msg, spans[0].len);
+                    memcpy(spans[1].data, &msg[spans[0].len], spans[1].len);
+                    status = uart_write_commit(p->uart, MPSC_HEADER_LEN + len);
+                }
+            }
+            if (status == LED_STATUS_OK) {
+                break;
+            }
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+typedef struct {
+    uint8_t header[MPSC_HEADER_LEN];
+    uint32_t header_len;
+    uint32_t payload_pos;
+    uint32_t next_seq[MPSC_PRODUCERS];
+    uint32_t messages;
+    uint8_t error;
+} mpsc_parser_t;
+
+// 逐字节解析发送流
+static void mpsc_parse(mpsc_parser_t* parser, const uint8_t* data, uint32_t len) {
+    for (uint32_t i = 0; i < len && !parser->error; ++i) {
+        if (parser->header_len < MPSC_HEADER_LEN) {
+            parser->header[parser->header_len++] = data[i];
+            if (parser->header_len == MPSC_HEADER_LEN) {
+                uint8_t id = parser->header[0];
+                uint32_t seq = parser->header[1] | ((uint32_t)parser->header[2] << 8);
+                if (id >= MPSC_PRODUCERS || seq != (parser->next_seq[id] & 0xFFFFu) || parser->header[3] == 0 ||
+                    parser->header[3] > MPSC_MAX_PAYLOAD) {
+                    parser->error = 1;
+                }
+                parser->payload_pos = 0;
             }
+            continue;
+        }
+
+        uint8_t id = parser->header[0];
+        if (data[i] != mpsc_payload(id, parser->next_seq[id], parser->payload_pos)) {
+            parser->error = 1;
+        }
+        if (++parser->payload_pos == parser->header[3]) {
+            parser->next_seq[id]++;
+            parser->messages++;
+            parser->header_len = 0;
         }
+    }
+}
+
+typedef struct {
+    sim_uart_port_t* port;
+    mpsc_parser_t* parser;
+    uint32_t done;
+} mpsc_consumer_t;
+
+// “DMA发送完成中断”：解析正在发送的数据，然后调用完成回调接续下一段
+static void* mpsc_consumer_thread(void* arg) {
+    mpsc_consumer_t* c = (mpsc_consumer_t*)arg;
+    for (;;) {
+        uint32_t len = DRIVER_LOAD_ACQUIRE(&c->port->tx_len);
+        if (len != 0) {
+            mpsc_parse(c->parser, c->port->tx_data, len);
+            sim_uart_complete_tx(c->port);
+        } else if (DRIVER_LOAD_ACQUIRE(&c->done)) {
+            break;
+        } else {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+led_status_t driver_uart_test_mpsc(void) {
+    static sim_uart_port_t port;
+    static uart_t uart;
+    static uint8_t rx_unused[16];
+    static uint8_t tx_ring[256];
+    static mpsc_parser_t parser;
+    mpsc_producer_t producers[MPSC_PRODUCERS];
+    pthread_t producer_threads[MPSC_PRODUCERS];
+    pthread_t consumer_thread;
+    mpsc_consumer_t consumer = { &port, &parser, 0 };
+
+    memset(&port, 0, sizeof(port));
+    memset(&parser, 0, sizeof(parser));
+    if (uart_init(&uart, sim_uart_get_api(), &port, rx_unused, sizeof(rx_unused), tx_ring, sizeof(tx_ring)) != LED_STATUS_OK) {
+        return LED_STATUS_ERROR;
+    }
+
+    pthread_create(&consumer_thread, NULL, mpsc_consumer_thread, &consumer);
+    for (uint8_t i = 0; i < MPSC_PRODUCERS; ++i) {
+        producers[i].uart = &uart;
+        producers[i].id = i;
+        pthread_create(&producer_threads[i], NULL, mpsc_producer_thread, &producers[i]);
+    }
+    for (uint8_t i = 0; i < MPSC_PRODUCERS; ++i) {
+        pthread_join(producer_threads[i], NULL);
+    }
 
+    // 生产者全部结束后，所有数据都应该已经发布并由完成回调接续发出
+    while (uart_get_tx_pending(&uart) != 0) {
+        sched_yield();
     }
+    DRIVER_STORE_RELEASE(&consumer.done, 1);
+    pthread_join(consumer_thread, NULL);
+    uart_deinit(&uart);
+
+    if (parser.error || parser.header_len != 0 || parser.messages != MPSC_PRODUCERS * MPSC_MESSAGES) {
+        return LED_STATUS_ERROR;
+    }
+    for (uint8_t i = 0; i < MPSC_PRODUCERS; ++i) {
+        if (parser.next_seq[i] != MPSC_MESSAGES) {
+            return LED_STATUS_ERROR;
+        }
+    }
+    return LED_STATUS_OK;
 }
 
+#else
+
+led_status_t driver_uart_test_mpsc(void) {
+    return LED_STATUS_NOT_SUPPORTED;
+}
 
+#endif
@@ -3,6 +3,7 @@
 
 #include "driver_uart_bsp.h"
 #include "driver_uart.h"
+#include "driver_uart_frame.h"
 
 
 
@@ -12,6 +13,106 @@ extern "C" {
 
 void driver_uart_test(void);
 
+/**
+ * @brief 环形缓冲区吞吐量基准测试 (目标板上以DWT周期计时，PC上以纳秒计时)
+ * @note  结果通过g_uart1输出，需在g_uart1完成uart_init之后调用。
+ */
+void driver_uart_benchmark_ringbuf(void);
+
+/**
+ * @brief 多串口实例测试：同时运行4个模拟端口，验证数据互不串扰
+ * @note  使用模拟的uart_api_t，不依赖硬件。
+ * @return led_status_t - 全部校验通过返回LED_STATUS_OK
+ */
+led_status_t driver_uart_test_multi_port(void);
+
+/**
+ * @brief 循环DMA接收测试：用DMA计数器模拟器验证连续突发流量下零丢失
+ * @note  模拟HT/TC中断延迟和超过DMA缓冲区长度的无间隙突发。
+ * @return led_status_t - 收发字节完全一致返回LED_STATUS_OK
+ */
+led_status_t driver_uart_test_circular_dma(void);
+
+/**
+ * @brief 发送队列测试：验证异步写入、DMA自动接续、聚合写入和发送事件回调
+ * @return led_status_t - 线路上的数据与写入顺序完全一致返回LED_STATUS_OK
+ */
+led_status_t driver_uart_test_tx_queue(void);
+
+/**
+ * @brief 统计计数测试：验证接收/丢弃/溢出/高水位/事件计数以及快照清零
+ * @return led_status_t - 通过返回LED_STATUS_OK；未启用统计时返回LED_STATUS_NOT_SUPPORTED
+ */
+led_status_t driver_uart_test_stats(void);
+
+/**
+ * @brief 分隔符帧读取测试：验证uart_read_until/uart_peek_until跨回绕处的帧完整性
+ * @return led_status_t - 所有帧完整且内容正确返回LED_STATUS_OK
+ */
+led_status_t driver_uart_test_read_until(void);
+
+/**
+ * @brief 分隔符查找基准测试：按字并行查找与逐字节循环的对比 (目标板上以DWT周期计时，PC上以纳秒计时)
+ * @note  结果通过g_uart1输出，需在g_uart1完成uart_init之后调用。
+ */
+void driver_uart_benchmark_find(void);
+
+/**
+ * @brief 分帧器模糊测试：COBS/SLIP随机负载回环、随机切分、噪声重同步和超长帧丢弃
+ * @return led_status_t - 所有帧都被正确解码返回LED_STATUS_OK
+ */
+led_status_t driver_uart_test_frame_fuzz(void);
+
+/**
+ * @brief 分帧器吞吐量基准测试：COBS/SLIP编码和解码的每字节耗时 (目标板上以DWT周期计时，PC上以纳秒计时)
+ * @note  结果通过g_uart1输出，需在g_uart1完成uart_init之后调用。
+ */
+void driver_uart_benchmark_frame(void);
+
+/**
+ * @brief 阻塞读取测试：验证uart_read_timeout的超时精度、提前返回和数据到达回调
+ * @return led_status_t - 全部通过返回LED_STATUS_OK
+ */
+led_status_t driver_uart_test_read_timeout(void);
+
+/**
+ * @brief 大缓冲区测试：128KB环形缓冲区、超过单次DMA上限的写入和超过发送队列容量的阻塞写入
+ * @note  需要约230KB的RAM，适合在PC上或带外部SRAM的板子上运行。
+ * @return led_status_t - 全部通过返回LED_STATUS_OK
+ */
+led_status_t driver_uart_test_large_transfer(void);
+
+/**
+ * @brief RTS流控测试：对端快、应用层慢的场景下，开启水位流控后零丢失
+ * @return led_status_t - 开启流控时零丢失、关闭流控时出现丢失 (对照有效) 返回LED_STATUS_OK
+ */
+led_status_t driver_uart_test_flow_control(void);
+
+/**
+ * @brief 合并发送基准测试：对比不同合并阈值下每KB数据的DMA启动次数和消息延迟
+ * @note  结果通过g_uart1输出，需在g_uart1完成uart_init之后调用。
+ */
+void driver_uart_benchmark_coalesce(void);
+
+/**
+ * @brief 合并发送测试：验证阈值触发、超时触发 (由uart_process检查)、uart_flush和关闭合并时的发送时机
+ * @return led_status_t - 每次DMA启动的时机和长度都符合预期、线路上的数据与写入顺序一致返回LED_STATUS_OK
+ */
+led_status_t driver_uart_test_coalesce(void);
+
+/**
+ * @brief 接收时间戳测试：验证读取时得到的最早字节到达时间和延迟直方图
+ * @return led_status_t - 全部通过返回LED_STATUS_OK；UART_ENABLE_RX_TIMESTAMP为0时返回LED_STATUS_NOT_SUPPORTED
+ */
+led_status_t driver_uart_test_rx_timestamp(void);
+
+/**
+ * @brief 多生产者发送压力测试：多个线程 (代替中断和主循环) 同时写同一个串口
+ * @note  需要pthread，只能在PC上运行；在目标板上直接返回LED_STATUS_NOT_SUPPORTED。
+ * @return led_status_t - 所有消息完整、有序且没有交错返回LED_STATUS_OK
+ */
+led_status_t driver_uart_test_mpsc(void);
+
 
 #ifdef __cplusplus
 }
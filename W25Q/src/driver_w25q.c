@@ -0,0 +1,470 @@
+#include "driver_w25q.h"
+
+#include <stddef.h>
+#include "driver_atomic.h"
+
+/**
+ * @brief 当前操作
+ */
+enum {
+    W25Q_OP_NONE = 0,
+    W25Q_OP_PROGRAM,
+    W25Q_OP_ERASE,
+};
+
+/**
+ * @brief 状态机的状态
+ * @note  xxx_SENT表示对应的SPI事务已经启动，等它完成后再处理结果。
+ */
+enum {
+    W25Q_STATE_IDLE = 0,
+    W25Q_STATE_START,           /**< 准备写使能 (已经使能时直接发送指令) */
+    W25Q_STATE_WREN_SENT,       /**< 写使能已发出 */
+    W25Q_STATE_COMMAND_SENT,    /**< 编程/擦除指令已发出 */
+    W25Q_STATE_WAIT,            /**< 芯片忙，等到查询间隔后再读状态 */
+    W25Q_STATE_STATUS_SENT,     /**< 读状态已发出 */
+};
+
+/* SPI事务 ------------------------------------------------------------------*/
+
+static void spi_done_callback(spi_t* spi, led_status_t status, void* user_data) {
+    (void)spi;
+    w25q_t* flash = (w25q_t*)user_data;
+    flash->spi_status = status;
+    DRIVER_STORE_RELEASE(&flash->spi_pending, 0);
+}
+
+static void put_address(uint8_t* p, uint32_t address) {
+    p[0] = (uint8_t)(address >> 16);
+    p[1] = (uint8_t)(address >> 8);
+    p[2] = (uint8_t)address;
+}
+
+/**
+ * @brief 内部函数：启动一个 "指令 (+地址) + 可选数据段" 的异步事务
+ * @param[in] cmd_len - flash->cmd中的指令长度
+ * @param[in] tx_data - 指令之后要发送的数据，NULL表示没有
+ * @param[in] rx_data - 指令之后要接收的数据，NULL表示没有
+ * @param[in] len     - 数据段的长度
+ */
+static led_status_t start_spi(w25q_t* flash, uint16_t cmd_len, const uint8_t* tx_data, uint8_t* rx_data,
+                              uint16_t len) {
+    uint8_t count = 1;
+    flash->segments[0].tx_data = flash->cmd;
+    flash->segments[0].rx_data = NULL;
+    flash->segments[0].len = cmd_len;
+    flash->segments[0].delay_us = 0;
+    if (len != 0) {
+        flash->segments[1].tx_data = tx_data;
+        flash->segments[1].rx_data = rx_data;
+        flash->segments[1].len = len;
+        flash->segments[1].delay_us = 0;
+        count = 2;
+    }
+
+    DRIVER_STORE_RELAXED(&flash->spi_pending, 1);
+    led_status_t status = spi_transfer_async(flash->spi, flash->segments, count, spi_done_callback, flash);
+    if (status != LED_STATUS_OK) {
+        DRIVER_STORE_RELAXED(&flash->spi_pending, 0);
+    }
+    return status;
+}
+
+static uint32_t now_ms(w25q_t* flash) {
+    return flash->spi->api->get_tick();
+}
+
+/* 状态机 -------------------------------------------------------------------*/
+
+static void finish_op(w25q_t* flash, led_status_t status) {
+    w25q_callback_t callback = flash->callback;
+    void* user_data = flash->user_data;
+
+    flash->op = W25Q_OP_NONE;
+    flash->state = W25Q_STATE_IDLE;
+    flash->data = NULL;
+    flash->remaining = 0;
+    if (callback != NULL) {
+        callback(flash, status, user_data);
+    }
+}
+
+/**
+ * @brief 内部函数：发出编程 (当前页) 或擦除指令
+ */
+static led_status_t send_command(w25q_t* flash) {
+    if (flash->op == W25Q_OP_PROGRAM) {
+        // 本页剩余的空间：页编程超过页边界时会回绕到页首，所以必须在边界处拆开
+        uint32_t room = W25Q_PAGE_SIZE - (flash->address % W25Q_PAGE_SIZE);
+        flash->chunk = (uint16_t)(flash->remaining < room ? flash->remaining : room);
+        flash->cmd[0] = W25Q_CMD_PAGE_PROGRAM;
+        put_address(&flash->cmd[1], flash->address);
+        return start_spi(flash, 4, flash->data, NULL, flash->chunk);
+    }
+    flash->cmd[0] = flash->erase_cmd;
+    if (flash->erase_cmd == W25Q_CMD_CHIP_ERASE) {
+        return start_spi(flash, 1, NULL, NULL, 0);
+    }
+    put_address(&flash->cmd[1], flash->address);
+    return start_spi(flash, 4, NULL, NULL, 0);
+}
+
+/**
+ * @brief 内部函数：推进一步
+ * @return uint8_t - 还能立即继续推进时返回1，需要等待 (SPI事务进行中、芯片忙、总线被占用) 时返回0
+ */
+static uint8_t step(w25q_t* flash) {
+    if (DRIVER_LOAD_ACQUIRE(&flash->spi_pending)) {
+        return 0;
+    }
+
+    led_status_t status = LED_STATUS_OK;
+    switch (flash->state) {
+    case W25Q_STATE_START:
+        if (!flash->wel) {
+            flash->cmd[0] = W25Q_CMD_WRITE_ENABLE;
+            status = start_spi(flash, 1, NULL, NULL, 0);
+            if (status == LED_STATUS_OK) {
+                flash->state = W25Q_STATE_WREN_SENT;
+                return 1;
+            }
+            break;
+        }
+        // 写使能锁存位已经置位，直接发送指令
+        status = send_command(flash);
+        if (status == LED_STATUS_OK) {
+            flash->state = W25Q_STATE_COMMAND_SENT;
+            return 1;
+        }
+        break;
+
+    case W25Q_STATE_WREN_SENT:
+        if (flash->spi_status != LED_STATUS_OK) {
+            finish_op(flash, flash->spi_status);
+            return 0;
+        }
+        flash->wel = 1;
+        flash->state = W25Q_STATE_START;
+        return 1;
+
+    case W25Q_STATE_COMMAND_SENT:
+        if (flash->spi_status != LED_STATUS_OK) {
+            finish_op(flash, flash->spi_status);
+            return 0;
+        }
+        flash->started_at = now_ms(flash);
+        flash->polled_at = flash->started_at;
+        // 页编程 (查询间隔为0) 立即开始查询；擦除等一个查询间隔后再查询
+        flash->state = W25Q_STATE_WAIT;
+        return 1;
+
+    case W25Q_STATE_WAIT:
+        if ((uint32_t)(now_ms(flash) - flash->polled_at) < flash->poll_interval_ms) {
+            return 0;
+        }
+        flash->cmd[0] = W25Q_CMD_READ_STATUS1;
+        status = start_spi(flash, 1, NULL, &flash->status, 1);
+        if (status == LED_STATUS_OK) {
+            flash->polled_at = now_ms(flash);
+            flash->state = W25Q_STATE_STATUS_SENT;
+            return 1;
+        }
+        break;
+
+    case W25Q_STATE_STATUS_SENT:
+        if (flash->spi_status != LED_STATUS_OK) {
+            finish_op(flash, flash->spi_status);
+            return 0;
+        }
+        flash->wel = (flash->status & W25Q_STATUS_WEL) ? 1 : 0;
+        if (flash->status & W25Q_STATUS_BUSY) {
+            if ((uint32_t)(now_ms(flash) - flash->started_at) >= flash->timeout_ms) {
+                finish_op(flash, LED_STATUS_TIMEOUT);
+                return 0;
+            }
+            // 仍然忙：把CPU还给调用者，下一次w25q_process再查询
+            flash->state = W25Q_STATE_WAIT;
+            return 0;
+        }
+        if (flash->wel) {
+            // 芯片不忙但写使能仍然置位：指令被忽略了 (写保护的区域)，完成时WEL会自动清零
+            finish_op(flash, LED_STATUS_ERROR);
+            return 0;
+        }
+        if (flash->op == W25Q_OP_PROGRAM) {
+            flash->address += flash->chunk;
+            flash->data += flash->chunk;
+            flash->remaining -= flash->chunk;
+            if (flash->remaining != 0) {
+                // 每页都要重新写使能
+                flash->state = W25Q_STATE_START;
+                return 1;
+            }
+        }
+        finish_op(flash, LED_STATUS_OK);
+        return 0;
+
+    default:
+        return 0;
+    }
+
+    // 启动SPI事务失败：总线被占用时下次再试，其他错误结束操作
+    if (status != LED_STATUS_BUSY) {
+        finish_op(flash, status);
+    }
+    return 0;
+}
+
+/* 公共API ------------------------------------------------------------------*/
+
+led_status_t w25q_read_id(w25q_t* flash, uint8_t* manufacturer_id, uint16_t* device_id) {
+    if (flash == NULL || flash->spi == NULL || manufacturer_id == NULL || device_id == NULL) {
+        return LED_STATUS_INV_ARG;
+    }
+    if (flash->op != W25Q_OP_NONE) {
+        return LED_STATUS_BUSY;
+    }
+
+    uint8_t id[3] = { 0 };
+    flash->cmd[0] = W25Q_CMD_JEDEC_ID;
+    flash->segments[0].tx_data = flash->cmd;
+    flash->segments[0].rx_data = NULL;
+    flash->segments[0].len = 1;
+    flash->segments[0].delay_us = 0;
+    flash->segments[1].tx_data = NULL;
+    flash->segments[1].rx_data = id;
+    flash->segments[1].len = sizeof(id);
+    flash->segments[1].delay_us = 0;
+    led_status_t status = spi_transfer(flash->spi, flash->segments, 2);
+    if (status == LED_STATUS_OK) {
+        *manufacturer_id = id[0];
+        *device_id = (uint16_t)((id[1] << 8) | id[2]);
+    }
+    return status;
+}
+
+led_status_t w25q_init(w25q_t* flash, spi_t* spi) {
+    if (flash == NULL || spi == NULL) {
+        return LED_STATUS_INV_ARG;
+    }
+
+    flash->spi = spi;
+    flash->op = W25Q_OP_NONE;
+    flash->state = W25Q_STATE_IDLE;
+    flash->wel = 0;
+    flash->data = NULL;
+    flash->remaining = 0;
+    flash->callback = NULL;
+    flash->user_data = NULL;
+    flash->spi_pending = 0;
+    flash->spi_status = LED_STATUS_OK;
+    flash->capacity = 0;
+
+    led_status_t status = w25q_read_id(flash, &flash->manufacturer_id, &flash->device_id);
+    if (status != LED_STATUS_OK) {
+        return status;
+    }
+    // 总线上没有芯片时读到全0或全1；容量代码是2的幂次，3字节地址最多寻址16MB
+    uint8_t code = (uint8_t)flash->device_id;
+    if (flash->manufacturer_id == 0x00 || flash->manufacturer_id == 0xFF || code < 0x10 || code > 0x18) {
+        return LED_STATUS_NOT_SUPPORTED;
+    }
+    flash->capacity = 1UL << code;
+    return LED_STATUS_OK;
+}
+
+led_status_t w25q_read(w25q_t* flash, uint32_t address, uint8_t* buffer, uint32_t len) {
+    if (flash == NULL || flash->spi == NULL || buffer == NULL || len == 0) {
+        return LED_STATUS_INV_ARG;
+    }
+    if (address >= flash->capacity || len > flash->capacity - address) {
+        return LED_STATUS_INV_ARG;
+    }
+    if (flash->op != W25Q_OP_NONE) {
+        return LED_STATUS_BUSY;
+    }
+
+    while (len > 0) {
+        // 段长度是16位的，更长的读取分成多个事务
+        uint16_t chunk = (uint16_t)(len > 0x8000u ? 0x8000u : len);
+        flash->cmd[0] = W25Q_CMD_FAST_READ;
+        put_address(&flash->cmd[1], address);
+        flash->cmd[4] = 0x00; // 快速读取在地址之后需要一个空字节
+        flash->segments[0].tx_data = flash->cmd;
+        flash->segments[0].rx_data = NULL;
+        flash->segments[0].len = 5;
+        flash->segments[0].delay_us = 0;
+        flash->segments[1].tx_data = NULL;
+        flash->segments[1].rx_data = buffer;
+        flash->segments[1].len = chunk;
+        flash->segments[1].delay_us = 0;
+
+        led_status_t status = spi_transfer(flash->spi, flash->segments, 2);
+        if (status != LED_STATUS_OK) {
+            return status;
+        }
+        address += chunk;
+        buffer += chunk;
+        len -= chunk;
+    }
+    return LED_STATUS_OK;
+}
+
+led_status_t w25q_read_scatter(w25q_t* flash, uint32_t address, uint8_t* const* buffers, uint8_t count,
+                               uint16_t len) {
+    if (flash == NULL || flash->spi == NULL || buffers == NULL || count == 0 || count > W25Q_READ_MAX_BUFFERS ||
+        len == 0) {
+        return LED_STATUS_INV_ARG;
+    }
+    uint32_t total = (uint32_t)count * len;
+    if (address >= flash->capacity || total > flash->capacity - address) {
+        return LED_STATUS_INV_ARG;
+    }
+    if (flash->op != W25Q_OP_NONE) {
+        return LED_STATUS_BUSY;
+    }
+
+    // 阻塞调用，段列表放在栈上即可
+    spi_transfer_t segments[1 + W25Q_READ_MAX_BUFFERS];
+    flash->cmd[0] = W25Q_CMD_FAST_READ;
+    put_address(&flash->cmd[1], address);
+    flash->cmd[4] = 0x00;
+    segments[0].tx_data = flash->cmd;
+    segments[0].rx_data = NULL;
+    segments[0].len = 5;
+    segments[0].delay_us = 0;
+    for (uint8_t i = 0; i < count; ++i) {
+        if (buffers[i] == NULL) {
+            return LED_STATUS_INV_ARG;
+        }
+        segments[1 + i].tx_data = NULL;
+        segments[1 + i].rx_data = buffers[i];
+        segments[1 + i].len = len;
+        segments[1 + i].delay_us = 0;
+    }
+    return spi_transfer(flash->spi, segments, (uint8_t)(1 + count));
+}
+
+led_status_t w25q_program_async(w25q_t* flash, uint32_t address, const uint8_t* data, uint32_t len,
+                                w25q_callback_t callback, void* user_data) {
+    if (flash == NULL || flash->spi == NULL || data == NULL || len == 0) {
+        return LED_STATUS_INV_ARG;
+    }
+    if (address >= flash->capacity || len > flash->capacity - address) {
+        return LED_STATUS_INV_ARG;
+    }
+    if (flash->op != W25Q_OP_NONE) {
+        return LED_STATUS_BUSY;
+    }
+
+    flash->address = address;
+    flash->data = data;
+    flash->remaining = len;
+    flash->timeout_ms = W25Q_TIMEOUT_PROGRAM_MS;
+    flash->poll_interval_ms = 0;
+    flash->callback = callback;
+    flash->user_data = user_data;
+    flash->state = W25Q_STATE_START;
+    flash->op = W25Q_OP_PROGRAM;
+    return LED_STATUS_OK;
+}
+
+led_status_t w25q_erase_async(w25q_t* flash, w25q_erase_t type, uint32_t address, w25q_callback_t callback,
+                              void* user_data) {
+    if (flash == NULL || flash->spi == NULL) {
+        return LED_STATUS_INV_ARG;
+    }
+
+    uint32_t size;
+    uint8_t cmd;
+    uint32_t timeout_ms;
+    switch (type) {
+    case W25Q_ERASE_4K:
+        size = W25Q_SECTOR_SIZE;
+        cmd = W25Q_CMD_SECTOR_ERASE;
+        timeout_ms = W25Q_TIMEOUT_SECTOR_MS;
+        break;
+    case W25Q_ERASE_32K:
+        size = W25Q_BLOCK32_SIZE;
+        cmd = W25Q_CMD_BLOCK32_ERASE;
+        timeout_ms = W25Q_TIMEOUT_BLOCK32_MS;
+        break;
+    case W25Q_ERASE_64K:
+        size = W25Q_BLOCK64_SIZE;
+        cmd = W25Q_CMD_BLOCK64_ERASE;
+        timeout_ms = W25Q_TIMEOUT_BLOCK64_MS;
+        break;
+    case W25Q_ERASE_CHIP:
+        size = flash->capacity;
+        address = 0;
+        cmd = W25Q_CMD_CHIP_ERASE;
+        timeout_ms = W25Q_TIMEOUT_CHIP_MS;
+        break;
+    default:
+        return LED_STATUS_INV_ARG;
+    }
+    if ((address % size) != 0 || address >= flash->capacity) {
+        return LED_STATUS_INV_ARG;
+    }
+    if (flash->op != W25Q_OP_NONE) {
+        return LED_STATUS_BUSY;
+    }
+
+    flash->address = address;
+    flash->erase_cmd = cmd;
+    flash->timeout_ms = timeout_ms;
+    flash->poll_interval_ms = W25Q_ERASE_POLL_INTERVAL_MS;
+    flash->callback = callback;
+    flash->user_data = user_data;
+    flash->state = W25Q_STATE_START;
+    flash->op = W25Q_OP_ERASE;
+    return LED_STATUS_OK;
+}
+
+led_status_t w25q_process(w25q_t* flash) {
+    if (flash == NULL) {
+        return LED_STATUS_INV_ARG;
+    }
+    while (flash->op != W25Q_OP_NONE && step(flash)) {
+    }
+    return (flash->op != W25Q_OP_NONE) ? LED_STATUS_BUSY : LED_STATUS_OK;
+}
+
+uint8_t w25q_is_busy(w25q_t* flash) {
+    return (flash != NULL && flash->op != W25Q_OP_NONE) ? 1 : 0;
+}
+
+/* 阻塞封装 -----------------------------------------------------------------*/
+
+static void blocking_callback(w25q_t* flash, led_status_t status, void* user_data) {
+    (void)flash;
+    *(led_status_t*)user_data = status;
+}
+
+static void wait_op(w25q_t* flash) {
+    while (w25q_process(flash) == LED_STATUS_BUSY) {
+        if (flash->spi->api->wait_for_event) {
+            flash->spi->api->wait_for_event(flash->spi->handle);
+        }
+    }
+}
+
+led_status_t w25q_program(w25q_t* flash, uint32_t address, const uint8_t* data, uint32_t len) {
+    led_status_t result = LED_STATUS_ERROR;
+    led_status_t status = w25q_program_async(flash, address, data, len, blocking_callback, &result);
+    if (status != LED_STATUS_OK) {
+        return status;
+    }
+    wait_op(flash);
+    return result;
+}
+
+led_status_t w25q_erase(w25q_t* flash, w25q_erase_t type, uint32_t address) {
+    led_status_t result = LED_STATUS_ERROR;
+    led_status_t status = w25q_erase_async(flash, type, address, blocking_callback, &result);
+    if (status != LED_STATUS_OK) {
+        return status;
+    }
+    wait_op(flash);
+    return result;
+}
@@ -0,0 +1,226 @@
+#ifndef __DRIVER_W25Q_H
+#define __DRIVER_W25Q_H
+
+#include "driver_spi.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 页、扇区和块的大小
+ */
+#define W25Q_PAGE_SIZE    256u
+#define W25Q_SECTOR_SIZE  4096u
+#define W25Q_BLOCK32_SIZE 32768u
+#define W25Q_BLOCK64_SIZE 65536u
+
+/**
+ * @brief 指令
+ */
+#define W25Q_CMD_WRITE_ENABLE   0x06
+#define W25Q_CMD_WRITE_DISABLE  0x04
+#define W25Q_CMD_READ_STATUS1   0x05
+#define W25Q_CMD_FAST_READ      0x0B
+#define W25Q_CMD_PAGE_PROGRAM   0x02
+#define W25Q_CMD_SECTOR_ERASE   0x20
+#define W25Q_CMD_BLOCK32_ERASE  0x52
+#define W25Q_CMD_BLOCK64_ERASE  0xD8
+#define W25Q_CMD_CHIP_ERASE     0xC7
+#define W25Q_CMD_JEDEC_ID       0x9F
+
+/**
+ * @brief 状态寄存器1的位
+ */
+#define W25Q_STATUS_BUSY 0x01
+#define W25Q_STATUS_WEL  0x02
+
+/**
+ * @brief 各操作的最长时间 (毫秒，取数据手册的最大值)，超过后以LED_STATUS_TIMEOUT结束
+ */
+#ifndef W25Q_TIMEOUT_PROGRAM_MS
+#define W25Q_TIMEOUT_PROGRAM_MS 5
+#endif
+#ifndef W25Q_TIMEOUT_SECTOR_MS
+#define W25Q_TIMEOUT_SECTOR_MS 400
+#endif
+#ifndef W25Q_TIMEOUT_BLOCK32_MS
+#define W25Q_TIMEOUT_BLOCK32_MS 1600
+#endif
+#ifndef W25Q_TIMEOUT_BLOCK64_MS
+#define W25Q_TIMEOUT_BLOCK64_MS 2000
+#endif
+#ifndef W25Q_TIMEOUT_CHIP_MS
+#define W25Q_TIMEOUT_CHIP_MS 200000
+#endif
+
+/**
+ * @brief 擦除期间两次读状态之间的最小间隔 (毫秒)
+ * @note  擦除要几十毫秒到几秒，不需要每次w25q_process都读状态占用总线；页编程不到1毫秒，总是立即查询。
+ */
+#ifndef W25Q_ERASE_POLL_INTERVAL_MS
+#define W25Q_ERASE_POLL_INTERVAL_MS 1
+#endif
+
+/**
+ * @brief w25q_read_scatter一个事务最多的缓冲区数
+ */
+#ifndef W25Q_READ_MAX_BUFFERS
+#define W25Q_READ_MAX_BUFFERS 8
+#endif
+
+/**
+ * @brief 擦除的范围
+ */
+typedef enum {
+    W25Q_ERASE_4K = 0,          /**< 扇区擦除 (4KB) */
+    W25Q_ERASE_32K,             /**< 块擦除 (32KB) */
+    W25Q_ERASE_64K,             /**< 块擦除 (64KB) */
+    W25Q_ERASE_CHIP             /**< 整片擦除 */
+} w25q_erase_t;
+
+// 前向声明
+struct w25q_s;
+
+// 定义操作完成回调函数指针类型 (在w25q_process中被调用)
+// 参数: w25q_t* - Flash对象; status - 操作结果; void* - 用户自定义数据
+typedef void (*w25q_callback_t)(struct w25q_s* flash, led_status_t status, void* user_data);
+
+/**
+ * @brief W25Qxx系列SPI NOR Flash
+ * @note  编程和擦除是异步的：启动函数只检查参数并记录操作，之后由w25q_process一步步推进
+ * (写使能、发送指令、查询状态)，每一步只启动一次很短的SPI事务，从不等待芯片忙结束，
+ * 所以CPU在几十毫秒的擦除期间可以继续做别的事情。同一时间只能有一个编程或擦除操作。
+ */
+typedef struct w25q_s {
+    spi_t* spi;                 /**< 所属的SPI对象 */
+    uint8_t manufacturer_id;    /**< 制造商ID */
+    uint16_t device_id;         /**< 设备ID */
+    uint32_t capacity;          /**< 容量 (字节) */
+
+    // --- 异步操作 (只由启动函数和w25q_process访问) ---
+    uint8_t op;                 /**< 当前操作，0表示空闲 */
+    uint8_t state;              /**< 状态机的当前状态 */
+    uint8_t wel;                /**< 芯片的写使能锁存位 (按发出的指令和读到的状态跟踪) */
+    uint8_t erase_cmd;          /**< 擦除指令 */
+    uint32_t address;           /**< 下一次编程/擦除的地址 */
+    const uint8_t* data;        /**< 剩余的编程数据 */
+    uint32_t remaining;         /**< 剩余的编程字节数 */
+    uint16_t chunk;             /**< 本次页编程的字节数 */
+    uint32_t timeout_ms;        /**< 本次编程/擦除的超时时间 */
+    uint32_t poll_interval_ms;  /**< 查询状态的最小间隔 */
+    uint32_t started_at;        /**< 指令发出的时刻 */
+    uint32_t polled_at;         /**< 上一次查询状态的时刻 */
+    w25q_callback_t callback;   /**< 操作完成回调 */
+    void* user_data;            /**< 传递给回调函数的用户自定义数据 */
+
+    // --- 正在进行的SPI事务 ---
+    uint8_t cmd[5];             /**< 指令和地址 */
+    uint8_t status;             /**< 读到的状态寄存器 */
+    spi_transfer_t segments[2]; /**< 事务的段列表 */
+    uint32_t spi_pending;       /**< SPI事务进行中 (完成回调中清零) */
+    led_status_t spi_status;    /**< SPI事务的结果 */
+} w25q_t;
+
+/**
+ * @brief  初始化W25Q对象：读取JEDEC ID并确定容量
+ * @param[in] flash - 指向w25q_t对象的指针
+ * @param[in] spi   - 已初始化的spi_t对象
+ * @return led_status_t - 操作的状态码。ID无法识别或容量超过16MB (需要4字节地址) 时返回LED_STATUS_NOT_SUPPORTED
+ */
+led_status_t w25q_init(w25q_t* flash, spi_t* spi);
+
+/**
+ * @brief  读取JEDEC ID
+ * @param[in]  flash           - 指向w25q_t对象的指针
+ * @param[out] manufacturer_id - 制造商ID
+ * @param[out] device_id       - 设备ID (存储器类型 << 8 | 容量代码)
+ * @return led_status_t - 操作的状态码
+ */
+led_status_t w25q_read_id(w25q_t* flash, uint8_t* manufacturer_id, uint16_t* device_id);
+
+/**
+ * @brief  快速读取 (0x0B)，等待其完成
+ * @note   编程或擦除进行中时芯片不响应读取，返回LED_STATUS_BUSY。
+ * @param[in]  flash   - 指向w25q_t对象的指针
+ * @param[in]  address - 起始地址
+ * @param[out] buffer  - 存放数据的缓冲区
+ * @param[in]  len     - 读取长度
+ * @return led_status_t - 操作的状态码
+ */
+led_status_t w25q_read(w25q_t* flash, uint32_t address, uint8_t* buffer, uint32_t len);
+
+/**
+ * @brief  在一个快速读取事务中读取连续的count * len字节，依次分散存放到count个缓冲区
+ * @note   用于把相邻的几块数据直接读进各自的缓冲区，只发送一次指令和地址。
+ * 编程或擦除进行中时返回LED_STATUS_BUSY。
+ * @param[in]  flash   - 指向w25q_t对象的指针
+ * @param[in]  address - 起始地址
+ * @param[out] buffers - count个缓冲区，每个len字节
+ * @param[in]  count   - 缓冲区个数 (1 ~ W25Q_READ_MAX_BUFFERS)
+ * @param[in]  len     - 每个缓冲区的长度
+ * @return led_status_t - 操作的状态码
+ */
+led_status_t w25q_read_scatter(w25q_t* flash, uint32_t address, uint8_t* const* buffers, uint8_t count,
+                               uint16_t len);
+
+/**
+ * @brief  开始一个编程操作，立即返回
+ * @note   数据按256字节的页边界自动拆分，每页单独写使能、编程、查询完成。
+ * 操作完成之前data必须保持有效，编程只能把1变成0，目标区域应先擦除。
+ * @param[in] flash     - 指向w25q_t对象的指针
+ * @param[in] address   - 起始地址
+ * @param[in] data      - 要写入的数据
+ * @param[in] len       - 数据长度
+ * @param[in] callback  - 完成回调，可以为NULL
+ * @param[in] user_data - 传递给回调函数的用户自定义数据
+ * @return led_status_t - 操作的状态码。已有操作进行中时返回LED_STATUS_BUSY
+ */
+led_status_t w25q_program_async(w25q_t* flash, uint32_t address, const uint8_t* data, uint32_t len,
+                                w25q_callback_t callback, void* user_data);
+
+/**
+ * @brief  开始一个擦除操作，立即返回
+ * @param[in] flash     - 指向w25q_t对象的指针
+ * @param[in] type      - 擦除范围
+ * @param[in] address   - 起始地址，必须按擦除范围对齐 (整片擦除时忽略)
+ * @param[in] callback  - 完成回调，可以为NULL
+ * @param[in] user_data - 传递给回调函数的用户自定义数据
+ * @return led_status_t - 操作的状态码。地址未对齐返回LED_STATUS_INV_ARG，已有操作进行中时返回LED_STATUS_BUSY
+ */
+led_status_t w25q_erase_async(w25q_t* flash, w25q_erase_t type, uint32_t address, w25q_callback_t callback,
+                              void* user_data);
+
+/**
+ * @brief  推进正在进行的编程/擦除操作 (在主循环中反复调用)
+ * @note   从不等待：SPI事务进行中或芯片仍忙时直接返回。操作结束时在这里调用完成回调。
+ * @param[in] flash - 指向w25q_t对象的指针
+ * @return led_status_t - 操作进行中返回LED_STATUS_BUSY，空闲返回LED_STATUS_OK
+ */
+led_status_t w25q_process(w25q_t* flash);
+
+/**
+ * @brief  查询是否有编程/擦除操作正在进行
+ * @param[in] flash - 指向w25q_t对象的指针
+ * @return uint8_t - 进行中返回1，否则返回0
+ */
+uint8_t w25q_is_busy(w25q_t* flash);
+
+/**
+ * @brief  编程并等待完成 (阻塞封装，等待期间反复调用w25q_process)
+ * @return led_status_t - 操作的状态码
+ */
+led_status_t w25q_program(w25q_t* flash, uint32_t address, const uint8_t* data, uint32_t len);
+
+/**
+ * @brief  擦除并等待完成 (阻塞封装，等待期间反复调用w25q_process)
+ * @return led_status_t - 操作的状态码
+ */
+led_status_t w25q_erase(w25q_t* flash, w25q_erase_t type, uint32_t address);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __DRIVER_W25Q_H
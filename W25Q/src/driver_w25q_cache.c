@@ -0,0 +1,271 @@
+#include "driver_w25q_cache.h"
+
+#include <stddef.h>
+#include <string.h>
+
+// 还没有访问过任何块
+#define W25Q_CACHE_NO_BLOCK 0xFFFFFFFFu
+
+/* 缓存行 -------------------------------------------------------------------*/
+
+static uint8_t* line_data(w25q_cache_t* cache, w25q_cache_line_t* line) {
+    return cache->data + ((uint32_t)(line - cache->lines) << cache->block_shift);
+}
+
+static w25q_cache_line_t* find_line(w25q_cache_t* cache, uint32_t block) {
+    w25q_cache_line_t* set = &cache->lines[(block % cache->sets) * cache->ways];
+    for (uint8_t i = 0; i < cache->ways; ++i) {
+        if (set[i].valid && set[i].block == block) {
+            return &set[i];
+        }
+    }
+    return NULL;
+}
+
+// 选择替换的行：优先空行，否则最久没有访问的行 (按差值比较，时间戳回绕后仍然正确)
+static w25q_cache_line_t* victim_line(w25q_cache_t* cache, uint32_t block) {
+    w25q_cache_line_t* set = &cache->lines[(block % cache->sets) * cache->ways];
+    w25q_cache_line_t* victim = &set[0];
+    for (uint8_t i = 0; i < cache->ways; ++i) {
+        if (!set[i].valid) {
+            return &set[i];
+        }
+        if (cache->clock - set[i].used_at > cache->clock - victim->used_at) {
+            victim = &set[i];
+        }
+    }
+    return victim;
+}
+
+static void touch(w25q_cache_t* cache, w25q_cache_line_t* line) {
+    line->used_at = ++cache->clock;
+}
+
+/**
+ * @brief 内部函数：把块读入缓存，顺序访问时一并预读后面的块
+ * @return w25q_cache_line_t* - 装入block的行，读取失败返回NULL (状态码写入status)
+ */
+static w25q_cache_line_t* fill(w25q_cache_t* cache, uint32_t block, led_status_t* status) {
+    uint8_t count = 1;
+    if (cache->readahead != 0 && cache->sequential != 0) {
+        // 预读到已经缓存的块或者Flash末尾为止
+        uint32_t blocks = cache->flash->capacity >> cache->block_shift;
+        while (count <= cache->readahead && block + count < blocks && find_line(cache, block + count) == NULL) {
+            count++;
+        }
+    }
+
+    // 相邻的块落在不同的组 (预读块数小于组数)，选出的行互不相同。
+    // 读取成功之前不动行的状态：Flash忙时读取直接返回BUSY，被选中的行仍然可以命中
+    w25q_cache_line_t* lines[W25Q_READ_MAX_BUFFERS];
+    uint8_t* buffers[W25Q_READ_MAX_BUFFERS];
+    for (uint8_t i = 0; i < count; ++i) {
+        lines[i] = victim_line(cache, block + i);
+        buffers[i] = line_data(cache, lines[i]);
+    }
+
+    *status = w25q_read_scatter(cache->flash, block << cache->block_shift, buffers, count, cache->block_size);
+    if (*status != LED_STATUS_OK) {
+        // 传输已经开始过，行的数据可能已被部分覆盖
+        if (*status != LED_STATUS_INV_ARG && *status != LED_STATUS_BUSY) {
+            for (uint8_t i = 0; i < count; ++i) {
+                lines[i]->valid = 0;
+            }
+        }
+        return NULL;
+    }
+    cache->stats.flash_reads++;
+    cache->stats.prefetched += count - 1u;
+    for (uint8_t i = 0; i < count; ++i) {
+        lines[i]->block = block + i;
+        lines[i]->valid = 1;
+        lines[i]->prefetched = (i != 0);
+        touch(cache, lines[i]);
+    }
+    return lines[0];
+}
+
+/* 接口函数 -----------------------------------------------------------------*/
+
+led_status_t w25q_cache_init(w25q_cache_t* cache, w25q_t* flash, w25q_cache_line_t* lines, uint8_t* data,
+                             uint16_t block_size, uint16_t sets, uint8_t ways) {
+    if (cache == NULL || flash == NULL || lines == NULL || data == NULL || sets == 0 || ways == 0) {
+        return LED_STATUS_INV_ARG;
+    }
+    // 块长度必须是2的幂次，这样块不会跨越扇区
+    if (block_size < 16 || block_size > W25Q_CACHE_MAX_BLOCK_SIZE || (block_size & (block_size - 1)) != 0) {
+        return LED_STATUS_INV_ARG;
+    }
+
+    cache->flash = flash;
+    cache->lines = lines;
+    cache->data = data;
+    cache->block_size = block_size;
+    cache->block_shift = 0;
+    while ((1u << cache->block_shift) < block_size) {
+        cache->block_shift++;
+    }
+    cache->sets = sets;
+    cache->ways = ways;
+    cache->readahead = 0;
+    cache->clock = 0;
+    cache->last_block = W25Q_CACHE_NO_BLOCK;
+    cache->sequential = 0;
+    memset(lines, 0, (size_t)sets * ways * sizeof(w25q_cache_line_t));
+    memset(&cache->stats, 0, sizeof(cache->stats));
+    return LED_STATUS_OK;
+}
+
+led_status_t w25q_cache_set_readahead(w25q_cache_t* cache, uint8_t blocks) {
+    if (cache == NULL) {
+        return LED_STATUS_INV_ARG;
+    }
+    if (blocks >= W25Q_READ_MAX_BUFFERS || blocks >= cache->sets) {
+        return LED_STATUS_INV_ARG;
+    }
+    cache->readahead = blocks;
+    return LED_STATUS_OK;
+}
+
+led_status_t w25q_cache_read(w25q_cache_t* cache, uint32_t address, uint8_t* buffer, uint32_t len) {
+    if (cache == NULL || buffer == NULL || len == 0) {
+        return LED_STATUS_INV_ARG;
+    }
+    if (address >= cache->flash->capacity || len > cache->flash->capacity - address) {
+        return LED_STATUS_INV_ARG;
+    }
+
+    while (len > 0) {
+        uint32_t block = address >> cache->block_shift;
+        uint32_t offset = address & (cache->block_size - 1u);
+        uint32_t n = cache->block_size - offset;
+        if (n > len) {
+            n = len;
+        }
+
+        // 顺序访问检测：连续访问相邻的块
+        if (cache->last_block != W25Q_CACHE_NO_BLOCK && block == cache->last_block + 1) {
+            if (cache->sequential < 0xFF) {
+                cache->sequential++;
+            }
+        } else if (block != cache->last_block) {
+            cache->sequential = 0;
+        }
+        cache->last_block = block;
+
+        w25q_cache_line_t* line = find_line(cache, block);
+        if (line != NULL) {
+            cache->stats.hits++;
+            if (line->prefetched) {
+                line->prefetched = 0;
+                cache->stats.prefetch_hits++;
+            }
+            touch(cache, line);
+        } else {
+            led_status_t status;
+            cache->stats.misses++;
+            line = fill(cache, block, &status);
+            if (line == NULL) {
+                return status;
+            }
+        }
+
+        memcpy(buffer, line_data(cache, line) + offset, n);
+        address += n;
+        buffer += n;
+        len -= n;
+    }
+    return LED_STATUS_OK;
+}
+
+void w25q_cache_invalidate(w25q_cache_t* cache, uint32_t address, uint32_t len) {
+    if (cache == NULL || len == 0) {
+        return;
+    }
+    uint32_t first = address >> cache->block_shift;
+    uint32_t last = (address + (len - 1u)) >> cache->block_shift;
+    uint32_t count = (uint32_t)cache->sets * cache->ways;
+    for (uint32_t i = 0; i < count; ++i) {
+        w25q_cache_line_t* line = &cache->lines[i];
+        if (line->valid && line->block >= first && line->block <= last) {
+            line->valid = 0;
+            cache->stats.invalidations++;
+        }
+    }
+}
+
+// 擦除覆盖的地址范围
+static uint32_t erase_size(w25q_cache_t* cache, w25q_erase_t type) {
+    switch (type) {
+    case W25Q_ERASE_4K:
+        return W25Q_SECTOR_SIZE;
+    case W25Q_ERASE_32K:
+        return W25Q_BLOCK32_SIZE;
+    case W25Q_ERASE_64K:
+        return W25Q_BLOCK64_SIZE;
+    default:
+        return cache->flash->capacity;
+    }
+}
+
+led_status_t w25q_cache_program_async(w25q_cache_t* cache, uint32_t address, const uint8_t* data, uint32_t len,
+                                      w25q_callback_t callback, void* user_data) {
+    if (cache == NULL) {
+        return LED_STATUS_INV_ARG;
+    }
+    led_status_t status = w25q_program_async(cache->flash, address, data, len, callback, user_data);
+    if (status == LED_STATUS_OK) {
+        // 操作进行中Flash不响应读取，失效的行要等操作结束后才会重新装入
+        w25q_cache_invalidate(cache, address, len);
+    }
+    return status;
+}
+
+led_status_t w25q_cache_erase_async(w25q_cache_t* cache, w25q_erase_t type, uint32_t address,
+                                    w25q_callback_t callback, void* user_data) {
+    if (cache == NULL) {
+        return LED_STATUS_INV_ARG;
+    }
+    led_status_t status = w25q_erase_async(cache->flash, type, address, callback, user_data);
+    if (status == LED_STATUS_OK) {
+        w25q_cache_invalidate(cache, (type == W25Q_ERASE_CHIP) ? 0 : address, erase_size(cache, type));
+    }
+    return status;
+}
+
+led_status_t w25q_cache_program(w25q_cache_t* cache, uint32_t address, const uint8_t* data, uint32_t len) {
+    if (cache == NULL) {
+        return LED_STATUS_INV_ARG;
+    }
+    // 失败时芯片上的数据可能已经部分改变，无论结果如何都要失效
+    led_status_t status = w25q_program(cache->flash, address, data, len);
+    if (status != LED_STATUS_INV_ARG && status != LED_STATUS_BUSY) {
+        w25q_cache_invalidate(cache, address, len);
+    }
+    return status;
+}
+
+led_status_t w25q_cache_erase(w25q_cache_t* cache, w25q_erase_t type, uint32_t address) {
+    if (cache == NULL) {
+        return LED_STATUS_INV_ARG;
+    }
+    led_status_t status = w25q_erase(cache->flash, type, address);
+    if (status != LED_STATUS_INV_ARG && status != LED_STATUS_BUSY) {
+        w25q_cache_invalidate(cache, (type == W25Q_ERASE_CHIP) ? 0 : address, erase_size(cache, type));
+    }
+    return status;
+}
+
+void w25q_cache_get_stats(w25q_cache_t* cache, w25q_cache_stats_t* stats) {
+    if (cache == NULL || stats == NULL) {
+        return;
+    }
+    *stats = cache->stats;
+}
+
+void w25q_cache_reset_stats(w25q_cache_t* cache) {
+    if (cache == NULL) {
+        return;
+    }
+    memset(&cache->stats, 0, sizeof(cache->stats));
+}
@@ -0,0 +1,146 @@
+#ifndef __DRIVER_W25Q_CACHE_H
+#define __DRIVER_W25Q_CACHE_H
+
+#include "driver_w25q.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 缓存块的最大长度 (一个扇区)
+ */
+#define W25Q_CACHE_MAX_BLOCK_SIZE W25Q_SECTOR_SIZE
+
+/**
+ * @brief 缓存行
+ */
+typedef struct {
+    uint32_t block;             /**< 缓存的块号 (地址 / 块长度) */
+    uint32_t used_at;           /**< 最近一次访问的时间戳，用于LRU替换 */
+    uint8_t valid;              /**< 行中的数据有效 */
+    uint8_t prefetched;         /**< 由预读装入，还没有被访问过 */
+} w25q_cache_line_t;
+
+/**
+ * @brief 缓存统计
+ */
+typedef struct {
+    uint32_t hits;              /**< 命中的块访问次数 */
+    uint32_t misses;            /**< 未命中的块访问次数 */
+    uint32_t flash_reads;       /**< 向Flash发出的读取事务数 */
+    uint32_t prefetched;        /**< 预读装入的块数 */
+    uint32_t prefetch_hits;     /**< 预读装入后被访问到的块数 */
+    uint32_t invalidations;     /**< 因编程/擦除而失效的行数 */
+} w25q_cache_stats_t;
+
+/**
+ * @brief W25Q读缓存：N路组相联、LRU替换
+ * @note  块号按 (块号 % 组数) 映射到组，每组ways行。读取未命中时把整块读入缓存；
+ * 连续访问相邻的块时，一次读取事务同时装入后面的若干块 (预读)。
+ * 编程和擦除直接写入Flash (写直达)，并使覆盖到的行失效，所以缓存中的数据总是与Flash一致。
+ * 编程和擦除必须通过本模块的函数进行，否则需要自行调用w25q_cache_invalidate。
+ */
+typedef struct {
+    w25q_t* flash;              /**< 所属的Flash对象 */
+    w25q_cache_line_t* lines;   /**< 缓存行 (sets * ways个，由调用者提供) */
+    uint8_t* data;              /**< 缓存数据 (sets * ways * block_size字节，由调用者提供) */
+    uint16_t block_size;        /**< 块长度 */
+    uint8_t block_shift;        /**< log2(block_size) */
+    uint16_t sets;              /**< 组数 */
+    uint8_t ways;               /**< 每组的行数 */
+    uint8_t readahead;          /**< 检测到顺序访问时预读的块数，0表示不预读 */
+    uint32_t clock;             /**< LRU时间戳 */
+    uint32_t last_block;        /**< 上一次访问的块号 */
+    uint8_t sequential;         /**< 连续访问相邻块的次数 */
+    w25q_cache_stats_t stats;   /**< 统计 */
+} w25q_cache_t;
+
+/**
+ * @brief  初始化缓存
+ * @param[in] cache      - 指向w25q_cache_t对象的指针
+ * @param[in] flash      - 已初始化的w25q_t对象
+ * @param[in] lines      - sets * ways个缓存行
+ * @param[in] data       - sets * ways * block_size字节的数据区
+ * @param[in] block_size - 块长度，2的幂次，16 ~ W25Q_CACHE_MAX_BLOCK_SIZE
+ * @param[in] sets       - 组数
+ * @param[in] ways       - 每组的行数 (相联度)
+ * @return led_status_t - 操作的状态码
+ */
+led_status_t w25q_cache_init(w25q_cache_t* cache, w25q_t* flash, w25q_cache_line_t* lines, uint8_t* data,
+                             uint16_t block_size, uint16_t sets, uint8_t ways);
+
+/**
+ * @brief  设置预读的块数 (默认0，不预读)
+ * @note   连续访问两个相邻的块后，下一次未命中时一并读入后面的blocks个块。
+ * 受W25Q_READ_MAX_BUFFERS和组数限制 (相邻的块落在不同的组，互不替换)。
+ * @param[in] cache  - 指向w25q_cache_t对象的指针
+ * @param[in] blocks - 预读的块数
+ * @return led_status_t - 操作的状态码
+ */
+led_status_t w25q_cache_set_readahead(w25q_cache_t* cache, uint8_t blocks);
+
+/**
+ * @brief  经过缓存读取
+ * @note   全部命中时不访问Flash，即使Flash正在编程或擦除；需要访问Flash而Flash忙时返回LED_STATUS_BUSY。
+ * @param[in]  cache   - 指向w25q_cache_t对象的指针
+ * @param[in]  address - 起始地址
+ * @param[out] buffer  - 存放数据的缓冲区
+ * @param[in]  len     - 读取长度
+ * @return led_status_t - 操作的状态码
+ */
+led_status_t w25q_cache_read(w25q_cache_t* cache, uint32_t address, uint8_t* buffer, uint32_t len);
+
+/**
+ * @brief  使覆盖[address, address + len)的缓存行失效
+ * @param[in] cache   - 指向w25q_cache_t对象的指针
+ * @param[in] address - 起始地址
+ * @param[in] len     - 长度
+ */
+void w25q_cache_invalidate(w25q_cache_t* cache, uint32_t address, uint32_t len);
+
+/**
+ * @brief  开始一个编程操作 (见w25q_program_async)，并使覆盖到的缓存行失效
+ * @return led_status_t - 操作的状态码
+ */
+led_status_t w25q_cache_program_async(w25q_cache_t* cache, uint32_t address, const uint8_t* data, uint32_t len,
+                                      w25q_callback_t callback, void* user_data);
+
+/**
+ * @brief  开始一个擦除操作 (见w25q_erase_async)，并使覆盖到的缓存行失效
+ * @return led_status_t - 操作的状态码
+ */
+led_status_t w25q_cache_erase_async(w25q_cache_t* cache, w25q_erase_t type, uint32_t address,
+                                    w25q_callback_t callback, void* user_data);
+
+/**
+ * @brief  编程并等待完成 (见w25q_program)，并使覆盖到的缓存行失效
+ * @return led_status_t - 操作的状态码
+ */
+led_status_t w25q_cache_program(w25q_cache_t* cache, uint32_t address, const uint8_t* data, uint32_t len);
+
+/**
+ * @brief  擦除并等待完成 (见w25q_erase)，并使覆盖到的缓存行失效
+ * @return led_status_t - 操作的状态码
+ */
+led_status_t w25q_cache_erase(w25q_cache_t* cache, w25q_erase_t type, uint32_t address);
+
+/**
+ * @brief  读取统计
+ * @param[in]  cache - 指向w25q_cache_t对象的指针
+ * @param[out] stats - 统计
+ */
+void w25q_cache_get_stats(w25q_cache_t* cache, w25q_cache_stats_t* stats);
+
+/**
+ * @brief  清零统计
+ * @param[in] cache - 指向w25q_cache_t对象的指针
+ */
+void w25q_cache_reset_stats(w25q_cache_t* cache);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __DRIVER_W25Q_CACHE_H
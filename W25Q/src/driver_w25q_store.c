@@ -0,0 +1,639 @@
+#include "driver_w25q_store.h"
+
+#include <stddef.h>
+#include <string.h>
+#include "driver_crc.h"
+
+/* 存储格式 -----------------------------------------------------------------*/
+// 扇区头 (20字节，小端)：
+//   0  magic        擦除完成后写入，与erase_count、erase_crc一起表示扇区已擦除
+//   4  erase_count
+//   8  erase_crc    CRC-16/CCITT (magic, erase_count)
+//   10 seq_crc      CRC-16/CCITT (seq)，分配为头扇区时与seq一起写入
+//   12 seq
+//   16 released     0xFF表示有效，其他值表示已释放 (只需把这一个字节写成0)
+// 记录 (按4字节对齐)：
+//   0  commit       0xFF表示未提交，数据编程完成后写成W25Q_STORE_COMMITTED
+//   1  保留 (0xFF)
+//   2  len
+//   4  crc          CRC-32 (len, 数据)
+//   8  数据，补0xFF到4字节对齐
+// 每个字段都只从擦除状态写一次，掉电时写了一半的字段由CRC或提交标记识别出来。
+
+#define W25Q_STORE_MAGIC     0x4C353257u // "W25L"
+#define W25Q_STORE_COMMITTED 0x00
+
+#define W25Q_STORE_HDR_MAGIC       0
+#define W25Q_STORE_HDR_ERASE_COUNT 4
+#define W25Q_STORE_HDR_ERASE_CRC   8
+#define W25Q_STORE_HDR_SEQ_CRC     10
+#define W25Q_STORE_HDR_SEQ         12
+#define W25Q_STORE_HDR_RELEASED    16
+
+// 挂载时擦除次数未知的扇区
+#define W25Q_STORE_UNKNOWN_COUNT 0xFFFFFFFFu
+
+/**
+ * @brief 正在进行的Flash操作
+ */
+enum {
+    W25Q_STORE_OP_NONE = 0,
+    W25Q_STORE_OP_OPEN,         /**< 写入序号，分配为头扇区 */
+    W25Q_STORE_OP_BODY,         /**< 写入记录头和数据 */
+    W25Q_STORE_OP_COMMIT,       /**< 写入提交标记 */
+    W25Q_STORE_OP_RELEASE,      /**< 写入释放标记 */
+    W25Q_STORE_OP_ERASE,        /**< 擦除扇区 */
+    W25Q_STORE_OP_FORMAT,       /**< 擦除后写入扇区头 */
+};
+
+static void put_le16(uint8_t* p, uint16_t value) {
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+}
+
+static void put_le32(uint8_t* p, uint32_t value) {
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+    p[2] = (uint8_t)(value >> 16);
+    p[3] = (uint8_t)(value >> 24);
+}
+
+static uint16_t get_le16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_le32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint32_t sector_address(w25q_store_t* store, uint16_t index) {
+    return (store->first_sector + index) * W25Q_SECTOR_SIZE;
+}
+
+static uint32_t record_crc(const uint8_t* len_field, const void* data, uint32_t len) {
+    uint32_t crc = crc32_update(crc32_init(), len_field, 2);
+    return crc32_final(crc32_update(crc, data, len));
+}
+
+/* 扇区索引 -----------------------------------------------------------------*/
+
+// 指定状态的扇区中擦除次数最少的一个，次数相同时按头扇区之后的顺序，没有时返回sector_count
+static uint16_t least_worn(w25q_store_t* store, uint8_t state) {
+    uint16_t best = store->sector_count;
+    uint16_t start = (store->head < store->sector_count) ? (uint16_t)(store->head + 1) : 0;
+    for (uint16_t k = 0; k < store->sector_count; ++k) {
+        uint16_t i = (uint16_t)((start + k) % store->sector_count);
+        if (store->sectors[i].state == state &&
+            (best == store->sector_count || store->sectors[i].erase_count < store->sectors[best].erase_count)) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+static uint16_t count_state(w25q_store_t* store, uint8_t state) {
+    uint16_t count = 0;
+    for (uint16_t i = 0; i < store->sector_count; ++i) {
+        if (store->sectors[i].state == state) {
+            count++;
+        }
+    }
+    return count;
+}
+
+static uint16_t find_seq(w25q_store_t* store, uint32_t seq) {
+    for (uint16_t i = 0; i < store->sector_count; ++i) {
+        if (store->sectors[i].state == W25Q_STORE_SECTOR_USED && store->sectors[i].seq == seq) {
+            return i;
+        }
+    }
+    return store->sector_count;
+}
+
+// 序号大于seq (after为0时不小于seq) 的扇区中最旧的一个
+static uint16_t find_oldest(w25q_store_t* store, uint32_t seq, uint8_t after) {
+    uint16_t best = store->sector_count;
+    for (uint16_t i = 0; i < store->sector_count; ++i) {
+        w25q_store_sector_t* sector = &store->sectors[i];
+        if (sector->state == W25Q_STORE_SECTOR_USED && (after ? sector->seq > seq : sector->seq >= seq) &&
+            (best == store->sector_count || sector->seq < store->sectors[best].seq)) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+/* 追加缓冲区 ---------------------------------------------------------------*/
+// 记录在缓冲区中连续存放，末尾放不下时回绕到开头 (wrap记录回绕前的数据末尾)。
+
+static void buffer_reset(w25q_store_t* store) {
+    store->rd = 0;
+    store->wr = 0;
+    store->wrap = 0;
+    store->pending = 0;
+    store->pending_bytes = 0;
+    store->body_written = 0;
+}
+
+static uint8_t* buffer_reserve(w25q_store_t* store, uint32_t size) {
+    if (store->pending == 0) {
+        buffer_reset(store);
+    }
+    if (store->wrap == 0) {
+        // 没有回绕：数据在[rd, wr)
+        if (store->buffer_size - store->wr >= size) {
+            return &store->buffer[store->wr];
+        }
+        if (store->rd >= size) {
+            store->wrap = store->wr;
+            store->wr = 0;
+            return store->buffer;
+        }
+        return NULL;
+    }
+    // 已回绕：数据在[rd, wrap)和[0, wr)
+    return (store->rd - store->wr >= size) ? &store->buffer[store->wr] : NULL;
+}
+
+static uint32_t buffer_front_size(w25q_store_t* store) {
+    return W25Q_STORE_RECORD_SIZE(get_le16(&store->buffer[store->rd + 2]));
+}
+
+static void buffer_pop(w25q_store_t* store) {
+    uint32_t size = buffer_front_size(store);
+    store->rd += size;
+    store->pending--;
+    store->pending_bytes -= size;
+    if (store->wrap != 0 && store->rd == store->wrap) {
+        store->rd = 0;
+        store->wrap = 0;
+    }
+    if (store->pending == 0) {
+        buffer_reset(store);
+    }
+}
+
+/* Flash操作 ----------------------------------------------------------------*/
+
+static void op_done(w25q_t* flash, led_status_t status, void* user_data) {
+    (void)flash;
+    w25q_store_t* store = (w25q_store_t*)user_data;
+    w25q_store_sector_t* sector = &store->sectors[store->op_sector];
+    uint8_t op = store->op;
+    store->op = W25Q_STORE_OP_NONE;
+
+    if (status != LED_STATUS_OK) {
+        store->stats.errors++;
+        if (op == W25Q_STORE_OP_BODY || op == W25Q_STORE_OP_COMMIT) {
+            // 不再往这个扇区追加，记录在下一个扇区中重写
+            store->head_sealed = 1;
+            store->body_written = 0;
+        } else {
+            // 扇区内容不确定，擦除后重新使用
+            sector->state = W25Q_STORE_SECTOR_DIRTY;
+        }
+        return;
+    }
+
+    switch (op) {
+    case W25Q_STORE_OP_OPEN:
+        sector->state = W25Q_STORE_SECTOR_USED;
+        sector->seq = store->next_seq++;
+        store->head = store->op_sector;
+        store->head_offset = W25Q_STORE_HEADER_SIZE;
+        store->head_sealed = 0;
+        break;
+    case W25Q_STORE_OP_BODY:
+        store->body_written = 1;
+        break;
+    case W25Q_STORE_OP_COMMIT:
+        store->body_written = 0;
+        buffer_pop(store);
+        store->stats.committed++;
+        break;
+    case W25Q_STORE_OP_RELEASE:
+        sector->state = W25Q_STORE_SECTOR_DIRTY;
+        break;
+    case W25Q_STORE_OP_ERASE:
+        sector->erase_count++;
+        sector->state = W25Q_STORE_SECTOR_ERASED;
+        store->stats.erases++;
+        break;
+    case W25Q_STORE_OP_FORMAT:
+        sector->state = W25Q_STORE_SECTOR_FREE;
+        break;
+    default:
+        break;
+    }
+}
+
+static uint8_t start_program(w25q_store_t* store, uint8_t op, uint16_t sector, uint32_t offset,
+                             const uint8_t* data, uint32_t len) {
+    store->op = op;
+    store->op_sector = sector;
+    if (w25q_program_async(store->flash, sector_address(store, sector) + offset, data, len, op_done, store) !=
+        LED_STATUS_OK) {
+        store->op = W25Q_STORE_OP_NONE;
+        return 0;
+    }
+    store->stats.programs++;
+    return 1;
+}
+
+static uint8_t start_erase(w25q_store_t* store, uint16_t sector) {
+    store->op = W25Q_STORE_OP_ERASE;
+    store->op_sector = sector;
+    if (w25q_erase_async(store->flash, W25Q_ERASE_4K, sector_address(store, sector), op_done, store) !=
+        LED_STATUS_OK) {
+        store->op = W25Q_STORE_OP_NONE;
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief 内部函数：垃圾回收的一步
+ * @param[in] force - 非0表示马上需要一个空闲扇区
+ * @return uint8_t - 启动了一个Flash操作时返回1
+ */
+static uint8_t gc_step(w25q_store_t* store, uint8_t force) {
+    // 先把释放写入Flash，掉电后已释放的记录不会再出现。
+    // 从最旧的扇区开始写，中途掉电时留下的记录仍然是连续的
+    uint16_t releasing = store->sector_count;
+    for (uint16_t i = 0; i < store->sector_count; ++i) {
+        w25q_store_sector_t* sector = &store->sectors[i];
+        if (sector->state == W25Q_STORE_SECTOR_RELEASING &&
+            (releasing == store->sector_count || sector->seq < store->sectors[releasing].seq)) {
+            releasing = i;
+        }
+    }
+    if (releasing != store->sector_count) {
+        store->op_data[0] = 0x00;
+        return start_program(store, W25Q_STORE_OP_RELEASE, releasing, W25Q_STORE_HDR_RELEASED, store->op_data, 1);
+    }
+
+    uint16_t free_sectors =
+        (uint16_t)(count_state(store, W25Q_STORE_SECTOR_FREE) + count_state(store, W25Q_STORE_SECTOR_ERASED));
+    if (!force && free_sectors >= store->reserve) {
+        return 0;
+    }
+    uint16_t dirty = least_worn(store, W25Q_STORE_SECTOR_DIRTY);
+    if (dirty != store->sector_count) {
+        return start_erase(store, dirty);
+    }
+    if (!store->overwrite) {
+        return 0;
+    }
+
+    // 环形日志：丢弃最旧的扇区 (头扇区除外)
+    uint16_t oldest = store->sector_count;
+    for (uint16_t i = 0; i < store->sector_count; ++i) {
+        w25q_store_sector_t* sector = &store->sectors[i];
+        if (i != store->head && sector->state == W25Q_STORE_SECTOR_USED &&
+            (oldest == store->sector_count || sector->seq < store->sectors[oldest].seq)) {
+            oldest = i;
+        }
+    }
+    if (oldest == store->sector_count) {
+        return 0;
+    }
+    store->sectors[oldest].state = W25Q_STORE_SECTOR_RELEASING;
+    store->stats.released++;
+    store->stats.dropped++;
+    return gc_step(store, force);
+}
+
+/**
+ * @brief 内部函数：启动下一个Flash操作
+ * @return uint8_t - 启动了一个Flash操作时返回1，没有可做的事情时返回0
+ */
+static uint8_t start_next(w25q_store_t* store) {
+    // 擦除完成的扇区写入扇区头后才能分配
+    uint16_t erased = least_worn(store, W25Q_STORE_SECTOR_ERASED);
+    if (erased != store->sector_count) {
+        put_le32(&store->op_data[W25Q_STORE_HDR_MAGIC], W25Q_STORE_MAGIC);
+        put_le32(&store->op_data[W25Q_STORE_HDR_ERASE_COUNT], store->sectors[erased].erase_count);
+        put_le16(&store->op_data[W25Q_STORE_HDR_ERASE_CRC], crc16_ccitt(store->op_data, 8));
+        return start_program(store, W25Q_STORE_OP_FORMAT, erased, 0, store->op_data, 10);
+    }
+
+    if (store->pending != 0) {
+        uint8_t* record = &store->buffer[store->rd];
+        uint32_t size = buffer_front_size(store);
+        if (store->body_written) {
+            // 数据已经写好 (位于头扇区的末尾)，写提交标记
+            store->op_data[0] = W25Q_STORE_COMMITTED;
+            return start_program(store, W25Q_STORE_OP_COMMIT, store->head, store->head_offset - size,
+                                 store->op_data, 1);
+        }
+        if (store->head == store->sector_count || store->head_sealed ||
+            store->head_offset + size > W25Q_SECTOR_SIZE) {
+            uint16_t sector = least_worn(store, W25Q_STORE_SECTOR_FREE);
+            if (sector == store->sector_count) {
+                return gc_step(store, 1);
+            }
+            uint32_t seq = store->next_seq;
+            put_le32(&store->op_data[2], seq);
+            put_le16(&store->op_data[0], crc16_ccitt(&store->op_data[2], 4));
+            return start_program(store, W25Q_STORE_OP_OPEN, sector, W25Q_STORE_HDR_SEQ_CRC, store->op_data, 6);
+        }
+        // 提交标记之外的部分
+        uint32_t offset = store->head_offset;
+        if (!start_program(store, W25Q_STORE_OP_BODY, store->head, offset + 1, record + 1, size - 1)) {
+            return 0;
+        }
+        store->head_offset = offset + size;
+        return 1;
+    }
+
+    // 追加缓冲区不到一半满时在后台回收，留出空间容纳擦除期间追加的记录
+    if (store->pending_bytes <= store->buffer_size / 2) {
+        return gc_step(store, 0);
+    }
+    return 0;
+}
+
+/* 接口函数 -----------------------------------------------------------------*/
+
+led_status_t w25q_store_init(w25q_store_t* store, w25q_t* flash, uint32_t first_sector, uint16_t sector_count,
+                             w25q_store_sector_t* sectors, uint8_t* buffer, uint32_t buffer_size) {
+    if (store == NULL || flash == NULL || sectors == NULL || buffer == NULL || sector_count < 3 ||
+        buffer_size < 64) {
+        return LED_STATUS_INV_ARG;
+    }
+    if (first_sector + sector_count > flash->capacity / W25Q_SECTOR_SIZE) {
+        return LED_STATUS_INV_ARG;
+    }
+
+    memset(store, 0, sizeof(*store));
+    store->flash = flash;
+    store->first_sector = first_sector;
+    store->sector_count = sector_count;
+    store->sectors = sectors;
+    store->reserve = 1;
+    store->overwrite = 0;
+    store->head = sector_count;
+    store->buffer = buffer;
+    store->buffer_size = buffer_size;
+    buffer_reset(store);
+    memset(sectors, 0, sector_count * sizeof(w25q_store_sector_t));
+    return LED_STATUS_OK;
+}
+
+led_status_t w25q_store_set_gc(w25q_store_t* store, uint8_t reserve, uint8_t overwrite) {
+    if (store == NULL || reserve == 0 || reserve + 2u > store->sector_count) {
+        return LED_STATUS_INV_ARG;
+    }
+    store->reserve = reserve;
+    store->overwrite = overwrite ? 1 : 0;
+    return LED_STATUS_OK;
+}
+
+// 扫描头扇区中的记录头，找到追加位置 (以追加缓冲区作为读取缓冲区，不读取记录数据)
+static led_status_t scan_head(w25q_store_t* store) {
+    uint32_t base = sector_address(store, store->head);
+    uint32_t offset = W25Q_STORE_HEADER_SIZE;
+
+    while (offset + W25Q_STORE_RECORD_HEADER_SIZE <= W25Q_SECTOR_SIZE) {
+        uint32_t chunk = W25Q_SECTOR_SIZE - offset;
+        if (chunk > store->buffer_size) {
+            chunk = store->buffer_size;
+        }
+        led_status_t status = w25q_read(store->flash, base + offset, store->buffer, chunk);
+        if (status != LED_STATUS_OK) {
+            return status;
+        }
+
+        uint32_t p = 0;
+        while (p + W25Q_STORE_RECORD_HEADER_SIZE <= chunk) {
+            const uint8_t* header = &store->buffer[p];
+            uint16_t len = get_le16(&header[2]);
+            if (get_le32(&header[0]) == 0xFFFFFFFFu && get_le32(&header[4]) == 0xFFFFFFFFu) {
+                store->head_offset = offset + p;
+                return LED_STATUS_OK;
+            }
+            if (header[0] != W25Q_STORE_COMMITTED || len == 0 || len > W25Q_STORE_MAX_RECORD ||
+                offset + p + W25Q_STORE_RECORD_SIZE(len) > W25Q_SECTOR_SIZE) {
+                // 写了一半的记录 (掉电)：之后的空间不再使用
+                store->head_offset = offset + p;
+                store->head_sealed = 1;
+                return LED_STATUS_OK;
+            }
+            p += W25Q_STORE_RECORD_SIZE(len);
+        }
+        offset += p;
+    }
+    store->head_offset = offset;
+    return LED_STATUS_OK;
+}
+
+led_status_t w25q_store_mount(w25q_store_t* store) {
+    if (store == NULL) {
+        return LED_STATUS_INV_ARG;
+    }
+    if (store->op != W25Q_STORE_OP_NONE) {
+        return LED_STATUS_BUSY;
+    }
+
+    store->head = store->sector_count;
+    store->head_sealed = 0;
+    store->head_offset = 0;
+    store->next_seq = 0;
+    buffer_reset(store);
+
+    uint32_t max_erase_count = 0;
+    for (uint16_t i = 0; i < store->sector_count; ++i) {
+        w25q_store_sector_t* sector = &store->sectors[i];
+        uint8_t header[W25Q_STORE_HEADER_SIZE];
+        led_status_t status = w25q_read(store->flash, sector_address(store, i), header, sizeof(header));
+        if (status != LED_STATUS_OK) {
+            return status;
+        }
+
+        sector->state = W25Q_STORE_SECTOR_DIRTY;
+        sector->seq = 0;
+        sector->erase_count = W25Q_STORE_UNKNOWN_COUNT;
+        if (get_le32(&header[W25Q_STORE_HDR_MAGIC]) != W25Q_STORE_MAGIC ||
+            crc16_ccitt(header, 8) != get_le16(&header[W25Q_STORE_HDR_ERASE_CRC])) {
+            // 空白、擦除被打断或不属于本存储
+            continue;
+        }
+        sector->erase_count = get_le32(&header[W25Q_STORE_HDR_ERASE_COUNT]);
+        if (sector->erase_count > max_erase_count) {
+            max_erase_count = sector->erase_count;
+        }
+
+        uint16_t seq_crc = get_le16(&header[W25Q_STORE_HDR_SEQ_CRC]);
+        uint32_t seq = get_le32(&header[W25Q_STORE_HDR_SEQ]);
+        if (seq_crc == 0xFFFF && seq == 0xFFFFFFFFu && header[W25Q_STORE_HDR_RELEASED] == 0xFF) {
+            sector->state = W25Q_STORE_SECTOR_FREE;
+        } else if (seq != 0xFFFFFFFFu && crc16_ccitt(&header[W25Q_STORE_HDR_SEQ], 4) == seq_crc &&
+                   header[W25Q_STORE_HDR_RELEASED] == 0xFF) {
+            sector->state = W25Q_STORE_SECTOR_USED;
+            sector->seq = seq;
+            if (store->head == store->sector_count || seq > store->sectors[store->head].seq) {
+                store->head = i;
+            }
+        }
+    }
+
+    // 扇区头无法识别的扇区按已知的最大擦除次数计
+    for (uint16_t i = 0; i < store->sector_count; ++i) {
+        if (store->sectors[i].erase_count == W25Q_STORE_UNKNOWN_COUNT) {
+            store->sectors[i].erase_count = max_erase_count;
+        }
+    }
+    if (store->head == store->sector_count) {
+        return LED_STATUS_OK;
+    }
+    store->next_seq = store->sectors[store->head].seq + 1;
+    return scan_head(store);
+}
+
+led_status_t w25q_store_append(w25q_store_t* store, const void* data, uint32_t len) {
+    if (store == NULL || data == NULL || len == 0 || len > W25Q_STORE_MAX_RECORD) {
+        return LED_STATUS_INV_ARG;
+    }
+    uint32_t size = W25Q_STORE_RECORD_SIZE(len);
+    if (size > store->buffer_size) {
+        return LED_STATUS_INV_ARG;
+    }
+    uint8_t* record = buffer_reserve(store, size);
+    if (record == NULL) {
+        return LED_STATUS_BUSY;
+    }
+
+    record[0] = 0xFF;
+    record[1] = 0xFF;
+    put_le16(&record[2], (uint16_t)len);
+    put_le32(&record[4], record_crc(&record[2], data, len));
+    memcpy(&record[W25Q_STORE_RECORD_HEADER_SIZE], data, len);
+    memset(&record[W25Q_STORE_RECORD_HEADER_SIZE + len], 0xFF, size - W25Q_STORE_RECORD_HEADER_SIZE - len);
+    store->wr += size;
+    store->pending++;
+    store->pending_bytes += size;
+    store->stats.appended++;
+    return LED_STATUS_OK;
+}
+
+led_status_t w25q_store_process(w25q_store_t* store) {
+    if (store == NULL) {
+        return LED_STATUS_INV_ARG;
+    }
+    for (;;) {
+        if (store->op != W25Q_STORE_OP_NONE) {
+            w25q_process(store->flash);
+            if (store->op != W25Q_STORE_OP_NONE) {
+                return LED_STATUS_BUSY;
+            }
+        }
+        if (!start_next(store)) {
+            return LED_STATUS_OK;
+        }
+    }
+}
+
+led_status_t w25q_store_flush(w25q_store_t* store) {
+    if (store == NULL) {
+        return LED_STATUS_INV_ARG;
+    }
+    const spi_api_t* api = store->flash->spi->api;
+    while (w25q_store_process(store) == LED_STATUS_BUSY) {
+        if (api->wait_for_event) {
+            api->wait_for_event(store->flash->spi->handle);
+        }
+    }
+    return (store->pending == 0) ? LED_STATUS_OK : LED_STATUS_ERROR;
+}
+
+void w25q_store_rewind(w25q_store_t* store, w25q_store_cursor_t* cursor) {
+    if (store == NULL || cursor == NULL) {
+        return;
+    }
+    // 还没有记录时指向下一个分配的扇区
+    uint16_t oldest = find_oldest(store, 0, 0);
+    cursor->seq = (oldest != store->sector_count) ? store->sectors[oldest].seq : store->next_seq;
+    cursor->offset = W25Q_STORE_HEADER_SIZE;
+}
+
+led_status_t w25q_store_read(w25q_store_t* store, w25q_store_cursor_t* cursor, void* buffer, uint32_t size,
+                             uint32_t* len) {
+    if (store == NULL || cursor == NULL || buffer == NULL || len == NULL) {
+        return LED_STATUS_INV_ARG;
+    }
+    *len = 0;
+
+    for (;;) {
+        uint16_t index = find_seq(store, cursor->seq);
+        // 正在追加的头扇区：遇到未提交的记录表示读完了，之后再读还能读到新提交的记录
+        uint8_t live = (index == store->head && !store->head_sealed);
+        uint8_t valid = 0;
+        uint8_t header[W25Q_STORE_RECORD_HEADER_SIZE];
+        uint16_t record_len = 0;
+
+        if (index != store->sector_count) {
+            uint32_t limit = (index == store->head) ? store->head_offset : W25Q_SECTOR_SIZE;
+            uint32_t address = sector_address(store, index) + cursor->offset;
+            if (cursor->offset + W25Q_STORE_RECORD_HEADER_SIZE <= limit) {
+                led_status_t status = w25q_read(store->flash, address, header, sizeof(header));
+                if (status != LED_STATUS_OK) {
+                    return status;
+                }
+                record_len = get_le16(&header[2]);
+                valid = header[0] == W25Q_STORE_COMMITTED && record_len != 0 &&
+                        record_len <= W25Q_STORE_MAX_RECORD &&
+                        cursor->offset + W25Q_STORE_RECORD_SIZE(record_len) <= limit;
+            }
+            if (valid) {
+                if (record_len > size) {
+                    *len = record_len;
+                    return LED_STATUS_INV_ARG;
+                }
+                led_status_t status = w25q_read(store->flash, address + W25Q_STORE_RECORD_HEADER_SIZE, (uint8_t*)buffer,
+                                                record_len);
+                if (status != LED_STATUS_OK) {
+                    return status;
+                }
+                cursor->offset += W25Q_STORE_RECORD_SIZE(record_len);
+                if (record_crc(&header[2], buffer, record_len) == get_le32(&header[4])) {
+                    *len = record_len;
+                    return LED_STATUS_OK;
+                }
+                // 记录已经提交、长度可信，只是数据损坏：跳过这一条，后面的记录照常读取
+                store->stats.errors++;
+                continue;
+            }
+            if (live) {
+                return LED_STATUS_OK;
+            }
+        }
+
+        // 本扇区读完 (或已被释放)：转到下一个扇区
+        uint16_t next = find_oldest(store, cursor->seq, 1);
+        if (next == store->sector_count) {
+            return LED_STATUS_OK;
+        }
+        cursor->seq = store->sectors[next].seq;
+        cursor->offset = W25Q_STORE_HEADER_SIZE;
+    }
+}
+
+void w25q_store_release(w25q_store_t* store, const w25q_store_cursor_t* cursor) {
+    if (store == NULL || cursor == NULL) {
+        return;
+    }
+    for (uint16_t i = 0; i < store->sector_count; ++i) {
+        w25q_store_sector_t* sector = &store->sectors[i];
+        if (i != store->head && sector->state == W25Q_STORE_SECTOR_USED && sector->seq < cursor->seq) {
+            sector->state = W25Q_STORE_SECTOR_RELEASING;
+            store->stats.released++;
+        }
+    }
+}
+
+void w25q_store_get_stats(w25q_store_t* store, w25q_store_stats_t* stats) {
+    if (store == NULL || stats == NULL) {
+        return;
+    }
+    *stats = store->stats;
+}
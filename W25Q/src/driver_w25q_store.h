@@ -0,0 +1,210 @@
+#ifndef __DRIVER_W25Q_STORE_H
+#define __DRIVER_W25Q_STORE_H
+
+#include "driver_w25q.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 扇区头和记录头的长度
+ */
+#define W25Q_STORE_HEADER_SIZE        20u
+#define W25Q_STORE_RECORD_HEADER_SIZE 8u
+
+/**
+ * @brief 记录数据的最大长度 (一条记录不跨扇区)
+ */
+#define W25Q_STORE_MAX_RECORD (W25Q_SECTOR_SIZE - W25Q_STORE_HEADER_SIZE - W25Q_STORE_RECORD_HEADER_SIZE)
+
+/**
+ * @brief 一条记录在Flash和追加缓冲区中占用的字节数 (按4字节对齐)
+ */
+#define W25Q_STORE_RECORD_SIZE(len) (W25Q_STORE_RECORD_HEADER_SIZE + (((uint32_t)(len) + 3u) & ~3u))
+
+/**
+ * @brief 扇区状态
+ */
+typedef enum {
+    W25Q_STORE_SECTOR_DIRTY = 0,    /**< 需要擦除 (已释放、空白或内容无法识别) */
+    W25Q_STORE_SECTOR_FREE,         /**< 已擦除，可以分配 */
+    W25Q_STORE_SECTOR_USED,         /**< 存有记录 */
+    W25Q_STORE_SECTOR_RELEASING,    /**< 已释放，释放标记还没有写入Flash */
+    W25Q_STORE_SECTOR_ERASED        /**< 已擦除，扇区头还没有写入 */
+} w25q_store_sector_state_t;
+
+/**
+ * @brief 扇区索引 (每个扇区一项，挂载时只读各扇区头建立)
+ */
+typedef struct {
+    uint32_t seq;               /**< 扇区序号，越大越新 */
+    uint32_t erase_count;       /**< 擦除次数 */
+    uint8_t state;              /**< w25q_store_sector_state_t */
+} w25q_store_sector_t;
+
+/**
+ * @brief 读取位置
+ */
+typedef struct {
+    uint32_t seq;               /**< 当前扇区的序号 */
+    uint32_t offset;            /**< 下一条记录在扇区中的偏移 */
+} w25q_store_cursor_t;
+
+/**
+ * @brief 统计
+ */
+typedef struct {
+    uint32_t appended;          /**< 放入追加缓冲区的记录数 */
+    uint32_t committed;         /**< 已提交 (写入Flash并写好提交标记) 的记录数 */
+    uint32_t programs;          /**< 编程操作数 */
+    uint32_t erases;            /**< 擦除的扇区数 */
+    uint32_t released;          /**< 释放的扇区数 (含覆盖丢弃的) */
+    uint32_t dropped;           /**< 空间不足时覆盖丢弃的扇区数 */
+    uint32_t errors;            /**< 失败的Flash操作数与读取时因校验失败被跳过的记录数 */
+} w25q_store_stats_t;
+
+/**
+ * @brief W25Q上的日志结构记录存储
+ * @note  Flash中连续的一组扇区组成一个环：记录按顺序追加到当前扇区 (头扇区)，写满后
+ * 分配一个空闲扇区接着写。每个扇区以扇区头开始 (擦除次数、序号、释放标记)，
+ * 每条记录带长度、CRC-32和提交标记：先写入记录头和数据，编程完成后再单独写提交标记，
+ * 掉电时写了一半的记录没有提交标记，挂载和读取时被丢弃。
+ *
+ * 追加只把记录放入RAM中的追加缓冲区，由w25q_store_process在后台写入Flash；
+ * 释放的扇区也在后台逐个擦除 (增量垃圾回收)，擦除期间新的记录先留在缓冲区中，
+ * 所以追加从不等待几十毫秒的擦除。分配扇区时选择擦除次数最少的空闲扇区 (磨损均衡)。
+ *
+ * 挂载时只读取每个扇区的扇区头，再扫描头扇区中的记录头找到追加位置，不扫描全部数据。
+ * 所有函数都只能在同一个上下文 (主循环) 中调用。
+ */
+typedef struct {
+    w25q_t* flash;              /**< 所属的Flash对象 */
+    uint32_t first_sector;      /**< 起始扇区号 */
+    uint16_t sector_count;      /**< 扇区数 */
+    w25q_store_sector_t* sectors; /**< 扇区索引 (sector_count项，由调用者提供) */
+    uint8_t reserve;            /**< 保持预先擦除好的空闲扇区数 */
+    uint8_t overwrite;          /**< 空间不足时丢弃最旧的扇区 */
+
+    // --- 头扇区 ---
+    uint16_t head;              /**< 头扇区的下标，sector_count表示没有 */
+    uint8_t head_sealed;        /**< 头扇区不再追加 (挂载时发现未提交的记录) */
+    uint32_t head_offset;       /**< 下一条记录在头扇区中的偏移 */
+    uint32_t next_seq;          /**< 下一个分配的扇区序号 */
+
+    // --- 追加缓冲区 (按Flash中的格式存放待写入的记录) ---
+    uint8_t* buffer;            /**< 缓冲区 (由调用者提供) */
+    uint32_t buffer_size;       /**< 缓冲区长度 */
+    uint32_t rd;                /**< 最旧的待写记录的位置 */
+    uint32_t wr;                /**< 下一条记录的写入位置 */
+    uint32_t wrap;              /**< 回绕前的数据末尾，0表示没有回绕 */
+    uint32_t pending;           /**< 缓冲区中的记录数 */
+    uint32_t pending_bytes;     /**< 缓冲区中的字节数 */
+    uint8_t body_written;       /**< 最旧的待写记录已写入数据，等待写提交标记 */
+
+    // --- 正在进行的Flash操作 ---
+    uint8_t op;                 /**< 当前操作，0表示没有 */
+    uint16_t op_sector;         /**< 操作的扇区 */
+    uint8_t op_data[W25Q_STORE_HEADER_SIZE]; /**< 编程的数据 (扇区头的字段或提交标记) */
+
+    w25q_store_stats_t stats;   /**< 统计 */
+} w25q_store_t;
+
+/**
+ * @brief  初始化存储对象 (不访问Flash)
+ * @param[in] store        - 指向w25q_store_t对象的指针
+ * @param[in] flash        - 已初始化的w25q_t对象
+ * @param[in] first_sector - 起始扇区号
+ * @param[in] sector_count - 扇区数，至少为3
+ * @param[in] sectors      - sector_count项的扇区索引
+ * @param[in] buffer       - 追加缓冲区，挂载时也用作读取缓冲区
+ * @param[in] buffer_size  - 追加缓冲区的长度 (至少64字节)，记录的长度也受它限制
+ * @return led_status_t - 操作的状态码
+ */
+led_status_t w25q_store_init(w25q_store_t* store, w25q_t* flash, uint32_t first_sector, uint16_t sector_count,
+                             w25q_store_sector_t* sectors, uint8_t* buffer, uint32_t buffer_size);
+
+/**
+ * @brief  设置垃圾回收策略
+ * @param[in] store     - 指向w25q_store_t对象的指针
+ * @param[in] reserve   - 后台保持预先擦除好的空闲扇区数 (默认1)
+ * @param[in] overwrite - 非0时空间不足则丢弃最旧的扇区 (环形日志)，为0时等待w25q_store_release释放 (默认0)
+ * @return led_status_t - 操作的状态码
+ */
+led_status_t w25q_store_set_gc(w25q_store_t* store, uint8_t reserve, uint8_t overwrite);
+
+/**
+ * @brief  挂载：读取各扇区头建立索引，扫描头扇区找到追加位置 (阻塞)
+ * @note   空白或无法识别的扇区标记为需要擦除，由w25q_store_process在后台擦除，
+ * 所以在全新的芯片上挂载也会成功。
+ * @param[in] store - 指向w25q_store_t对象的指针
+ * @return led_status_t - 操作的状态码
+ */
+led_status_t w25q_store_mount(w25q_store_t* store);
+
+/**
+ * @brief  追加一条记录 (复制到追加缓冲区，立即返回)
+ * @param[in] store - 指向w25q_store_t对象的指针
+ * @param[in] data  - 记录数据
+ * @param[in] len   - 记录长度 (1 ~ W25Q_STORE_MAX_RECORD)
+ * @return led_status_t - 操作的状态码。缓冲区已满时返回LED_STATUS_BUSY
+ */
+led_status_t w25q_store_append(w25q_store_t* store, const void* data, uint32_t len);
+
+/**
+ * @brief  在后台推进写入和垃圾回收 (在主循环中反复调用)
+ * @note   从不等待：Flash操作进行中时直接返回。每次最多启动一个Flash操作。
+ * @param[in] store - 指向w25q_store_t对象的指针
+ * @return led_status_t - 还有工作要做时返回LED_STATUS_BUSY，空闲 (或空间已满无法继续) 时返回LED_STATUS_OK
+ */
+led_status_t w25q_store_process(w25q_store_t* store);
+
+/**
+ * @brief  把追加缓冲区中的记录全部写入Flash (阻塞)
+ * @param[in] store - 指向w25q_store_t对象的指针
+ * @return led_status_t - 操作的状态码。空间已满时返回LED_STATUS_ERROR
+ */
+led_status_t w25q_store_flush(w25q_store_t* store);
+
+/**
+ * @brief  把读取位置设到最旧的记录
+ * @param[in]  store  - 指向w25q_store_t对象的指针
+ * @param[out] cursor - 读取位置
+ */
+void w25q_store_rewind(w25q_store_t* store, w25q_store_cursor_t* cursor);
+
+/**
+ * @brief  读取一条已提交的记录，并把读取位置移到下一条
+ * @param[in]     store  - 指向w25q_store_t对象的指针
+ * @param[in,out] cursor - 读取位置
+ * @param[out]    buffer - 存放记录数据的缓冲区
+ * @param[in]     size   - 缓冲区长度
+ * @param[out]    len    - 记录长度，没有更多记录时为0
+ * @note   数据校验失败的记录被跳过 (计入stats.errors)，不影响后面的记录。
+ * @return led_status_t - 操作的状态码。缓冲区太小时返回LED_STATUS_INV_ARG (*len为记录长度，位置不变)，
+ *         Flash忙时返回LED_STATUS_BUSY
+ */
+led_status_t w25q_store_read(w25q_store_t* store, w25q_store_cursor_t* cursor, void* buffer, uint32_t size,
+                             uint32_t* len);
+
+/**
+ * @brief  释放读取位置之前的全部扇区 (其中的记录都已处理，不再需要)
+ * @note   只改变索引，释放标记的写入和擦除由w25q_store_process在后台完成。
+ * @param[in] store  - 指向w25q_store_t对象的指针
+ * @param[in] cursor - 读取位置
+ */
+void w25q_store_release(w25q_store_t* store, const w25q_store_cursor_t* cursor);
+
+/**
+ * @brief  读取统计
+ * @param[in]  store - 指向w25q_store_t对象的指针
+ * @param[out] stats - 统计
+ */
+void w25q_store_get_stats(w25q_store_t* store, w25q_store_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __DRIVER_W25Q_STORE_H
@@ -0,0 +1,1348 @@
+#include "driver_w25q_test.h"
+
+#include <string.h>
+#include "driver_bench.h"
+
+/* 内存中的W25Q模型 ---------------------------------------------------------*/
+// 按字节解析MOSI上的指令，在片选取消时执行写使能、页编程和擦除 (与真实芯片一样)。
+// 编程和擦除之后芯片忙一段时间 (以模拟的毫秒节拍计)，忙期间只响应读状态，其他指令记为违规。
+// DMA传输在启动时只记录参数，由测试代码 (或等待钩子) 触发完成中断；轮询传输立即完成。
+
+#define W25Q_MODEL_CAPACITY_CODE 0x11
+#define W25Q_MODEL_CAPACITY      (1u << W25Q_MODEL_CAPACITY_CODE)
+
+#define W25Q_MODEL_PROGRAM_MS  1u
+#define W25Q_MODEL_SECTOR_MS   45u
+#define W25Q_MODEL_BLOCK32_MS  120u
+#define W25Q_MODEL_BLOCK64_MS  150u
+#define W25Q_MODEL_CHIP_MS     300u
+
+typedef struct {
+    spi_complete_callback_t callback;
+    void* context;
+    const uint8_t* tx_data;
+    uint8_t* rx_data;
+    uint16_t len;
+
+    uint8_t mem[W25Q_MODEL_CAPACITY];
+    uint8_t cs_low;
+    uint8_t cmd;
+    uint32_t pos;               /**< 本次片选以来的字节序号 */
+    uint32_t address;
+    uint8_t page[W25Q_PAGE_SIZE];
+    uint32_t page_bytes;        /**< 本次页编程收到的数据字节数 */
+
+    uint8_t wel;
+    uint8_t op_active;          /**< 编程/擦除进行中 (结束时清除WEL) */
+    uint32_t busy_until;
+    uint8_t protect;            /**< 非0时忽略编程和擦除 (写保护) */
+    uint8_t stuck;              /**< 非0时编程/擦除永远不结束 */
+
+    uint32_t wrens;
+    uint32_t programs;
+    uint32_t erases;
+    uint32_t status_reads;
+    uint32_t overflows;         /**< 一次页编程超过256字节的次数 */
+    uint32_t violations;        /**< 忙期间的指令、无法识别的指令等 */
+    uint32_t transactions;      /**< 片选次数 */
+    uint32_t bytes;             /**< 总线上传输的字节数 */
+    uint32_t program_bytes;     /**< 编程的字节数 */
+
+    // 掉电模拟：第cut_after次编程/擦除执行到一半时掉电，之后芯片不再响应 (MISO一直为0xFF)
+    uint32_t cut_after;         /**< 0表示不掉电 */
+    uint32_t cut_seed;          /**< 决定掉电时写了多少 */
+    uint8_t dead;
+} w25q_model_t;
+
+static w25q_model_t s_model;
+static uint32_t s_model_tick;
+
+static uint8_t model_busy(w25q_model_t* m) {
+    if (m->op_active && !m->stuck && s_model_tick >= m->busy_until) {
+        m->op_active = 0;
+        m->wel = 0;
+    }
+    return m->op_active;
+}
+
+static uint32_t model_random(w25q_model_t* m) {
+    m->cut_seed = m->cut_seed * 1103515245u + 12345u;
+    return m->cut_seed >> 8;
+}
+
+// 编程或擦除开始执行时调用，返回1表示这一次执行到一半时掉电
+static uint8_t model_power_cut(w25q_model_t* m) {
+    if (m->cut_after == 0 || --m->cut_after != 0) {
+        return 0;
+    }
+    m->dead = 1;
+    return 1;
+}
+
+static uint8_t model_byte(w25q_model_t* m, uint8_t mosi) {
+    if (m->dead) {
+        return 0xFF;
+    }
+    uint32_t pos = m->pos++;
+    if (pos == 0) {
+        m->cmd = mosi;
+        if (model_busy(m) && mosi != W25Q_CMD_READ_STATUS1) {
+            m->violations++;
+            m->cmd = 0;
+        }
+        return 0xFF;
+    }
+    if (pos <= 3) {
+        m->address = (m->address << 8) | mosi;
+    }
+
+    switch (m->cmd) {
+    case W25Q_CMD_READ_STATUS1:
+        m->status_reads++;
+        return (uint8_t)((model_busy(m) ? W25Q_STATUS_BUSY : 0) | (m->wel ? W25Q_STATUS_WEL : 0));
+    case W25Q_CMD_JEDEC_ID: {
+        static const uint8_t id[3] = { 0xEF, 0x40, W25Q_MODEL_CAPACITY_CODE };
+        return (pos <= 3) ? id[pos - 1] : 0xFF;
+    }
+    case W25Q_CMD_FAST_READ:
+        // 3字节地址之后还有1个空字节
+        return (pos >= 5) ? m->mem[(m->address + pos - 5) % W25Q_MODEL_CAPACITY] : 0xFF;
+    case W25Q_CMD_PAGE_PROGRAM:
+        if (pos >= 4) {
+            // 超过页边界时回绕到页首 (与真实芯片相同)
+            uint32_t offset = ((m->address & 0xFF) + (pos - 4)) & 0xFF;
+            m->page[offset] = mosi;
+            m->page_bytes++;
+        }
+        return 0xFF;
+    default:
+        return 0xFF;
+    }
+}
+
+static void model_erase(w25q_model_t* m, uint32_t size, uint32_t busy_ms) {
+    uint32_t start = (m->address % W25Q_MODEL_CAPACITY) & ~(size - 1);
+    if (model_power_cut(m)) {
+        // 只擦除了前面一部分，边界上的字节只有部分位变成1
+        uint32_t done = model_random(m) % size;
+        memset(&m->mem[start], 0xFF, done);
+        m->mem[start + done] |= (uint8_t)model_random(m);
+        return;
+    }
+    memset(&m->mem[start], 0xFF, size);
+    m->erases++;
+    m->op_active = 1;
+    m->busy_until = s_model_tick + busy_ms;
+}
+
+// 片选取消：执行指令
+static void model_deselect(w25q_model_t* m) {
+    uint8_t cmd = m->cmd;
+    uint32_t pos = m->pos;
+    m->pos = 0;
+    m->cmd = 0;
+    if (pos == 0 || cmd == 0 || m->dead) {
+        return;
+    }
+
+    uint8_t can_write = m->wel && !m->protect;
+    switch (cmd) {
+    case W25Q_CMD_WRITE_ENABLE:
+        m->wel = 1;
+        m->wrens++;
+        break;
+    case W25Q_CMD_WRITE_DISABLE:
+        m->wel = 0;
+        break;
+    case W25Q_CMD_PAGE_PROGRAM:
+        if (pos < 5) {
+            m->violations++;
+            break;
+        }
+        if (m->page_bytes > W25Q_PAGE_SIZE) {
+            m->overflows++;
+        }
+        if (can_write) {
+            uint32_t base = (m->address % W25Q_MODEL_CAPACITY) & ~(W25Q_PAGE_SIZE - 1);
+            uint32_t first = m->address & 0xFF;
+            uint32_t count = m->page_bytes > W25Q_PAGE_SIZE ? W25Q_PAGE_SIZE : m->page_bytes;
+            uint32_t done = count;
+            if (model_power_cut(m)) {
+                // 只写入了前面一部分，边界上的字节只有部分位变成0
+                done = model_random(m) % (count + 1);
+                if (done < count) {
+                    uint32_t offset = (first + done) & 0xFF;
+                    m->mem[base + offset] &= (uint8_t)(m->page[offset] | model_random(m));
+                }
+            }
+            for (uint32_t i = 0; i < done; ++i) {
+                uint32_t offset = (first + i) & 0xFF;
+                // 编程只能把1变成0
+                m->mem[base + offset] &= m->page[offset];
+            }
+            m->program_bytes += count;
+            if (m->dead) {
+                break;
+            }
+            m->programs++;
+            m->op_active = 1;
+            m->busy_until = s_model_tick + W25Q_MODEL_PROGRAM_MS;
+        }
+        m->page_bytes = 0;
+        break;
+    case W25Q_CMD_SECTOR_ERASE:
+    case W25Q_CMD_BLOCK32_ERASE:
+    case W25Q_CMD_BLOCK64_ERASE:
+        if (pos != 4) {
+            m->violations++;
+            break;
+        }
+        if (can_write) {
+            if (cmd == W25Q_CMD_SECTOR_ERASE) {
+                model_erase(m, W25Q_SECTOR_SIZE, W25Q_MODEL_SECTOR_MS);
+            } else if (cmd == W25Q_CMD_BLOCK32_ERASE) {
+                model_erase(m, W25Q_BLOCK32_SIZE, W25Q_MODEL_BLOCK32_MS);
+            } else {
+                model_erase(m, W25Q_BLOCK64_SIZE, W25Q_MODEL_BLOCK64_MS);
+            }
+        }
+        break;
+    case W25Q_CMD_CHIP_ERASE:
+        if (can_write) {
+            m->address = 0;
+            model_erase(m, W25Q_MODEL_CAPACITY, W25Q_MODEL_CHIP_MS);
+        }
+        break;
+    case W25Q_CMD_READ_STATUS1:
+    case W25Q_CMD_JEDEC_ID:
+    case W25Q_CMD_FAST_READ:
+        break;
+    default:
+        m->violations++;
+        break;
+    }
+}
+
+static void model_shift(w25q_model_t* m, const uint8_t* tx_data, uint8_t* rx_data, uint16_t len) {
+    m->bytes += len;
+    for (uint16_t i = 0; i < len; ++i) {
+        uint8_t miso = model_byte(m, tx_data ? tx_data[i] : 0xFF);
+        if (rx_data) {
+            rx_data[i] = miso;
+        }
+    }
+}
+
+static led_status_t model_init(void* handle, spi_complete_callback_t callback, void* context) {
+    w25q_model_t* m = (w25q_model_t*)handle;
+    m->callback = callback;
+    m->context = context;
+    return LED_STATUS_OK;
+}
+
+static led_status_t model_deinit(void* handle) {
+    (void)handle;
+    return LED_STATUS_OK;
+}
+
+static led_status_t model_transceive_dma(void* handle, const uint8_t* tx_data, uint8_t* rx_data, uint16_t len) {
+    w25q_model_t* m = (w25q_model_t*)handle;
+    if (!m->cs_low || m->len != 0) {
+        m->violations++;
+        return LED_STATUS_ERROR;
+    }
+    m->tx_data = tx_data;
+    m->rx_data = rx_data;
+    m->len = len;
+    return LED_STATUS_OK;
+}
+
+static led_status_t model_transceive_poll(void* handle, const uint8_t* tx_data, uint8_t* rx_data, uint16_t len) {
+    w25q_model_t* m = (w25q_model_t*)handle;
+    if (!m->cs_low || m->len != 0) {
+        m->violations++;
+        return LED_STATUS_ERROR;
+    }
+    model_shift(m, tx_data, rx_data, len);
+    return LED_STATUS_OK;
+}
+
+static led_status_t model_chip_select(void* handle) {
+    w25q_model_t* m = (w25q_model_t*)handle;
+    m->cs_low = 1;
+    m->transactions++;
+    m->pos = 0;
+    m->address = 0;
+    m->page_bytes = 0;
+    return LED_STATUS_OK;
+}
+
+static led_status_t model_chip_deselect(void* handle) {
+    w25q_model_t* m = (w25q_model_t*)handle;
+    if (m->cs_low) {
+        m->cs_low = 0;
+        model_deselect(m);
+    }
+    return LED_STATUS_OK;
+}
+
+static uint32_t model_get_tick(void) {
+    return s_model_tick;
+}
+
+// 模拟DMA完成中断
+static void model_irq(w25q_model_t* m) {
+    while (m->len != 0) {
+        uint16_t len = m->len;
+        model_shift(m, m->tx_data, m->rx_data, len);
+        m->len = 0;
+        m->callback(m->context, LED_STATUS_OK);
+    }
+}
+
+// 每次“休眠”经过1毫秒，期间进行中的DMA完成
+static void model_wait_for_event(void* handle) {
+    model_irq((w25q_model_t*)handle);
+    s_model_tick++;
+}
+
+static const spi_api_t s_model_api = {
+    .init = model_init,
+    .deinit = model_deinit,
+    .transceive_dma = model_transceive_dma,
+    .transceive_poll = model_transceive_poll,
+    .chip_select = model_chip_select,
+    .chip_deselect = model_chip_deselect,
+    .get_tick = model_get_tick,
+    .wait_for_event = model_wait_for_event,
+};
+
+/* 测试 ---------------------------------------------------------------------*/
+
+typedef struct {
+    uint32_t calls;
+    led_status_t status;
+} w25q_done_t;
+
+static void on_done(w25q_t* flash, led_status_t status, void* user_data) {
+    (void)flash;
+    w25q_done_t* done = (w25q_done_t*)user_data;
+    done->calls++;
+    done->status = status;
+}
+
+// 主循环：每个节拍 (1毫秒) 调用一次w25q_process，返回经过的节拍数
+static uint32_t run_until_idle(w25q_t* flash, uint32_t max_ticks) {
+    uint32_t start = s_model_tick;
+    while (w25q_process(flash) == LED_STATUS_BUSY && s_model_tick - start < max_ticks) {
+        model_irq(&s_model);
+        s_model_tick++;
+    }
+    return s_model_tick - start;
+}
+
+static uint8_t is_erased(uint32_t address, uint32_t len) {
+    for (uint32_t i = 0; i < len; ++i) {
+        if (s_model.mem[address + i] != 0xFF) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+led_status_t driver_w25q_test(void) {
+    static spi_t spi;
+    static w25q_t flash;
+    static uint8_t data[600];
+    static uint8_t readback[0x10000];
+    w25q_done_t done;
+
+    memset(&s_model, 0, sizeof(s_model));
+    memset(s_model.mem, 0x5A, sizeof(s_model.mem));
+    s_model_tick = 0;
+    for (uint32_t i = 0; i < sizeof(data); ++i) {
+        data[i] = (uint8_t)(i * 13 + 1);
+    }
+
+    // 1. 初始化：JEDEC ID和容量
+    if (spi_init(&spi, &s_model_api, &s_model) != LED_STATUS_OK || w25q_init(&flash, &spi) != LED_STATUS_OK ||
+        flash.manufacturer_id != 0xEF || flash.device_id != (0x4000 | W25Q_MODEL_CAPACITY_CODE) ||
+        flash.capacity != W25Q_MODEL_CAPACITY) {
+        return LED_STATUS_ERROR;
+    }
+
+    // 2. 异步扇区擦除：立即返回，第一次process发出写使能和擦除指令后就返回，
+    // 之后每个查询间隔最多读一次状态，忙期间的其他操作返回BUSY
+    memset(&done, 0, sizeof(done));
+    if (w25q_erase_async(&flash, W25Q_ERASE_4K, 0x1000, on_done, &done) != LED_STATUS_OK || s_model.erases != 0 ||
+        !w25q_is_busy(&flash)) {
+        return LED_STATUS_ERROR;
+    }
+    if (w25q_process(&flash) != LED_STATUS_BUSY || s_model.wrens != 1 || s_model.erases != 1 ||
+        s_model.status_reads != 0 || done.calls != 0) {
+        return LED_STATUS_ERROR;
+    }
+    if (w25q_program_async(&flash, 0, data, 1, NULL, NULL) != LED_STATUS_BUSY ||
+        w25q_erase_async(&flash, W25Q_ERASE_CHIP, 0, NULL, NULL) != LED_STATUS_BUSY ||
+        flash.erase_cmd != W25Q_CMD_SECTOR_ERASE ||
+        w25q_read(&flash, 0, readback, 1) != LED_STATUS_BUSY) {
+        return LED_STATUS_ERROR;
+    }
+    uint32_t ticks = run_until_idle(&flash, 1000);
+    if (done.calls != 1 || done.status != LED_STATUS_OK || ticks < W25Q_MODEL_SECTOR_MS ||
+        ticks > W25Q_MODEL_SECTOR_MS + 2 || s_model.status_reads > ticks + 1 || !is_erased(0x1000, 0x1000) ||
+        s_model.mem[0x0FFF] != 0x5A || s_model.mem[0x2000] != 0x5A || flash.wel) {
+        return LED_STATUS_ERROR;
+    }
+
+    // 3. 跨页编程：600字节从0x10F0开始，拆成16 + 256 + 256 + 72字节四次页编程，每页一次写使能
+    memset(&done, 0, sizeof(done));
+    s_model.wrens = 0;
+    if (w25q_program_async(&flash, 0x10F0, data, sizeof(data), on_done, &done) != LED_STATUS_OK) {
+        return LED_STATUS_ERROR;
+    }
+    run_until_idle(&flash, 100);
+    if (done.calls != 1 || done.status != LED_STATUS_OK || s_model.programs != 4 || s_model.wrens != 4 ||
+        s_model.overflows != 0 || flash.wel) {
+        return LED_STATUS_ERROR;
+    }
+    if (w25q_read(&flash, 0x10F0, readback, sizeof(data)) != LED_STATUS_OK ||
+        memcmp(readback, data, sizeof(data)) != 0 || s_model.mem[0x10EF] != 0xFF ||
+        s_model.mem[0x10F0 + sizeof(data)] != 0xFF) {
+        return LED_STATUS_ERROR;
+    }
+
+    // 4. 参数检查：越界、未对齐、长度为0
+    if (w25q_read(&flash, W25Q_MODEL_CAPACITY - 4, readback, 8) != LED_STATUS_INV_ARG ||
+        w25q_program_async(&flash, W25Q_MODEL_CAPACITY - 1, data, 2, NULL, NULL) != LED_STATUS_INV_ARG ||
+        w25q_program_async(&flash, 0, data, 0, NULL, NULL) != LED_STATUS_INV_ARG ||
+        w25q_erase_async(&flash, W25Q_ERASE_4K, 0x1100, NULL, NULL) != LED_STATUS_INV_ARG ||
+        w25q_erase_async(&flash, W25Q_ERASE_32K, 0x1000, NULL, NULL) != LED_STATUS_INV_ARG ||
+        w25q_erase_async(&flash, W25Q_ERASE_64K, W25Q_MODEL_CAPACITY, NULL, NULL) != LED_STATUS_INV_ARG) {
+        return LED_STATUS_ERROR;
+    }
+
+    // 5. 阻塞封装：32K和64K擦除，以及超过一个事务长度 (32KB) 的读取
+    s_model.erases = 0;
+    if (w25q_erase(&flash, W25Q_ERASE_32K, 0x8000) != LED_STATUS_OK || !is_erased(0x8000, 0x8000) ||
+        s_model.mem[0x7FFF] != 0x5A) {
+        return LED_STATUS_ERROR;
+    }
+    if (w25q_erase(&flash, W25Q_ERASE_64K, 0x10000) != LED_STATUS_OK || !is_erased(0x10000, 0x10000) ||
+        s_model.erases != 2) {
+        return LED_STATUS_ERROR;
+    }
+    if (w25q_program(&flash, 0x1FF00, data, 256) != LED_STATUS_OK ||
+        w25q_read(&flash, 0x10000, readback, 0x10000) != LED_STATUS_OK ||
+        memcmp(readback, &s_model.mem[0x10000], 0x10000) != 0 || readback[0xFF00] != data[0] ||
+        readback[0xFFFF] != data[255]) {
+        return LED_STATUS_ERROR;
+    }
+
+    // 6. 写保护：芯片忽略编程，写使能位保持置位，操作以错误结束，数据不变
+    s_model.protect = 1;
+    if (w25q_program(&flash, 0x3000, data, 4) != LED_STATUS_ERROR || s_model.mem[0x3000] != 0x5A) {
+        return LED_STATUS_ERROR;
+    }
+    s_model.protect = 0;
+    // 写使能仍然有效，下一次操作不再重复写使能
+    s_model.wrens = 0;
+    if (!flash.wel || w25q_erase(&flash, W25Q_ERASE_4K, 0x3000) != LED_STATUS_OK || s_model.wrens != 0) {
+        return LED_STATUS_ERROR;
+    }
+
+    // 7. 整片擦除
+    if (w25q_erase(&flash, W25Q_ERASE_CHIP, 0) != LED_STATUS_OK || !is_erased(0, W25Q_MODEL_CAPACITY)) {
+        return LED_STATUS_ERROR;
+    }
+
+    // 8. 超时：芯片一直忙，超过扇区擦除的最长时间后以超时结束
+    s_model.stuck = 1;
+    memset(&done, 0, sizeof(done));
+    w25q_erase_async(&flash, W25Q_ERASE_4K, 0, on_done, &done);
+    ticks = run_until_idle(&flash, 1000);
+    if (done.calls != 1 || done.status != LED_STATUS_TIMEOUT || ticks < W25Q_TIMEOUT_SECTOR_MS ||
+        ticks > W25Q_TIMEOUT_SECTOR_MS + 2) {
+        return LED_STATUS_ERROR;
+    }
+
+    // 整个过程中芯片忙时从未收到过读状态以外的指令
+    if (s_model.violations != 0) {
+        return LED_STATUS_ERROR;
+    }
+
+    spi_deinit(&spi);
+    return LED_STATUS_OK;
+}
+
+/* 读缓存测试 ---------------------------------------------------------------*/
+
+static uint8_t model_pattern(uint32_t address) {
+    return (uint8_t)((address * 7u) ^ (address >> 8));
+}
+
+// 复位模型 (存储内容按地址生成) 并初始化SPI和W25Q对象
+static led_status_t model_setup(spi_t* spi, w25q_t* flash) {
+    memset(&s_model, 0, sizeof(s_model));
+    for (uint32_t i = 0; i < W25Q_MODEL_CAPACITY; ++i) {
+        s_model.mem[i] = model_pattern(i);
+    }
+    s_model_tick = 0;
+    if (spi_init(spi, &s_model_api, &s_model) != LED_STATUS_OK) {
+        return LED_STATUS_ERROR;
+    }
+    return w25q_init(flash, spi);
+}
+
+// 经过缓存读取并与模型中的存储内容比较
+static led_status_t cache_read_check(w25q_cache_t* cache, uint32_t address, uint32_t len) {
+    static uint8_t buffer[1024];
+    led_status_t status = w25q_cache_read(cache, address, buffer, len);
+    if (status != LED_STATUS_OK) {
+        return status;
+    }
+    return (memcmp(buffer, &s_model.mem[address], len) == 0) ? LED_STATUS_OK : LED_STATUS_ERROR;
+}
+
+#define W25Q_CACHE_TEST_BLOCK 256u
+#define W25Q_CACHE_TEST_SETS  8u
+#define W25Q_CACHE_TEST_WAYS  2u
+
+led_status_t driver_w25q_test_cache(void) {
+    static spi_t spi;
+    static w25q_t flash;
+    static w25q_cache_t cache;
+    static w25q_cache_line_t lines[W25Q_CACHE_TEST_SETS * W25Q_CACHE_TEST_WAYS];
+    static uint8_t data[W25Q_CACHE_TEST_SETS * W25Q_CACHE_TEST_WAYS * W25Q_CACHE_TEST_BLOCK];
+    static uint8_t program_data[300];
+    w25q_cache_stats_t stats;
+    uint8_t buffer[4];
+
+    if (model_setup(&spi, &flash) != LED_STATUS_OK) {
+        return LED_STATUS_ERROR;
+    }
+    if (w25q_cache_init(&cache, &flash, lines, data, 100, W25Q_CACHE_TEST_SETS, W25Q_CACHE_TEST_WAYS) !=
+            LED_STATUS_INV_ARG ||
+        w25q_cache_init(&cache, &flash, lines, data, 8192, W25Q_CACHE_TEST_SETS, W25Q_CACHE_TEST_WAYS) !=
+            LED_STATUS_INV_ARG ||
+        w25q_cache_init(&cache, &flash, lines, data, W25Q_CACHE_TEST_BLOCK, W25Q_CACHE_TEST_SETS,
+                        W25Q_CACHE_TEST_WAYS) != LED_STATUS_OK) {
+        return LED_STATUS_ERROR;
+    }
+
+    // 1. 未命中时读入整块，之后同一块内的读取不再访问Flash
+    uint32_t transactions = s_model.transactions;
+    if (cache_read_check(&cache, 0x100, 32) != LED_STATUS_OK || s_model.transactions != transactions + 1 ||
+        cache_read_check(&cache, 0x110, 16) != LED_STATUS_OK || s_model.transactions != transactions + 1) {
+        return LED_STATUS_ERROR;
+    }
+    // 跨块读取：第一块命中，第二块未命中
+    if (cache_read_check(&cache, 0x1F0, 32) != LED_STATUS_OK || s_model.transactions != transactions + 2) {
+        return LED_STATUS_ERROR;
+    }
+    w25q_cache_get_stats(&cache, &stats);
+    if (stats.hits != 2 || stats.misses != 2 || stats.flash_reads != 2) {
+        return LED_STATUS_ERROR;
+    }
+
+    // 2. LRU：块16、24、32落在同一组 (2路)，访问16、24、16、32之后被替换的是24
+    w25q_cache_reset_stats(&cache);
+    static const uint32_t lru_blocks[] = { 16, 24, 16, 32, 16, 24 };
+    for (uint32_t i = 0; i < sizeof(lru_blocks) / sizeof(lru_blocks[0]); ++i) {
+        if (cache_read_check(&cache, lru_blocks[i] * W25Q_CACHE_TEST_BLOCK, 8) != LED_STATUS_OK) {
+            return LED_STATUS_ERROR;
+        }
+    }
+    w25q_cache_get_stats(&cache, &stats);
+    if (stats.hits != 2 || stats.misses != 4) {
+        return LED_STATUS_ERROR;
+    }
+
+    // 3. 写直达：编程使覆盖到的行失效；操作进行中失效的块返回BUSY，其他块照常命中
+    memset(program_data, 0x00, sizeof(program_data));
+    if (w25q_cache_program_async(&cache, 0x120, program_data, 4, NULL, NULL) != LED_STATUS_OK ||
+        cache.stats.invalidations != 1) {
+        return LED_STATUS_ERROR;
+    }
+    w25q_process(&flash);
+    if (w25q_cache_read(&cache, 0x120, buffer, sizeof(buffer)) != LED_STATUS_BUSY ||
+        cache_read_check(&cache, 0x200, 16) != LED_STATUS_OK) {
+        return LED_STATUS_ERROR;
+    }
+    // 组0已经装满 (块16和24)：未命中的块8返回BUSY，组内原有的两行都不会被替换掉
+    transactions = s_model.transactions;
+    if (w25q_cache_read(&cache, 8 * W25Q_CACHE_TEST_BLOCK, buffer, sizeof(buffer)) != LED_STATUS_BUSY ||
+        cache_read_check(&cache, 16 * W25Q_CACHE_TEST_BLOCK, 8) != LED_STATUS_OK ||
+        cache_read_check(&cache, 24 * W25Q_CACHE_TEST_BLOCK, 8) != LED_STATUS_OK ||
+        s_model.transactions != transactions) {
+        return LED_STATUS_ERROR;
+    }
+    run_until_idle(&flash, 100);
+    if (cache_read_check(&cache, 0x100, 64) != LED_STATUS_OK || s_model.mem[0x120] != 0x00) {
+        return LED_STATUS_ERROR;
+    }
+    // 擦除使整个扇区内的行失效
+    if (w25q_cache_erase(&cache, W25Q_ERASE_4K, 0) != LED_STATUS_OK ||
+        cache_read_check(&cache, 0x100, 256) != LED_STATUS_OK || !is_erased(0x100, 0x200) ||
+        cache_read_check(&cache, 0x200, 16) != LED_STATUS_OK) {
+        return LED_STATUS_ERROR;
+    }
+
+    // 4. 预读：连续访问两个相邻的块之后，一次事务读入当前块和后面3块
+    if (w25q_cache_set_readahead(&cache, W25Q_READ_MAX_BUFFERS) != LED_STATUS_INV_ARG ||
+        w25q_cache_set_readahead(&cache, W25Q_CACHE_TEST_SETS) != LED_STATUS_INV_ARG ||
+        w25q_cache_set_readahead(&cache, 3) != LED_STATUS_OK) {
+        return LED_STATUS_ERROR;
+    }
+    w25q_cache_reset_stats(&cache);
+    for (uint32_t address = 0x8000; address < 0x8800; address += 64) {
+        if (cache_read_check(&cache, address, 64) != LED_STATUS_OK) {
+            return LED_STATUS_ERROR;
+        }
+    }
+    // 块0x80单独读入；0x81触发预读0x82 ~ 0x84；0x85触发预读0x86 ~ 0x88
+    w25q_cache_get_stats(&cache, &stats);
+    if (stats.misses != 3 || stats.hits != 29 || stats.flash_reads != 3 || stats.prefetched != 6 ||
+        stats.prefetch_hits != 5) {
+        return LED_STATUS_ERROR;
+    }
+
+    // 5. 随机读写与模型中的存储内容对照
+    uint32_t seed = 12345;
+    for (uint32_t i = 0; i < 3000; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        uint32_t r = seed >> 8;
+        uint32_t address = r % 0x8000u;
+        uint32_t kind = r % 20u;
+        if (kind == 0) {
+            if (w25q_cache_erase(&cache, W25Q_ERASE_4K, address & ~(W25Q_SECTOR_SIZE - 1)) != LED_STATUS_OK) {
+                return LED_STATUS_ERROR;
+            }
+        } else if (kind <= 3) {
+            uint32_t len = 1 + (r >> 4) % sizeof(program_data);
+            for (uint32_t j = 0; j < len; ++j) {
+                program_data[j] = (uint8_t)(seed >> (j & 7));
+            }
+            if (w25q_cache_program(&cache, address, program_data, len) != LED_STATUS_OK) {
+                return LED_STATUS_ERROR;
+            }
+        } else {
+            uint32_t len = 1 + (r >> 4) % 600u;
+            if (cache_read_check(&cache, address, len) != LED_STATUS_OK) {
+                return LED_STATUS_ERROR;
+            }
+        }
+    }
+
+    if (s_model.violations != 0) {
+        return LED_STATUS_ERROR;
+    }
+    spi_deinit(&spi);
+    return LED_STATUS_OK;
+}
+
+/* 读缓存基准测试 -----------------------------------------------------------*/
+// 按几种典型的访问模式人工构造访问序列 (不是实测记录)，比较不用缓存和几种缓存配置 (数据区都是4KB) 的Flash事务数、
+// 总线字节数和估算的总线时间，以及每次读取的CPU开销。
+// 访问序列的每一项表示：从address开始读len字节，重复count次，每次地址增加stride。
+
+// 估算总线时间用的参数：SPI时钟21MHz，每个事务的固定开销 (片选、启动DMA、中断) 约2微秒
+#define W25Q_BENCH_SPI_KHZ        21000u
+#define W25Q_BENCH_TRANSACTION_NS 2000u
+
+typedef struct {
+    uint32_t address;
+    uint16_t len;
+    uint16_t count;
+    uint32_t stride;
+} w25q_trace_t;
+
+typedef struct {
+    const char* name;
+    const w25q_trace_t* items;
+    uint32_t count;
+    uint32_t rounds;
+} w25q_trace_set_t;
+
+// 配置参数：启动和周期性重新加载时解析两个扇区中的小记录
+static const w25q_trace_t s_trace_config[] = {
+    { 0x0000, 16, 1, 0 },  { 0x0010, 4, 24, 4 },  { 0x0080, 32, 8, 32 }, { 0x1000, 16, 1, 0 },
+    { 0x1010, 8, 32, 8 },  { 0x0000, 16, 1, 0 },  { 0x1200, 64, 4, 64 }, { 0x0180, 32, 6, 40 },
+};
+
+// 查找表：在8KB的表中按索引取4字节的表项
+static const w25q_trace_t s_trace_lut[] = {
+    { 0x4000, 4, 64, 124 }, { 0x4010, 4, 64, 60 }, { 0x4800, 4, 32, 4 }, { 0x5F00, 4, 48, 3 },
+    { 0x4000, 4, 16, 516 }, { 0x4404, 4, 64, 32 },
+};
+
+// 顺序读取：按64字节读出一个32KB的文件 (例如固件镜像校验)
+static const w25q_trace_t s_trace_stream[] = {
+    { 0x10000, 64, 512, 64 },
+};
+
+// 混合：顺序读取的同时穿插配置和查找表访问
+static const w25q_trace_t s_trace_mixed[] = {
+    { 0x10000, 64, 32, 64 }, { 0x0010, 4, 8, 4 },    { 0x4000, 4, 16, 124 }, { 0x10800, 64, 32, 64 },
+    { 0x1010, 8, 8, 8 },     { 0x4404, 4, 16, 32 },  { 0x11000, 64, 32, 64 }, { 0x0000, 16, 1, 0 },
+    { 0x11800, 64, 32, 64 }, { 0x4800, 4, 16, 4 },
+};
+
+static const w25q_trace_set_t s_traces[] = {
+    { "config", s_trace_config, sizeof(s_trace_config) / sizeof(s_trace_config[0]), 20 },
+    { "lut", s_trace_lut, sizeof(s_trace_lut) / sizeof(s_trace_lut[0]), 20 },
+    { "stream", s_trace_stream, sizeof(s_trace_stream) / sizeof(s_trace_stream[0]), 2 },
+    { "mixed", s_trace_mixed, sizeof(s_trace_mixed) / sizeof(s_trace_mixed[0]), 10 },
+};
+
+typedef struct {
+    const char* name;
+    uint16_t block_size;        /**< 0表示不用缓存 */
+    uint16_t sets;
+    uint8_t ways;
+    uint8_t readahead;
+} w25q_cache_config_t;
+
+static const w25q_cache_config_t s_cache_configs[] = {
+    { "none", 0, 0, 0, 0 },
+    { "256x8x2", 256, 8, 2, 0 },
+    { "256x4x4", 256, 4, 4, 0 },
+    { "1Kx2x2", 1024, 2, 2, 0 },
+    { "4Kx1x1", 4096, 1, 1, 0 },
+    { "256x8x2+ra3", 256, 8, 2, 3 },
+};
+
+#define W25Q_BENCH_CACHE_BYTES 4096u
+#define W25Q_BENCH_CACHE_LINES 16u
+
+void driver_w25q_benchmark_cache(void) {
+    static spi_t spi;
+    static w25q_t flash;
+    static w25q_cache_t cache;
+    static w25q_cache_line_t lines[W25Q_BENCH_CACHE_LINES];
+    static uint8_t data[W25Q_BENCH_CACHE_BYTES];
+    static uint8_t buffer[256];
+
+    if (model_setup(&spi, &flash) != LED_STATUS_OK) {
+        return;
+    }
+    bench_cycle_counter_init();
+
+    bench_report("w25q read cache, 4KB of cache data (bus time @%ukHz + %uns per transaction, %s per read)\r\n",
+           (unsigned)W25Q_BENCH_SPI_KHZ, (unsigned)W25Q_BENCH_TRANSACTION_NS, BENCH_UNIT);
+    for (uint32_t t = 0; t < sizeof(s_traces) / sizeof(s_traces[0]); ++t) {
+        const w25q_trace_set_t* trace = &s_traces[t];
+        bench_report("%s\r\n", trace->name);
+        bench_report("  %-12s %6s %6s %8s %9s %7s %6s\r\n", "cache", "reads", "trans", "bytes", "bus(us)", "hit%",
+               "cpu");
+        for (uint32_t c = 0; c < sizeof(s_cache_configs) / sizeof(s_cache_configs[0]); ++c) {
+            const w25q_cache_config_t* config = &s_cache_configs[c];
+            if (config->block_size != 0) {
+                w25q_cache_init(&cache, &flash, lines, data, config->block_size, config->sets, config->ways);
+                w25q_cache_set_readahead(&cache, config->readahead);
+            }
+
+            uint32_t transactions = s_model.transactions;
+            uint32_t bytes = s_model.bytes;
+            uint32_t reads = 0;
+            uint32_t cpu = 0;
+            for (uint32_t round = 0; round < trace->rounds; ++round) {
+                for (uint32_t i = 0; i < trace->count; ++i) {
+                    const w25q_trace_t* item = &trace->items[i];
+                    for (uint32_t k = 0; k < item->count; ++k) {
+                        uint32_t address = item->address + k * item->stride;
+                        uint32_t t0 = bench_now();
+                        if (config->block_size != 0) {
+                            w25q_cache_read(&cache, address, buffer, item->len);
+                        } else {
+                            w25q_read(&flash, address, buffer, item->len);
+                        }
+                        cpu += bench_now() - t0;
+                        reads++;
+                    }
+                }
+            }
+
+            transactions = s_model.transactions - transactions;
+            bytes = s_model.bytes - bytes;
+            uint32_t bus_us = (uint32_t)(((uint64_t)bytes * 8u * 1000u / W25Q_BENCH_SPI_KHZ +
+                                          (uint64_t)transactions * W25Q_BENCH_TRANSACTION_NS) / 1000u);
+            uint32_t hit_percent = 0;
+            if (config->block_size != 0 && cache.stats.hits + cache.stats.misses != 0) {
+                hit_percent = cache.stats.hits * 100u / (cache.stats.hits + cache.stats.misses);
+            }
+            bench_report("  %-12s %6lu %6lu %8lu %9lu %6lu%% %6lu\r\n", config->name, (unsigned long)reads,
+                   (unsigned long)transactions, (unsigned long)bytes, (unsigned long)bus_us,
+                   (unsigned long)hit_percent, (unsigned long)(cpu / reads));
+        }
+    }
+    spi_deinit(&spi);
+}
+
+/* 记录存储测试 -------------------------------------------------------------*/
+
+#define W25Q_STORE_TEST_FIRST   16u
+#define W25Q_STORE_TEST_SECTORS 8u
+#define W25Q_STORE_TEST_BUFFER  1024u
+
+static w25q_store_sector_t s_store_sectors[W25Q_MODEL_CAPACITY / W25Q_SECTOR_SIZE];
+static uint8_t s_store_buffer[W25Q_STORE_TEST_BUFFER];
+
+// 掉电后重新上电：芯片回到空闲状态，进行中的传输丢失
+static void model_power_on(w25q_model_t* m) {
+    m->dead = 0;
+    m->cut_after = 0;
+    m->cs_low = 0;
+    m->pos = 0;
+    m->cmd = 0;
+    m->len = 0;
+    m->wel = 0;
+    m->op_active = 0;
+}
+
+// 记录n的内容：前4字节是n，之后由n生成
+static void store_record_fill(uint8_t* buffer, uint32_t n, uint32_t len) {
+    for (uint32_t i = 0; i < len; ++i) {
+        buffer[i] = (i < 4) ? (uint8_t)(n >> (8 * i)) : (uint8_t)(n * 31u + i);
+    }
+}
+
+static uint32_t store_record_len(uint32_t n) {
+    return 4u + (n * 37u) % 200u;
+}
+
+// 检查记录内容，返回记录号，内容不对时返回0xFFFFFFFF
+static uint32_t store_record_check(const uint8_t* buffer, uint32_t len) {
+    static uint8_t expected[W25Q_STORE_MAX_RECORD];
+    if (len < 4) {
+        return 0xFFFFFFFFu;
+    }
+    uint32_t n = (uint32_t)buffer[0] | ((uint32_t)buffer[1] << 8) | ((uint32_t)buffer[2] << 16) |
+                 ((uint32_t)buffer[3] << 24);
+    if (len != store_record_len(n)) {
+        return 0xFFFFFFFFu;
+    }
+    store_record_fill(expected, n, len);
+    return (memcmp(buffer, expected, len) == 0) ? n : 0xFFFFFFFFu;
+}
+
+// 初始化并挂载 (上电后)
+static led_status_t store_boot(spi_t* spi, w25q_t* flash, w25q_store_t* store, uint16_t sectors) {
+    if (spi_init(spi, &s_model_api, &s_model) != LED_STATUS_OK || w25q_init(flash, spi) != LED_STATUS_OK ||
+        w25q_store_init(store, flash, W25Q_STORE_TEST_FIRST, sectors, s_store_sectors, s_store_buffer,
+                        sizeof(s_store_buffer)) != LED_STATUS_OK) {
+        return LED_STATUS_ERROR;
+    }
+    return w25q_store_mount(store);
+}
+
+// 主循环：每个节拍调用一次w25q_store_process，直到空闲
+static void store_run(w25q_store_t* store, uint32_t max_ticks) {
+    uint32_t start = s_model_tick;
+    while (w25q_store_process(store) == LED_STATUS_BUSY && s_model_tick - start < max_ticks && !s_model.dead) {
+        model_irq(&s_model);
+        s_model_tick++;
+    }
+}
+
+// 从头读出全部记录，检查内容和顺序 (记录号递增)；返回读到的记录数，出错时返回0xFFFFFFFF
+static uint32_t store_read_all(w25q_store_t* store, uint32_t* first, uint32_t* last) {
+    static uint8_t buffer[W25Q_STORE_MAX_RECORD];
+    w25q_store_cursor_t cursor;
+    uint32_t count = 0;
+    uint32_t len;
+
+    w25q_store_rewind(store, &cursor);
+    for (;;) {
+        if (w25q_store_read(store, &cursor, buffer, sizeof(buffer), &len) != LED_STATUS_OK) {
+            return 0xFFFFFFFFu;
+        }
+        if (len == 0) {
+            return count;
+        }
+        uint32_t n = store_record_check(buffer, len);
+        if (n == 0xFFFFFFFFu || (count != 0 && n <= *last)) {
+            return 0xFFFFFFFFu;
+        }
+        if (count == 0) {
+            *first = n;
+        }
+        *last = n;
+        count++;
+    }
+}
+
+static led_status_t store_append_record(w25q_store_t* store, uint32_t n) {
+    uint8_t buffer[W25Q_STORE_MAX_RECORD];
+    uint32_t len = store_record_len(n);
+    store_record_fill(buffer, n, len);
+    return w25q_store_append(store, buffer, len);
+}
+
+// 破坏一条记录的一个数据字节 (模拟存储单元出错)，cursor是刚读完这条记录之后的读取位置
+static void store_record_corrupt(w25q_store_t* store, const w25q_store_cursor_t* cursor, uint32_t len) {
+    for (uint16_t i = 0; i < store->sector_count; ++i) {
+        if (store->sectors[i].state == W25Q_STORE_SECTOR_USED && store->sectors[i].seq == cursor->seq) {
+            uint32_t address = (W25Q_STORE_TEST_FIRST + i) * W25Q_SECTOR_SIZE + cursor->offset -
+                               W25Q_STORE_RECORD_SIZE(len) + W25Q_STORE_RECORD_HEADER_SIZE + len / 2;
+            s_model.mem[address] ^= 0x5A;
+            return;
+        }
+    }
+}
+
+led_status_t driver_w25q_test_store(void) {
+    static spi_t spi;
+    static w25q_t flash;
+    static w25q_store_t store;
+    uint32_t first = 0;
+    uint32_t last = 0;
+    uint32_t n = 0;
+
+    // 存储区域里是旧数据 (不是本存储的格式)
+    if (model_setup(&spi, &flash) != LED_STATUS_OK) {
+        return LED_STATUS_ERROR;
+    }
+    if (w25q_store_init(&store, &flash, W25Q_STORE_TEST_FIRST, 2, s_store_sectors, s_store_buffer,
+                        sizeof(s_store_buffer)) != LED_STATUS_INV_ARG ||
+        w25q_store_init(&store, &flash, 30, 3, s_store_sectors, s_store_buffer, sizeof(s_store_buffer)) !=
+            LED_STATUS_INV_ARG) {
+        return LED_STATUS_ERROR;
+    }
+
+    // 1. 挂载：所有扇区都需要擦除，没有记录
+    if (store_boot(&spi, &flash, &store, W25Q_STORE_TEST_SECTORS) != LED_STATUS_OK ||
+        store.head != W25Q_STORE_TEST_SECTORS || store_read_all(&store, &first, &last) != 0 ||
+        w25q_store_set_gc(&store, 0, 0) != LED_STATUS_INV_ARG ||
+        w25q_store_set_gc(&store, W25Q_STORE_TEST_SECTORS - 1, 0) != LED_STATUS_INV_ARG) {
+        return LED_STATUS_ERROR;
+    }
+    for (uint32_t i = 0; i < W25Q_STORE_TEST_SECTORS; ++i) {
+        if (s_store_sectors[i].state != W25Q_STORE_SECTOR_DIRTY) {
+            return LED_STATUS_ERROR;
+        }
+    }
+
+    // 2. 追加：立即返回，后台擦除一个扇区后写入，再预先擦除一个备用；写入后可以按顺序读出
+    for (; n < 3; ++n) {
+        if (store_append_record(&store, n) != LED_STATUS_OK) {
+            return LED_STATUS_ERROR;
+        }
+    }
+    if (s_model.erases != 0 || w25q_store_flush(&store) != LED_STATUS_OK || store.stats.committed != 3 ||
+        store.stats.erases != 2 || store_read_all(&store, &first, &last) != 3 || first != 0 || last != 2) {
+        return LED_STATUS_ERROR;
+    }
+
+    // 3. 重新挂载：只读扇区头和头扇区，之后接着追加
+    uint32_t transactions = s_model.transactions;
+    if (store_boot(&spi, &flash, &store, W25Q_STORE_TEST_SECTORS) != LED_STATUS_OK ||
+        s_model.transactions - transactions > 1 + W25Q_STORE_TEST_SECTORS + 1 ||
+        store_read_all(&store, &first, &last) != 3) {
+        return LED_STATUS_ERROR;
+    }
+    if (store_append_record(&store, n++) != LED_STATUS_OK || w25q_store_flush(&store) != LED_STATUS_OK ||
+        store_boot(&spi, &flash, &store, W25Q_STORE_TEST_SECTORS) != LED_STATUS_OK ||
+        store_read_all(&store, &first, &last) != 4 || last != 3) {
+        return LED_STATUS_ERROR;
+    }
+
+    // 4. 读取位置停在头扇区的末尾，之后提交的记录接着读出
+    static uint8_t buffer[W25Q_STORE_MAX_RECORD];
+    w25q_store_cursor_t cursor;
+    uint32_t len = 0;
+    w25q_store_rewind(&store, &cursor);
+    for (uint32_t i = 0; i < 4; ++i) {
+        w25q_store_read(&store, &cursor, buffer, sizeof(buffer), &len);
+    }
+    if (w25q_store_read(&store, &cursor, buffer, sizeof(buffer), &len) != LED_STATUS_OK || len != 0 ||
+        store_append_record(&store, n++) != LED_STATUS_OK || w25q_store_flush(&store) != LED_STATUS_OK ||
+        w25q_store_read(&store, &cursor, buffer, sizeof(buffer), &len) != LED_STATUS_OK ||
+        store_record_check(buffer, len) != 4 ||
+        w25q_store_read(&store, &cursor, buffer, 2, &len) != LED_STATUS_OK || len != 0) {
+        return LED_STATUS_ERROR;
+    }
+
+    // 5. 写满：不覆盖时空间用完后flush失败，释放已读的扇区后继续
+    uint32_t full_at = 0;
+    for (uint32_t i = 0; i < 400 && full_at == 0; ++i) {
+        if (store_append_record(&store, n) == LED_STATUS_OK) {
+            n++;
+        }
+        if (w25q_store_flush(&store) != LED_STATUS_OK) {
+            full_at = n;
+        }
+    }
+    // 最后追加的一条还在缓冲区中
+    if (full_at == 0 || store_read_all(&store, &first, &last) != full_at - 1 || first != 0 || last != full_at - 2) {
+        return LED_STATUS_ERROR;
+    }
+    // 读到一半，释放之前的扇区
+    w25q_store_rewind(&store, &cursor);
+    for (uint32_t i = 0; i < full_at / 2; ++i) {
+        w25q_store_read(&store, &cursor, buffer, sizeof(buffer), &len);
+    }
+    w25q_store_release(&store, &cursor);
+    if (w25q_store_flush(&store) != LED_STATUS_OK || store_read_all(&store, &first, &last) == 0xFFFFFFFFu ||
+        first == 0 || first > full_at / 2 || last != n - 1) {
+        return LED_STATUS_ERROR;
+    }
+    // 释放在重新挂载后仍然有效
+    uint32_t released_first = first;
+    if (store_boot(&spi, &flash, &store, W25Q_STORE_TEST_SECTORS) != LED_STATUS_OK ||
+        store_read_all(&store, &first, &last) == 0xFFFFFFFFu || first != released_first || last != n - 1) {
+        return LED_STATUS_ERROR;
+    }
+
+    // 6. 环形日志：一直追加，最旧的扇区被丢弃，擦除次数保持均匀
+    if (w25q_store_set_gc(&store, 2, 1) != LED_STATUS_OK) {
+        return LED_STATUS_ERROR;
+    }
+    for (uint32_t i = 0; i < 2500; ++i) {
+        while (store_append_record(&store, n) == LED_STATUS_BUSY) {
+            store_run(&store, 1);
+        }
+        n++;
+        w25q_store_process(&store);
+    }
+    if (w25q_store_flush(&store) != LED_STATUS_OK || store.stats.dropped == 0 ||
+        store_read_all(&store, &first, &last) == 0xFFFFFFFFu || last != n - 1) {
+        return LED_STATUS_ERROR;
+    }
+    uint32_t min_erase = 0xFFFFFFFFu;
+    uint32_t max_erase = 0;
+    for (uint32_t i = 0; i < W25Q_STORE_TEST_SECTORS; ++i) {
+        uint32_t count = s_store_sectors[i].erase_count;
+        min_erase = count < min_erase ? count : min_erase;
+        max_erase = count > max_erase ? count : max_erase;
+    }
+    if (min_erase < 5 || max_erase - min_erase > 1) {
+        return LED_STATUS_ERROR;
+    }
+
+    // 7. 擦除期间追加的记录留在缓冲区中，缓冲区满时返回BUSY
+    uint32_t busy = 0;
+    for (uint32_t i = 0; i < 200 && busy == 0; ++i) {
+        if (store_append_record(&store, n) == LED_STATUS_BUSY) {
+            busy = 1;
+        } else {
+            n++;
+        }
+    }
+    if (!busy || w25q_store_flush(&store) != LED_STATUS_OK ||
+        store_read_all(&store, &first, &last) == 0xFFFFFFFFu || last != n - 1) {
+        return LED_STATUS_ERROR;
+    }
+
+    // 8. 写记录时掉电：重新挂载后之前的记录完整，写了一半的记录被丢弃，之后的记录写入新的扇区
+    store_append_record(&store, n++);
+    store_append_record(&store, n++);
+    s_model.cut_after = 1;
+    s_model.cut_seed = 7;
+    store_run(&store, 100);
+    model_power_on(&s_model);
+    if (store_boot(&spi, &flash, &store, W25Q_STORE_TEST_SECTORS) != LED_STATUS_OK || !store.head_sealed ||
+        store_read_all(&store, &first, &last) == 0xFFFFFFFFu || last != n - 3) {
+        return LED_STATUS_ERROR;
+    }
+    uint32_t head = store.head;
+    if (store_append_record(&store, n++) != LED_STATUS_OK || w25q_store_flush(&store) != LED_STATUS_OK ||
+        store.head == head || store_read_all(&store, &first, &last) == 0xFFFFFFFFu || last != n - 1) {
+        return LED_STATUS_ERROR;
+    }
+
+    // 9. 数据损坏 (校验失败) 的记录被跳过并计入errors，后面的记录照常读出：
+    // 分别破坏最旧扇区的第一条记录和头扇区的倒数第二条记录
+    for (uint32_t i = 0; i < 3; ++i) {
+        if (store_append_record(&store, n++) != LED_STATUS_OK) {
+            return LED_STATUS_ERROR;
+        }
+    }
+    if (w25q_store_flush(&store) != LED_STATUS_OK) {
+        return LED_STATUS_ERROR;
+    }
+    uint32_t total = store_read_all(&store, &first, &last);
+    w25q_store_rewind(&store, &cursor);
+    if (total == 0xFFFFFFFFu || w25q_store_read(&store, &cursor, buffer, sizeof(buffer), &len) != LED_STATUS_OK ||
+        store_record_check(buffer, len) != first) {
+        return LED_STATUS_ERROR;
+    }
+    uint32_t corrupted = first;
+    store_record_corrupt(&store, &cursor, len);
+    w25q_store_cursor_t tail[2] = { cursor, cursor };
+    uint32_t tail_len[2] = { len, len };
+    while (w25q_store_read(&store, &cursor, buffer, sizeof(buffer), &len) == LED_STATUS_OK && len != 0) {
+        tail[0] = tail[1];
+        tail_len[0] = tail_len[1];
+        tail[1] = cursor;
+        tail_len[1] = len;
+    }
+    if (tail[0].seq != store.sectors[store.head].seq || tail[1].seq != tail[0].seq) {
+        return LED_STATUS_ERROR;
+    }
+    store_record_corrupt(&store, &tail[0], tail_len[0]);
+    uint32_t errors = store.stats.errors;
+    if (store_read_all(&store, &first, &last) != total - 2 || first != corrupted + 1 || last != n - 1 ||
+        store.stats.errors != errors + 2) {
+        return LED_STATUS_ERROR;
+    }
+    // 挂载只检查记录头，损坏的记录不影响之后的追加
+    if (store_append_record(&store, n++) != LED_STATUS_OK || w25q_store_flush(&store) != LED_STATUS_OK ||
+        store_boot(&spi, &flash, &store, W25Q_STORE_TEST_SECTORS) != LED_STATUS_OK ||
+        store_read_all(&store, &first, &last) != total - 1 || first != corrupted + 1 || last != n - 1) {
+        return LED_STATUS_ERROR;
+    }
+
+    if (s_model.violations != 0 || s_model.overflows != 0) {
+        return LED_STATUS_ERROR;
+    }
+    spi_deinit(&spi);
+    return LED_STATUS_OK;
+}
+
+/* 掉电测试 -----------------------------------------------------------------*/
+// 随机追加、读取和释放记录，在随机的编程/擦除操作中途掉电 (写入或擦除随机的一部分)，
+// 重新上电挂载后检查：
+//   - 读出的记录内容完整、记录号递增，没有写了一半的记录，也没有已经消失的记录重新出现；
+//   - 已确认提交的记录从最旧的一条开始没有缺失 (只有释放或覆盖能从最旧的一端删除记录)。
+
+#define W25Q_FUZZ_MAX_RECORDS 65536u
+
+enum {
+    W25Q_FUZZ_NONE = 0,         /**< 没有追加过 */
+    W25Q_FUZZ_PENDING,          /**< 已追加，还没有确认提交 */
+    W25Q_FUZZ_COMMITTED,        /**< 已确认提交 */
+    W25Q_FUZZ_GONE,             /**< 已删除或掉电丢失，不能再出现 */
+    W25Q_FUZZ_SEEN,             /**< 本次检查中读到 */
+};
+
+static uint8_t s_fuzz_state[W25Q_FUZZ_MAX_RECORDS];
+
+static uint32_t fuzz_random(uint32_t* seed) {
+    *seed = *seed * 1664525u + 1013904223u;
+    return *seed >> 8;
+}
+
+// 挂载后读出全部记录并与记录状态对照，low为可能还存在的最小记录号
+static led_status_t fuzz_check(w25q_store_t* store, uint32_t* low, uint32_t next) {
+    static uint8_t buffer[W25Q_STORE_MAX_RECORD];
+    w25q_store_cursor_t cursor;
+    uint32_t first = next;
+    uint32_t last = 0;
+    uint32_t count = 0;
+    uint32_t len;
+
+    w25q_store_rewind(store, &cursor);
+    for (;;) {
+        if (w25q_store_read(store, &cursor, buffer, sizeof(buffer), &len) != LED_STATUS_OK) {
+            return LED_STATUS_ERROR;
+        }
+        if (len == 0) {
+            break;
+        }
+        uint32_t n = store_record_check(buffer, len);
+        if (n >= next || (count != 0 && n <= last) ||
+            (s_fuzz_state[n] != W25Q_FUZZ_PENDING && s_fuzz_state[n] != W25Q_FUZZ_COMMITTED)) {
+            return LED_STATUS_ERROR;
+        }
+        if (count == 0) {
+            first = n;
+        }
+        s_fuzz_state[n] = W25Q_FUZZ_SEEN;
+        last = n;
+        count++;
+    }
+
+    for (uint32_t n = *low; n < next; ++n) {
+        switch (s_fuzz_state[n]) {
+        case W25Q_FUZZ_SEEN:
+            s_fuzz_state[n] = W25Q_FUZZ_COMMITTED;
+            break;
+        case W25Q_FUZZ_COMMITTED:
+            // 已确认的记录只能从最旧的一端被删除
+            if (n > first) {
+                return LED_STATUS_ERROR;
+            }
+            s_fuzz_state[n] = W25Q_FUZZ_GONE;
+            break;
+        case W25Q_FUZZ_PENDING:
+            s_fuzz_state[n] = W25Q_FUZZ_GONE;
+            break;
+        default:
+            break;
+        }
+    }
+    *low = first;
+    return LED_STATUS_OK;
+}
+
+led_status_t driver_w25q_test_store_power_cut(uint32_t cycles) {
+    static spi_t spi;
+    static w25q_t flash;
+    static w25q_store_t store;
+    static uint8_t buffer[W25Q_STORE_MAX_RECORD];
+    uint32_t seed = 2024;
+    uint32_t next = 0;
+    uint32_t low = 0;
+    uint32_t len;
+
+    memset(s_fuzz_state, 0, sizeof(s_fuzz_state));
+    if (model_setup(&spi, &flash) != LED_STATUS_OK ||
+        store_boot(&spi, &flash, &store, W25Q_STORE_TEST_SECTORS) != LED_STATUS_OK) {
+        return LED_STATUS_ERROR;
+    }
+
+    for (uint32_t cycle = 0; cycle < cycles && next < W25Q_FUZZ_MAX_RECORDS - 1000; ++cycle) {
+        // 覆盖和不覆盖 (由读取方释放) 两种策略轮流使用
+        uint8_t overwrite = (uint8_t)(cycle & 1);
+        if (w25q_store_set_gc(&store, 1, overwrite) != LED_STATUS_OK) {
+            return LED_STATUS_ERROR;
+        }
+        s_model.cut_after = 1 + fuzz_random(&seed) % 40;
+        s_model.cut_seed = fuzz_random(&seed);
+
+        uint32_t base = next;
+        uint32_t acked = 0;
+        uint32_t ticks = 0;
+        while (!s_model.dead) {
+            uint32_t r = fuzz_random(&seed);
+            if (r % 4 != 0 && store_append_record(&store, next) == LED_STATUS_OK) {
+                s_fuzz_state[next++] = W25Q_FUZZ_PENDING;
+            }
+            if (r % 32 == 0 || (!overwrite && r % 4 == 0)) {
+                // 读出一些记录，释放它们之前的扇区
+                w25q_store_cursor_t cursor;
+                w25q_store_rewind(&store, &cursor);
+                for (uint32_t i = 0; i < (r >> 5) % 64; ++i) {
+                    if (w25q_store_read(&store, &cursor, buffer, sizeof(buffer), &len) != LED_STATUS_OK ||
+                        len == 0) {
+                        break;
+                    }
+                }
+                w25q_store_release(&store, &cursor);
+            }
+            w25q_store_process(&store);
+            for (; acked < store.stats.committed; ++acked) {
+                s_fuzz_state[base + acked] = W25Q_FUZZ_COMMITTED;
+            }
+            model_irq(&s_model);
+            s_model_tick++;
+            if (++ticks > 100000) {
+                return LED_STATUS_ERROR;
+            }
+        }
+
+        // 重新上电
+        model_power_on(&s_model);
+        if (store_boot(&spi, &flash, &store, W25Q_STORE_TEST_SECTORS) != LED_STATUS_OK ||
+            fuzz_check(&store, &low, next) != LED_STATUS_OK) {
+            return LED_STATUS_ERROR;
+        }
+    }
+
+    if (s_model.violations != 0 || s_model.overflows != 0) {
+        return LED_STATUS_ERROR;
+    }
+    spi_deinit(&spi);
+    return LED_STATUS_OK;
+}
+
+/* 记录存储基准测试 ---------------------------------------------------------*/
+// 以不同的记录长度连续追加 (环形覆盖)，统计Flash操作并按数据手册的典型值估算Flash时间和吞吐量，
+// 同时测量每条记录的CPU开销 (追加和后台处理)、各扇区的擦除次数，以及挂载与全盘扫描的代价。
+
+// 典型值：字节编程首字节30微秒、之后每字节2.5微秒，扇区擦除45毫秒
+#define W25Q_BENCH_PROGRAM_FIRST_NS 30000u
+#define W25Q_BENCH_PROGRAM_BYTE_NS  2500u
+#define W25Q_BENCH_SECTOR_ERASE_NS  45000000u
+
+#define W25Q_BENCH_STORE_SECTORS 16u
+#define W25Q_BENCH_STORE_RECORDS 4000u
+
+void driver_w25q_benchmark_store(void) {
+    static spi_t spi;
+    static w25q_t flash;
+    static w25q_store_t store;
+    static uint8_t record[256];
+    static const uint16_t sizes[] = { 16, 64, 240 };
+
+    bench_cycle_counter_init();
+    bench_report("w25q record store, %u sectors, %u records per size (flash time estimated from datasheet typicals, "
+           "cpu in %s per record)\r\n",
+           (unsigned)W25Q_BENCH_STORE_SECTORS, (unsigned)W25Q_BENCH_STORE_RECORDS, BENCH_UNIT);
+    bench_report("  %5s %8s %7s %10s %9s %8s %6s %6s %7s\r\n", "size", "programs", "erases", "flash(ms)", "records/s",
+           "KB/s", "cpu", "stalls", "wear");
+
+    for (uint32_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+        if (model_setup(&spi, &flash) != LED_STATUS_OK ||
+            store_boot(&spi, &flash, &store, W25Q_BENCH_STORE_SECTORS) != LED_STATUS_OK ||
+            w25q_store_set_gc(&store, 2, 1) != LED_STATUS_OK || w25q_store_flush(&store) != LED_STATUS_OK) {
+            return;
+        }
+        uint32_t programs = s_model.programs;
+        uint32_t program_bytes = s_model.program_bytes;
+        uint32_t erases = s_model.erases;
+        uint32_t bytes = s_model.bytes;
+        uint32_t cpu = 0;
+        uint32_t stalls = 0;
+
+        for (uint32_t i = 0; i < W25Q_BENCH_STORE_RECORDS; ++i) {
+            store_record_fill(record, i, sizes[s]);
+            uint32_t t0 = bench_now();
+            led_status_t status = w25q_store_append(&store, record, sizes[s]);
+            w25q_store_process(&store);
+            cpu += bench_now() - t0;
+            while (status == LED_STATUS_BUSY) {
+                // 追加缓冲区满：等Flash操作推进
+                stalls++;
+                model_irq(&s_model);
+                s_model_tick++;
+                t0 = bench_now();
+                w25q_store_process(&store);
+                status = w25q_store_append(&store, record, sizes[s]);
+                cpu += bench_now() - t0;
+            }
+            model_irq(&s_model);
+            s_model_tick++;
+        }
+        w25q_store_flush(&store);
+
+        programs = s_model.programs - programs;
+        program_bytes = s_model.program_bytes - program_bytes;
+        erases = s_model.erases - erases;
+        bytes = s_model.bytes - bytes;
+        uint64_t flash_ns = (uint64_t)programs * W25Q_BENCH_PROGRAM_FIRST_NS +
+                            (uint64_t)(program_bytes - programs) * W25Q_BENCH_PROGRAM_BYTE_NS +
+                            (uint64_t)erases * W25Q_BENCH_SECTOR_ERASE_NS +
+                            (uint64_t)bytes * 8u * 1000000u / W25Q_BENCH_SPI_KHZ;
+        uint32_t records_per_s = (uint32_t)((uint64_t)W25Q_BENCH_STORE_RECORDS * 1000000000u / flash_ns);
+        uint32_t kb_per_s = (uint32_t)((uint64_t)records_per_s * sizes[s] / 1024u);
+        uint32_t min_erase = 0xFFFFFFFFu;
+        uint32_t max_erase = 0;
+        for (uint32_t i = 0; i < W25Q_BENCH_STORE_SECTORS; ++i) {
+            uint32_t count = s_store_sectors[i].erase_count;
+            min_erase = count < min_erase ? count : min_erase;
+            max_erase = count > max_erase ? count : max_erase;
+        }
+        bench_report("  %5u %8lu %7lu %10lu %9lu %8lu %6lu %6lu %3lu-%-3lu\r\n", sizes[s], (unsigned long)programs,
+               (unsigned long)erases, (unsigned long)(flash_ns / 1000000u), (unsigned long)records_per_s,
+               (unsigned long)kb_per_s, (unsigned long)(cpu / W25Q_BENCH_STORE_RECORDS), (unsigned long)stalls,
+               (unsigned long)min_erase, (unsigned long)max_erase);
+    }
+
+    // 挂载：只读扇区头和头扇区，与读出整个存储区域比较
+    uint32_t transactions = s_model.transactions;
+    uint32_t bytes = s_model.bytes;
+    uint32_t t0 = bench_now();
+    store_boot(&spi, &flash, &store, W25Q_BENCH_STORE_SECTORS);
+    uint32_t mount_cpu = bench_now() - t0;
+    transactions = s_model.transactions - transactions;
+    bytes = s_model.bytes - bytes;
+    uint32_t scan_bytes = W25Q_BENCH_STORE_SECTORS * W25Q_SECTOR_SIZE;
+    bench_report("mount: %lu transactions, %lu bus bytes (%lu us), cpu %lu %s; full scan would read %lu bytes (%lu us)\r\n",
+           (unsigned long)transactions, (unsigned long)bytes,
+           (unsigned long)((uint64_t)bytes * 8u * 1000u / W25Q_BENCH_SPI_KHZ), (unsigned long)mount_cpu,
+           BENCH_UNIT, (unsigned long)scan_bytes,
+           (unsigned long)((uint64_t)scan_bytes * 8u * 1000u / W25Q_BENCH_SPI_KHZ));
+    spi_deinit(&spi);
+}
@@ -0,0 +1,67 @@
+#ifndef __DRIVER_W25Q_TEST_H
+#define __DRIVER_W25Q_TEST_H
+
+#include "driver_w25q.h"
+#include "driver_w25q_cache.h"
+#include "driver_w25q_store.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief W25Q驱动测试：在内存中的W25Q模型上验证读ID、快速读取、跨页编程的自动拆分、
+ * 4K/32K/64K/整片擦除、异步操作期间CPU不被阻塞 (查询间隔)、写使能跟踪、
+ * 芯片忙时不发送其他指令、写保护和超时
+ * @note  使用模拟的spi_api_t，不依赖硬件。
+ * @return led_status_t - 全部通过返回LED_STATUS_OK
+ */
+led_status_t driver_w25q_test(void);
+
+/**
+ * @brief 读缓存测试：验证命中和未命中、组内LRU替换、编程/擦除时的写直达失效
+ * (操作进行中其他块照常命中，未命中的块返回BUSY且不替换原有的行)、顺序访问时的预读，以及随机读写与模型存储内容的一致性
+ * @note  使用模拟的spi_api_t，不依赖硬件。
+ * @return led_status_t - 全部通过返回LED_STATUS_OK
+ */
+led_status_t driver_w25q_test_cache(void);
+
+/**
+ * @brief 读缓存基准测试：按配置解析、查找表、顺序读取和混合访问几种典型模式人工构造访问序列，
+ * 比较不用缓存和几种缓存配置的Flash事务数、总线字节数、估算的总线时间、命中率和每次读取的CPU开销
+ * @note  结果通过g_uart1输出，需在g_uart1完成uart_init之后调用。
+ */
+void driver_w25q_benchmark_cache(void);
+
+/**
+ * @brief 记录存储测试：验证在旧数据上挂载、后台擦除后追加、重新挂载后接着追加、
+ * 读取位置跟随新提交的记录、写满与释放 (释放在重新挂载后仍然有效)、环形覆盖和擦除次数均匀、
+ * 擦除期间追加缓冲区满时返回BUSY、写记录时掉电后的恢复、数据损坏的记录被跳过而后面的记录照常读出
+ * @note  使用模拟的spi_api_t，不依赖硬件。
+ * @return led_status_t - 全部通过返回LED_STATUS_OK
+ */
+led_status_t driver_w25q_test_store(void);
+
+/**
+ * @brief 记录存储掉电测试：随机追加、读取和释放记录，在随机的编程/擦除操作中途掉电
+ * (只写入或擦除了一部分)，重新挂载后检查读出的记录完整有序、已确认提交的记录没有缺失、
+ * 已删除或丢失的记录不会重新出现
+ * @note  使用模拟的spi_api_t，不依赖硬件。
+ * @param[in] cycles - 掉电次数
+ * @return led_status_t - 全部通过返回LED_STATUS_OK
+ */
+led_status_t driver_w25q_test_store_power_cut(uint32_t cycles);
+
+/**
+ * @brief 记录存储基准测试：以16/64/240字节的记录连续追加，按数据手册的典型值估算Flash时间和吞吐量，
+ * 输出每条记录的CPU开销、追加缓冲区满的次数和各扇区擦除次数的范围，以及挂载与全盘扫描的代价
+ * @note  结果通过g_uart1输出，需在g_uart1完成uart_init之后调用。
+ */
+void driver_w25q_benchmark_store(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif